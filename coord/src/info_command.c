@@ -26,6 +26,7 @@ static InfoFieldSpec toplevelSpecs_g[] = {
     {.name = "doc_table_size_mb", .type = InfoField_DoubleSum},
     {.name = "sortable_values_size_mb", .type = InfoField_DoubleSum},
     {.name = "key_table_size_mb", .type = InfoField_DoubleSum},
+    {.name = "deleted_bitmap_size_mb", .type = InfoField_DoubleSum},
     {.name = "records_per_doc_avg", .type = InfoField_DoubleAverage},
     {.name = "bytes_per_record_avg", .type = InfoField_DoubleAverage},
     {.name = "offsets_per_term_avg", .type = InfoField_DoubleAverage},
@@ -46,9 +47,26 @@ static InfoFieldSpec cursorSpecs[] = {
     {.name = "index_total", .type = InfoField_WholeSum},
 };
 
+static InfoFieldSpec expansionCacheSpecs[] = {
+    {.name = "hits", .type = InfoField_WholeSum},
+    {.name = "misses", .type = InfoField_WholeSum},
+    {.name = "entries", .type = InfoField_WholeSum},
+    {.name = "size_mb", .type = InfoField_DoubleSum},
+};
+
+static InfoFieldSpec resultCacheSpecs[] = {
+    {.name = "hits", .type = InfoField_WholeSum},
+    {.name = "misses", .type = InfoField_WholeSum},
+    {.name = "hit_ratio", .type = InfoField_DoubleAverage},
+    {.name = "entries", .type = InfoField_WholeSum},
+    {.name = "size_mb", .type = InfoField_DoubleSum},
+};
+
 #define NUM_FIELDS_SPEC (sizeof(toplevelSpecs_g) / sizeof(InfoFieldSpec))
 #define NUM_GC_FIELDS_SPEC (sizeof(gcSpecs) / sizeof(InfoFieldSpec))
 #define NUM_CURSOR_FIELDS_SPEC (sizeof(cursorSpecs) / sizeof(InfoFieldSpec))
+#define NUM_EXPANSION_CACHE_FIELDS_SPEC (sizeof(expansionCacheSpecs) / sizeof(InfoFieldSpec))
+#define NUM_RESULT_CACHE_FIELDS_SPEC (sizeof(resultCacheSpecs) / sizeof(InfoFieldSpec))
 
 // Variant value type
 typedef struct {
@@ -74,6 +92,8 @@ typedef struct {
   InfoValue toplevelValues[NUM_FIELDS_SPEC];
   InfoValue gcValues[NUM_GC_FIELDS_SPEC];
   InfoValue cursorValues[NUM_CURSOR_FIELDS_SPEC];
+  InfoValue expansionCacheValues[NUM_EXPANSION_CACHE_FIELDS_SPEC];
+  InfoValue resultCacheValues[NUM_RESULT_CACHE_FIELDS_SPEC];
 } InfoFields;
 
 /**
@@ -146,6 +166,12 @@ static void handleSpecialField(InfoFields *fields, const char *name, MRReply *va
 
   } else if (!strcmp(name, "cursor_stats")) {
     processKvArray(fields, value, fields->cursorValues, cursorSpecs, NUM_CURSOR_FIELDS_SPEC, 1);
+  } else if (!strcmp(name, "expansion_cache_stats")) {
+    processKvArray(fields, value, fields->expansionCacheValues, expansionCacheSpecs,
+                   NUM_EXPANSION_CACHE_FIELDS_SPEC, 1);
+  } else if (!strcmp(name, "result_cache_stats")) {
+    processKvArray(fields, value, fields->resultCacheValues, resultCacheSpecs,
+                   NUM_RESULT_CACHE_FIELDS_SPEC, 1);
   }
 }
 
@@ -253,6 +279,20 @@ static void generateFieldsReply(InfoFields *fields, RedisModuleCtx *ctx) {
   RedisModule_ReplySetArrayLength(ctx, nCursorStats);
   n += 2;
 
+  RedisModule_ReplyWithSimpleString(ctx, "expansion_cache_stats");
+  RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
+  size_t nExpansionCacheStats = replyKvArray(fields, ctx, fields->expansionCacheValues,
+                                             expansionCacheSpecs, NUM_EXPANSION_CACHE_FIELDS_SPEC);
+  RedisModule_ReplySetArrayLength(ctx, nExpansionCacheStats);
+  n += 2;
+
+  RedisModule_ReplyWithSimpleString(ctx, "result_cache_stats");
+  RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
+  size_t nResultCacheStats = replyKvArray(fields, ctx, fields->resultCacheValues,
+                                          resultCacheSpecs, NUM_RESULT_CACHE_FIELDS_SPEC);
+  RedisModule_ReplySetArrayLength(ctx, nResultCacheStats);
+  n += 2;
+
   n += replyKvArray(fields, ctx, fields->toplevelValues, toplevelSpecs_g, NUM_FIELDS_SPEC);
   RedisModule_ReplySetArrayLength(ctx, n);
 }
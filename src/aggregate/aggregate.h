@@ -6,6 +6,7 @@
 #include "result_processor.h"
 #include "expr/expression.h"
 #include "aggregate_plan.h"
+#include "result_cache.h"
 #include "rmutil/rm_assert.h"
 
 #ifdef __cplusplus
@@ -53,6 +54,10 @@ typedef enum {
   /* FT.AGGREGATE load all fields */
   QEXEC_AGG_LOAD_ALL = 0x20000,
 
+  /* The total number of results does not have to be exact, so results can be read from the
+   * index in the order of the sort key until the limit is reached */
+  QEXEC_F_WITHOUT_COUNT = 0x40000,
+
 } QEFlags;
 
 #define IsCount(r) ((r)->reqflags & QEXEC_F_NOROWS)
@@ -62,6 +67,15 @@ typedef enum {
 typedef enum {
   /* Received EOF from iterator */
   QEXEC_S_ITERDONE = 0x02,
+
+  /* The root iterator reads the results in the order of the sort key */
+  QEXEC_S_INDEX_ORDERED = 0x04,
+
+  /* The number of results was counted from the index, and no results are read */
+  QEXEC_S_COUNTED = 0x08,
+
+  /* The request is counted in the active queries of its index */
+  QEXEC_S_ACTIVE = 0x10,
 } QEStateFlags;
 
 typedef struct {
@@ -87,6 +101,16 @@ typedef struct {
   /** Root iterator. This is owned by the request */
   IndexIterator *rootiter;
 
+  /** Cached results of the query, read instead of the root iterator. Holds a reference */
+  CachedResultPage *cachedPage;
+
+  /** Number of results of a count request, when counted without reading them */
+  size_t countedResults;
+
+  /** Key to cache the results of the query under, and the index revision they are computed at */
+  sds cacheKey;
+  uint64_t cacheRevision;
+
   /** Context, owned by request */
   RedisSearchCtx *sctx;
 
@@ -342,6 +342,9 @@ static void serializeGroup(myArgArray_t *arr, const PLN_BaseStep *stp) {
   for (size_t ii = 0; ii < gstp->nproperties; ++ii) {
     append_string(arr, gstp->properties[ii]);
   }
+  if (gstp->byTagValues) {
+    append_string(arr, "TAGVALUES");
+  }
   size_t nreducers = array_len(gstp->reducers);
   for (size_t ii = 0; ii < nreducers; ++ii) {
     const PLN_Reducer *r = gstp->reducers + ii;
@@ -117,6 +117,9 @@ typedef struct {
     ArgsCursor args;
   } * reducers;
   int idx;
+  // TAGVALUES: group a BITSET tag field by each of its indexed values, rather than by the value
+  // of the field in the document
+  int byTagValues;
 } PLN_GroupStep;
 
 /**
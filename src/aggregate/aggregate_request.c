@@ -11,6 +11,7 @@
 #include "profile.h"
 #include "config.h"
 #include "util/timeout.h"
+#include "numeric_order.h"
 
 extern RSConfig RSGlobalConfig;
 
@@ -395,6 +396,7 @@ static int parseQueryArgs(ArgsCursor *ac, AREQ *req, RSSearchOptions *searchOpts
       {AC_MKBITFLAG("NOCONTENT", &req->reqflags, QEXEC_F_SEND_NOFIELDS)},
       {AC_MKBITFLAG("NOSTOPWORDS", &searchOpts->flags, Search_NoStopwrods)},
       {AC_MKBITFLAG("EXPLAINSCORE", &req->reqflags, QEXEC_F_SEND_SCOREEXPLAIN)},
+      {AC_MKBITFLAG("WITHOUTCOUNT", &req->reqflags, QEXEC_F_WITHOUT_COUNT)},
       {.name = "PAYLOAD",
        .type = AC_ARGTYPE_STRING,
        .target = &req->ast.udata,
@@ -607,6 +609,7 @@ static int parseGroupby(AREQ *req, ArgsCursor *ac, QueryError *status) {
   // Number of fields.. now let's see the reducers
   PLN_GroupStep *gstp = PLNGroupStep_New((const char **)groupArgs.objs, groupArgs.argc);
   AGPLN_AddStep(&req->ap, &gstp->base);
+  gstp->byTagValues = AC_AdvanceIfMatch(ac, "TAGVALUES");
 
   while (AC_AdvanceIfMatch(ac, "REDUCE")) {
     const char *name;
@@ -821,12 +824,113 @@ static void applyGlobalFilters(RSSearchOptions *opts, QueryAST *ast, const Redis
   }
 }
 
+/* The result cache keeps the scored and sorted page of plain searches. Requests which need more
+ * than the docId and score of their results, or which are read in several calls, are not cached */
+static int isResultCacheable(const AREQ *req) {
+  return RSGlobalConfig.resultCacheSize && IsSearch(req) && !IsProfile(req) && !isTrimming &&
+         !(req->reqflags &
+           (QEXEC_F_IS_CURSOR | QEXEC_F_SEND_HIGHLIGHT | QEXEC_F_SEND_SCOREEXPLAIN));
+}
+
+/* Looks the query up in the result cache of the index. On a miss, the key is kept so that the
+ * results are cached once computed. Returns 1 on a hit */
+static int lookupCachedResults(AREQ *req) {
+  IndexSpec *spec = req->sctx->spec;
+  sds key = QAST_SerializeKey(&req->ast, &req->searchopts);
+  if (!key) {
+    return 0;
+  }
+  key = sdscatprintf(key, " %x", req->reqflags);
+  const PLN_ArrangeStep *astp =
+      (PLN_ArrangeStep *)AGPLN_FindStep(&req->ap, NULL, NULL, PLN_T_ARRANGE);
+  if (astp) {
+    key = sdscatprintf(key, " %llu %llu %llx", (unsigned long long)astp->offset,
+                       (unsigned long long)astp->limit, (unsigned long long)astp->sortAscMap);
+    for (size_t ii = 0; astp->sortKeys && ii < array_len(astp->sortKeys); ++ii) {
+      key = sdscatprintf(key, " %zu:%s", strlen(astp->sortKeys[ii]), astp->sortKeys[ii]);
+    }
+  }
+
+  if (!spec->rescache) {
+    spec->rescache = NewResultCache();
+  }
+  req->cachedPage = ResultCache_Get(spec->rescache, key, spec->revision);
+  if (req->cachedPage) {
+    sdsfree(key);
+    return 1;
+  }
+  req->cacheKey = key;
+  req->cacheRevision = spec->revision;
+  return 0;
+}
+
+/* A search sorted by a single sortable numeric field, which does not need the exact number of
+ * results, reads the matches in the order of the field's range tree so that reading stops at
+ * the limit */
+static void applyNumericOrder(AREQ *req) {
+  IndexSpec *sp = req->sctx->spec;
+  const PLN_ArrangeStep *astp = AGPLN_GetArrangeStep(&req->ap);
+  if (!(req->reqflags & QEXEC_F_WITHOUT_COUNT) || !IsSearch(req) || IsCount(req) ||
+      !req->rootiter || req->ast.vecScoreFieldNames || !isSpecHash(sp) || !astp ||
+      !astp->sortKeys || array_len(astp->sortKeys) != 1) {
+    return;
+  }
+  // multi-value documents are only indexed from JSON, so hash documents have a single value
+  const char *sortKey = astp->sortKeys[0];
+  const FieldSpec *fs = IndexSpec_GetField(sp, sortKey, strlen(sortKey));
+  if (!fs || !FIELD_IS(fs, INDEXFLD_T_NUMERIC) || !FieldSpec_IsSortable(fs)) {
+    return;
+  }
+  NumericRangeTree *t = OpenNumericIndexForQuery(req->sctx, fs->name, INDEXFLD_T_NUMERIC);
+  if (!t) {
+    return;
+  }
+  req->rootiter = NewNumericOrderIterator(sp, t, req->rootiter, fs->sortIdx,
+                                          SORTASCMAP_GETASC(astp->sortAscMap, 0));
+  req->stateflags |= QEXEC_S_INDEX_ORDERED;
+}
+
+/* Returns 1 if the steps of the plan do not change the number of results */
+static int keepsResultCount(AGGPlan *pln) {
+  DLLIST_FOREACH(nn, &pln->steps) {
+    const PLN_BaseStep *stp = DLLIST_ITEM(nn, PLN_BaseStep, llnodePln);
+    if (stp->type != PLN_T_ROOT && stp->type != PLN_T_ARRANGE && stp->type != PLN_T_LOAD) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* A count request whose query is a single numeric range is counted on the range tree of the
+ * field, without going through the results. Returns 1 if the request was counted */
+static int applyNumericCount(AREQ *req) {
+  IndexSpec *sp = req->sctx->spec;
+  const QueryNode *root = req->ast.root;
+  if (!IsCount(req) || IsProfile(req) || isTrimming || (req->reqflags & QEXEC_F_IS_CURSOR) ||
+      !isSpecHash(sp) || !root || root->type != QN_NUMERIC || !keepsResultCount(&req->ap)) {
+    return 0;
+  }
+  // multi-value documents are only indexed from JSON, so each document is counted once
+  const NumericFilter *nf = root->nn.nf;
+  const FieldSpec *fs = IndexSpec_GetField(sp, nf->fieldName, strlen(nf->fieldName));
+  if (!fs || !FIELD_IS(fs, INDEXFLD_T_NUMERIC)) {
+    return 0;
+  }
+  NumericRangeTree *t = OpenNumericIndexForQuery(req->sctx, nf->fieldName, INDEXFLD_T_NUMERIC);
+  req->countedResults = t ? NumericRangeTree_CountMatches(t, sp, nf) : 0;
+  req->stateflags |= QEXEC_S_COUNTED;
+  return 1;
+}
+
 int AREQ_ApplyContext(AREQ *req, RedisSearchCtx *sctx, QueryError *status) {
   // Sort through the applicable options:
   IndexSpec *index = sctx->spec;
   RSSearchOptions *opts = &req->searchopts;
   sctx->timeout = req->timeoutTime;
   req->sctx = sctx;
+  // the document ids of the index are not compacted until the request is freed
+  __sync_fetch_and_add(&index->activeQueries, 1);
+  req->stateflags |= QEXEC_S_ACTIVE;
 
   if ((index->flags & Index_StoreByteOffsets) == 0 && (req->reqflags & QEXEC_F_SEND_HIGHLIGHT)) {
     QueryError_SetError(
@@ -876,12 +980,19 @@ int AREQ_ApplyContext(AREQ *req, RedisSearchCtx *sctx, QueryError *status) {
   }
 
   ConcurrentSearchCtx_Init(sctx->redisCtx, &req->conc);
+  if (isResultCacheable(req) && lookupCachedResults(req)) {
+    return REDISMODULE_OK;
+  }
+  if (applyNumericCount(req)) {
+    return REDISMODULE_OK;
+  }
   req->rootiter = QAST_Iterate(ast, opts, sctx, &req->conc, req->reqflags, status);
 
   TimedOut_WithStatus(&req->timeoutTime, status);
 
   if (QueryError_HasError(status))
     return REDISMODULE_ERR;
+  applyNumericOrder(req);
   if (IsProfile(req)) {
     // Add a Profile iterators before every iterator in the tree
     Profile_AddIters(&req->rootiter);
@@ -950,10 +1061,56 @@ static ResultProcessor *pushRP(AREQ *req, ResultProcessor *rp, ResultProcessor *
   return rp;
 }
 
+/* Build a processor counting the results by the values of a tag field from the bitsets of the
+ * field, if the group step is the first step, and groups the results by a single tag field with
+ * bitsets, and only has COUNT reducers. Returns NULL otherwise */
+/* The facets of a BITSET tag field grouped by TAGVALUES are counted from the bitsets of its values,
+ * without loading the documents. The groups are the indexed values, so a document with several
+ * values is counted once for each of them */
+static ResultProcessor *getTagFacetsRP(AREQ *req, PLN_GroupStep *gstp, RLookup *lookup,
+                                       QueryError *status) {
+  size_t nreducers = array_len(gstp->reducers);
+  if (!req->sctx || gstp->nproperties != 1 ||
+      lookup != AGPLN_GetLookup(&req->ap, &gstp->base, AGPLN_GETLOOKUP_FIRST)) {
+    QueryError_SetError(status, QUERY_EBADOPTION,
+                        "TAGVALUES must group the results of the query by a single field");
+    return NULL;
+  }
+  for (size_t ii = 0; ii < nreducers; ++ii) {
+    if (strcasecmp(gstp->reducers[ii].name, "COUNT") || gstp->reducers[ii].args.argc) {
+      QueryError_SetError(status, QUERY_EBADOPTION, "TAGVALUES only supports COUNT reducers");
+      return NULL;
+    }
+  }
+  const char *fldname = gstp->properties[0] + 1;  // account for the @-
+  const FieldSpec *fs = IndexSpec_GetField(req->sctx->spec, fldname, strlen(fldname));
+  if (!fs || !FIELD_IS(fs, INDEXFLD_T_TAG) || !(fs->tagOpts.tagFlags & TagField_Bitset) ||
+      !RLookup_GetKey(lookup, fldname, RLOOKUP_F_NOINCREF)) {
+    QueryError_SetErrorFmt(status, QUERY_EBADOPTION,
+                           "TAGVALUES requires a BITSET TAG field, `%s` is not", fldname);
+    return NULL;
+  }
+
+  const RLookupKey *countKeys[nreducers];
+  for (size_t ii = 0; ii < nreducers; ++ii) {
+    countKeys[ii] = RLookup_GetKey(&gstp->lookup, gstp->reducers[ii].alias,
+                                   RLOOKUP_F_OCREAT | RLOOKUP_F_NOINCREF);
+  }
+  const RLookupKey *valueKey =
+      RLookup_GetKey(&gstp->lookup, fldname, RLOOKUP_F_OCREAT | RLOOKUP_F_NOINCREF);
+  return RPTagFacets_New(fs->name, valueKey, countKeys, nreducers);
+}
+
 static ResultProcessor *getGroupRP(AREQ *req, PLN_GroupStep *gstp, ResultProcessor *rpUpstream,
                                    QueryError *status) {
   AGGPlan *pln = &req->ap;
   RLookup *lookup = AGPLN_GetLookup(pln, &gstp->base, AGPLN_GETLOOKUP_PREV);
+
+  if (gstp->byTagValues) {
+    ResultProcessor *facetsRP = getTagFacetsRP(req, gstp, lookup, status);
+    return facetsRP ? pushRP(req, facetsRP, rpUpstream) : NULL;
+  }
+
   ResultProcessor *groupRP = buildGroupRP(gstp, lookup, status);
 
   if (!groupRP) {
@@ -1019,6 +1176,9 @@ static ResultProcessor *getArrangeRP(AREQ *req, AGGPlan *pln, const PLN_BaseStep
   if (IsCount(req)) {
     rp = RPCounter_New();
     up = pushRP(req, rp, up);
+    if (req->cacheKey) {
+      up = pushRP(req, RPResultCacheWriter_New(req->cacheKey, req->cacheRevision), up);
+    }
     return up;
   }
 
@@ -1044,6 +1204,10 @@ static ResultProcessor *getArrangeRP(AREQ *req, AGGPlan *pln, const PLN_BaseStep
       }
     }
 
+    // Results read in the order of the sort key need no more than the limit to be sorted
+    if (req->stateflags & QEXEC_S_INDEX_ORDERED) {
+      up = pushRP(req, RPPager_New(0, limit), up);
+    }
     rp = RPSorter_NewByFields(limit, sortkeys, nkeys, astp->sortAscMap);
     up = pushRP(req, rp, up);
   }
@@ -1054,6 +1218,12 @@ static ResultProcessor *getArrangeRP(AREQ *req, AGGPlan *pln, const PLN_BaseStep
     up = pushRP(req, rp, up);
   }
 
+  // Cache the sorted results before paging, the pager is applied again on every hit
+  if (rp && req->cacheKey) {
+    rp = RPResultCacheWriter_New(req->cacheKey, req->cacheRevision);
+    up = pushRP(req, rp, up);
+  }
+
   if (astp->offset || (astp->limit && !rp)) {
     rp = RPPager_New(astp->offset, astp->limit);
     up = pushRP(req, rp, up);
@@ -1080,6 +1250,22 @@ static ResultProcessor *getScorerRP(AREQ *req) {
   return rp;
 }
 
+/* Results of a search without SORTBY are kept in a bounded heap ordered by score, so the
+ * iterators can skip whatever cannot beat the lowest score in the heap */
+static void applyTopKPruning(AREQ *req) {
+  const char *scorer = req->searchopts.scorerName;
+  if (!scorer) {
+    scorer = DEFAULT_SCORER_NAME;
+  }
+  TopKPruneCtx ctx = {.TermBound = DefaultScorer_GetTermBound(scorer),
+                      .threshold = &req->qiter.minScore};
+  if (!ctx.TermBound || req->ast.vecScoreFieldNames) {
+    return;
+  }
+  IndexSpec_GetStats(req->sctx->spec, &ctx.stats);
+  IndexIterator_EnableTopKPruning(req->rootiter, &ctx);
+}
+
 static int hasQuerySortby(const AGGPlan *pln) {
   const PLN_BaseStep *bstp = AGPLN_FindStep(pln, NULL, NULL, PLN_T_GROUP);
   if (bstp != NULL) {
@@ -1115,8 +1301,22 @@ static void buildImplicitPipeline(AREQ *req, QueryError *Status) {
 
   RLookup_Init(first, cache);
 
-  ResultProcessor *rp = RPIndexIterator_New(req->rootiter, req->timeoutTime);
   ResultProcessor *rpUpstream = NULL;
+  if (req->cachedPage) {
+    // The cached results are already scored, and are sorted again by the arrange step
+    ResultProcessor *rp = RPCachedResults_New(req->cachedPage);
+    req->qiter.rootProc = req->qiter.endProc = rp;
+    PUSH_RP();
+    return;
+  }
+  if (req->stateflags & QEXEC_S_COUNTED) {
+    ResultProcessor *rp = RPCountedResults_New(req->countedResults);
+    req->qiter.rootProc = req->qiter.endProc = rp;
+    PUSH_RP();
+    return;
+  }
+
+  ResultProcessor *rp = RPIndexIterator_New(req->rootiter, req->timeoutTime);
   req->qiter.rootProc = req->qiter.endProc = rp;
   PUSH_RP();
 
@@ -1128,6 +1328,10 @@ static void buildImplicitPipeline(AREQ *req, QueryError *Status) {
     rp = getScorerRP(req);
     PUSH_RP();
   }
+
+  if (RSGlobalConfig.topkPruning && !hasQuerySortby(&req->ap) && IsSearch(req) && !IsCount(req)) {
+    applyTopKPruning(req);
+  }
 }
 
 /**
@@ -1352,6 +1556,14 @@ void AREQ_Free(AREQ *req) {
     req->rootiter->Free(req->rootiter);
     req->rootiter = NULL;
   }
+  if (req->cachedPage) {
+    CachedResultPage_Decref(req->cachedPage);
+    req->cachedPage = NULL;
+  }
+  if (req->cacheKey) {
+    sdsfree(req->cacheKey);
+    req->cacheKey = NULL;
+  }
 
   // Go through each of the steps and free it..
   AGPLN_FreeSteps(&req->ap);
@@ -1369,6 +1581,9 @@ void AREQ_Free(AREQ *req) {
   // detached ("Thread Safe") context.
   RedisModuleCtx *thctx = NULL;
   if (req->sctx) {
+    if (req->stateflags & QEXEC_S_ACTIVE) {
+      __sync_sub_and_fetch(&req->sctx->spec->activeQueries, 1);
+    }
     if (req->reqflags & QEXEC_F_IS_CURSOR) {
       thctx = req->sctx->redisCtx;
       req->sctx->redisCtx = NULL;
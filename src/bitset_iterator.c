@@ -0,0 +1,115 @@
+#include "bitset_iterator.h"
+#include "index_result.h"
+#include "rmalloc.h"
+
+/* Move to the first set bit at or after docId */
+static int BI_Seek(BitsetIterator *it, t_docId docId, RSIndexResult **hit) {
+  size_t w = docId / 64;
+  if (w >= it->nwords) {
+    IITER_SET_EOF(&it->base);
+    return INDEXREAD_EOF;
+  }
+  uint64_t word = it->words[w] & (~0ULL << (docId % 64));
+  while (!word) {
+    if (++w == it->nwords) {
+      IITER_SET_EOF(&it->base);
+      return INDEXREAD_EOF;
+    }
+    word = it->words[w];
+  }
+  it->lastDocId = w * 64 + __builtin_ctzll(word);
+  it->base.current->docId = it->lastDocId;
+  *hit = it->base.current;
+  return INDEXREAD_OK;
+}
+
+static int BI_Read(void *ctx, RSIndexResult **hit) {
+  BitsetIterator *it = ctx;
+  if (!it->base.isValid) {
+    return INDEXREAD_EOF;
+  }
+  return BI_Seek(it, it->lastDocId + 1, hit);
+}
+
+static int BI_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
+  BitsetIterator *it = ctx;
+  if (!it->base.isValid) {
+    return INDEXREAD_EOF;
+  }
+  if (docId <= it->lastDocId) {
+    // the iterator is already at or past docId
+    *hit = it->base.current;
+    return docId == it->lastDocId ? INDEXREAD_OK : INDEXREAD_NOTFOUND;
+  }
+  int rc = BI_Seek(it, docId, hit);
+  if (rc == INDEXREAD_OK && it->lastDocId != docId) {
+    return INDEXREAD_NOTFOUND;
+  }
+  return rc;
+}
+
+static size_t BI_NumEstimated(void *ctx) {
+  BitsetIterator *it = ctx;
+  return it->numDocs;
+}
+
+static t_docId BI_LastDocId(void *ctx) {
+  BitsetIterator *it = ctx;
+  return it->lastDocId;
+}
+
+static int BI_HasNext(void *ctx) {
+  BitsetIterator *it = ctx;
+  return it->base.isValid;
+}
+
+static void BI_Abort(void *ctx) {
+  BitsetIterator *it = ctx;
+  IITER_SET_EOF(&it->base);
+}
+
+static void BI_Rewind(void *ctx) {
+  BitsetIterator *it = ctx;
+  it->lastDocId = 0;
+  it->base.current->docId = 0;
+  IITER_CLEAR_EOF(&it->base);
+}
+
+static void BI_Free(IndexIterator *self) {
+  BitsetIterator *it = self->ctx;
+  IndexResult_Free(it->base.current);
+  rm_free(it->words);
+  rm_free(it);
+}
+
+IndexIterator *NewBitsetIterator(uint64_t *words, size_t nwords, double weight) {
+  BitsetIterator *it = rm_calloc(1, sizeof(*it));
+  it->words = words;
+  it->nwords = nwords;
+  // docId 0 is never used, so its bit is not read
+  if (nwords) {
+    it->words[0] &= ~1ULL;
+  }
+  for (size_t i = 0; i < nwords; ++i) {
+    it->numDocs += __builtin_popcountll(words[i]);
+  }
+
+  IndexIterator *ri = &it->base;
+  ri->ctx = it;
+  ri->type = BITSET_ITERATOR;
+  ri->mode = MODE_SORTED;
+  ri->isValid = 1;
+  ri->current = NewVirtualResult(weight);
+  ri->current->fieldMask = RS_FIELDMASK_ALL;
+  ri->NumEstimated = BI_NumEstimated;
+  ri->GetCriteriaTester = NULL;
+  ri->Read = BI_Read;
+  ri->SkipTo = BI_SkipTo;
+  ri->LastDocId = BI_LastDocId;
+  ri->HasNext = BI_HasNext;
+  ri->Free = BI_Free;
+  ri->Len = BI_NumEstimated;
+  ri->Abort = BI_Abort;
+  ri->Rewind = BI_Rewind;
+  return ri;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "index_iterator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Reads the docIds of a bitset, whose bit b of word w is set for the docId w * 64 + b. The bitset
+ * is usually computed with word-level operations out of the bitsets of tag values, so a union or
+ * an intersection of dense values is read without merging their inverted indexes */
+typedef struct {
+  IndexIterator base;
+  uint64_t *words;
+  size_t nwords;
+  size_t numDocs;
+  t_docId lastDocId;
+} BitsetIterator;
+
+/* Create an iterator over the set bits of words, which it takes ownership of */
+IndexIterator *NewBitsetIterator(uint64_t *words, size_t nwords, double weight);
+
+#ifdef __cplusplus
+}
+#endif
@@ -275,6 +275,11 @@ CONFIG_SETTER(setForkGcCleanThreshold) {
   RETURN_STATUS(acrc);
 }
 
+CONFIG_SETTER(setForkGcCompactDocIdsRatio) {
+  int acrc = AC_GetSize(ac, &config->forkGcCompactDocIdsRatio, 0);
+  RETURN_STATUS(acrc);
+}
+
 CONFIG_SETTER(setForkGcRetryInterval) {
   int acrc = AC_GetSize(ac, &config->forkGcRetryInterval, AC_F_GE1);
   RETURN_STATUS(acrc);
@@ -290,6 +295,11 @@ CONFIG_SETTER(setMinUnionIteratorHeap) {
   RETURN_STATUS(acrc);
 }
 
+CONFIG_SETTER(setMinUnionAccumulate) {
+  int acrc = AC_GetLongLong(ac, &config->minUnionAccumulate, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
 CONFIG_SETTER(setCursorMaxIdle) {
   int acrc = AC_GetLongLong(ac, &config->cursorMaxIdle, AC_F_GE1);
   RETURN_STATUS(acrc);
@@ -300,6 +310,11 @@ CONFIG_GETTER(getForkGcCleanThreshold) {
   return sdscatprintf(ss, "%lu", config->forkGcCleanThreshold);
 }
 
+CONFIG_GETTER(getForkGcCompactDocIdsRatio) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->forkGcCompactDocIdsRatio);
+}
+
 CONFIG_GETTER(getForkGcInterval) {
   sds ss = sdsempty();
   return sdscatprintf(ss, "%lu", config->forkGcRunIntervalSec);
@@ -332,6 +347,11 @@ CONFIG_GETTER(getMinUnionIteratorHeap) {
   return sdscatprintf(ss, "%lld", config->minUnionIterHeap);
 }
 
+CONFIG_GETTER(getMinUnionAccumulate) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lld", config->minUnionAccumulate);
+}
+
 CONFIG_GETTER(getCursorMaxIdle) {
   sds ss = sdsempty();
   return sdscatprintf(ss, "%lld", config->cursorMaxIdle);
@@ -363,6 +383,10 @@ CONFIG_BOOLEAN_GETTER(getPrintProfileClock, printProfileClock, 0)
 CONFIG_BOOLEAN_SETTER(setRawDocIDEncoding, invertedIndexRawDocidEncoding)
 CONFIG_BOOLEAN_GETTER(getRawDocIDEncoding, invertedIndexRawDocidEncoding, 0)
 
+// _TOPK_PRUNING
+CONFIG_BOOLEAN_SETTER(setTopKPruning, topkPruning)
+CONFIG_BOOLEAN_GETTER(getTopKPruning, topkPruning, 0)
+
 CONFIG_SETTER(setNumericTreeMaxDepthRange) {
   size_t maxDepthRange;
   int acrc = AC_GetSize(ac, &maxDepthRange, AC_F_GE0);
@@ -409,6 +433,46 @@ CONFIG_GETTER(getVSSMaxResize) {
   return sdscatprintf(ss, "%u", config->vssMaxResize);
 }
 
+CONFIG_SETTER(setExpansionCacheMaxMemory) {
+  int acrc = AC_GetSize(ac, &config->expansionCacheMaxMemory, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getExpansionCacheMaxMemory) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%zu", config->expansionCacheMaxMemory);
+}
+
+CONFIG_SETTER(setResultCacheSize) {
+  int acrc = AC_GetSize(ac, &config->resultCacheSize, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getResultCacheSize) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%zu", config->resultCacheSize);
+}
+
+CONFIG_SETTER(setResultCacheTTL) {
+  int acrc = AC_GetSize(ac, &config->resultCacheTTL, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getResultCacheTTL) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%zu", config->resultCacheTTL);
+}
+
+CONFIG_SETTER(setResultCacheMaxMemory) {
+  int acrc = AC_GetSize(ac, &config->resultCacheMaxMemory, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getResultCacheMaxMemory) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%zu", config->resultCacheMaxMemory);
+}
+
 CONFIG_SETTER(setGcPolicy) {
   const char *policy;
   int acrc = AC_GetString(ac, &policy, NULL, 0);
@@ -662,6 +726,11 @@ RSConfigOptions RSGlobalConfigOptions = {
                      "will acceded this threshold",
          .setValue = setForkGcCleanThreshold,
          .getValue = getForkGcCleanThreshold},
+        {.name = "FORK_GC_COMPACT_DOCIDS_RATIO",
+         .helpText = "after a cycle, the fork gc renumbers the documents of an index once its "
+                     "highest document id is this many times its number of documents (0 to disable)",
+         .setValue = setForkGcCompactDocIdsRatio,
+         .getValue = getForkGcCompactDocIdsRatio},
         {.name = "FORK_GC_RETRY_INTERVAL",
          .helpText = "interval (in seconds) in which to retry running the forkgc after failure.",
          .setValue = setForkGcRetryInterval,
@@ -684,6 +753,11 @@ RSConfigOptions RSGlobalConfigOptions = {
                      "switch to heap based implementation.",
          .setValue = setMinUnionIteratorHeap,
          .getValue = getMinUnionIteratorHeap},
+        {.name = "UNION_ITERATOR_ACCUMULATE",
+         .helpText = "minimum number of expanded terms in a prefix, fuzzy or suffix query from "
+                     "which they are read term-at-a-time into a bitmap. 0 disables it.",
+         .setValue = setMinUnionAccumulate,
+         .getValue = getMinUnionAccumulate},
         {.name = "CURSOR_MAX_IDLE",
          .helpText = "max idle time allowed to be set for cursor, setting it hight might cause "
                      "high memory consumption.",
@@ -722,6 +796,11 @@ RSConfigOptions RSGlobalConfigOptions = {
          .setValue = setRawDocIDEncoding,
          .getValue = getRawDocIDEncoding,
          .flags = RSCONFIGVAR_F_IMMUTABLE},
+        {.name = "_TOPK_PRUNING",
+         .helpText = "Skip index blocks which cannot make it into the top results of a search "
+                     "sorted by score. The total number of results becomes an estimate.",
+         .setValue = setTopKPruning,
+         .getValue = getTopKPruning},
         {.name = "_NUMERIC_RANGES_PARENTS",
          .helpText = "Keep numeric ranges in numeric tree parent nodes of leafs "
                      "for `x` generations.",
@@ -735,6 +814,26 @@ RSConfigOptions RSGlobalConfigOptions = {
          .helpText = "Set RediSearch vector indexes max resize (in bytes).",
          .setValue = setVSSMaxResize,
          .getValue = getVSSMaxResize},
+        {.name = "EXPANSION_CACHE_MAX_MEMORY",
+         .helpText = "Memory limit (in bytes) of the cached prefix, suffix and contains expansions "
+                     "of each index. 0 disables the cache.",
+         .setValue = setExpansionCacheMaxMemory,
+         .getValue = getExpansionCacheMaxMemory},
+        {.name = "RESULT_CACHE_SIZE",
+         .helpText = "Number of result pages cached per index, invalidated by any write to the "
+                     "index. 0 disables the cache.",
+         .setValue = setResultCacheSize,
+         .getValue = getResultCacheSize},
+        {.name = "RESULT_CACHE_TTL",
+         .helpText = "Time to live (in ms) of a cached result page. 0 keeps pages until they are "
+                     "invalidated or evicted.",
+         .setValue = setResultCacheTTL,
+         .getValue = getResultCacheTTL},
+        {.name = "RESULT_CACHE_MAX_MEMORY",
+         .helpText = "Memory limit (in bytes) of the cached result pages of each index. Pages "
+                     "larger than the limit are not cached.",
+         .setValue = setResultCacheMaxMemory,
+         .getValue = getResultCacheMaxMemory},
         {.name = NULL}}};
 
 void RSConfigOptions_AddConfigs(RSConfigOptions *src, RSConfigOptions *dst) {
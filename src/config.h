@@ -79,6 +79,8 @@ typedef struct {
   GCPolicy gcPolicy;
   size_t forkGcRunIntervalSec;
   size_t forkGcCleanThreshold;
+  // Renumber the documents of an index once its max docId reaches this multiple of its size
+  size_t forkGcCompactDocIdsRatio;
   size_t forkGcRetryInterval;
   size_t forkGcSleepBeforeExit;
   int forkGCCleanNumericEmptyNodes;
@@ -90,6 +92,8 @@ typedef struct {
 
   long long maxResultsToUnsortedMode;
   long long minUnionIterHeap;
+  // minimum number of expanded terms from which a union is evaluated term-at-a-time
+  long long minUnionAccumulate;
 
   int noMemPool;
 
@@ -105,11 +109,21 @@ typedef struct {
   int printProfileClock;
   // disable compression for inverted index DocIdsOnly
   int invertedIndexRawDocidEncoding;
+  // skip index blocks which cannot enter the top-k results of a search sorted by score
+  int topkPruning;
   // Default dialect level used throughout database lifetime.
   unsigned int defaultDialectVersion;
   // sets the memory limit for vector indexes to resize by (in bytes).
   // 0 indicates no limit. Default value is 0.
   unsigned int vssMaxResize;
+  // memory limit of the cached expansions of each index (in bytes), 0 disables the cache
+  size_t expansionCacheMaxMemory;
+  // number of result pages cached per index, 0 disables the cache
+  size_t resultCacheSize;
+  // time to live of a cached result page (in ms), 0 keeps pages until invalidated or evicted
+  size_t resultCacheTTL;
+  // memory limit of the cached result pages of each index (in bytes)
+  size_t resultCacheMaxMemory;
 } RSConfig;
 
 typedef enum {
@@ -195,10 +209,14 @@ void RSConfig_AddToInfo(RedisModuleInfoCtx *ctx);
     .forkGcSleepBeforeExit = 0, .maxResultsToUnsortedMode = DEFAULT_MAX_RESULTS_TO_UNSORTED_MODE, \
     .forkGcRetryInterval = 5, .forkGcCleanThreshold = 100, .noMemPool = 0, .filterCommands = 0,   \
     .maxSearchResults = SEARCH_REQUEST_RESULTS_MAX, .maxAggregateResults = -1,                    \
-    .minUnionIterHeap = 20, .numericCompress = false, .numericTreeMaxDepthRange = 0,              \
+    .minUnionIterHeap = 20, .minUnionAccumulate = 100, .numericCompress = false,                  \
+    .numericTreeMaxDepthRange = 0,                                                                \
     .printProfileClock = 1, .invertedIndexRawDocidEncoding = false,                               \
     .forkGCCleanNumericEmptyNodes = true, .freeResourcesThread = true, .defaultDialectVersion = 1,\
-    .vssMaxResize = 0,                                                                            \
+    .vssMaxResize = 0, .topkPruning = false,                                                      \
+    .expansionCacheMaxMemory = 16 * 1024 * 1024,                                                  \
+    .resultCacheSize = 0, .resultCacheTTL = 0, .forkGcCompactDocIdsRatio = 0,                     \
+    .resultCacheMaxMemory = 16 * 1024 * 1024,                                                     \
   }
 
 #define REDIS_ARRAY_LIMIT 7
@@ -329,6 +329,14 @@ void Cursors_RenderStatsForInfo(CursorList *cl, const char *name, RedisModuleInf
 }
 #endif // FTINFO_FOR_INFO_MODULES
 
+size_t Cursors_NumOpen(CursorList *cl, const char *lookupName) {
+  CursorList_Lock(cl);
+  CursorSpecInfo *info = findInfo(cl, lookupName, NULL);
+  size_t used = info ? info->used : 0;
+  CursorList_Unlock(cl);
+  return used;
+}
+
 static void purgeCb(CursorList *cl, Cursor *cur, void *arg) {
   CursorSpecInfo *info = arg;
   if (cur->specInfo != info) {
@@ -169,6 +169,9 @@ int Cursors_Purge(CursorList *cl, uint64_t cid);
 
 int Cursors_CollectIdle(CursorList *cl);
 
+/** Number of cursors open on the given lookup name */
+size_t Cursors_NumOpen(CursorList *cl, const char *lookupName);
+
 /** Remove all cursors with the given lookup name */
 void Cursors_PurgeWithName(CursorList *cl, const char *lookupName);
 
@@ -8,6 +8,7 @@
 #include "gc.h"
 #include "module.h"
 #include "suffix.h"
+#include "docid_compaction.h"
 
 #define DUMP_PHONETIC_HASH "DUMP_PHONETIC_HASH"
 
@@ -241,23 +242,15 @@ DEBUG_COMMAND(DumpTagIndex) {
     goto end;
   }
 
-  TrieMapIterator *iter = TrieMap_Iterate(tagIndex->values, "", 0);
-
-  char *tag;
-  tm_len_t len;
-  InvertedIndex *iv;
-
-  size_t resultSize = 0;
-  RedisModule_ReplyWithArray(sctx->redisCtx, REDISMODULE_POSTPONED_ARRAY_LEN);
-  while (TrieMapIterator_Next(iter, &tag, &len, (void **)&iv)) {
+  TagValue **sorted = TagIndex_SortedValues(tagIndex);
+  size_t resultSize = TagIndex_NumValues(tagIndex);
+  RedisModule_ReplyWithArray(sctx->redisCtx, resultSize);
+  for (size_t i = 0; i < resultSize; ++i) {
     RedisModule_ReplyWithArray(sctx->redisCtx, 2);
-    RedisModule_ReplyWithStringBuffer(sctx->redisCtx, tag, len);
-    IndexReader *reader = NewTermIndexReader(iv, NULL, RS_FIELDMASK_ALL, NULL, 1);
+    RedisModule_ReplyWithStringBuffer(sctx->redisCtx, sorted[i]->str, sorted[i]->len);
+    IndexReader *reader = NewTermIndexReader(sorted[i]->iv, NULL, RS_FIELDMASK_ALL, NULL, 1);
     ReplyReaderResults(reader, sctx->redisCtx);
-    ++resultSize;
   }
-  RedisModule_ReplySetArrayLength(sctx->redisCtx, resultSize);
-  TrieMapIterator_Free(iter);
 
 end:
   if (keyp) {
@@ -467,6 +460,32 @@ end:
   return REDISMODULE_OK;
 }
 
+DEBUG_COMMAND(CompactDocIds) {
+  if (argc != 1) {
+    return RedisModule_WrongArity(ctx);
+  }
+  GET_SEARCH_CTX(argv[0])
+  DocIdCompactionStats stats;
+  QueryError status = {0};
+  if (IndexSpec_CompactDocIds(sctx, &stats, &status) != REDISMODULE_OK) {
+    QueryError_ReplyAndClear(ctx, &status);
+    goto end;
+  }
+
+  size_t len = 0;
+  RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
+  REPLY_WITH_LONG_LONG("max_doc_id_before", stats.maxDocIdBefore, len);
+  REPLY_WITH_LONG_LONG("max_doc_id_after", stats.maxDocIdAfter, len);
+  REPLY_WITH_LONG_LONG("inverted_size_before", stats.invertedSizeBefore, len);
+  REPLY_WITH_LONG_LONG("inverted_size_after", stats.invertedSizeAfter, len);
+  REPLY_WITH_LONG_LONG("records_removed", stats.recordsRemoved, len);
+  RedisModule_ReplySetArrayLength(ctx, len);
+
+end:
+  SearchCtx_Free(sctx);
+  return REDISMODULE_OK;
+}
+
 DEBUG_COMMAND(ttl) {
   if (argc < 1) {
     return RedisModule_WrongArity(ctx);
@@ -519,18 +538,6 @@ typedef struct {
   const char *prefix;
 } DumpOptions;
 
-static void seekTagIterator(TrieMapIterator *it, size_t offset) {
-  char *tag;
-  tm_len_t len;
-  InvertedIndex *iv;
-
-  for (size_t n = 0; n < offset; n++) {
-    if (!TrieMapIterator_Next(it, &tag, &len, (void **)&iv)) {
-      break;
-    }
-  }
-}
-
 /**
  * INFO_TAGIDX <index> <field> [OPTIONS...]
  */
@@ -565,7 +572,7 @@ DEBUG_COMMAND(InfoTagIndex) {
     goto end;
   }
 
-  const TagIndex *idx = TagIndex_Open(sctx, keyName, false, &keyp);
+  TagIndex *idx = TagIndex_Open(sctx, keyName, false, &keyp);
   if (!idx) {
     RedisModule_ReplyWithError(sctx->redisCtx, "can not open tag field");
     goto end;
@@ -574,7 +581,7 @@ DEBUG_COMMAND(InfoTagIndex) {
   size_t nelem = 0;
   RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
   RedisModule_ReplyWithSimpleString(ctx, "num_values");
-  RedisModule_ReplyWithLongLong(ctx, idx->values->cardinality);
+  RedisModule_ReplyWithLongLong(ctx, TagIndex_NumValues(idx));
   nelem += 2;
 
   if (options.dumpIdEntries) {
@@ -586,18 +593,16 @@ DEBUG_COMMAND(InfoTagIndex) {
   }
 
   size_t limit = options.limit ? options.limit : 0;
-  TrieMapIterator *iter = TrieMap_Iterate(idx->values, "", 0);
-  char *tag;
-  tm_len_t len;
-  InvertedIndex *iv;
+  TagValue **sorted = TagIndex_SortedValues(idx);
+  size_t numValues = TagIndex_NumValues(idx);
 
   nelem += 2;
   RedisModule_ReplyWithSimpleString(ctx, "values");
   RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
 
-  seekTagIterator(iter, options.offset);
   size_t nvalues = 0;
-  while (nvalues++ < limit && TrieMapIterator_Next(iter, &tag, &len, (void **)&iv)) {
+  for (size_t i = options.offset; nvalues < limit && i < numValues; ++i, ++nvalues) {
+    InvertedIndex *iv = sorted[i]->iv;
     size_t nsubelem = 8;
     if (!options.dumpIdEntries) {
       nsubelem -= 2;
@@ -605,7 +610,7 @@ DEBUG_COMMAND(InfoTagIndex) {
     RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
 
     RedisModule_ReplyWithSimpleString(ctx, "value");
-    RedisModule_ReplyWithStringBuffer(ctx, tag, len);
+    RedisModule_ReplyWithStringBuffer(ctx, sorted[i]->str, sorted[i]->len);
 
     RedisModule_ReplyWithSimpleString(ctx, "num_entries");
     RedisModule_ReplyWithLongLong(ctx, iv->numDocs);
@@ -621,8 +626,7 @@ DEBUG_COMMAND(InfoTagIndex) {
 
     RedisModule_ReplySetArrayLength(ctx, nsubelem);
   }
-  TrieMapIterator_Free(iter);
-  RedisModule_ReplySetArrayLength(ctx, nvalues - 1);
+  RedisModule_ReplySetArrayLength(ctx, nvalues);
 
 reply_done:
   RedisModule_ReplySetArrayLength(ctx, nelem);
@@ -781,6 +785,7 @@ DebugCommandType commands[] = {{"DUMP_INVIDX", DumpInvertedIndex},
                                {"GC_FORCEINVOKE", GCForceInvoke},
                                {"GC_FORCEBGINVOKE", GCForceBGInvoke},
                                {"GC_CLEAN_NUMERIC", GCCleanNumeric},
+                               {"COMPACT_DOCIDS", CompactDocIds},
                                {"GIT_SHA", GitSha},
                                {"TTL", ttl},
                                {"VECSIM_INFO", VecsimInfo},
@@ -4,72 +4,33 @@
 #include <stdio.h>
 #include "redismodule.h"
 #include "util/fnv.h"
-#include "triemap/triemap.h"
 #include "sortable.h"
 #include "rmalloc.h"
+#include "util/arr.h"
 #include "spec.h"
 #include "config.h"
 
-/* Creates a new DocTable with a given capacity */
+/* Creates a new DocTable with room for a given number of documents in its page directory */
 DocTable NewDocTable(size_t cap, size_t max_size) {
   DocTable ret = {
       .size = 1,
-      .cap = cap,
+      .cap = (cap >> DOCTABLE_PAGE_BITS) + 1,
       .maxDocId = 0,
       .memsize = 0,
       .sortablesSize = 0,
       .maxSize = max_size,
       .dim = NewDocIdMap(),
   };
-  ret.buckets = rm_calloc(cap, sizeof(*ret.buckets));
+  ret.pages = rm_calloc(ret.cap, sizeof(*ret.pages));
   return ret;
 }
 
-static inline uint32_t DocTable_GetBucket(const DocTable *t, t_docId docId) {
-  return docId < t->maxSize ? docId : docId % t->maxSize;
-}
-
-static inline int DocTable_ValidateDocId(const DocTable *t, t_docId docId) {
-  return docId != 0 && docId <= t->maxDocId;
-}
-
-RSDocumentMetadata *DocTable_Get(const DocTable *t, t_docId docId) {
-  if (!DocTable_ValidateDocId(t, docId)) {
-    return NULL;
-  }
-  uint32_t bucketIndex = DocTable_GetBucket(t, docId);
-  if (bucketIndex >= t->cap) {
-    return NULL;
-  }
-  DMDChain *dmdChain = &t->buckets[bucketIndex];
-  DLLIST2_FOREACH(it, &dmdChain->lroot) {
-    RSDocumentMetadata *dmd = DLLIST2_ITEM(it, RSDocumentMetadata, llnode);
-    if (dmd->id == docId) {
-      return dmd;
-    }
-  }
-  return NULL;
-}
-
 int DocTable_Exists(const DocTable *t, t_docId docId) {
-  if (!docId || docId > t->maxDocId) {
-    return 0;
-  }
-  uint32_t ix = DocTable_GetBucket(t, docId);
-  if (ix >= t->cap) {
-    return 0;
-  }
-  const DMDChain *chain = t->buckets + ix;
-  if (chain == NULL) {
+  if (DocTable_IsDeleted(t, docId)) {
     return 0;
   }
-  DLLIST2_FOREACH(it, &chain->lroot) {
-    const RSDocumentMetadata *md = DLLIST2_ITEM(it, RSDocumentMetadata, llnode);
-    if (md->id == docId && !(md->flags & Document_Deleted)) {
-      return 1;
-    }
-  }
-  return 0;
+  const RSDocumentMetadata *md = DocTable_Get(t, docId);
+  return md && !(md->flags & Document_Deleted);
 }
 
 RSDocumentMetadata *DocTable_GetByKeyR(const DocTable *t, RedisModuleString *s) {
@@ -81,29 +42,33 @@ RSDocumentMetadata *DocTable_GetByKeyR(const DocTable *t, RedisModuleString *s)
 }
 
 static inline void DocTable_Set(DocTable *t, t_docId docId, RSDocumentMetadata *dmd) {
-  uint32_t bucket = DocTable_GetBucket(t, docId);
-  if (bucket >= t->cap && t->cap < t->maxSize) {
-    /* We have to grow the array capacity.
-     * We only grow till we reach maxSize, then we starts to add the dmds to
-     * the already existing chains.
-     */
+  size_t ix = docId >> DOCTABLE_PAGE_BITS;
+  if (ix >= t->cap) {
     size_t oldcap = t->cap;
-    // We grow by half of the current capacity with maximum of 1m
-    t->cap += 1 + (t->cap ? MIN(t->cap / 2, 1024 * 1024) : 1);
-    t->cap = MIN(t->cap, t->maxSize);  // make sure we do not excised maxSize
-    t->cap = MAX(t->cap, bucket + 1);  // docs[bucket] needs to be valid, so t->cap > bucket
-    t->buckets = rm_realloc(t->buckets, t->cap * sizeof(DMDChain));
-    
-    // We clear new extra allocation to Null all list pointers
-    size_t memsetSize = (t->cap - oldcap) * sizeof(DMDChain);
-    memset(&t->buckets[oldcap], 0, memsetSize);
-  }
-
-  DMDChain *chain = &t->buckets[bucket];
-  DMD_Incref(dmd);
+    // We grow by half of the current capacity, the directory is small compared to the pages
+    t->cap = MAX(ix + 1, t->cap + 1 + t->cap / 2);
+    t->pages = rm_realloc(t->pages, t->cap * sizeof(*t->pages));
+    memset(t->pages + oldcap, 0, (t->cap - oldcap) * sizeof(*t->pages));
+  }
 
-  // Adding the dmd to the chain
-  dllist2_append(&chain->lroot, &dmd->llnode);
+  DocTablePage *page = &t->pages[ix];
+  if (!page->dmds) {
+    page->dmds = rm_calloc(DOCTABLE_PAGE_SIZE, sizeof(*page->dmds));
+    // the previous last page was kept when it was emptied, now no new document can land on it
+    DocTablePage *prev = ix ? &t->pages[ix - 1] : NULL;
+    if (prev && prev->dmds && !prev->numDocs) {
+      rm_free(prev->dmds);
+      prev->dmds = NULL;
+    }
+  }
+  RSDocumentMetadata **slot = &page->dmds[docId & DOCTABLE_PAGE_MASK];
+  if (!*slot) {
+    ++page->numDocs;
+  } else {
+    DMD_Decref(*slot);
+  }
+  DMD_Incref(dmd);
+  *slot = dmd;
 }
 
 /** Get the docId of a key if it exists in the table, or 0 if it doesnt */
@@ -226,7 +191,7 @@ RSDocumentMetadata *DocTable_Put(DocTable *t, const char *s, size_t n, double sc
   DocTable_Set(t, docId, dmd);
   ++t->size;
   t->memsize += sdsAllocSize(keyPtr);
-  DocIdMap_Put(&t->dim, s, n, docId);
+  DocIdMap_Put(&t->dim, dmd);
   return dmd;
 }
 
@@ -280,26 +245,130 @@ void DMD_Free(RSDocumentMetadata *md) {
 }
 
 void DocTable_Free(DocTable *t) {
-  for (int i = 0; i < t->cap; ++i) {
-    DMDChain *chain = &t->buckets[i];
-    if (DLLIST2_IS_EMPTY(&chain->lroot)) {
+  for (size_t i = 0; i < t->cap; ++i) {
+    DocTablePage *page = &t->pages[i];
+    if (!page->dmds) {
       continue;
     }
-    DLLIST2_node *nn = chain->lroot.head;
-    while (nn) {
-      RSDocumentMetadata *md = DLLIST2_ITEM(nn, RSDocumentMetadata, llnode);
-      nn = nn->next;
-      DMD_Free(md);
+    for (size_t j = 0; j < DOCTABLE_PAGE_SIZE && page->numDocs; ++j) {
+      if (page->dmds[j]) {
+        DMD_Free(page->dmds[j]);
+        --page->numDocs;
+      }
     }
+    rm_free(page->dmds);
   }
-  rm_free(t->buckets);
+  rm_free(t->pages);
+  rm_free(t->deleted);
+  array_free(t->deletedDuringGc);
   DocIdMap_Free(&t->dim);
 }
 
-static void DocTable_DmdUnchain(DocTable *t, RSDocumentMetadata *md) {
-  uint32_t bucketIndex = DocTable_GetBucket(t, md->id);
-  DMDChain *dmdChain = &t->buckets[bucketIndex];
-  dllist2_delete(&dmdChain->lroot, &md->llnode);
+void DocIdRemap_Init(DocIdRemap *r, const DocTable *t) {
+  r->nwords = (t->maxDocId >> 6) + 1;
+  r->live = rm_calloc(r->nwords, sizeof(*r->live));
+  r->rank = rm_malloc(r->nwords * sizeof(*r->rank));
+  DOCTABLE_FOREACH(t, r->live[dmd->id >> 6] |= 1ULL << (dmd->id & 63));
+  t_docId rank = 0;
+  for (size_t i = 0; i < r->nwords; ++i) {
+    r->rank[i] = rank;
+    rank += __builtin_popcountll(r->live[i]);
+  }
+}
+
+void DocIdRemap_Free(DocIdRemap *r) {
+  rm_free(r->live);
+  rm_free(r->rank);
+}
+
+void DocTable_Renumber(DocTable *t, const DocIdRemap *r) {
+  DocTablePage *pages = t->pages;
+  size_t cap = t->cap;
+  t->cap = ((t->size - 1) >> DOCTABLE_PAGE_BITS) + 1;
+  t->pages = rm_calloc(t->cap, sizeof(*t->pages));
+  t->maxDocId = t->size - 1;
+  for (size_t i = 0; i < cap; ++i) {
+    if (!pages[i].dmds) {
+      continue;
+    }
+    for (size_t j = 0; j < DOCTABLE_PAGE_SIZE; ++j) {
+      RSDocumentMetadata *dmd = pages[i].dmds[j];
+      if (!dmd) {
+        continue;
+      }
+      // the key map points at the metadata, so it follows the new id
+      dmd->id = DocIdRemap_Get(r, dmd->id);
+      DocTablePage *page = &t->pages[dmd->id >> DOCTABLE_PAGE_BITS];
+      if (!page->dmds) {
+        page->dmds = rm_calloc(DOCTABLE_PAGE_SIZE, sizeof(*page->dmds));
+      }
+      page->dmds[dmd->id & DOCTABLE_PAGE_MASK] = dmd;
+      ++page->numDocs;
+    }
+    rm_free(pages[i].dmds);
+  }
+  rm_free(pages);
+
+  // no id below maxDocId is deleted anymore
+  rm_free(t->deleted);
+  t->deleted = NULL;
+  t->deletedWords = 0;
+  if (t->deletedDuringGc) {
+    array_clear(t->deletedDuringGc);
+  }
+  t->deletedEpoch++;
+}
+
+static void DocTable_MarkDeleted(DocTable *t, t_docId docId) {
+  size_t word = docId >> 6;
+  if (word >= t->deletedWords) {
+    // grow by at least a half to keep the number of reallocations logarithmic
+    size_t words = MAX(word + 1, t->deletedWords + t->deletedWords / 2);
+    t->deleted = rm_realloc(t->deleted, words * sizeof(*t->deleted));
+    memset(t->deleted + t->deletedWords, 0, (words - t->deletedWords) * sizeof(*t->deleted));
+    t->deletedWords = words;
+  }
+  t->deleted[word] |= 1ULL << (docId & 63);
+  t->deletedEpoch++;
+}
+
+void DocTable_GcStarted(DocTable *t) {
+  // the pass collects everything deleted so far, including what a failed pass left
+  array_clear(t->deletedDuringGc);
+}
+
+void DocTable_GcCompleted(DocTable *t) {
+  if (!t->deletedDuringGc) {
+    return;
+  }
+  rm_free(t->deleted);
+  t->deleted = NULL;
+  t->deletedWords = 0;
+  for (uint32_t i = 0; i < array_len(t->deletedDuringGc); ++i) {
+    DocTable_MarkDeleted(t, t->deletedDuringGc[i]);
+  }
+  array_free(t->deletedDuringGc);
+  t->deletedDuringGc = NULL;
+}
+
+size_t DocTable_DeletedMemUsage(const DocTable *t) {
+  size_t sz = t->deletedWords * sizeof(*t->deleted);
+  if (t->deletedDuringGc) {
+    sz += array_sizeof(array_hdr(t->deletedDuringGc));
+  }
+  return sz;
+}
+
+static void DocTable_Unset(DocTable *t, RSDocumentMetadata *md) {
+  size_t ix = md->id >> DOCTABLE_PAGE_BITS;
+  DocTablePage *page = &t->pages[ix];
+  page->dmds[md->id & DOCTABLE_PAGE_MASK] = NULL;
+  // the last page still receives new documents, so it is kept even when empty. DocTable_Set frees
+  // it once documents move on to the next page
+  if (!--page->numDocs && ix < (t->maxDocId >> DOCTABLE_PAGE_BITS)) {
+    rm_free(page->dmds);
+    page->dmds = NULL;
+  }
 }
 
 int DocTable_Delete(DocTable *t, const char *s, size_t n) {
@@ -322,6 +391,10 @@ RSDocumentMetadata *DocTable_Pop(DocTable *t, const char *s, size_t n) {
     }
 
     md->flags |= Document_Deleted;
+    DocTable_MarkDeleted(t, docId);
+    if (t->deletedDuringGc) {
+      t->deletedDuringGc = array_append(t->deletedDuringGc, docId);
+    }
 
     t->memsize -= sdsAllocSize(md->keyPtr);
     if (!hasPayload(md->flags)) {
@@ -334,7 +407,7 @@ RSDocumentMetadata *DocTable_Pop(DocTable *t, const char *s, size_t n) {
       t->sortablesSize -= RSSortingVector_GetMemorySize(md->sortVector);
     }
 
-    DocTable_DmdUnchain(t, md);
+    DocTable_Unset(t, md);
     DocIdMap_Delete(&t->dim, s, n);
     --t->size;
 
@@ -350,10 +423,10 @@ int DocTable_Replace(DocTable *t, const char *from_str, size_t from_len, const c
     return REDISMODULE_ERR;
   }
   DocIdMap_Delete(&t->dim, from_str, from_len);
-  DocIdMap_Put(&t->dim, to_str, to_len, id);
   RSDocumentMetadata *dmd = DocTable_Get(t, id);
   sdsfree(dmd->keyPtr);
   dmd->keyPtr = sdsnewlen(to_str, to_len);
+  DocIdMap_Put(&t->dim, dmd);
   return REDISMODULE_OK;
 }
 
@@ -362,40 +435,34 @@ void DocTable_RdbSave(DocTable *t, RedisModuleIO *rdb) {
   RedisModule_SaveUnsigned(rdb, t->size);
 
   uint32_t elements_written = 0;
-  for (uint32_t i = 0; i < t->cap; ++i) {
-    if (DLLIST2_IS_EMPTY(&t->buckets[i].lroot)) {
-      continue;
-    }
-    DLLIST2_FOREACH(it, &t->buckets[i].lroot) {
-      const RSDocumentMetadata *dmd = DLLIST2_ITEM(it, RSDocumentMetadata, llnode);
-      RedisModule_SaveStringBuffer(rdb, dmd->keyPtr, sdslen(dmd->keyPtr));
-      RedisModule_SaveUnsigned(rdb, dmd->flags);
-      RedisModule_SaveUnsigned(rdb, dmd->maxFreq);
-      RedisModule_SaveUnsigned(rdb, dmd->len);
-      RedisModule_SaveFloat(rdb, dmd->score);
-      if (dmd->flags & Document_HasPayload) {
-        if (hasPayload(dmd->flags)) {
-          // save an extra space for the null terminator to make the payload null terminated on
-          RedisModule_SaveStringBuffer(rdb, dmd->payload->data, dmd->payload->len + 1);
-        } else {
-          RedisModule_SaveStringBuffer(rdb, "", 1);
-        }
+  DOCTABLE_FOREACH(t, {
+    RedisModule_SaveStringBuffer(rdb, dmd->keyPtr, sdslen(dmd->keyPtr));
+    RedisModule_SaveUnsigned(rdb, dmd->flags);
+    RedisModule_SaveUnsigned(rdb, dmd->maxFreq);
+    RedisModule_SaveUnsigned(rdb, dmd->len);
+    RedisModule_SaveFloat(rdb, dmd->score);
+    if (dmd->flags & Document_HasPayload) {
+      if (hasPayload(dmd->flags)) {
+        // save an extra space for the null terminator to make the payload null terminated on
+        RedisModule_SaveStringBuffer(rdb, dmd->payload->data, dmd->payload->len + 1);
+      } else {
+        RedisModule_SaveStringBuffer(rdb, "", 1);
       }
+    }
 
-      //      if (dmd->flags & Document_HasSortVector) {
-      //        SortingVector_RdbSave(rdb, dmd->sortVector);
-      //      }
+    //      if (dmd->flags & Document_HasSortVector) {
+    //        SortingVector_RdbSave(rdb, dmd->sortVector);
+    //      }
 
-      if (dmd->flags & Document_HasOffsetVector) {
-        Buffer tmp;
-        Buffer_Init(&tmp, 16);
-        RSByteOffsets_Serialize(dmd->byteOffsets, &tmp);
-        RedisModule_SaveStringBuffer(rdb, tmp.data, tmp.offset);
-        Buffer_Free(&tmp);
-      }
-      ++elements_written;
+    if (dmd->flags & Document_HasOffsetVector) {
+      Buffer tmp;
+      Buffer_Init(&tmp, 16);
+      RSByteOffsets_Serialize(dmd->byteOffsets, &tmp);
+      RedisModule_SaveStringBuffer(rdb, tmp.data, tmp.offset);
+      Buffer_Free(&tmp);
     }
-  }
+    ++elements_written;
+  });
   RS_LOG_ASSERT((elements_written + 1 == t->size), "Wrong number of written elements");
 }
 
@@ -409,20 +476,6 @@ void DocTable_LegacyRdbLoad(DocTable *t, RedisModuleIO *rdb, int encver) {
     t->maxSize = MIN(RSGlobalConfig.maxDocTableSize, t->maxDocId);
   }
 
-  if (t->maxDocId > t->maxSize) {
-    /**
-     * If the maximum doc id is greater than the maximum cap size
-     * then it means there is a possibility that any index under maxId can
-     * be accessed. However, it is possible that this bucket does not have
-     * any documents inside it (and thus might not be populated below), but
-     * could still be accessed for simple queries (e.g. get, exist). Ensure
-     * we don't have to rely on Set/Put to ensure the doc table array.
-     */
-    t->cap = t->maxSize;
-    rm_free(t->buckets);
-    t->buckets = rm_calloc(t->cap, sizeof(*t->buckets));
-  }
-
   for (size_t i = 1; i < t->size; i++) {
     size_t len;
 
@@ -485,7 +538,7 @@ void DocTable_LegacyRdbLoad(DocTable *t, RedisModuleIO *rdb, int encver) {
       ++deletedElements;
       DMD_Free(dmd);
     } else {
-      DocIdMap_Put(&t->dim, dmd->keyPtr, sdslen(dmd->keyPtr), dmd->id);
+      DocIdMap_Put(&t->dim, dmd);
       DocTable_Set(t, dmd->id, dmd);
       t->memsize += sizeof(RSDocumentMetadata) + len;
     }
@@ -589,39 +642,115 @@ void DocTable_RdbLoad(DocTable *t, RedisModuleIO *rdb, int encver) {
   }
 }
 
+#define DOCIDMAP_EMPTY 0x80
+#define DOCIDMAP_DELETED 0xfe
+#define DOCIDMAP_INITIAL_CAP 8
+
 DocIdMap NewDocIdMap() {
+  return (DocIdMap){0};
+}
 
-  TrieMap *m = NewTrieMap();
-  return (DocIdMap){m};
+static inline uint64_t DocIdMap_Hash(const char *s, size_t n) {
+  return fnv_64a_buf(s, n, 0xcbf29ce484222325ULL);
 }
 
-t_docId DocIdMap_Get(const DocIdMap *m, const char *s, size_t n) {
+/* Returns the slot of the key, or m->cap if it is not in the map */
+static size_t DocIdMap_Find(const DocIdMap *m, const char *s, size_t n, uint64_t hash) {
+  if (!m->cap) {
+    return 0;
+  }
+  size_t mask = m->cap - 1;
+  uint8_t tag = hash & 0x7f;
+  // the load factor guarantees there is an empty slot to stop at
+  for (size_t i = (hash >> 7) & mask;; i = (i + 1) & mask) {
+    uint8_t c = m->ctrl[i];
+    if (c == DOCIDMAP_EMPTY) {
+      return m->cap;
+    }
+    if (c == tag) {
+      const sds key = m->dmds[i]->keyPtr;
+      if (sdslen(key) == n && !memcmp(key, s, n)) {
+        return i;
+      }
+    }
+  }
+}
 
-  void *val = TrieMap_Find(m->tm, (char *)s, n);
-  if (val && val != TRIEMAP_NOTFOUND) {
-    return *((t_docId *)val);
+static void DocIdMap_Insert(DocIdMap *m, RSDocumentMetadata *dmd, uint64_t hash) {
+  size_t mask = m->cap - 1;
+  size_t i = (hash >> 7) & mask;
+  while (m->ctrl[i] != DOCIDMAP_EMPTY && m->ctrl[i] != DOCIDMAP_DELETED) {
+    i = (i + 1) & mask;
   }
-  return 0;
+  if (m->ctrl[i] == DOCIDMAP_DELETED) {
+    --m->tombstones;
+  }
+  m->ctrl[i] = hash & 0x7f;
+  m->dmds[i] = dmd;
+  ++m->size;
 }
 
-void *_docIdMap_replace(void *oldval, void *newval) {
-  if (oldval) {
-    rm_free(oldval);
+/* Rebuild the table without tombstones, doubling its capacity if it is at least half full */
+static void DocIdMap_Rehash(DocIdMap *m) {
+  DocIdMap old = *m;
+  m->cap = !old.cap ? DOCIDMAP_INITIAL_CAP : old.size * 2 >= old.cap ? old.cap * 2 : old.cap;
+  m->ctrl = rm_malloc(m->cap * sizeof(*m->ctrl));
+  memset(m->ctrl, DOCIDMAP_EMPTY, m->cap * sizeof(*m->ctrl));
+  m->dmds = rm_malloc(m->cap * sizeof(*m->dmds));
+  m->size = 0;
+  m->tombstones = 0;
+  for (size_t i = 0; i < old.cap; ++i) {
+    if (!(old.ctrl[i] & 0x80)) {
+      RSDocumentMetadata *dmd = old.dmds[i];
+      DocIdMap_Insert(m, dmd, DocIdMap_Hash(dmd->keyPtr, sdslen(dmd->keyPtr)));
+    }
   }
-  return newval;
+  rm_free(old.ctrl);
+  rm_free(old.dmds);
 }
 
-void DocIdMap_Put(DocIdMap *m, const char *s, size_t n, t_docId docId) {
+t_docId DocIdMap_Get(const DocIdMap *m, const char *s, size_t n) {
+  size_t i = DocIdMap_Find(m, s, n, DocIdMap_Hash(s, n));
+  return i < m->cap ? m->dmds[i]->id : 0;
+}
 
-  t_docId *pd = rm_malloc(sizeof(t_docId));
-  *pd = docId;
-  TrieMap_Add(m->tm, (char *)s, n, pd, _docIdMap_replace);
+void DocIdMap_Put(DocIdMap *m, RSDocumentMetadata *dmd) {
+  size_t n = sdslen(dmd->keyPtr);
+  uint64_t hash = DocIdMap_Hash(dmd->keyPtr, n);
+  size_t i = DocIdMap_Find(m, dmd->keyPtr, n, hash);
+  if (i < m->cap) {
+    m->dmds[i] = dmd;
+    return;
+  }
+  // keep the load factor, tombstones included, at most 7/8
+  if ((m->size + m->tombstones + 1) * 8 > m->cap * 7) {
+    DocIdMap_Rehash(m);
+  }
+  DocIdMap_Insert(m, dmd, hash);
 }
 
 void DocIdMap_Free(DocIdMap *m) {
-  TrieMap_Free(m->tm, rm_free);
+  rm_free(m->ctrl);
+  rm_free(m->dmds);
+  *m = NewDocIdMap();
 }
 
 int DocIdMap_Delete(DocIdMap *m, const char *s, size_t n) {
-  return TrieMap_Delete(m->tm, (char *)s, n, rm_free);
+  size_t i = DocIdMap_Find(m, s, n, DocIdMap_Hash(s, n));
+  if (i >= m->cap) {
+    return 0;
+  }
+  if (!--m->size) {
+    // release the table of an emptied index
+    DocIdMap_Free(m);
+    return 1;
+  }
+  // a slot followed by an empty one ends no probe sequence, so it can be emptied too
+  if (m->ctrl[(i + 1) & (m->cap - 1)] == DOCIDMAP_EMPTY) {
+    m->ctrl[i] = DOCIDMAP_EMPTY;
+  } else {
+    m->ctrl[i] = DOCIDMAP_DELETED;
+    ++m->tombstones;
+  }
+  return 1;
 }
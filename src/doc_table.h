@@ -3,7 +3,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include "redismodule.h"
-#include "triemap/triemap.h"
 #include "redisearch.h"
 #include "sortable.h"
 #include "byte_offsets.h"
@@ -28,22 +27,36 @@ static inline RedisModuleString *DMD_CreateKeyString(const RSDocumentMetadata *d
   return RedisModule_CreateString(ctx, dmd->keyPtr, sdslen(dmd->keyPtr));
 }
 
-/* Map between external id an incremental id */
+/* Map between external id an incremental id.
+ * An open addressing hash table of the documents' metadata, keyed by the metadata's own key, so
+ * the keys are not stored twice. Each slot has a control byte holding either the low 7 bits of the
+ * key hash or an empty/deleted marker, so that probing only compares keys whose tag matches */
 typedef struct {
-  TrieMap *tm;
+  uint8_t *ctrl;
+  RSDocumentMetadata **dmds;
+  // number of slots, 0 or a power of 2
+  size_t cap;
+  size_t size;
+  size_t tombstones;
 } DocIdMap;
 
 DocIdMap NewDocIdMap();
 /* Get docId from a did-map. Returns 0  if the key is not in the map */
 t_docId DocIdMap_Get(const DocIdMap *m, const char *s, size_t n);
 
-/* Put a new doc id in the map if it does not already exist */
-void DocIdMap_Put(DocIdMap *m, const char *s, size_t n, t_docId docId);
+/* Map the key of the document to its id, replacing any document already mapped by that key. The
+ * metadata must stay alive and keep its key while it is in the map */
+void DocIdMap_Put(DocIdMap *m, RSDocumentMetadata *dmd);
 
 int DocIdMap_Delete(DocIdMap *m, const char *s, size_t n);
 /* Free the doc id map */
 void DocIdMap_Free(DocIdMap *m);
 
+/* Memory used by the map, not including the keys which belong to the metadata */
+static inline size_t DocIdMap_MemUsage(const DocIdMap *m) {
+  return m->cap * (sizeof(*m->ctrl) + sizeof(*m->dmds));
+}
+
 /* The DocTable is a simple mapping between incremental ids and the original document key and
  * metadata. It is also responsible for storing the id incrementor for the index and assigning
  * new
@@ -53,23 +66,74 @@ void DocIdMap_Free(DocIdMap *m);
  * the
  * same key. This may result in document duplication in results  */
 
+/* Documents are stored in fixed size pages of slots addressed directly by docId, so that a lookup
+ * is a two level index and iterating the table walks memory sequentially. Since docIds are never
+ * reused, pages behind the last docId are freed once all their documents are deleted */
+#define DOCTABLE_PAGE_BITS 10
+#define DOCTABLE_PAGE_SIZE (1 << DOCTABLE_PAGE_BITS)
+#define DOCTABLE_PAGE_MASK (DOCTABLE_PAGE_SIZE - 1)
+
 typedef struct {
-  DLLIST2 lroot;
-} DMDChain;
+  // DOCTABLE_PAGE_SIZE slots, NULL for holes. NULL if the page was never used or was emptied
+  RSDocumentMetadata **dmds;
+  // number of occupied slots
+  uint32_t numDocs;
+} DocTablePage;
 
 typedef struct {
   size_t size;
-  // the maximum size this table is allowed to grow to
+  // kept for RDB compatibility. The paged layout is not bounded by it
   t_docId maxSize;
   t_docId maxDocId;
+  // number of pages in the page directory
   size_t cap;
   size_t memsize;
   size_t sortablesSize;
 
-  DMDChain *buckets;
+  DocTablePage *pages;
   DocIdMap dim;
+  // bitmap of deleted docIds, so that dead postings are told apart without fetching the metadata.
+  // The bits are cleared once the GC removed the postings of the documents
+  uint64_t *deleted;
+  size_t deletedWords;
+  // ids deleted while a GC pass runs, which it may not have collected. NULL when no pass runs
+  t_docId *deletedDuringGc;
+  // incremented by every delete, so counts of the deleted entries of an index can be cached
+  uint64_t deletedEpoch;
 } DocTable;
 
+/* Returns 1 if docId was deleted from the table */
+static inline int DocTable_IsDeleted(const DocTable *t, t_docId docId) {
+  size_t word = docId >> 6;
+  return word < t->deletedWords && (t->deleted[word] >> (docId & 63)) & 1;
+}
+
+/* Maps the ids of the live documents of a table to 1..n, preserving their order. Used to compact
+ * the id space of an index */
+typedef struct {
+  // bitmap of the live docIds
+  uint64_t *live;
+  // number of live docIds before each word of the bitmap
+  t_docId *rank;
+  size_t nwords;
+} DocIdRemap;
+
+void DocIdRemap_Init(DocIdRemap *r, const DocTable *t);
+void DocIdRemap_Free(DocIdRemap *r);
+
+/* Returns the new id of docId, or 0 if it is not a live document */
+static inline t_docId DocIdRemap_Get(const DocIdRemap *r, t_docId docId) {
+  size_t word = docId >> 6;
+  if (word >= r->nwords) {
+    return 0;
+  }
+  uint64_t bit = 1ULL << (docId & 63);
+  if (!(r->live[word] & bit)) {
+    return 0;
+  }
+  return r->rank[word] + __builtin_popcountll(r->live[word] & (bit - 1)) + 1;
+}
+
 /* increasing the ref count of the given dmd */
 #define DMD_Incref(md)                                                       \
   if (md) {                                                                  \
@@ -79,24 +143,32 @@ typedef struct {
 
 #define DOCTABLE_FOREACH(dt, code)                                           \
   for (size_t i = 0; i < dt->cap; ++i) {                                     \
-    DMDChain *chain = &dt->buckets[i];                                       \
-    if (DLLIST2_IS_EMPTY(&chain->lroot)) {                                   \
+    DocTablePage *page = &dt->pages[i];                                      \
+    if (!page->numDocs) {                                                    \
       continue;                                                              \
     }                                                                        \
-    DLLIST2_FOREACH(it, &chain->lroot) {                                     \
-      RSDocumentMetadata *dmd = DLLIST_ITEM(it, RSDocumentMetadata, llnode); \
-      code;                                                                  \
+    for (size_t j = 0; j < DOCTABLE_PAGE_SIZE; ++j) {                        \
+      RSDocumentMetadata *dmd = page->dmds[j];                               \
+      if (dmd) {                                                             \
+        code;                                                                \
+      }                                                                      \
     }                                                                        \
   }
 
-/* Creates a new DocTable with a given capacity */
+/* Creates a new DocTable with room for a given number of documents in its page directory */
 DocTable NewDocTable(size_t cap, size_t max_size);
 
 #define DocTable_New(cap) NewDocTable(cap, RSGlobalConfig.maxDocTableSize)
 
 /* Get the metadata for a doc Id from the DocTable.
  *  If docId is not inside the table, we return NULL */
-RSDocumentMetadata *DocTable_Get(const DocTable *t, t_docId docId);
+static inline RSDocumentMetadata *DocTable_Get(const DocTable *t, t_docId docId) {
+  size_t ix = docId >> DOCTABLE_PAGE_BITS;
+  if (docId == 0 || docId > t->maxDocId || ix >= t->cap || !t->pages[ix].dmds) {
+    return NULL;
+  }
+  return t->pages[ix].dmds[docId & DOCTABLE_PAGE_MASK];
+}
 
 RSDocumentMetadata *DocTable_GetByKeyR(const DocTable *r, RedisModuleString *s);
 
@@ -123,6 +195,17 @@ int DocTable_SetPayload(DocTable *t, RSDocumentMetadata *dmd, const char *data,
 
 int DocTable_Exists(const DocTable *t, t_docId docId);
 
+/* Called when a GC pass over all the indexes of the table starts. It collects the postings of the
+ * documents deleted so far */
+void DocTable_GcStarted(DocTable *t);
+
+/* Called when the GC pass completed. The bits of the documents deleted before it started are
+ * cleared, and those deleted since are kept until the next pass */
+void DocTable_GcCompleted(DocTable *t);
+
+/* Memory used by the record of the deleted documents */
+size_t DocTable_DeletedMemUsage(const DocTable *t);
+
 /* Set the sorting vector for a document. If the vector is NULL we mark the doc as not having a
  * vector. Returns 1 on success, 0 if the document does not exist. No further validation is done */
 int DocTable_SetSortingVector(DocTable *t, RSDocumentMetadata *dmd, RSSortingVector *v);
@@ -148,6 +231,9 @@ static inline t_docId DocTable_GetIdR(const DocTable *dt, RedisModuleString *r)
   return DocTable_GetId(dt, s, n);
 }
 
+/* Assign the documents their ids in the remap, dropping the record of deleted ids */
+void DocTable_Renumber(DocTable *t, const DocIdRemap *r);
+
 /* Free the table and all the keys of documents */
 void DocTable_Free(DocTable *t);
 
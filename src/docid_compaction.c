@@ -0,0 +1,146 @@
+#include "docid_compaction.h"
+#include "spec.h"
+#include "config.h"
+#include "cursor.h"
+#include "indexer.h"
+#include "inverted_index.h"
+#include "redis_index.h"
+#include "numeric_index.h"
+#include "tag_index.h"
+#include "expansion_cache.h"
+#include "result_cache.h"
+#include "gc.h"
+#include "util/arr.h"
+
+int IndexSpec_ShouldCompactDocIds(const IndexSpec *sp) {
+  size_t ratio = RSGlobalConfig.forkGcCompactDocIdsRatio;
+  // the table size counts one more than the number of documents
+  return ratio && sp->docs.maxDocId >= ratio * sp->docs.size;
+}
+
+static int canCompact(IndexSpec *sp, QueryError *status) {
+  for (size_t i = 0; i < sp->numFields; ++i) {
+    if (FIELD_IS(sp->fields + i, INDEXFLD_T_VECTOR)) {
+      QueryError_SetError(status, QUERY_EGENERIC,
+                          "Can not renumber the documents of an index with vector fields");
+      return 0;
+    }
+  }
+  if (Cursors_NumOpen(&RSCursors, sp->name)) {
+    QueryError_SetError(status, QUERY_EGENERIC, "Index has open cursors");
+    return 0;
+  }
+  // a query running in a search thread may be paused between two reads, holding ids which the
+  // compaction would give to other documents
+  if (__sync_fetch_and_add(&sp->activeQueries, 0)) {
+    QueryError_SetError(status, QUERY_EGENERIC, "Index has running queries");
+    return 0;
+  }
+  if (sp->indexer && Indexer_IsBusy(sp->indexer)) {
+    QueryError_SetError(status, QUERY_EGENERIC, "Index has documents being indexed");
+    return 0;
+  }
+  if (sp->gc && GCContext_IsCollecting(sp->gc)) {
+    QueryError_SetError(status, QUERY_EGENERIC, "Index is being garbage collected");
+    return 0;
+  }
+  return 1;
+}
+
+static void renumberTerms(RedisSearchCtx *sctx, const DocIdRemap *remap,
+                          IndexRepairParams *params) {
+  TrieIterator *iter = Trie_Iterate(sctx->spec->terms, "", 0, 0, 1);
+  rune *rstr = NULL;
+  t_len slen = 0;
+  float score = 0;
+  int dist = 0;
+  while (TrieIterator_Next(iter, &rstr, &slen, NULL, &score, &dist)) {
+    size_t termLen;
+    char *term = runesToStr(rstr, slen, &termLen);
+    RedisModuleKey *idxKey = NULL;
+    InvertedIndex *idx = Redis_OpenInvertedIndexEx(sctx, term, termLen, 1, &idxKey);
+    if (idx) {
+      InvertedIndex_Renumber(idx, remap, params);
+    }
+    if (idxKey) {
+      RedisModule_CloseKey(idxKey);
+    }
+    rm_free(term);
+  }
+  DFAFilter_Free(iter->ctx);
+  rm_free(iter->ctx);
+  TrieIterator_Free(iter);
+}
+
+static void renumberNumeric(RedisSearchCtx *sctx, const DocIdRemap *remap,
+                            IndexRepairParams *params) {
+  FieldSpec **fields = getFieldsByType(sctx->spec, INDEXFLD_T_NUMERIC | INDEXFLD_T_GEO);
+  for (size_t i = 0; i < array_len(fields); ++i) {
+    RedisModuleKey *idxKey = NULL;
+    RedisModuleString *keyName =
+        IndexSpec_GetFormattedKey(sctx->spec, fields[i], INDEXFLD_T_NUMERIC);
+    NumericRangeTree *rt = OpenNumericIndex(sctx, keyName, &idxKey);
+    if (rt) {
+      NumericRangeTree_Renumber(rt, remap, params);
+    }
+    if (idxKey) {
+      RedisModule_CloseKey(idxKey);
+    }
+  }
+  array_free(fields);
+}
+
+static void renumberTags(RedisSearchCtx *sctx, const DocIdRemap *remap,
+                         IndexRepairParams *params) {
+  FieldSpec **fields = getFieldsByType(sctx->spec, INDEXFLD_T_TAG);
+  for (size_t i = 0; i < array_len(fields); ++i) {
+    RedisModuleKey *idxKey = NULL;
+    RedisModuleString *keyName = IndexSpec_GetFormattedKey(sctx->spec, fields[i], INDEXFLD_T_TAG);
+    TagIndex *tagIdx = TagIndex_Open(sctx, keyName, false, &idxKey);
+    if (tagIdx) {
+      TagIndex_Renumber(tagIdx, remap, params);
+    }
+    if (idxKey) {
+      RedisModule_CloseKey(idxKey);
+    }
+  }
+  array_free(fields);
+}
+
+int IndexSpec_CompactDocIds(RedisSearchCtx *sctx, DocIdCompactionStats *stats,
+                            QueryError *status) {
+  IndexSpec *sp = sctx->spec;
+  if (!canCompact(sp, status)) {
+    return REDISMODULE_ERR;
+  }
+
+  *stats = (DocIdCompactionStats){.maxDocIdBefore = sp->docs.maxDocId};
+  DocIdRemap remap;
+  DocIdRemap_Init(&remap, &sp->docs);
+
+  IndexRepairParams params = {0};
+  renumberTerms(sctx, &remap, &params);
+  renumberNumeric(sctx, &remap, &params);
+  renumberTags(sctx, &remap, &params);
+  DocTable_Renumber(&sp->docs, &remap);
+  DocIdRemap_Free(&remap);
+
+  stats->maxDocIdAfter = sp->docs.maxDocId;
+  stats->invertedSizeBefore = params.bytesBeforFix;
+  stats->invertedSizeAfter = params.bytesAfterFix;
+  stats->recordsRemoved = params.docsCollected;
+
+  sp->stats.invertedSize += params.bytesAfterFix;
+  sp->stats.invertedSize -= params.bytesBeforFix;
+  sp->stats.numRecords -= params.docsCollected;
+
+  // cached postings and results refer to the old ids
+  sp->revision++;
+  if (sp->expcache) {
+    ExpansionCache_Clear(sp->expcache);
+  }
+  if (sp->rescache) {
+    ResultCache_Clear(sp->rescache);
+  }
+  return REDISMODULE_OK;
+}
@@ -0,0 +1,39 @@
+#ifndef DOCID_COMPACTION_H
+#define DOCID_COMPACTION_H
+
+#include "search_ctx.h"
+#include "query_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  t_docId maxDocIdBefore;
+  t_docId maxDocIdAfter;
+  // size of the blocks of the inverted indexes of the terms, numeric and tag fields
+  size_t invertedSizeBefore;
+  size_t invertedSizeAfter;
+  // records of deleted documents dropped along the way
+  size_t recordsRemoved;
+} DocIdCompactionStats;
+
+/* Returns true if the ids of the index are sparse enough to be compacted, according to
+ * FORK_GC_COMPACT_DOCIDS_RATIO */
+int IndexSpec_ShouldCompactDocIds(const IndexSpec *sp);
+
+/* Renumber the documents of the index to 1..n, keeping their order, and rewrite the inverted
+ * indexes of all the terms, numeric and tag fields with the new ids. This keeps the deltas of the
+ * postings small and shortens the id range walked by wildcard and NOT iterators.
+ *
+ * Must be called with the GIL (or the spec write lock, for indexes outside the keyspace) held,
+ * while no fork GC child is collecting the index. All the postings are rewritten in one pass, so
+ * the lock is held for a time linear in the size of the inverted indexes. Fails if the ids can't be
+ * changed under something holding them: open cursors, queries paused in a search thread,
+ * documents being indexed, or vector fields, whose labels can't be renamed */
+int IndexSpec_CompactDocIds(RedisSearchCtx *sctx, DocIdCompactionStats *stats, QueryError *status);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -14,6 +14,7 @@
 #include "rmalloc.h"
 #include "indexer.h"
 #include "tag_index.h"
+#include "ngram.h"
 #include "aggregate/expr/expression.h"
 #include "rmutil/rm_assert.h"
 
@@ -500,6 +501,9 @@ FIELD_BULK_INDEXER(numericIndexer) {
       return -1;
     }
   }
+  if (FieldSpec_IsCompressed(fs) && !(rt->indexFlags & Index_PackNumeric)) {
+    NumericRangeTree_SetIndexFlags(rt, rt->indexFlags | Index_PackNumeric);
+  }
   NRN_AddRv rv = NumericRangeTree_Add(rt, aCtx->doc->docId, fdata->numeric);
   ctx->spec->stats.invertedSize += rv.sz;  // TODO: exact amount
   ctx->spec->stats.numRecords += rv.numRecords;
@@ -610,6 +614,15 @@ FIELD_BULK_INDEXER(tagIndexer) {
     if (FieldSpec_HasSuffixTrie(fs) && !tidx->suffix) {
       tidx->suffix = NewTrieMap();
     }
+    if (FieldSpec_HasNgrams(fs) && !tidx->ngrams) {
+      tidx->ngrams = NewNgramIndex(NGRAM_LEN);
+    }
+    if (fs->tagOpts.tagFlags & TagField_Compressed) {
+      tidx->invIdxFlags |= Index_EliasFano;
+    }
+    if (fs->tagOpts.tagFlags & TagField_Bitset) {
+      TagIndex_EnableBitsets(tidx);
+    }
   }
 
   ctx->spec->stats.invertedSize +=
@@ -797,6 +810,7 @@ static void AddDocumentCtx_UpdateNoIndex(RSAddDocumentCtx *aCtx, RedisSearchCtx
 
   // Update the score
   md->score = doc->score;
+  sctx->spec->revision++;
   // Set the payload if needed
   if (doc->payload) {
     DocTable_SetPayload(&sctx->spec->docs, md, doc->payload, doc->payloadSize);
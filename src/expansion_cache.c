@@ -0,0 +1,220 @@
+#include "expansion_cache.h"
+#include "config.h"
+#include "rmalloc.h"
+#include "util/dict.h"
+#include "util/arr.h"
+
+#include <string.h>
+
+ExpansionPostings *NewExpansionPostings(void) {
+  ExpansionPostings *p = rm_calloc(1, sizeof(*p));
+  p->refcount = 1;
+  return p;
+}
+
+size_t ExpansionPostings_MemUsage(const ExpansionPostings *p) {
+  return sizeof(*p) + p->nwords * (sizeof(*p->bits) + sizeof(*p->ranks)) +
+         p->len * (sizeof(*p->terms) + sizeof(*p->freqs) + sizeof(*p->masks));
+}
+
+void ExpansionPostings_Decref(ExpansionPostings *p) {
+  if (__sync_sub_and_fetch(&p->refcount, 1)) {
+    return;
+  }
+  rm_free(p->bits);
+  rm_free(p->ranks);
+  rm_free(p->terms);
+  rm_free(p->freqs);
+  rm_free(p->masks);
+  rm_free(p);
+}
+
+ExpansionCache *NewExpansionCache(void) {
+  ExpansionCache *c = rm_calloc(1, sizeof(*c));
+  c->entries = dictCreate(&dictTypeHeapStrings, NULL);
+  c->patterns = dictCreate(&dictTypeHeapStrings, NULL);
+  for (int kind = 0; kind <= ExpansionKind_Contains; ++kind) {
+    c->plens[kind] = array_new(size_t, 8);
+  }
+  dllist_init(&c->lru);
+  return c;
+}
+
+/* Writes the key of a pattern in the patterns dictionary to buf, which holds plen + 2 bytes */
+static void patternKey(char *buf, ExpansionKind kind, const char *pattern, size_t plen) {
+  buf[0] = '0' + kind;
+  memcpy(buf + 1, pattern, plen);
+  buf[plen + 1] = '\0';
+}
+
+static char *makeKey(ExpansionKind kind, const char *pattern, size_t plen, t_fieldMask mask) {
+  // the expansion limit is part of the key, as it decides which terms are expanded
+  char *key = rm_malloc(plen + 96);
+  int n = sprintf(key, "%d:%llx:%llx:%lld:", (int)kind, (unsigned long long)(mask >> 32 >> 32),
+                  (unsigned long long)mask, RSGlobalConfig.maxPrefixExpansions);
+  memcpy(key + n, pattern, plen);
+  key[n + plen] = '\0';
+  return key;
+}
+
+static void entryFree(ExpansionCacheEntry *e) {
+  ExpansionPostings_Decref(e->postings);
+  for (size_t i = 0; i < e->nterms; ++i) {
+    rm_free(e->terms[i].str);
+  }
+  rm_free(e->terms);
+  rm_free(e->pattern);
+  rm_free(e->key);
+  rm_free(e);
+}
+
+static void ExpansionCache_Remove(ExpansionCache *c, ExpansionCacheEntry *e) {
+  char *pkey = rm_malloc(e->plen + 2);
+  patternKey(pkey, e->kind, e->pattern, e->plen);
+  dictEntry *de = dictFind(c->patterns, pkey);
+  ExpansionCacheEntry **pp = (ExpansionCacheEntry **)&dictGetVal(de);
+  while (*pp != e) {
+    pp = &(*pp)->samePattern;
+  }
+  *pp = e->samePattern;
+  if (!dictGetVal(de)) {
+    dictDelete(c->patterns, pkey);
+  }
+  rm_free(pkey);
+  c->plens[e->kind][e->plen]--;
+
+  dictDelete(c->entries, e->key);
+  dllist_delete(&e->llnode);
+  c->memsize -= e->memsize;
+  entryFree(e);
+}
+
+const ExpansionCacheEntry *ExpansionCache_Get(ExpansionCache *c, ExpansionKind kind,
+                                              const char *pattern, size_t plen, t_fieldMask mask) {
+  char *key = makeKey(kind, pattern, plen, mask);
+  dictEntry *de = dictFind(c->entries, key);
+  rm_free(key);
+  if (!de) {
+    c->misses++;
+    return NULL;
+  }
+  c->hits++;
+  ExpansionCacheEntry *e = dictGetVal(de);
+  dllist_delete(&e->llnode);
+  dllist_prepend(&c->lru, &e->llnode);
+  return e;
+}
+
+void ExpansionCache_Put(ExpansionCache *c, ExpansionKind kind, const char *pattern, size_t plen,
+                        t_fieldMask mask, ExpansionPostings *postings, ExpansionTerm *terms,
+                        size_t nterms) {
+  ExpansionCacheEntry *e = rm_calloc(1, sizeof(*e));
+  e->key = makeKey(kind, pattern, plen, mask);
+  e->kind = kind;
+  e->pattern = rm_strndup(pattern, plen);
+  e->plen = plen;
+  e->postings = postings;
+  ExpansionPostings_Incref(postings);
+  e->terms = terms;
+  e->nterms = nterms;
+  e->memsize = sizeof(*e) + 2 * strlen(e->key) + ExpansionPostings_MemUsage(postings) +
+               nterms * sizeof(*terms);
+  for (size_t i = 0; i < nterms; ++i) {
+    e->memsize += terms[i].len + 1;
+  }
+
+  size_t maxMemory = RSGlobalConfig.expansionCacheMaxMemory;
+  dictEntry *de = dictFind(c->entries, e->key);
+  if (de) {
+    ExpansionCache_Remove(c, dictGetVal(de));
+  }
+  if (e->memsize > maxMemory) {
+    entryFree(e);
+    return;
+  }
+  while (c->memsize + e->memsize > maxMemory) {
+    ExpansionCache_Remove(c, DLLIST_ITEM(c->lru.prev, ExpansionCacheEntry, llnode));
+  }
+  dictAdd(c->entries, e->key, e);
+  dllist_prepend(&c->lru, &e->llnode);
+  c->memsize += e->memsize;
+
+  char *pkey = rm_malloc(plen + 2);
+  patternKey(pkey, kind, pattern, plen);
+  dictEntry *pe = dictFind(c->patterns, pkey);
+  if (pe) {
+    e->samePattern = dictGetVal(pe);
+    dictSetVal(c->patterns, pe, e);
+  } else {
+    e->samePattern = NULL;
+    dictAdd(c->patterns, pkey, e);
+  }
+  rm_free(pkey);
+  size_t **plens = &c->plens[kind];
+  while (array_len(*plens) <= plen) {
+    *plens = array_append(*plens, 0);
+  }
+  (*plens)[plen]++;
+}
+
+/* Evicts the entries of a kind whose pattern is the substring of the term at [start, start+plen) */
+static void evictPattern(ExpansionCache *c, char *buf, ExpansionKind kind, const char *term,
+                         size_t start, size_t plen) {
+  patternKey(buf, kind, term + start, plen);
+  dictEntry *de = dictFind(c->patterns, buf);
+  if (!de) {
+    return;
+  }
+  // removing the last entry of the chain deletes the dictionary entry
+  ExpansionCacheEntry *e = dictGetVal(de);
+  while (e) {
+    ExpansionCacheEntry *next = e->samePattern;
+    ExpansionCache_Remove(c, e);
+    e = next;
+  }
+}
+
+void ExpansionCache_OnTermWrite(ExpansionCache *c, const char *term, size_t len) {
+  if (!dictSize(c->entries)) {
+    return;
+  }
+  char *buf = rm_malloc(len + 2);
+  for (int kind = 0; kind <= ExpansionKind_Contains; ++kind) {
+    size_t *plens = c->plens[kind];
+    for (size_t plen = 1; plen <= len && plen < array_len(plens); ++plen) {
+      if (!plens[plen]) {
+        continue;
+      }
+      if (kind == ExpansionKind_Prefix) {
+        evictPattern(c, buf, kind, term, 0, plen);
+      } else if (kind == ExpansionKind_Suffix) {
+        evictPattern(c, buf, kind, term, len - plen, plen);
+      } else {
+        for (size_t start = 0; start + plen <= len; ++start) {
+          evictPattern(c, buf, kind, term, start, plen);
+        }
+      }
+    }
+  }
+  rm_free(buf);
+}
+
+void ExpansionCache_Clear(ExpansionCache *c) {
+  while (!DLLIST_IS_EMPTY(&c->lru)) {
+    ExpansionCache_Remove(c, DLLIST_ITEM(c->lru.next, ExpansionCacheEntry, llnode));
+  }
+}
+
+size_t ExpansionCache_NumEntries(const ExpansionCache *c) {
+  return dictSize(c->entries);
+}
+
+void ExpansionCache_Free(ExpansionCache *c) {
+  ExpansionCache_Clear(c);
+  dictRelease(c->entries);
+  dictRelease(c->patterns);
+  for (int kind = 0; kind <= ExpansionKind_Contains; ++kind) {
+    array_free(c->plens[kind]);
+  }
+  rm_free(c);
+}
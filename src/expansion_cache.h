@@ -0,0 +1,113 @@
+#ifndef EXPANSION_CACHE_H
+#define EXPANSION_CACHE_H
+
+#include "redisearch.h"
+#include "util/dllist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The documents matched by a term expansion, as collected by a term-at-a-time union. Matches are
+ * kept as a bitmap of docIds starting at minId, along with the number of matches before each word
+ * of the bitmap, which locates the term, frequency and field mask of a match. Postings are
+ * immutable once built and are shared by reference between the cache and the iterators reading
+ * them */
+typedef struct {
+  t_docId minId;
+  uint64_t *bits;
+  uint32_t *ranks;
+  size_t nwords;
+  // number of matches
+  size_t len;
+  // index of the first expanded term matching each document, its frequency and field mask,
+  // in docId order
+  uint32_t *terms;
+  uint32_t *freqs;
+  t_fieldMask *masks;
+  // changed atomically, since queries running in the search threads release their references
+  // outside of the GIL
+  uint32_t refcount;
+} ExpansionPostings;
+
+ExpansionPostings *NewExpansionPostings(void);
+size_t ExpansionPostings_MemUsage(const ExpansionPostings *p);
+
+static inline void ExpansionPostings_Incref(ExpansionPostings *p) {
+  __sync_fetch_and_add(&p->refcount, 1);
+}
+void ExpansionPostings_Decref(ExpansionPostings *p);
+
+typedef enum {
+  ExpansionKind_Prefix,
+  ExpansionKind_Suffix,
+  ExpansionKind_Contains,
+} ExpansionKind;
+
+/* An expanded term of a cached expansion, with the number of documents it had when cached */
+typedef struct {
+  char *str;
+  size_t len;
+  size_t numDocs;
+} ExpansionTerm;
+
+typedef struct ExpansionCacheEntry {
+  DLLIST_node llnode;
+  // the next entry with the same kind and pattern, cached for other fields
+  struct ExpansionCacheEntry *samePattern;
+  char *key;
+  ExpansionKind kind;
+  char *pattern;
+  size_t plen;
+  ExpansionPostings *postings;
+  ExpansionTerm *terms;
+  size_t nterms;
+  size_t memsize;
+} ExpansionCacheEntry;
+
+/* A least recently used cache of the postings of the prefix, suffix and contains expansions of an
+ * index, keyed by the pattern and the fields it was searched in. An entry is evicted as soon as a
+ * term matching its pattern is written to the index, so the cached postings never miss a
+ * document. Deleted documents are filtered out when the results are loaded, as with any other
+ * posting list.
+ * The entries are also indexed by their kind and pattern, and the number of patterns of each
+ * kind and length is kept, so a term write only looks up its own prefixes, suffixes or substrings
+ * of the cached lengths instead of comparing the term with every entry */
+typedef struct ExpansionCache {
+  struct dict *entries;
+  // the entries by kind and pattern, chained by samePattern
+  struct dict *patterns;
+  // the number of entries of each kind by the length of their pattern
+  size_t *plens[ExpansionKind_Contains + 1];
+  // most recently used first
+  DLLIST lru;
+  size_t memsize;
+  size_t hits;
+  size_t misses;
+} ExpansionCache;
+
+ExpansionCache *NewExpansionCache(void);
+void ExpansionCache_Free(ExpansionCache *c);
+
+/* Returns the cached expansion of pattern in the fields of mask, or NULL. The entry is valid until
+ * the cache is next modified */
+const ExpansionCacheEntry *ExpansionCache_Get(ExpansionCache *c, ExpansionKind kind,
+                                              const char *pattern, size_t plen, t_fieldMask mask);
+
+/* Caches an expansion. The cache takes ownership of the terms and a reference to the postings.
+ * Least recently used entries are evicted to stay within EXPANSION_CACHE_MAX_MEMORY */
+void ExpansionCache_Put(ExpansionCache *c, ExpansionKind kind, const char *pattern, size_t plen,
+                        t_fieldMask mask, ExpansionPostings *postings, ExpansionTerm *terms,
+                        size_t nterms);
+
+/* Evicts the expansions whose pattern matches a term being written to the index */
+void ExpansionCache_OnTermWrite(ExpansionCache *c, const char *term, size_t len);
+
+void ExpansionCache_Clear(ExpansionCache *c);
+
+size_t ExpansionCache_NumEntries(const ExpansionCache *c);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -203,6 +203,39 @@ static double BM25Scorer(const ScoringFunctionArgs *ctx, const RSIndexResult *r,
   return score;
 }
 
+/******************************************************************************************
+ *
+ * Score upper bounds, used for top-k pruning. These bound the contribution of a single term to
+ * the scorer's sum, before the aggregate weights. The document score (at most 1) and the slop (at
+ * least 1) can only lower the final score.
+ *
+ ******************************************************************************************/
+
+/* TF is normalized by the document's max frequency or length, both of which are at least the
+ * frequency of any of its terms, so a term can contribute at most weight * idf */
+static double TFIDFTermBound(const RSIndexResult *r, uint32_t maxFreq, const RSIndexStats *stats) {
+  double idf = r->term.term ? r->term.term->idf : 0;
+  return r->weight * idf;
+}
+
+/* The BM25 term score is monotonic in the frequency */
+static double BM25TermBound(const RSIndexResult *r, uint32_t maxFreq, const RSIndexStats *stats) {
+  static const float b = 0.5;
+  static const float k1 = 1.2;
+  double f = (double)maxFreq;
+  double idf = (r->term.term ? r->term.term->idf : 0);
+  return idf * f / (f + k1 * (1.0f - b + b * stats->avgDocLen));
+}
+
+TermScoreBoundFunc DefaultScorer_GetTermBound(const char *scorerName) {
+  if (!strcmp(scorerName, DEFAULT_SCORER_NAME) || !strcmp(scorerName, TFIDF_DOCNORM_SCORER_NAME)) {
+    return TFIDFTermBound;
+  } else if (!strcmp(scorerName, BM25_SCORER_NAME)) {
+    return BM25TermBound;
+  }
+  return NULL;
+}
+
 /******************************************************************************************
  *
  * Raw document-score scorer. Just returns the document score
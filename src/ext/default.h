@@ -1,6 +1,7 @@
 #ifndef __EXT_DEFAULT_H__
 #define __EXT_DEFAULT_H__
 #include "redisearch.h"
+#include "inverted_index.h"
 
 #define PHONETIC_EXPENDER_NAME "PHONETIC"
 #define SYNONYMS_EXPENDER_NAME "SYNONYM"
@@ -15,4 +16,8 @@
 
 int DefaultExtensionInit(RSExtensionCtx *ctx);
 
+/* Get the term score bound function of a builtin scorer, or NULL if the scorer does not support
+ * top-k pruning */
+TermScoreBoundFunc DefaultScorer_GetTermBound(const char *scorerName);
+
 #endif
\ No newline at end of file
@@ -53,6 +53,10 @@ typedef enum {
   FieldSpec_Dynamic = 0x10,
   FieldSpec_UNF = 0x20,
   FieldSpec_WithSuffixTrie = 0x40,
+  // Bit-pack the values of a numeric field
+  FieldSpec_Compressed = 0x80,
+  // Keep the terms of the field in an n-gram index for contains and suffix queries
+  FieldSpec_WithNgrams = 0x100,
 } FieldSpecOptions;
 
 RS_ENUM_BITWISE_HELPER(FieldSpecOptions)
@@ -62,6 +66,10 @@ typedef enum {
   TagField_CaseSensitive = 0x01,
   TagField_TrimSpace = 0x02,
   TagField_RemoveAccents = 0x04,
+  // Elias-Fano pack the docIds of the tag values
+  TagField_Compressed = 0x08,
+  // Keep a bitset of the docIds of each tag value
+  TagField_Bitset = 0x10,
 } TagFieldFlags;
 
 RS_ENUM_BITWISE_HELPER(TagFieldFlags)
@@ -74,7 +82,7 @@ typedef struct FieldSpec {
   char *name;
   char *path;
   FieldType types : 8;
-  FieldSpecOptions options : 8;
+  FieldSpecOptions options : 16;
 
   /** If this field is sortable, the sortable index */
   int16_t sortIdx;
@@ -116,6 +124,8 @@ typedef struct FieldSpec {
 #define FieldSpec_IsPhonetics(fs) ((fs)->options & FieldSpec_Phonetics)
 #define FieldSpec_IsIndexable(fs) (0 == ((fs)->options & FieldSpec_NotIndexable))
 #define FieldSpec_HasSuffixTrie(fs) ((fs)->options & FieldSpec_WithSuffixTrie)
+#define FieldSpec_IsCompressed(fs) ((fs)->options & FieldSpec_Compressed)
+#define FieldSpec_HasNgrams(fs) ((fs)->options & FieldSpec_WithNgrams)
 
 void FieldSpec_SetSortable(FieldSpec* fs);
 void FieldSpec_Cleanup(FieldSpec* fs);
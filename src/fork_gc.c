@@ -18,6 +18,8 @@
 #include "module.h"
 #include "rmutil/rm_assert.h"
 #include "suffix.h"
+#include "ngram.h"
+#include "docid_compaction.h"
 
 #ifdef __linux__
 #include <sys/prctl.h>
@@ -496,17 +498,17 @@ static void FGC_childCollectTags(ForkGC *gc, RedisSearchCtx *sctx) {
                              .field = tagFields[i]->name,
                              .uniqueId = tagIdx->uniqueId};
 
-      TrieMapIterator *iter = TrieMap_Iterate(tagIdx->values, "", 0);
-      char *ptr;
-      tm_len_t len;
-      InvertedIndex *value;
-      while (TrieMapIterator_Next(iter, &ptr, &len, (void **)&value)) {
-        header.curPtr = value;
-        header.tagValue = ptr;
-        header.tagLen = len;
+      dictIterator *iter = dictGetIterator(tagIdx->values);
+      dictEntry *e;
+      while ((e = dictNext(iter))) {
+        TagValue *tv = dictGetKey(e);
+        header.curPtr = tv->iv;
+        header.tagValue = (char *)tv->str;
+        header.tagLen = tv->len;
         // send repaired data
-        FGC_childRepairInvidx(gc, sctx, value, sendNumericTagHeader, &header, NULL);
+        FGC_childRepairInvidx(gc, sctx, tv->iv, sendNumericTagHeader, &header, NULL);
       }
+      dictReleaseIterator(iter);
 
       // we are done with the current field
       if (header.sentFieldName) {
@@ -787,6 +789,9 @@ static FGCError FGC_parentHandleTerms(ForkGC *gc, RedisModuleCtx *rctx) {
     if (sctx->spec->suffix) {
       deleteSuffixTrie(sctx->spec->suffix, term, len);
     }
+    if (sctx->spec->ngrams) {
+      NgramIndex_Delete(sctx->spec->ngrams, term, len);
+    }
   }
 
 cleanup:
@@ -989,6 +994,9 @@ static FGCError FGC_parentHandleNumeric(ForkGC *gc, RedisModuleCtx *rctx) {
       NRN_AddRv rv = NumericRangeTree_TrimEmptyLeaves(rt);
       rt->numRanges += rv.numRanges;
       rt->emptyLeaves = 0;
+      // trimming can leave some branches much deeper than others
+      rv = NumericRangeTree_Rebalance(rt);
+      rt->numRanges += rv.numRanges;
     }
     if (hasLock) {
       FGC_unlock(gc, rctx);
@@ -1060,7 +1068,7 @@ static FGCError FGC_parentHandleTags(ForkGC *gc, RedisModuleCtx *rctx) {
     }
 
     InvertedIndex *idx = TagIndex_OpenIndex(tagIdx, tagVal, tagValLen, 0);
-    if (idx == TRIEMAP_NOTFOUND || idx != value) {
+    if (!idx || idx != value) {
       status = FGC_PARENT_ERROR;
       goto loop_cleanup;
     }
@@ -1069,15 +1077,18 @@ static FGCError FGC_parentHandleTags(ForkGC *gc, RedisModuleCtx *rctx) {
 
     FGC_applyInvertedIndex(gc, &idxbufs, &info, idx);
     FGC_updateStats(sctx, gc, info.ndocsCollected, info.nbytesCollected);
+    TagIndex_RebuildBitset(tagIdx, tagVal, tagValLen);
 
     // if tag value is empty, let's remove it.
     if (idx->numDocs == 0) {
-      // printf("Delete GC %s %p\n", tagVal, TrieMap_Find(tagIdx->values, tagVal, tagValLen));
-      TrieMap_Delete(tagIdx->values, tagVal, tagValLen, InvertedIndex_Free);
+      TagIndex_DeleteValue(tagIdx, tagVal, tagValLen);
 
       if (tagIdx->suffix) {
         deleteSuffixTrieMap(tagIdx->suffix, tagVal, tagValLen);
       }
+      if (tagIdx->ngrams) {
+        NgramIndex_Delete(tagIdx->ngrams, tagVal, tagValLen);
+      }
     }
 
   loop_cleanup:
@@ -1138,6 +1149,51 @@ static int FGC_fork(ForkGC *gc, RedisModuleCtx *ctx) {
   }
 }
 
+// Renumber the documents of the index if its ids became too sparse. Runs in the parent, once the
+// results of the child are applied, so that no collected index refers to the old ids
+static void FGC_compactDocIds(ForkGC *gc) {
+  RedisModuleCtx *rctx = gc->ctx;
+  if (!FGC_lock(gc, rctx)) {
+    return;
+  }
+  RedisSearchCtx *sctx = FGC_getSctx(gc, rctx);
+  if (sctx && sctx->spec->uniqueId == gc->specUniqueId &&
+      IndexSpec_ShouldCompactDocIds(sctx->spec)) {
+    DocIdCompactionStats stats;
+    QueryError status = {0};
+    if (IndexSpec_CompactDocIds(sctx, &stats, &status) == REDISMODULE_OK) {
+      RedisModule_Log(rctx, "notice",
+                      "Renumbered the documents of index %s: max doc id %zu -> %zu, inverted "
+                      "indexes %zu -> %zu bytes",
+                      sctx->spec->name, (size_t)stats.maxDocIdBefore, (size_t)stats.maxDocIdAfter,
+                      stats.invertedSizeBefore, stats.invertedSizeAfter);
+    } else {
+      // retried after the next cycle
+      QueryError_ClearError(&status);
+    }
+  }
+  if (sctx) {
+    SearchCtx_Free(sctx);
+  }
+  FGC_unlock(gc, rctx);
+}
+
+// Tell the doc table of the index that a pass over its indexes started, or that it completed and
+// the postings of the documents deleted before it were collected. Called with the lock held
+static void FGC_notifyDocTable(ForkGC *gc, RedisModuleCtx *rctx, bool completed) {
+  RedisSearchCtx *sctx = FGC_getSctx(gc, rctx);
+  if (sctx && sctx->spec->uniqueId == gc->specUniqueId) {
+    if (completed) {
+      DocTable_GcCompleted(&sctx->spec->docs);
+    } else {
+      DocTable_GcStarted(&sctx->spec->docs);
+    }
+  }
+  if (sctx) {
+    SearchCtx_Free(sctx);
+  }
+}
+
 static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
   ForkGC *gc = privdata;
   if (gc->deleting) {
@@ -1202,6 +1258,7 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
 
   gc->execState = FGC_STATE_SCANNING;
 
+  FGC_notifyDocTable(gc, ctx, false);
   cpid = FGC_fork(gc, ctx);  // duplicate the current process
 
   if (cpid == -1) {
@@ -1261,6 +1318,9 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
     gc->execState = FGC_STATE_APPLYING;
     if (FGC_parentHandleFromChild(gc) == REDISMODULE_ERR) {
       gcrv = 1;
+    } else if (FGC_lock(gc, ctx)) {
+      FGC_notifyDocTable(gc, ctx, true);
+      FGC_unlock(gc, ctx);
     }
     close(gc->pipefd[GC_READERFD]);
     if (FGC_haveRedisFork()) {
@@ -1297,6 +1357,9 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
     }
   }
   gc->execState = FGC_STATE_IDLE;
+  if (RSGlobalConfig.forkGcCompactDocIdsRatio) {
+    FGC_compactDocIds(gc);
+  }
   TimeSampler_End(&ts);
 
   long long msRun = TimeSampler_DurationMS(&ts);
@@ -1400,6 +1463,12 @@ static void deleteCb(void *ctx) {
   ++gc->deletedDocsFromLastRun;
 }
 
+static int isCollectingCb(void *ctx) {
+  ForkGC *gc = ctx;
+  // the child is forked and its results applied with the lock released
+  return gc->execState != FGC_STATE_IDLE && gc->execState != FGC_STATE_WAIT_FORK;
+}
+
 static struct timespec getIntervalCb(void *ctx) {
   ForkGC *gc = ctx;
   return gc->retryInterval;
@@ -1430,6 +1499,7 @@ ForkGC *FGC_New(const RedisModuleString *k, uint64_t specUniqueId, GCCallbacks *
   callbacks->getInterval = getIntervalCb;
   callbacks->kill = killCb;
   callbacks->onDelete = deleteCb;
+  callbacks->isCollecting = isCollectingCb;
 
   return forkGc;
 }
@@ -190,6 +190,10 @@ void GCContext_OnDelete(GCContext* gc) {
   }
 }
 
+int GCContext_IsCollecting(GCContext* gc) {
+  return gc->callbacks.isCollecting && gc->callbacks.isCollecting(gc->gcCtx);
+}
+
 void GCContext_CommonForceInvoke(GCContext* gc, RedisModuleBlockedClient* bc) {
   if (gc->stopped) {
     RedisModule_Log(RSDummyContext, "warning", "ForceInvokeGC command received after shut down");
@@ -22,6 +22,8 @@ typedef struct GCCallbacks {
   // Send a "kill signal" to the GC, requesting it to terminate asynchronously
   void (*kill)(void* ctx);
   struct timespec (*getInterval)(void* ctx);
+  // Whether a cycle is running whose results are not yet applied. Optional
+  int (*isCollecting)(void* ctx);
 } GCCallbacks;
 
 typedef struct GCContext {
@@ -47,6 +49,7 @@ void GCContext_RenderStats(GCContext* gc, RedisModuleCtx* ctx);
 void GCContext_RenderStatsForInfo(GCContext* gc, RedisModuleInfoCtx* ctx);
 #endif
 void GCContext_OnDelete(GCContext* gc);
+int GCContext_IsCollecting(GCContext* gc);
 void GCContext_ForceInvoke(GCContext* gc, RedisModuleBlockedClient* bc);
 void GCContext_ForceBGInvoke(GCContext* gc);
 
@@ -5,6 +5,7 @@
 #include "rmutil/rm_assert.h"
 #include "query_node.h"
 #include "query_param.h"
+#include <sys/param.h>
 
 static double extractUnitFactor(GeoDistance unit);
 
@@ -56,6 +57,9 @@ int GeoFilter_Parse(GeoFilter *gf, ArgsCursor *ac, QueryError *status) {
 
 void GeoFilter_Free(GeoFilter *gf) {
   if (gf->property) rm_free((char *)gf->property);
+  if (gf->scoreField) rm_free(gf->scoreField);
+  if (gf->coords) rm_free(gf->coords);
+  if (gf->edges) rm_free(gf->edges);
   if (gf->numericFilters) {
     for (int i = 0; i < GEO_RANGE_COUNT; ++i) {
       if (gf->numericFilters[i])
@@ -66,49 +70,49 @@ void GeoFilter_Free(GeoFilter *gf) {
   rm_free(gf);
 }
 
-static t_docId *geoRangeLoad(const GeoIndex *gi, const GeoFilter *gf, size_t *num) {
-  *num = 0;
-  t_docId *docIds = NULL;
-  RedisModuleString *s = IndexSpec_GetFormattedKey(gi->ctx->spec, gi->sp, INDEXFLD_T_GEO);
-  RS_LOG_ASSERT(s, "failed to retrive key");
-  /*GEORADIUS key longitude latitude radius m|km|ft|mi */
-  RedisModuleCtx *ctx = gi->ctx->redisCtx;
-  RedisModuleString *slon = RedisModule_CreateStringPrintf(ctx, "%f", gf->lon);
-  RedisModuleString *slat = RedisModule_CreateStringPrintf(ctx, "%f", gf->lat);
-  RedisModuleString *srad = RedisModule_CreateStringPrintf(ctx, "%f", gf->radius);
-  const char *unitstr = GeoDistance_ToString(gf->unitType);
-  RedisModuleCallReply *rep =
-      RedisModule_Call(ctx, "GEORADIUS", "ssssc", s, slon, slat, srad, unitstr);
-  if (rep == NULL || RedisModule_CallReplyType(rep) != REDISMODULE_REPLY_ARRAY) {
-    goto done;
+/* Store the edges of a polygon as the arrays of their first x, their first y, their second y and
+ * their slope in x per y, so checking a point is a single pass over arrays of doubles */
+static void preparePolygon(GeoFilter *gf) {
+  size_t n = gf->numCoords / 2;
+  gf->edges = rm_malloc(4 * n * sizeof(*gf->edges));
+  double *x1 = gf->edges, *y1 = x1 + n, *y2 = y1 + n, *slope = y2 + n;
+  for (size_t i = 0; i < n; ++i) {
+    size_t j = (i + 1) % n;
+    x1[i] = gf->coords[2 * i];
+    y1[i] = gf->coords[2 * i + 1];
+    y2[i] = gf->coords[2 * j + 1];
+    // a horizontal edge is never crossed, so its slope is never used
+    slope[i] = y1[i] == y2[i] ? 0 : (gf->coords[2 * j] - x1[i]) / (y2[i] - y1[i]);
   }
+}
 
-  size_t sz = RedisModule_CallReplyLength(rep);
-  docIds = rm_calloc(sz, sizeof(t_docId));
-  for (size_t i = 0; i < sz; i++) {
-    const char *s = RedisModule_CallReplyStringPtr(RedisModule_CallReplyArrayElement(rep, i), NULL);
-    if (!s) continue;
-
-    docIds[i] = (t_docId)atol(s);
+/* Calculate the cells which cover the box or the bounding box of the polygon of the filter */
+static void calcShapeRanges(const GeoFilter *gf, GeoHashRange *ranges) {
+  if (gf->shape == GEO_SHAPE_BOX) {
+    calcBoxRanges(gf->coords[0], gf->coords[1], gf->coords[2], gf->coords[3], ranges);
+    return;
   }
-
-  *num = sz;
-
-done:
-  RedisModule_FreeString(ctx, slon);
-  RedisModule_FreeString(ctx, slat);
-  RedisModule_FreeString(ctx, srad);
-  if (rep) {
-    RedisModule_FreeCallReply(rep);
+  double minLon = gf->coords[0], minLat = gf->coords[1], maxLon = minLon, maxLat = minLat;
+  for (size_t i = 2; i < gf->numCoords; i += 2) {
+    minLon = MIN(minLon, gf->coords[i]);
+    maxLon = MAX(maxLon, gf->coords[i]);
+    minLat = MIN(minLat, gf->coords[i + 1]);
+    maxLat = MAX(maxLat, gf->coords[i + 1]);
   }
-
-  return docIds;
+  calcBoxRanges(minLon, minLat, maxLon, maxLat, ranges);
 }
 
 IndexIterator *NewGeoRangeIterator(RedisSearchCtx *ctx, const GeoFilter *gf) {
   GeoHashRange ranges[GEO_RANGE_COUNT] = {{0}};
-  double radius_meter = gf->radius * extractUnitFactor(gf->unitType);
-  calcRanges(gf->lon, gf->lat, radius_meter, ranges);
+  if (gf->shape == GEO_SHAPE_RADIUS) {
+    double radius_meter = gf->radius * extractUnitFactor(gf->unitType);
+    calcRanges(gf->lon, gf->lat, radius_meter, ranges);
+  } else {
+    if (gf->shape == GEO_SHAPE_POLYGON && !gf->edges) {
+      preparePolygon((GeoFilter *)gf);
+    }
+    calcShapeRanges(gf, ranges);
+  }
 
   IndexIterator **iters = rm_calloc(GEO_RANGE_COUNT, sizeof(*iters));
   ((GeoFilter *)gf)->numericFilters = rm_calloc(GEO_RANGE_COUNT, sizeof(*gf->numericFilters));
@@ -218,6 +222,30 @@ int GeoFilter_Validate(const GeoFilter *gf, QueryError *status) {
     return 0;
   }
 
+  if (gf->knn) {
+    if (gf->k == 0) {
+      QERR_MKSYNTAXERR(status, "Invalid GeoFilter KNN k");
+      return 0;
+    }
+    return 1;
+  }
+
+  if (gf->shape != GEO_SHAPE_RADIUS) {
+    for (size_t i = 0; i < gf->numCoords; i += 2) {
+      double lon = gf->coords[i], lat = gf->coords[i + 1];
+      if (lat > 90 || lat < -90 || lon > 180 || lon < -180) {
+        QERR_MKSYNTAXERR(status, "Invalid GeoFilter lat/lon");
+        return 0;
+      }
+    }
+    // the longitudes of a box may wrap around the antimeridian, but its latitudes may not
+    if (gf->shape == GEO_SHAPE_BOX && gf->coords[1] > gf->coords[3]) {
+      QERR_MKSYNTAXERR(status, "Invalid GeoFilter box");
+      return 0;
+    }
+    return 1;
+  }
+
   // validate radius
   if (gf->radius <= 0) {
     QERR_MKSYNTAXERR(status, "Invalid GeoFilter radius");
@@ -265,21 +293,6 @@ static double extractUnitFactor(GeoDistance unit) {
   return rv;
 }
 
-/**
- * Populates the numeric range to search for within a given square direction
- * specified by `dir`
- */
-static int populateRange(const GeoFilter *gf, GeoHashRange *ranges) {
-  double xy[2] = {gf->lon, gf->lat};
-
-  double radius_meters = gf->radius * extractUnitFactor(gf->unitType);
-  if (radius_meters < 0) {
-    return -1;
-  }
-  calcRanges(gf->lon, gf->lat, radius_meters, ranges);
-  return 0;
-}
-
 /**
  * Checks if the given coordinate d is within the radius gf
  */
@@ -291,15 +304,31 @@ int isWithinRadius(const GeoFilter *gf, double d, double *distance) {
   return rv;
 }
 
-static int checkResult(const GeoFilter *gf, const RSIndexResult *cur) {
-  double distance;
-  if (cur->type == RSResultType_Numeric) {
-    return isWithinRadius(gf, cur->num.value, &distance);
+/* Even-odd test of a point against the edges of a polygon. Every edge is checked with the same
+ * arithmetic, without branches, so the loop runs over the edge arrays in vector registers */
+static int polygonContains(const double *edges, size_t n, double x, double y) {
+  const double *x1 = edges, *y1 = x1 + n, *y2 = y1 + n, *slope = y2 + n;
+  int crossings = 0;
+  for (size_t i = 0; i < n; ++i) {
+    // whether the edge crosses the horizontal ray from the point to the east
+    crossings += ((y1[i] > y) != (y2[i] > y)) & (x < x1[i] + (y - y1[i]) * slope[i]);
   }
-  for (size_t ii = 0; ii < cur->agg.numChildren; ++ii) {
-    if (checkResult(gf, cur->agg.children[ii])) {
-      return 1;
-    }
+  return crossings & 1;
+}
+
+int GeoFilter_Contains(const GeoFilter *gf, double d) {
+  if (gf->shape == GEO_SHAPE_RADIUS) {
+    return isWithinRadius(gf, d, NULL);
+  }
+  double xy[2];
+  decodeGeo(d, xy);
+  if (gf->shape == GEO_SHAPE_POLYGON) {
+    return polygonContains(gf->edges, gf->numCoords / 2, xy[0], xy[1]);
+  }
+  const double *c = gf->coords;
+  if (xy[1] < c[1] || xy[1] > c[3]) {
+    return 0;
   }
-  return 0;
+  // a box whose min longitude is east of its max longitude crosses the antimeridian
+  return c[0] <= c[2] ? xy[0] >= c[0] && xy[0] <= c[2] : xy[0] >= c[0] || xy[0] <= c[2];
 }
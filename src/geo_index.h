@@ -11,13 +11,6 @@
 #include "numeric_index.h"
 #include "query_node.h"
 
-typedef struct geoIndex {
-  RedisSearchCtx *ctx;
-  const FieldSpec *sp;
-} GeoIndex;
-
-#define GEOINDEX_KEY_FMT "geo:%s/%s"
-
 typedef enum {  // Placeholder for bad/invalid unit
   GEO_DISTANCE_INVALID = -1,
 #define X_GEO_DISTANCE(X) \
@@ -31,6 +24,12 @@ typedef enum {  // Placeholder for bad/invalid unit
 #undef X
 } GeoDistance;
 
+typedef enum {
+  GEO_SHAPE_RADIUS,   // the points within the radius around lon,lat
+  GEO_SHAPE_BOX,      // the points within the box of the corners minLon,minLat and maxLon,maxLat
+  GEO_SHAPE_POLYGON,  // the points within the polygon of the lon,lat vertices
+} GeoShape;
+
 typedef struct GeoFilter {
   const char *property;
   double lat;
@@ -38,6 +37,15 @@ typedef struct GeoFilter {
   double radius;
   GeoDistance unitType;
   NumericFilter **numericFilters;
+  // the k nearest points are matched instead of the points within the radius
+  int knn;
+  size_t k;
+  char *scoreField;  // the field of the distance of a knn match, in meters
+  // the points within a box or a polygon are matched instead of the points within the radius
+  GeoShape shape;
+  double *coords;  // the lon,lat pairs of the corners of the box or the vertices of the polygon
+  size_t numCoords;
+  double *edges;  // the edges of the polygon, prepared by NewGeoRangeIterator
 } GeoFilter;
 
 /* Create a geo filter from parsed strings and numbers */
@@ -72,3 +80,6 @@ IndexIterator *NewGeoRangeIterator(RedisSearchCtx *ctx, const GeoFilter *gf);
 #define INVALID_GEOHASH -1.0
 double calcGeoHash(double lon, double lat);
 int isWithinRadius(const GeoFilter *gf, double d, double *distance);
+
+/* Check if the point of the geohash d is within the radius or the shape of the filter */
+int GeoFilter_Contains(const GeoFilter *gf, double d);
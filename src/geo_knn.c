@@ -0,0 +1,328 @@
+#include "geo_knn.h"
+#include "rs_geo.h"
+#include "numeric_index.h"
+#include "inverted_index.h"
+#include "doc_table.h"
+#include "rmalloc.h"
+#include "util/arr.h"
+#include <math.h>
+#include <sys/param.h>
+
+#define GEO_KNN_EARTH_AREA 5.1e14  // square meters
+// beyond this radius neighbouring geohash cells may overlap, and every leaf is read instead
+#define GEO_KNN_FULL_SCAN_RADIUS 5000000
+#define GEO_KNN_RADIUS_GROWTH 4
+
+static int cmpEntriesById(const void *p1, const void *p2) {
+  const GeoKnnEntry *e1 = p1, *e2 = p2;
+  if (e1->docId != e2->docId) {
+    return e1->docId < e2->docId ? -1 : 1;
+  }
+  return e1->distance < e2->distance ? -1 : e1->distance > e2->distance ? 1 : 0;
+}
+
+static int cmpEntriesByDistance(const void *p1, const void *p2) {
+  const GeoKnnEntry *e1 = p1, *e2 = p2;
+  if (e1->distance != e2->distance) {
+    return e1->distance < e2->distance ? -1 : 1;
+  }
+  return e1->docId < e2->docId ? -1 : e1->docId > e2->docId ? 1 : 0;
+}
+
+static void clearEntries(GeoKnnEntry *entries, size_t from) {
+  for (size_t i = from; i < array_len(entries); ++i) {
+    if (entries[i].hit) {
+      IndexResult_Free(entries[i].hit);
+    }
+  }
+  array_trimm(entries, from, ARR_CAP_NOSHRINK);
+}
+
+/* Add the points of a range which are within the radius to the entries */
+static GeoKnnEntry *collectRange(GeoKnnIterator *it, GeoKnnEntry *entries, NumericRange *rng,
+                                 const NumericFilter *nf, double radius) {
+  const IndexSpec *sp = it->sp;
+  IndexReader *ir = NewNumericReader(sp, rng->entries, nf, rng->minVal, rng->maxVal);
+  RSIndexResult *res = NULL;
+  while (IR_Read(ir, &res) == INDEXREAD_OK) {
+    // deleted documents must not take the place of the nearest ones
+    if (!DocTable_Exists(&sp->docs, res->docId)) {
+      continue;
+    }
+    double xy[2];
+    decodeGeo(res->num.value, xy);
+    double distance = geohashGetDistance(it->gf->lon, it->gf->lat, xy[0], xy[1]);
+    if (distance <= radius) {
+      GeoKnnEntry e = {.docId = res->docId, .distance = distance};
+      entries = array_append(entries, e);
+    }
+  }
+  IR_Free(ir);
+  return entries;
+}
+
+/* Collect the points within the radius, without duplicates. A document with several points is
+ * kept with the nearest of them */
+static GeoKnnEntry *collectRadius(GeoKnnIterator *it, NumericRangeTree *t, double radius) {
+  GeoKnnEntry *entries = array_new(GeoKnnEntry, 16);
+  if (radius >= GEO_KNN_FULL_SCAN_RADIUS) {
+    NumericRange **ranges = NumericRangeTree_GetLeafRanges(t);
+    for (size_t i = 0; i < array_len(ranges); ++i) {
+      entries = collectRange(it, entries, ranges[i], NULL, INFINITY);
+    }
+    array_free(ranges);
+  } else {
+    GeoHashRange cells[GEO_RANGE_COUNT] = {0};
+    calcRanges(it->gf->lon, it->gf->lat, radius, cells);
+    for (size_t i = 0; i < GEO_RANGE_COUNT; ++i) {
+      if (cells[i].min == cells[i].max) {
+        continue;
+      }
+      NumericFilter nf = {
+          .min = cells[i].min, .max = cells[i].max, .inclusiveMin = 1, .inclusiveMax = 0};
+      Vector *v = NumericRangeTree_Find(t, nf.min, nf.max);
+      for (size_t j = 0; v && j < Vector_Size(v); ++j) {
+        NumericRange *rng;
+        Vector_Get(v, j, &rng);
+        if (rng) {
+          entries = collectRange(it, entries, rng, &nf, radius);
+        }
+      }
+      if (v) {
+        Vector_Free(v);
+      }
+    }
+  }
+
+  size_t n = array_len(entries);
+  qsort(entries, n, sizeof(*entries), cmpEntriesById);
+  size_t unique = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (!unique || entries[unique - 1].docId != entries[i].docId) {
+      entries[unique++] = entries[i];
+    }
+  }
+  array_trimm(entries, unique, ARR_CAP_NOSHRINK);
+  return entries;
+}
+
+/* Keep the entries which match the filter, and set the hits of all the entries */
+static int filterEntries(GeoKnnIterator *it, GeoKnnEntry *entries, size_t *num) {
+  IndexIterator *filter = it->child;
+  size_t n = array_len(entries);
+  if (!filter) {
+    for (size_t i = 0; i < n; ++i) {
+      RSIndexResult *hit = entries[i].hit = NewDistanceResult();
+      hit->docId = entries[i].docId;
+      hit->dist.distance = entries[i].distance;
+      hit->dist.scoreField = it->gf->scoreField;
+    }
+    *num = n;
+    return INDEXREAD_OK;
+  }
+
+  filter->Rewind(filter->ctx);
+  RSIndexResult *agg = NewHybridResult();
+  RSIndexResult *dist = NewDistanceResult();
+  RSIndexResult *fhit = NULL;
+  t_docId filterId = 0;
+  size_t matched = 0;
+  int rc = INDEXREAD_OK;
+  for (size_t i = 0; i < n; ++i) {
+    GeoKnnEntry *e = &entries[i];
+    if (e->docId > filterId) {
+      rc = filter->SkipTo(filter->ctx, e->docId, &fhit);
+      if (rc == INDEXREAD_TIMEOUT || rc == INDEXREAD_EOF) {
+        break;
+      } else if (rc == INDEXREAD_NOTFOUND) {
+        // the filter read its next match, which may be one of the next entries
+        filterId = MAX(fhit->docId, e->docId);
+        continue;
+      }
+      filterId = e->docId;
+    } else if (e->docId < filterId) {
+      // the filter is already past this document
+      continue;
+    }
+    dist->docId = agg->docId = e->docId;
+    dist->dist.distance = e->distance;
+    dist->dist.scoreField = it->gf->scoreField;
+    // the first child is the distance, and the second is the subtree of the filter, like the
+    // results of a hybrid vector query
+    AggregateResult_AddChild(agg, dist);
+    AggregateResult_AddChild(agg, fhit);
+    entries[matched] = *e;
+    entries[matched++].hit = IndexResult_DeepCopy(agg);
+    AggregateResult_Reset(agg);
+  }
+  IndexResult_Free(dist);
+  IndexResult_Free(agg);
+  *num = matched;
+  return rc == INDEXREAD_TIMEOUT ? INDEXREAD_TIMEOUT : INDEXREAD_OK;
+}
+
+/* The radius in which k points are expected if the n points of the index were spread evenly */
+static double initialRadius(size_t k, size_t n) {
+  if (!n) {
+    return GEO_KNN_FULL_SCAN_RADIUS;
+  }
+  double radius = sqrt(k * GEO_KNN_EARTH_AREA / (M_PI * n));
+  return MAX(radius, 1);
+}
+
+static int computeNearest(GeoKnnIterator *it) {
+  it->computed = 1;
+  NumericRangeTree *t = it->tree;
+
+  size_t k = it->gf->k;
+  size_t n = t->numEntries;
+  if (it->child) {
+    n = MIN(n, it->child->NumEstimated(it->child->ctx));
+  }
+  double radius = initialRadius(k, n);
+  while (1) {
+    GeoKnnEntry *entries = collectRadius(it, t, radius);
+    size_t matched;
+    int rc = filterEntries(it, entries, &matched);
+    array_trimm(entries, matched, ARR_CAP_NOSHRINK);
+    if (rc == INDEXREAD_TIMEOUT) {
+      clearEntries(entries, 0);
+      array_free(entries);
+      return rc;
+    }
+    // all the points within the radius were found, so k of them are the nearest of all
+    if (matched >= k || radius >= GEO_KNN_FULL_SCAN_RADIUS) {
+      qsort(entries, matched, sizeof(*entries), cmpEntriesByDistance);
+      clearEntries(entries, MIN(matched, k));
+      qsort(entries, array_len(entries), sizeof(*entries), cmpEntriesById);
+      it->entries = entries;
+      return INDEXREAD_OK;
+    }
+    clearEntries(entries, 0);
+    array_free(entries);
+    radius *= GEO_KNN_RADIUS_GROWTH;
+  }
+}
+
+static int GKI_Read(void *ctx, RSIndexResult **hit) {
+  GeoKnnIterator *it = ctx;
+  if (!it->base.isValid) {
+    return INDEXREAD_EOF;
+  }
+  if (!it->computed && computeNearest(it) == INDEXREAD_TIMEOUT) {
+    return INDEXREAD_TIMEOUT;
+  }
+  if (it->entryIdx >= array_len(it->entries)) {
+    IITER_SET_EOF(&it->base);
+    return INDEXREAD_EOF;
+  }
+  GeoKnnEntry *e = &it->entries[it->entryIdx++];
+  it->lastDocId = e->docId;
+  *hit = it->base.current = e->hit;
+  return INDEXREAD_OK;
+}
+
+static int GKI_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
+  GeoKnnIterator *it = ctx;
+  if (!it->base.isValid) {
+    return INDEXREAD_EOF;
+  }
+  if (!it->computed && computeNearest(it) == INDEXREAD_TIMEOUT) {
+    return INDEXREAD_TIMEOUT;
+  }
+  // binary search for the first entry at or after docId
+  size_t lo = it->entryIdx, hi = array_len(it->entries);
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (it->entries[mid].docId < docId) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == array_len(it->entries)) {
+    it->entryIdx = lo;
+    IITER_SET_EOF(&it->base);
+    return INDEXREAD_EOF;
+  }
+  GeoKnnEntry *e = &it->entries[lo];
+  it->entryIdx = lo + 1;
+  it->lastDocId = e->docId;
+  *hit = it->base.current = e->hit;
+  return e->docId == docId ? INDEXREAD_OK : INDEXREAD_NOTFOUND;
+}
+
+static int GKI_HasNext(void *ctx) {
+  GeoKnnIterator *it = ctx;
+  return it->base.isValid;
+}
+
+static size_t GKI_NumEstimated(void *ctx) {
+  GeoKnnIterator *it = ctx;
+  return it->computed ? array_len(it->entries) : it->gf->k;
+}
+
+static size_t GKI_Len(void *ctx) {
+  return GKI_NumEstimated(ctx);
+}
+
+static t_docId GKI_LastDocId(void *ctx) {
+  GeoKnnIterator *it = ctx;
+  return it->lastDocId;
+}
+
+static void GKI_Abort(void *ctx) {
+  GeoKnnIterator *it = ctx;
+  IITER_SET_EOF(&it->base);
+  if (it->child) {
+    it->child->Abort(it->child->ctx);
+  }
+}
+
+/* The nearest matches are kept, and read again from the start */
+static void GKI_Rewind(void *ctx) {
+  GeoKnnIterator *it = ctx;
+  it->entryIdx = 0;
+  it->lastDocId = 0;
+  it->base.current = NULL;
+  IITER_CLEAR_EOF(&it->base);
+}
+
+static void GKI_Free(IndexIterator *self) {
+  GeoKnnIterator *it = self->ctx;
+  if (it->entries) {
+    clearEntries(it->entries, 0);
+    array_free(it->entries);
+  }
+  if (it->child) {
+    it->child->Free(it->child);
+  }
+  rm_free(it);
+}
+
+IndexIterator *NewGeoKnnIterator(const IndexSpec *sp, NumericRangeTree *t, const GeoFilter *gf,
+                                 IndexIterator *filter) {
+  GeoKnnIterator *it = rm_calloc(1, sizeof(*it));
+  it->child = filter;
+  it->sp = sp;
+  it->tree = t;
+  it->gf = gf;
+
+  IndexIterator *ri = &it->base;
+  ri->ctx = it;
+  ri->type = GEO_KNN_ITERATOR;
+  ri->mode = MODE_SORTED;
+  ri->isValid = 1;
+  ri->current = NULL;
+  ri->NumEstimated = GKI_NumEstimated;
+  ri->GetCriteriaTester = NULL;
+  ri->Read = GKI_Read;
+  ri->SkipTo = GKI_SkipTo;
+  ri->LastDocId = GKI_LastDocId;
+  ri->HasNext = GKI_HasNext;
+  ri->Free = GKI_Free;
+  ri->Len = GKI_Len;
+  ri->Abort = GKI_Abort;
+  ri->Rewind = GKI_Rewind;
+  return ri;
+}
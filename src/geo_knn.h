@@ -0,0 +1,46 @@
+#pragma once
+
+#include "index_iterator.h"
+#include "geo_index.h"
+#include "numeric_index.h"
+#include "spec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  t_docId docId;
+  double distance;     // in meters
+  RSIndexResult *hit;  // the distance, with a copy of the filter's hit. Owned by the iterator
+} GeoKnnEntry;
+
+/* Returns the k points of a geo field which are nearest to the point of a knn geo filter.
+ * The search starts with the radius in which k points are expected if the points were spread
+ * evenly, and reads the geohash cells around the point which cover it. As long as fewer than k
+ * points are found within the radius, it is multiplied and the cells of the larger radius are
+ * read. Once k points are found within a radius, no point outside it can be nearer, so the search
+ * never reads more than a few times the area of the k nearest points.
+ * The nearest points are returned in the order of their docId, so the iterator can be nested in
+ * other iterators */
+typedef struct {
+  IndexIterator base;
+  IndexIterator *child;  // the filter of the knn query, or NULL
+  const IndexSpec *sp;
+  NumericRangeTree *tree;  // the index of the geo field
+  const GeoFilter *gf;
+  GeoKnnEntry *entries;  // array of the nearest matches, sorted by docId
+  size_t entryIdx;
+  t_docId lastDocId;
+  int computed;
+} GeoKnnIterator;
+
+/* Create an iterator over the gf->k documents nearest to the point of gf in the geo index t, out of
+ * the matches of filter. The iterator takes ownership of the filter, which may be NULL. The matches
+ * are only searched on the first read */
+IndexIterator *NewGeoKnnIterator(const IndexSpec *sp, NumericRangeTree *t, const GeoFilter *gf,
+                                 IndexIterator *filter);
+
+#ifdef __cplusplus
+}
+#endif
@@ -12,6 +12,8 @@
 #include "util/heap.h"
 #include "profile.h"
 #include "hybrid_reader.h"
+#include "numeric_order.h"
+#include "geo_knn.h"
 
 static int UI_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit);
 static int UI_SkipToHigh(void *ctx, t_docId docId, RSIndexResult **hit);
@@ -26,6 +28,7 @@ static int II_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit);
 static int II_ReadUnsorted(void *ctx, RSIndexResult **hit);
 static IndexCriteriaTester *II_GetCriteriaTester(void *ctx);
 static int II_ReadSorted(void *ctx, RSIndexResult **hit);
+static int II_ReadWindows(void *ctx, RSIndexResult **hit);
 static size_t II_NumEstimated(void *ctx);
 static size_t II_Len(void *ctx);
 static t_docId II_LastDocId(void *ctx);
@@ -42,6 +45,44 @@ int cmpMinId(const void *e1, const void *e2, const void *udata) {
   return 0;
 }
 
+/* MaxScore state of a union iterator. The children are ordered by their score upper bound, and a
+ * prefix of them that together cannot lift a document above the top-k threshold is not used to
+ * generate candidates - only to complete the records of candidates found by the other children */
+typedef struct {
+  const double *threshold;
+  // product of the weights above the union, including its own
+  double weight;
+  // score upper bound of the rest of the query
+  double rest;
+  // score upper bound of the union, including its weight
+  double bound;
+  // score upper bound of each child, in the order of origits / its
+  double *origBounds;
+  double *bounds;
+} UnionPrune;
+
+/* Term-at-a-time state of a quick exit union over many term readers, as created for prefix, fuzzy
+ * and suffix expansions. Rather than merging the readers posting by posting through the heap, the
+ * union drains them one after the other into a bitmap of the matching docIds, keeping the record of
+ * the first reader that matched each document - which is all a quick exit union reports. The
+ * bitmap is then iterated in docId order. A union over cached postings has no readers, and is
+ * ready from the start */
+typedef struct {
+  // whether the readers were already drained
+  int ready;
+  ExpansionPostings *postings;
+  // the term of each reader, owned by the accumulator only for cached postings
+  RSQueryTerm **terms;
+  size_t nterms;
+  int ownTerms;
+  // weight of the term records
+  double weight;
+  // the next bit to read
+  size_t pos;
+  // the term record reported for the current match
+  RSIndexResult *record;
+} UnionAccumulator;
+
 typedef struct {
   IndexIterator base;
   /**
@@ -69,6 +110,12 @@ typedef struct {
   QueryNodeType origType;
   // original string for fuzzy or prefix unions
   const char *qstr;
+
+  // top-k pruning state, NULL unless enabled
+  UnionPrune *prune;
+
+  // term-at-a-time state, NULL unless enabled
+  UnionAccumulator *acc;
 } UnionIterator;
 
 static void resetMinIdHeap(UnionIterator *ui) {
@@ -93,6 +140,9 @@ static inline t_docId UI_LastDocId(void *ctx) {
 static void UI_SyncIterList(UnionIterator *ui) {
   ui->num = ui->norig;
   memcpy(ui->its, ui->origits, sizeof(*ui->its) * ui->norig);
+  if (ui->prune) {
+    memcpy(ui->prune->bounds, ui->prune->origBounds, sizeof(double) * ui->norig);
+  }
   for (size_t ii = 0; ii < ui->num; ++ii) {
     ui->its[ii]->minId = 0;
   }
@@ -112,6 +162,10 @@ static size_t UI_RemoveExhausted(UnionIterator *it, size_t badix) {
   // destination: its + 8
   // number: it->len (10) - (8) - 1 == 1
   memmove(it->its + badix, it->its + badix + 1, sizeof(*it->its) * (it->num - badix - 1));
+  if (it->prune) {
+    double *bounds = it->prune->bounds;
+    memmove(bounds + badix, bounds + badix + 1, sizeof(double) * (it->num - badix - 1));
+  }
   it->num--;
   // Repeat the same index again, because we have a new iterator at the same
   // position
@@ -287,6 +341,20 @@ static inline int UI_ReadUnsorted(void *ctx, RSIndexResult **hit) {
   return INDEXREAD_EOF;
 }
 
+/* Returns the index of the first child which is needed for generating candidates. The children
+ * before it can't produce a top-k result on their own */
+static unsigned UI_FirstEssential(const UnionIterator *ui) {
+  const UnionPrune *prune = ui->prune;
+  const double threshold = *prune->threshold;
+  double bound = prune->rest;
+  unsigned i = 0;
+  for (; i < ui->num; i++) {
+    bound += prune->weight * prune->bounds[i];
+    if (bound >= threshold) break;
+  }
+  return i;
+}
+
 static inline int UI_ReadSorted(void *ctx, RSIndexResult **hit) {
   UnionIterator *ui = ctx;
   // nothing to do
@@ -306,8 +374,11 @@ static inline int UI_ReadSorted(void *ctx, RSIndexResult **hit) {
     numActive = 0;
     int rc = INDEXREAD_EOF;
     unsigned nits = ui->num;
+    // when pruning, only the essential children generate candidates. UI_SkipTo below completes
+    // the record from the rest
+    unsigned first = ui->prune ? UI_FirstEssential(ui) : 0;
 
-    for (unsigned i = 0; i < nits; i++) {
+    for (unsigned i = first; i < nits; i++) {
       IndexIterator *it = ui->its[i];
       RSIndexResult *res = IITER_CURRENT_RECORD(it);
       rc = INDEXREAD_OK;
@@ -586,6 +657,282 @@ static int UI_SkipToHigh(void *ctx, t_docId docId, RSIndexResult **hit) {
   return rc;
 }
 
+// The number of postings drained at once from each reader of an accumulating union
+#define UI_ACC_CHUNK 1024
+
+/* Matches found while draining the readers of an accumulating union, in the order found */
+typedef struct {
+  t_docId *docIds;
+  uint32_t *childs;
+  uint32_t *freqs;
+  t_fieldMask *masks;
+  size_t len;
+  size_t cap;
+} UIAccMatches;
+
+static void UI_AccMatchesAdd(UIAccMatches *m, t_docId docId, uint32_t child, uint32_t freq,
+                             t_fieldMask mask) {
+  if (m->len == m->cap) {
+    m->cap = m->cap ? m->cap * 2 : UI_ACC_CHUNK;
+    m->docIds = rm_realloc(m->docIds, m->cap * sizeof(*m->docIds));
+    m->childs = rm_realloc(m->childs, m->cap * sizeof(*m->childs));
+    m->freqs = rm_realloc(m->freqs, m->cap * sizeof(*m->freqs));
+    m->masks = rm_realloc(m->masks, m->cap * sizeof(*m->masks));
+  }
+  m->docIds[m->len] = docId;
+  m->childs[m->len] = child;
+  m->freqs[m->len] = freq;
+  m->masks[m->len] = mask;
+  m->len++;
+}
+
+static inline size_t UI_AccRank(const ExpansionPostings *p, size_t pos) {
+  uint64_t below = p->bits[pos / 64] & ((1ULL << (pos % 64)) - 1);
+  return p->ranks[pos / 64] + __builtin_popcountll(below);
+}
+
+/* Drain all the readers of the union into its accumulator */
+static void UI_Accumulate(UnionIterator *ui) {
+  UnionAccumulator *acc = ui->acc;
+  ExpansionPostings *p = acc->postings = NewExpansionPostings();
+  acc->ready = 1;
+
+  t_docId minId = UINT64_MAX, maxId = 0;
+  for (size_t i = 0; i < ui->norig; ++i) {
+    const InvertedIndex *idx = ((IndexReader *)ui->origits[i]->ctx)->idx;
+    if (idx->size && idx->lastId) {
+      minId = MIN(minId, idx->blocks[0].firstId);
+      maxId = MAX(maxId, idx->lastId);
+    }
+  }
+  if (minId > maxId) {
+    return;
+  }
+  p->minId = minId;
+  p->nwords = (maxId - minId) / 64 + 1;
+  p->bits = rm_calloc(p->nwords, sizeof(*p->bits));
+
+  t_docId docIds[UI_ACC_CHUNK];
+  uint32_t freqs[UI_ACC_CHUNK];
+  t_fieldMask masks[UI_ACC_CHUNK];
+  UIAccMatches found = {0};
+  for (uint32_t i = 0; i < ui->norig; ++i) {
+    IndexReader *ir = ui->origits[i]->ctx;
+    size_t n;
+    while ((n = IR_ReadBatch(ir, docIds, freqs, masks, UI_ACC_CHUNK))) {
+      for (size_t j = 0; j < n; ++j) {
+        t_docId off = docIds[j] - minId;
+        uint64_t bit = 1ULL << (off % 64);
+        if (p->bits[off / 64] & bit) {
+          continue;
+        }
+        p->bits[off / 64] |= bit;
+        UI_AccMatchesAdd(&found, docIds[j], i, freqs[j], masks[j]);
+      }
+    }
+  }
+
+  p->ranks = rm_malloc(p->nwords * sizeof(*p->ranks));
+  uint32_t rank = 0;
+  for (size_t w = 0; w < p->nwords; ++w) {
+    p->ranks[w] = rank;
+    rank += __builtin_popcountll(p->bits[w]);
+  }
+
+  // put the records in docId order
+  p->len = found.len;
+  p->terms = rm_malloc(found.len * sizeof(*p->terms));
+  p->freqs = rm_malloc(found.len * sizeof(*p->freqs));
+  p->masks = rm_malloc(found.len * sizeof(*p->masks));
+  for (size_t k = 0; k < found.len; ++k) {
+    size_t r = UI_AccRank(p, found.docIds[k] - minId);
+    p->terms[r] = found.childs[k];
+    p->freqs[r] = found.freqs[k];
+    p->masks[r] = found.masks[k];
+  }
+  rm_free(found.docIds);
+  rm_free(found.childs);
+  rm_free(found.freqs);
+  rm_free(found.masks);
+}
+
+/* Returns the first set bit of the postings from pos, or SIZE_MAX if there is none */
+static size_t UI_AccNextSetBit(const ExpansionPostings *p, size_t pos) {
+  size_t w = pos / 64;
+  if (w >= p->nwords) {
+    return SIZE_MAX;
+  }
+  uint64_t word = p->bits[w] & (~0ULL << (pos % 64));
+  while (!word) {
+    if (++w == p->nwords) {
+      return SIZE_MAX;
+    }
+    word = p->bits[w];
+  }
+  return w * 64 + __builtin_ctzll(word);
+}
+
+/* Move the accumulating union to its first match at or after bit pos, and build its record */
+static int UI_AccSeek(UnionIterator *ui, size_t pos, RSIndexResult **hit) {
+  UnionAccumulator *acc = ui->acc;
+  const ExpansionPostings *p = acc->postings;
+  pos = UI_AccNextSetBit(p, pos);
+  if (pos == SIZE_MAX) {
+    IITER_SET_EOF(&ui->base);
+    return INDEXREAD_EOF;
+  }
+  acc->pos = pos + 1;
+
+  size_t r = UI_AccRank(p, pos);
+  RSIndexResult *rec = acc->record;
+  rec->docId = p->minId + pos;
+  rec->freq = p->freqs[r];
+  rec->fieldMask = p->masks[r];
+  rec->weight = acc->weight;
+  rec->term.term = acc->terms[p->terms[r]];
+
+  AggregateResult_Reset(CURRENT_RECORD(ui));
+  AggregateResult_AddChild(CURRENT_RECORD(ui), rec);
+  ui->minDocId = rec->docId;
+  *hit = CURRENT_RECORD(ui);
+  return INDEXREAD_OK;
+}
+
+static int UI_ReadAccumulated(void *ctx, RSIndexResult **hit) {
+  UnionIterator *ui = ctx;
+  if (!IITER_HAS_NEXT(&ui->base)) {
+    return INDEXREAD_EOF;
+  }
+  if (!ui->acc->ready) {
+    UI_Accumulate(ui);
+  }
+  int rc = UI_AccSeek(ui, ui->acc->pos, hit);
+  if (rc == INDEXREAD_OK) {
+    ui->len++;
+  }
+  return rc;
+}
+
+static int UI_SkipToAccumulated(void *ctx, t_docId docId, RSIndexResult **hit) {
+  UnionIterator *ui = ctx;
+  if (docId == 0) {
+    return UI_ReadAccumulated(ctx, hit);
+  }
+  if (!IITER_HAS_NEXT(&ui->base)) {
+    return INDEXREAD_EOF;
+  }
+  UnionAccumulator *acc = ui->acc;
+  if (!acc->ready) {
+    UI_Accumulate(ui);
+  }
+  size_t pos = acc->pos;
+  if (docId >= acc->postings->minId) {
+    pos = MAX(pos, docId - acc->postings->minId);
+  }
+  int rc = UI_AccSeek(ui, pos, hit);
+  if (rc == INDEXREAD_EOF) {
+    return rc;
+  }
+  return ui->minDocId == docId ? INDEXREAD_OK : INDEXREAD_NOTFOUND;
+}
+
+static void UI_RewindAccumulated(void *ctx) {
+  UnionIterator *ui = ctx;
+  IITER_CLEAR_EOF(&ui->base);
+  ui->minDocId = 0;
+  CURRENT_RECORD(ui)->docId = 0;
+  ui->acc->pos = 0;
+}
+
+static void UnionAccumulator_Free(UnionAccumulator *acc) {
+  if (acc->postings) {
+    ExpansionPostings_Decref(acc->postings);
+  }
+  if (acc->ownTerms) {
+    for (size_t i = 0; i < acc->nterms; ++i) {
+      Term_Free(acc->terms[i]);
+    }
+  }
+  rm_free(acc->terms);
+  // the term belongs to the reader which matched, or was freed above
+  acc->record->term.term = NULL;
+  IndexResult_Free(acc->record);
+  rm_free(acc);
+}
+
+static void UI_SetAccumulator(IndexIterator *it, UnionAccumulator *acc) {
+  UnionIterator *ui = it->ctx;
+  ui->acc = acc;
+  acc->record = NewTokenRecord(NULL, acc->weight);
+  it->Read = UI_ReadAccumulated;
+  it->SkipTo = UI_SkipToAccumulated;
+  it->Rewind = UI_RewindAccumulated;
+}
+
+int IndexIterator_EnableAccumulation(IndexIterator *it, int anySize) {
+  if (it->type != UNION_ITERATOR || it->mode != MODE_SORTED) {
+    return 0;
+  }
+  UnionIterator *ui = it->ctx;
+  if (!ui->quickExit || ui->prune || ui->acc) {
+    return 0;
+  }
+  if (!anySize && (!RSGlobalConfig.minUnionAccumulate ||
+                   ui->norig < RSGlobalConfig.minUnionAccumulate)) {
+    return 0;
+  }
+  for (size_t i = 0; i < ui->norig; ++i) {
+    if (ui->origits[i]->type != READ_ITERATOR) {
+      return 0;
+    }
+  }
+  UnionAccumulator *acc = rm_calloc(1, sizeof(*acc));
+  acc->nterms = ui->norig;
+  acc->terms = rm_malloc(acc->nterms * sizeof(*acc->terms));
+  for (size_t i = 0; i < ui->norig; ++i) {
+    const RSIndexResult *rec = ((IndexReader *)ui->origits[i]->ctx)->record;
+    acc->terms[i] = rec->term.term;
+    acc->weight = rec->weight;
+  }
+  UI_SetAccumulator(it, acc);
+  return 1;
+}
+
+ExpansionPostings *IndexIterator_AccumulatedPostings(IndexIterator *it) {
+  if (it->type != UNION_ITERATOR) {
+    return NULL;
+  }
+  UnionIterator *ui = it->ctx;
+  if (!ui->acc) {
+    return NULL;
+  }
+  if (!ui->acc->ready) {
+    UI_Accumulate(ui);
+  }
+  return ui->acc->postings;
+}
+
+IndexIterator *NewCachedUnionIterator(ExpansionPostings *postings, RSQueryTerm **terms,
+                                      size_t nterms, DocTable *dt, double weight,
+                                      QueryNodeType type, const char *qstr) {
+  IndexIterator *it = NewUnionIterator(NULL, 0, dt, 1, weight, type, qstr);
+  UnionIterator *ui = it->ctx;
+  // there are no readers to test documents with
+  it->GetCriteriaTester = NULL;
+  ui->nexpected = postings->len;
+
+  UnionAccumulator *acc = rm_calloc(1, sizeof(*acc));
+  acc->ready = 1;
+  acc->postings = postings;
+  ExpansionPostings_Incref(postings);
+  acc->terms = terms;
+  acc->nterms = nterms;
+  acc->ownTerms = 1;
+  acc->weight = 1;
+  UI_SetAccumulator(it, acc);
+  return it;
+}
+
 void UnionIterator_Free(IndexIterator *itbase) {
   if (itbase == NULL) return;
 
@@ -599,6 +946,14 @@ void UnionIterator_Free(IndexIterator *itbase) {
 
   IndexResult_Free(CURRENT_RECORD(ui));
   if (ui->heapMinId) heap_free(ui->heapMinId);
+  if (ui->acc) {
+    UnionAccumulator_Free(ui->acc);
+  }
+  if (ui->prune) {
+    rm_free(ui->prune->origBounds);
+    rm_free(ui->prune->bounds);
+    rm_free(ui->prune);
+  }
   rm_free(ui->its);
   rm_free(ui->origits);
   rm_free(ui);
@@ -631,6 +986,14 @@ typedef struct {
   t_fieldMask fieldMask;
   double weight;
   size_t nexpected;
+  // whether the children are intersected through the decoded windows of their readers
+  int useWindows;
+
+  // docIds skipped by each child over its advances since the last reordering
+  t_docId *skipped;
+  uint32_t *advances;
+  // candidate rounds since the children were last reordered
+  uint32_t rounds;
 } IntersectIterator;
 
 void IntersectIterator_Free(IndexIterator *it) {
@@ -653,6 +1016,8 @@ void IntersectIterator_Free(IndexIterator *it) {
   }
 
   rm_free(ui->docIds);
+  rm_free(ui->skipped);
+  rm_free(ui->advances);
   rm_free(ui->its);
   IndexResult_Free(it->current);
   array_free(ui->testers);
@@ -673,6 +1038,7 @@ static void II_Rewind(void *ctx) {
   IntersectIterator *ii = ctx;
   ii->base.isValid = 1;
   ii->lastDocId = 0;
+  ii->lastFoundId = 0;
 
   // rewind all child iterators
   for (int i = 0; i < ii->num; i++) {
@@ -689,7 +1055,54 @@ static int cmpIter(IndexIterator **it1, IndexIterator **it2) {
   if (!*it1) return -1;
   if (!*it2) return 1;
 
-  return (int)((*it1)->NumEstimated((*it1)->ctx) - (*it2)->NumEstimated((*it2)->ctx));
+  size_t n1 = (*it1)->NumEstimated((*it1)->ctx), n2 = (*it2)->NumEstimated((*it2)->ctx);
+  return n1 < n2 ? -1 : (n1 > n2 ? 1 : 0);
+}
+
+// The number of candidate rounds after which the children of an intersection are reordered
+#define II_REORDER_INTERVAL 128
+
+static inline void II_RecordAdvance(IntersectIterator *ic, int i, t_docId from, t_docId to) {
+  if (to > from) {
+    ic->skipped[i] += to - from;
+  }
+  ic->advances[i]++;
+}
+
+/* The average number of docIds a child skipped per advance. A child which was not advanced since
+ * the last reordering is tried first, so that its selectivity gets measured */
+static inline double II_SkipRate(const IntersectIterator *ic, unsigned i) {
+  return ic->advances[i] ? (double)ic->skipped[i] / ic->advances[i] : INFINITY;
+}
+
+/* The estimated sizes used for the initial order are often far off, e.g. for numeric ranges or
+ * unions. Every few rounds, the children are reordered by the docIds they actually skipped per
+ * advance, so that the most selective ones rule candidates out first. Children can't be reordered
+ * if their order is checked */
+static void II_AdaptOrder(IntersectIterator *ic) {
+  if (ic->inOrder || ic->num < 2 || ++ic->rounds < II_REORDER_INTERVAL) {
+    return;
+  }
+  ic->rounds = 0;
+  // insertion sort, the children are few and mostly in order already
+  for (unsigned i = 1; i < ic->num; ++i) {
+    for (unsigned j = i; j > 0 && II_SkipRate(ic, j) > II_SkipRate(ic, j - 1); --j) {
+      IndexIterator *it = ic->its[j];
+      ic->its[j] = ic->its[j - 1];
+      ic->its[j - 1] = it;
+      t_docId docId = ic->docIds[j];
+      ic->docIds[j] = ic->docIds[j - 1];
+      ic->docIds[j - 1] = docId;
+      t_docId skipped = ic->skipped[j];
+      ic->skipped[j] = ic->skipped[j - 1];
+      ic->skipped[j - 1] = skipped;
+      uint32_t advances = ic->advances[j];
+      ic->advances[j] = ic->advances[j - 1];
+      ic->advances[j - 1] = advances;
+    }
+  }
+  memset(ic->skipped, 0, ic->num * sizeof(*ic->skipped));
+  memset(ic->advances, 0, ic->num * sizeof(*ic->advances));
 }
 
 static void II_SortChildren(IntersectIterator *ctx) {
@@ -763,6 +1176,31 @@ static void II_SortChildren(IntersectIterator *ctx) {
   array_free(unsortedIts);
 }
 
+/* Intersect the children by galloping over windows of decoded docIds when at least one of them is
+ * a plain reader. The other children are advanced with SkipTo */
+static void II_EnableWindows(IntersectIterator *ctx) {
+  if (ctx->base.mode != MODE_SORTED || ctx->num < 2) {
+    return;
+  }
+  int nreaders = 0;
+  for (size_t i = 0; i < ctx->num; ++i) {
+    if (!ctx->its[i]) {
+      return;
+    }
+    nreaders += ctx->its[i]->type == READ_ITERATOR;
+  }
+  if (!nreaders) {
+    return;
+  }
+  for (size_t i = 0; i < ctx->num; ++i) {
+    if (ctx->its[i]->type == READ_ITERATOR) {
+      IR_EnableWindow(ctx->its[i]->ctx);
+    }
+  }
+  ctx->useWindows = 1;
+  ctx->base.Read = II_ReadWindows;
+}
+
 IndexIterator *NewIntersecIterator(IndexIterator **its_, size_t num, DocTable *dt,
                                    t_fieldMask fieldMask, int maxSlop, int inOrder, double weight) {
   // printf("Creating new intersection iterator with fieldMask=%llx\n", fieldMask);
@@ -775,6 +1213,8 @@ IndexIterator *NewIntersecIterator(IndexIterator **its_, size_t num, DocTable *d
   ctx->fieldMask = fieldMask;
   ctx->weight = weight;
   ctx->docIds = rm_calloc(num, sizeof(t_docId));
+  ctx->skipped = rm_calloc(num, sizeof(*ctx->skipped));
+  ctx->advances = rm_calloc(num, sizeof(*ctx->advances));
   ctx->docTable = dt;
   ctx->nexpected = IITER_INVALID_NUM_ESTIMATED_RESULTS;
 
@@ -804,15 +1244,23 @@ IndexIterator *NewIntersecIterator(IndexIterator **its_, size_t num, DocTable *d
   it->HasNext = NULL;
   it->mode = MODE_SORTED;
   II_SortChildren(ctx);
+  II_EnableWindows(ctx);
   return it;
 }
 
 static int II_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
+  IntersectIterator *ic = ctx;
   /* A seek with docId 0 is equivalent to a read */
   if (docId == 0) {
-    return II_ReadSorted(ctx, hit);
+    return ic->base.Read(ctx, hit);
+  }
+  if (ic->useWindows) {
+    ic->lastDocId = MAX(ic->lastDocId, docId);
+    if (II_ReadWindows(ic, hit) == INDEXREAD_EOF) {
+      return INDEXREAD_EOF;
+    }
+    return ic->lastFoundId == docId ? INDEXREAD_OK : INDEXREAD_NOTFOUND;
   }
-  IntersectIterator *ic = ctx;
   AggregateResult_Reset(ic->base.current);
   int nfound = 0;
 
@@ -965,6 +1413,7 @@ static int II_ReadSorted(void *ctx, RSIndexResult **hit) {
   do {
     nh = 0;
     AggregateResult_Reset(ic->base.current);
+    II_AdaptOrder(ic);
 
     for (i = 0; i < ic->num; i++) {
       IndexIterator *it = ic->its[i];
@@ -985,6 +1434,7 @@ static int II_ReadSorted(void *ctx, RSIndexResult **hit) {
         //        h->docId, it->LastDocId(it->ctx), rc);
 
         if (rc == INDEXREAD_EOF) goto eof;
+        II_RecordAdvance(ic, i, ic->lastDocId, h->docId);
         ic->docIds[i] = h->docId;
       }
 
@@ -1043,6 +1493,109 @@ eof:
   return INDEXREAD_EOF;
 }
 
+/* Find the first docId of the window which is not below the target. Gallops to a range which ends
+ * with such an id (the last one of the window always is), then counts the smaller ids of the range
+ * without branching, which the compiler vectorizes */
+static inline uint32_t II_WindowSeek(const IndexReaderWindow *w, t_docId target) {
+  uint32_t lo = w->cur, step = 1;
+  while (lo + step < w->len && w->docIds[lo + step] < target) {
+    lo += step;
+    step <<= 1;
+  }
+  uint32_t hi = MIN(lo + step, w->len - 1);
+  uint32_t n = 0;
+  for (uint32_t j = lo; j < hi; ++j) {
+    n += w->docIds[j] < target;
+  }
+  return lo + n;
+}
+
+/* Move child i of the intersection to its first docId not below the target. Returns the docId, or
+ * 0 at EOF */
+static t_docId II_AdvanceChild(IntersectIterator *ic, int i, t_docId target) {
+  IndexIterator *it = ic->its[i];
+  if (it->type == READ_ITERATOR) {
+    IndexReader *ir = it->ctx;
+    IndexReaderWindow *w = ir->window;
+    while (w->cur == w->len || w->docIds[w->len - 1] < target) {
+      if (!IR_FillWindow(ir, target)) {
+        return 0;
+      }
+    }
+    w->cur = II_WindowSeek(w, target);
+    return ic->docIds[i] = w->docIds[w->cur];
+  }
+
+  // the child's current record is a match if it is already at the target
+  if (ic->docIds[i] >= target) {
+    return ic->docIds[i];
+  }
+  RSIndexResult *h = NULL;
+  int rc = it->SkipTo(it->ctx, target, &h);
+  if (rc == INDEXREAD_EOF) {
+    return 0;
+  }
+  if (rc == INDEXREAD_OK || h->docId > target) {
+    return ic->docIds[i] = h->docId;
+  }
+  // the child rejected the target without moving past it
+  ic->docIds[i] = target;
+  return target + 1;
+}
+
+static int II_ReadWindows(void *ctx, RSIndexResult **hit) {
+  IntersectIterator *ic = ctx;
+  t_docId target = MAX(ic->lastDocId, 1);
+
+  while (1) {
+    II_AdaptOrder(ic);
+    // go round the children until they all agree on the target
+    for (int i = 0, agreed = 0; agreed < ic->num; i = (i + 1) % ic->num) {
+      t_docId docId = II_AdvanceChild(ic, i, target);
+      if (!docId) {
+        goto eof;
+      }
+      II_RecordAdvance(ic, i, target, docId);
+      if (docId > target) {
+        target = docId;
+        agreed = ic->docIds[i] == docId;
+      } else {
+        ++agreed;
+      }
+    }
+
+    AggregateResult_Reset(ic->base.current);
+    for (int i = 0; i < ic->num; ++i) {
+      IndexIterator *it = ic->its[i];
+      RSIndexResult *h = IITER_CURRENT_RECORD(it);
+      if (it->type == READ_ITERATOR) {
+        IndexReader *ir = it->ctx;
+        h = IR_ReadWindowRecord(ir, ir->window->cur);
+      }
+      AggregateResult_AddChild(ic->base.current, h);
+    }
+    ic->lastFoundId = target;
+    ic->lastDocId = ++target;
+
+    if ((ic->base.current->fieldMask & ic->fieldMask) == 0) {
+      continue;
+    }
+    if (ic->maxSlop >= 0 &&
+        !IndexResult_IsWithinRange(ic->base.current, ic->maxSlop, ic->inOrder)) {
+      continue;
+    }
+    ic->len++;
+    if (hit != NULL) {
+      *hit = ic->base.current;
+    }
+    return INDEXREAD_OK;
+  }
+
+eof:
+  ic->base.isValid = 0;
+  return INDEXREAD_EOF;
+}
+
 static t_docId II_LastDocId(void *ctx) {
   // return last FOUND id, not last read id form any child
   return ((IntersectIterator *)ctx)->lastFoundId;
@@ -1058,6 +1611,8 @@ typedef struct {
   IndexIterator base;
   IndexIterator *child;
   IndexCriteriaTester *childCT;
+  // deleted documents never match, even if the child does not have them
+  const DocTable *dt;
   t_docId lastDocId;
   t_docId maxDocId;
   size_t len;
@@ -1101,6 +1656,13 @@ static int NI_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
     return INDEXREAD_EOF;
   }
 
+  if (nc->dt && DocTable_IsDeleted(nc->dt, docId)) {
+    nc->base.current->docId = docId;
+    nc->lastDocId = docId;
+    *hit = nc->base.current;
+    return INDEXREAD_NOTFOUND;
+  }
+
   // Get the child's last read docId
   // if lastDocId is 0, Read & Skipto weren't called yet and child lastId
   // might not be be updated (ex. NUMERIC filter) (PR-2440)
@@ -1175,7 +1737,8 @@ static size_t NI_NumEstimated(void *ctx) {
 static int NI_ReadUnsorted(void *ctx, RSIndexResult **hit) {
   NotContext *nc = ctx;
   while (nc->lastDocId > nc->maxDocId) {
-    if (!nc->childCT->Test(nc->childCT, nc->lastDocId)) {
+    if (!nc->childCT->Test(nc->childCT, nc->lastDocId) &&
+        !(nc->dt && DocTable_IsDeleted(nc->dt, nc->lastDocId))) {
       nc->base.current->docId = nc->lastDocId;
       *hit = nc->base.current;
       ++nc->lastDocId;
@@ -1204,6 +1767,7 @@ static int NI_ReadSorted(void *ctx, RSIndexResult **hit) {
     nc->child->Read(nc->child->ctx, &cr);
   }
 
+next:
   // advance our reader by one, and let's test if it's a valid value or not
   nc->base.current->docId++;
 
@@ -1230,6 +1794,9 @@ ok:
     IITER_SET_EOF(&nc->base);
     return INDEXREAD_EOF;
   }
+  if (nc->dt && DocTable_IsDeleted(nc->dt, nc->base.current->docId)) {
+    goto next;
+  }
 
   // Set the next entry and return ok
   nc->lastDocId = nc->base.current->docId;
@@ -1259,13 +1826,15 @@ static t_docId NI_LastDocId(void *ctx) {
   return nc->lastDocId;
 }
 
-IndexIterator *NewNotIterator(IndexIterator *it, t_docId maxDocId, double weight) {
+IndexIterator *NewNotIterator(IndexIterator *it, const DocTable *dt, t_docId maxDocId,
+                              double weight) {
   NotContext *nc = rm_malloc(sizeof(*nc));
   nc->base.current = NewVirtualResult(weight);
   nc->base.current->fieldMask = RS_FIELDMASK_ALL;
   nc->base.current->docId = 0;
   nc->child = it ? it : NewEmptyIterator();
   nc->childCT = NULL;
+  nc->dt = dt;
   nc->lastDocId = 0;
   nc->maxDocId = maxDocId;
   nc->len = 0;
@@ -1525,6 +2094,8 @@ IndexIterator *NewOptionalIterator(IndexIterator *it, t_docId maxDocId, double w
  * the incremental document ids, and matches every skip within its range. */
 typedef struct {
   IndexIterator base;
+  // deleted documents are skipped
+  const DocTable *dt;
   t_docId topId;
   t_docId current;
 } WildcardIterator, WildcardIteratorCtx;
@@ -1540,6 +2111,9 @@ static void WI_Free(IndexIterator *it) {
 /* Read reads the next consecutive id, unless we're at the end */
 static int WI_Read(void *ctx, RSIndexResult **hit) {
   WildcardIteratorCtx *nc = ctx;
+  while (nc->dt && nc->current <= nc->topId && DocTable_IsDeleted(nc->dt, nc->current)) {
+    nc->current++;
+  }
   if (nc->current > nc->topId) {
     return INDEXREAD_EOF;
   }
@@ -1561,12 +2135,22 @@ static int WI_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
 
   if (docId == 0) return WI_Read(ctx, hit);
 
-  nc->current = docId;
-  CURRENT_RECORD(nc)->docId = docId;
+  // land on the next document which was not deleted
+  t_docId id = docId;
+  while (nc->dt && id <= nc->topId && DocTable_IsDeleted(nc->dt, id)) {
+    id++;
+  }
+  if (id > nc->topId) {
+    nc->current = nc->topId + 1;
+    return INDEXREAD_EOF;
+  }
+
+  nc->current = id;
+  CURRENT_RECORD(nc)->docId = id;
   if (hit) {
     *hit = CURRENT_RECORD(nc);
   }
-  return INDEXREAD_OK;
+  return id == docId ? INDEXREAD_OK : INDEXREAD_NOTFOUND;
 }
 
 static void WI_Abort(void *ctx) {
@@ -1604,8 +2188,9 @@ static size_t WI_NumEstimated(void *p) {
 }
 
 /* Create a new wildcard iterator */
-IndexIterator *NewWildcardIterator(t_docId maxId) {
+IndexIterator *NewWildcardIterator(const DocTable *dt, t_docId maxId) {
   WildcardIteratorCtx *c = rm_calloc(1, sizeof(*c));
+  c->dt = dt;
   c->current = 1;
   c->topId = maxId;
 
@@ -1667,6 +2252,167 @@ IndexIterator *NewEmptyIterator(void) {
   return &eofIterator;
 }
 
+/**********************************************************
+ * Top-k pruning
+ **********************************************************/
+
+/* Check whether every iterator in the tree has a known score upper bound. The scorers we support
+ * sum the term contributions, multiplied by the weights of the aggregates above them */
+static int Prune_IsSupported(const IndexIterator *it) {
+  if (!it) return 0;
+  switch (it->type) {
+    case EMPTY_ITERATOR:
+      return 1;
+    case READ_ITERATOR: {
+      const IndexReader *ir = it->ctx;
+      return ir->record->type == RSResultType_Term && (ir->idx->flags & Index_StoreFreqs);
+    }
+    case UNION_ITERATOR: {
+      const UnionIterator *ui = it->ctx;
+      if (it->mode != MODE_SORTED || ui->quickExit || ui->weight < 0) return 0;
+      for (size_t i = 0; i < ui->norig; ++i) {
+        if (!Prune_IsSupported(ui->origits[i])) return 0;
+      }
+      return 1;
+    }
+    case INTERSECT_ITERATOR: {
+      const IntersectIterator *ii = it->ctx;
+      if (it->mode != MODE_SORTED || array_len(ii->testers) || ii->weight < 0) return 0;
+      for (size_t i = 0; i < ii->num; ++i) {
+        if (!Prune_IsSupported(ii->its[i])) return 0;
+      }
+      return 1;
+    }
+    default:
+      return 0;
+  }
+}
+
+typedef struct {
+  IndexIterator *it;
+  double bound;
+} PruneChild;
+
+static int cmpPruneChild(const void *p1, const void *p2) {
+  const PruneChild *c1 = p1, *c2 = p2;
+  return c1->bound < c2->bound ? -1 : (c1->bound > c2->bound ? 1 : 0);
+}
+
+/* Enable pruning on the readers of the tree, and return its score upper bound */
+static double Prune_Enable(IndexIterator *it, const TopKPruneCtx *ctx) {
+  switch (it->type) {
+    case READ_ITERATOR:
+      return IR_EnablePruning(it->ctx, ctx);
+    case UNION_ITERATOR: {
+      UnionIterator *ui = it->ctx;
+      PruneChild *children = rm_malloc(ui->norig * sizeof(*children));
+      for (size_t i = 0; i < ui->norig; ++i) {
+        children[i].it = ui->origits[i];
+        children[i].bound = Prune_Enable(ui->origits[i], ctx);
+      }
+      // MaxScore needs the children ordered by their bound
+      qsort(children, ui->norig, sizeof(*children), cmpPruneChild);
+
+      UnionPrune *prune = rm_calloc(1, sizeof(*prune));
+      prune->threshold = ctx->threshold;
+      prune->origBounds = rm_malloc(ui->norig * sizeof(double));
+      prune->bounds = rm_malloc(ui->norig * sizeof(double));
+      double sum = 0;
+      for (size_t i = 0; i < ui->norig; ++i) {
+        ui->origits[i] = children[i].it;
+        prune->origBounds[i] = children[i].bound;
+        sum += children[i].bound;
+      }
+      rm_free(children);
+      prune->bound = ui->weight * sum;
+      ui->prune = prune;
+      UI_SyncIterList(ui);
+      return prune->bound;
+    }
+    case INTERSECT_ITERATOR: {
+      IntersectIterator *ii = it->ctx;
+      double sum = 0;
+      for (size_t i = 0; i < ii->num; ++i) {
+        sum += Prune_Enable(ii->its[i], ctx);
+      }
+      return ii->weight * sum;
+    }
+    default:
+      return 0;
+  }
+}
+
+/* The score upper bound of a tree on which Prune_Enable was already called */
+static double Prune_Bound(const IndexIterator *it) {
+  switch (it->type) {
+    case READ_ITERATOR:
+      return ((const IndexReader *)it->ctx)->prune->bound;
+    case UNION_ITERATOR:
+      return ((const UnionIterator *)it->ctx)->prune->bound;
+    case INTERSECT_ITERATOR: {
+      const IntersectIterator *ii = it->ctx;
+      double sum = 0;
+      for (size_t i = 0; i < ii->num; ++i) {
+        sum += Prune_Bound(ii->its[i]);
+      }
+      return ii->weight * sum;
+    }
+    default:
+      return 0;
+  }
+}
+
+/* Let every node know how much the rest of the query can add to a document's score, and the
+ * product of the weights above it */
+static void Prune_SetRest(IndexIterator *it, double rest, double weight) {
+  switch (it->type) {
+    case READ_ITERATOR: {
+      IndexReaderPrune *prune = ((IndexReader *)it->ctx)->prune;
+      prune->rest = rest;
+      prune->weight = weight;
+      break;
+    }
+    case UNION_ITERATOR: {
+      UnionIterator *ui = it->ctx;
+      UnionPrune *prune = ui->prune;
+      prune->rest = rest;
+      prune->weight = weight * ui->weight;
+      double sum = 0;
+      for (size_t i = 0; i < ui->norig; ++i) {
+        sum += prune->origBounds[i];
+      }
+      for (size_t i = 0; i < ui->norig; ++i) {
+        double others = prune->weight * (sum - prune->origBounds[i]);
+        Prune_SetRest(ui->origits[i], rest + others, prune->weight);
+      }
+      break;
+    }
+    case INTERSECT_ITERATOR: {
+      IntersectIterator *ii = it->ctx;
+      double w = weight * ii->weight;
+      double sum = 0;
+      for (size_t i = 0; i < ii->num; ++i) {
+        sum += Prune_Bound(ii->its[i]);
+      }
+      for (size_t i = 0; i < ii->num; ++i) {
+        Prune_SetRest(ii->its[i], rest + w * (sum - Prune_Bound(ii->its[i])), w);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+int IndexIterator_EnableTopKPruning(IndexIterator *root, const TopKPruneCtx *ctx) {
+  if (!Prune_IsSupported(root)) {
+    return 0;
+  }
+  Prune_Enable(root, ctx);
+  Prune_SetRest(root, 0, 1);
+  return 1;
+}
+
 // LCOV_EXCL_START unused
 const char *IndexIterator_GetTypeString(const IndexIterator *it) {
   if (it->Free == UnionIterator_Free) {
@@ -1829,7 +2575,9 @@ PRINT_PROFILE_FUNC(printUnionIt) {
   nlen++;
   if (printFull) {
     for (int i = 0; i < ui->norig; i++) {
-      printIteratorProfile(ctx, ui->origits[i], 0, 0, depth + 1, limited);
+      // the readers of an accumulating union are not wrapped by profile iterators
+      size_t childCounter = ui->acc ? ((IndexReader *)ui->origits[i]->ctx)->len : 0;
+      printIteratorProfile(ctx, ui->origits[i], childCounter, 0, depth + 1, limited);
     }
     nlen += ui->norig;
   } else {
@@ -1912,6 +2660,9 @@ PRINT_PROFILE_SINGLE(printWildcardIt, DummyIterator, "WILDCARD", 0);
 PRINT_PROFILE_SINGLE(printIdListIt, DummyIterator, "ID-LIST", 0);
 PRINT_PROFILE_SINGLE(printEmptyIt, DummyIterator, "EMPTY", 0);
 PRINT_PROFILE_SINGLE(printHybridIt, HybridIterator, "VECTOR", 1);
+PRINT_PROFILE_SINGLE(printNumericOrderIt, NumericOrderIterator, "NUMERIC-ORDER", 1);
+PRINT_PROFILE_SINGLE(printGeoKnnIt, GeoKnnIterator, "GEO-KNN", 1);
+PRINT_PROFILE_SINGLE(printBitsetIt, DummyIterator, "BITSET", 0);
 
 PRINT_PROFILE_FUNC(printProfileIt) {
   ProfileIterator *pi = (ProfileIterator *)root;
@@ -1942,6 +2693,9 @@ void printIteratorProfile(RedisModuleCtx *ctx, IndexIterator *root, size_t count
     case ID_LIST_ITERATOR:    { printIdListIt(ctx, root, counter, cpuTime, depth, limited);     break; }
     case PROFILE_ITERATOR:    { printProfileIt(ctx, root, 0, 0, depth, limited);                break; }
     case HYBRID_ITERATOR:     { printHybridIt(ctx, root, counter, cpuTime, depth, limited);     break; }
+    case NUMERIC_ORDER_ITERATOR: { printNumericOrderIt(ctx, root, counter, cpuTime, depth, limited); break; }
+    case GEO_KNN_ITERATOR:    { printGeoKnnIt(ctx, root, counter, cpuTime, depth, limited);     break; }
+    case BITSET_ITERATOR:     { printBitsetIt(ctx, root, counter, cpuTime, depth, limited);     break; }
     case MAX_ITERATOR:        { RS_LOG_ASSERT(0, "nope");   break; }
   }
 }
@@ -1964,8 +2718,18 @@ void Profile_AddIters(IndexIterator **root) {
     case HYBRID_ITERATOR:
       Profile_AddIters(&((HybridIterator *)((*root)->ctx))->child);
       break;
+    case NUMERIC_ORDER_ITERATOR:
+      Profile_AddIters(&((NumericOrderIterator *)((*root)->ctx))->child);
+      break;
+    case GEO_KNN_ITERATOR:
+      Profile_AddIters(&((GeoKnnIterator *)((*root)->ctx))->child);
+      break;
     case UNION_ITERATOR:
       ui = (*root)->ctx;
+      // the readers of an accumulating union are drained at once, not iterated
+      if (ui->acc) {
+        break;
+      }
       for (int i = 0; i < ui->norig; i++) {
         Profile_AddIters(&(ui->origits[i]));
       }
@@ -1981,6 +2745,7 @@ void Profile_AddIters(IndexIterator **root) {
     case READ_ITERATOR:
     case EMPTY_ITERATOR:
     case ID_LIST_ITERATOR:
+    case BITSET_ITERATOR:
       break;
     case PROFILE_ITERATOR:
     case MAX_ITERATOR:
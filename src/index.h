@@ -5,10 +5,12 @@
 #include "forward_index.h"
 #include "index_result.h"
 #include "index_iterator.h"
+#include "inverted_index.h"
 #include "redisearch.h"
 #include "util/logging.h"
 #include "varint.h"
 #include "query_node.h"
+#include "expansion_cache.h"
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -47,8 +49,10 @@ IndexIterator *NewUnionIterator(IndexIterator **its, int num, DocTable *t, int q
 IndexIterator *NewIntersecIterator(IndexIterator **its, size_t num, DocTable *t,
                                    t_fieldMask fieldMask, int maxSlop, int inOrder, double weight);
 
-/* Create a NOT iterator by wrapping another index iterator */
-IndexIterator *NewNotIterator(IndexIterator *it, t_docId maxDocId, double weight);
+/* Create a NOT iterator by wrapping another index iterator. Documents deleted from dt (if not NULL)
+ * are not matched either */
+IndexIterator *NewNotIterator(IndexIterator *it, const DocTable *dt, t_docId maxDocId,
+                              double weight);
 
 /* Create an Optional clause iterator by wrapping another index iterator. An optional iterator
  * always returns OK on skips, but a virtual hit with frequency of 0 if there is no hit */
@@ -57,8 +61,9 @@ IndexIterator *NewOptionalIterator(IndexIterator *it, t_docId maxDocId, double w
 /* Create a wildcard iterator, matching ALL documents in the index. This is used for one thing only
  * - purely negative queries. If the root of the query is a negative expression, we cannot process
  * it without a positive expression. So we create a wildcard iterator that basically just iterates
- * all the incremental document ids, and matches every skip within its range. */
-IndexIterator *NewWildcardIterator(t_docId maxId);
+ * all the incremental document ids, and matches every skip within its range, except for the
+ * documents deleted from dt (if not NULL). */
+IndexIterator *NewWildcardIterator(const DocTable *dt, t_docId maxId);
 
 /* Create a new IdListIterator from a pre populated list of document ids of size num. The doc ids
  * are sorted in this function, so there is no need to sort them. They are automatically freed in
@@ -68,6 +73,29 @@ IndexIterator *NewIdListIterator(t_docId *ids, t_offset num, double weight);
 /** Create a new iterator which returns no results */
 IndexIterator *NewEmptyIterator(void);
 
+/* Evaluate a quick exit union of many term readers (a prefix, fuzzy or suffix expansion)
+ * term-at-a-time: on first access the readers are drained into a bitmap of the matching docIds,
+ * which is then iterated instead of merging the readers. The records have no term offsets, so this
+ * must not be used if positions are checked or highlighted. Unless anySize is set, only unions of
+ * at least UNION_ITERATOR_ACCUMULATE readers are accumulated. Returns 1 if enabled */
+int IndexIterator_EnableAccumulation(IndexIterator *it, int anySize);
+
+/* Returns the postings of a term-at-a-time union, draining its readers if they were not drained
+ * yet, or NULL if the iterator is not such a union. The postings belong to the iterator */
+ExpansionPostings *IndexIterator_AccumulatedPostings(IndexIterator *it);
+
+/* Create a quick exit union reading previously accumulated postings, whose matches refer to the
+ * given terms. The iterator takes a reference to the postings and ownership of the terms */
+IndexIterator *NewCachedUnionIterator(ExpansionPostings *postings, RSQueryTerm **terms,
+                                      size_t nterms, DocTable *dt, double weight,
+                                      QueryNodeType type, const char *qstr);
+
+/* Enable top-k dynamic pruning on an iterator tree. Readers skip blocks, and unions stop
+ * generating candidates from children, which cannot lift a document's score above the current
+ * threshold of the top-k heap. Only trees of term readers, unions and intersections are supported.
+ * Returns 1 if pruning was enabled */
+int IndexIterator_EnableTopKPruning(IndexIterator *root, const TopKPruneCtx *ctx);
+
 /** Return a string containing the type of the iterator */
 const char *IndexIterator_GetTypeString(const IndexIterator *it);
 
@@ -23,6 +23,9 @@ enum iteratorType {
   WILDCARD_ITERATOR,
   EMPTY_ITERATOR,
   ID_LIST_ITERATOR,
+  NUMERIC_ORDER_ITERATOR,
+  GEO_KNN_ITERATOR,
+  BITSET_ITERATOR,
   PROFILE_ITERATOR,
   MAX_ITERATOR,
 };
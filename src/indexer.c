@@ -7,6 +7,7 @@
 #include "index.h"
 #include "redis_index.h"
 #include "suffix.h"
+#include "ngram.h"
 #include "rmutil/rm_assert.h"
 #include "phonetic_manager.h"
 
@@ -239,6 +240,11 @@ static void writeCurEntries(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx, Re
                                             && entry->term[0] != SYNONYM_PREFIX_CHAR) {
       addSuffixTrie(spec->suffix, entry->term, entry->len);
     }
+    if (spec->ngramMask & entry->fieldMask && entry->term[0] != STEM_PREFIX
+                                           && entry->term[0] != PHONETIC_PREFIX
+                                           && entry->term[0] != SYNONYM_PREFIX_CHAR) {
+      NgramIndex_Add(spec->ngrams, entry->term, entry->len);
+    }
 
     if (idxKey) {
       RedisModule_CloseKey(idxKey);
@@ -426,6 +432,7 @@ static void Indexer_Process(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx) {
     aCtx->stateFlags |= ACTX_F_ERRORED;
     goto cleanup;
   }
+  indexer->isWriting = 1;
 
   Document *doc = aCtx->doc;
 
@@ -458,8 +465,10 @@ static void Indexer_Process(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx) {
   if (!(aCtx->stateFlags & ACTX_F_OTHERINDEXED)) {
     indexBulkFields(aCtx, &ctx);
   }
+  ctx.spec->revision++;
 
 cleanup:
+  indexer->isWriting = 0;
   if (isBlocked) {
     ConcurrentSearchCtx_Unlock(&indexer->concCtx);
   }
@@ -502,6 +511,13 @@ static void *Indexer_Run(void *p) {
   return NULL;
 }
 
+int Indexer_IsBusy(DocumentIndexer *indexer) {
+  pthread_mutex_lock(&indexer->lock);
+  int busy = indexer->isWriting || indexer->head != NULL;
+  pthread_mutex_unlock(&indexer->lock);
+  return busy;
+}
+
 int Indexer_Add(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx) {
   if (!AddDocumentCtx_IsBlockable(aCtx)) {
     Indexer_Process(indexer, aCtx);
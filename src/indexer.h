@@ -31,6 +31,9 @@ typedef struct DocumentIndexer {
   KHTable mergeHt;               // Hashtable and block allocator for merging
   BlkAlloc alloc;
   int options;
+  // set while documents are written. The GIL may be yielded in between, when document ids are
+  // already assigned
+  int isWriting;
   pthread_t thr;
   size_t refcount;
 } DocumentIndexer;
@@ -47,6 +50,12 @@ size_t Indexer_Incref(DocumentIndexer *indexer);
 void Indexer_Free(DocumentIndexer *indexer);
 DocumentIndexer *NewIndexer(IndexSpec *spec);
 
+/**
+ * Returns true if documents are queued or being written, meaning some document ids are assigned
+ * but not yet written to the index. Called with the GIL held
+ */
+int Indexer_IsBusy(DocumentIndexer *indexer);
+
 /**
  * Add a document to the indexing queue. If successful, the indexer now takes
  * ownership of the document context (until it DocumentAddCtx_Finish).
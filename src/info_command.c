@@ -3,6 +3,9 @@
 #include "inverted_index.h"
 #include "vector_index.h"
 #include "cursor.h"
+#include "expansion_cache.h"
+#include "result_cache.h"
+#include "ngram.h"
 
 #define REPLY_KVNUM(n, k, v)                       \
   do {                                             \
@@ -49,6 +52,34 @@ static int renderIndexOptions(RedisModuleCtx *ctx, IndexSpec *sp) {
   return 2;
 }
 
+static int renderExpansionCacheStats(RedisModuleCtx *ctx, IndexSpec *sp) {
+  int n = 0;
+  const ExpansionCache *c = sp->expcache;
+  RedisModule_ReplyWithSimpleString(ctx, "expansion_cache_stats");
+  RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
+  REPLY_KVINT(n, "hits", c ? c->hits : 0);
+  REPLY_KVINT(n, "misses", c ? c->misses : 0);
+  REPLY_KVINT(n, "entries", c ? ExpansionCache_NumEntries(c) : 0);
+  REPLY_KVNUM(n, "size_mb", c ? c->memsize / (float)0x100000 : 0);
+  RedisModule_ReplySetArrayLength(ctx, n);
+  return 2;
+}
+
+static int renderResultCacheStats(RedisModuleCtx *ctx, IndexSpec *sp) {
+  int n = 0;
+  const ResultCache *c = sp->rescache;
+  size_t hits = c ? c->hits : 0, misses = c ? c->misses : 0;
+  RedisModule_ReplyWithSimpleString(ctx, "result_cache_stats");
+  RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
+  REPLY_KVINT(n, "hits", hits);
+  REPLY_KVINT(n, "misses", misses);
+  REPLY_KVNUM(n, "hit_ratio", hits + misses ? hits / (double)(hits + misses) : 0);
+  REPLY_KVINT(n, "entries", c ? ResultCache_NumEntries(c) : 0);
+  REPLY_KVNUM(n, "size_mb", c ? c->memsize / (float)0x100000 : 0);
+  RedisModule_ReplySetArrayLength(ctx, n);
+  return 2;
+}
+
 static int renderIndexDefinitions(RedisModuleCtx *ctx, IndexSpec *sp) {
   int n = 0;
   SchemaRule *rule = sp->rule;
@@ -158,6 +189,18 @@ int IndexInfoCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
         RedisModule_ReplyWithSimpleString(ctx, SPEC_TAG_CASE_SENSITIVE_STR);
         ++nn;
       }
+      if (fs->tagOpts.tagFlags & TagField_Compressed) {
+        RedisModule_ReplyWithSimpleString(ctx, SPEC_COMPRESSED_STR);
+        ++nn;
+      }
+      if (fs->tagOpts.tagFlags & TagField_Bitset) {
+        RedisModule_ReplyWithSimpleString(ctx, SPEC_TAG_BITSET_STR);
+        ++nn;
+      }
+    }
+    if (FIELD_IS(fs, INDEXFLD_T_NUMERIC) && FieldSpec_IsCompressed(fs)) {
+      RedisModule_ReplyWithSimpleString(ctx, SPEC_COMPRESSED_STR);
+      ++nn;
     }
     if (FieldSpec_IsSortable(fs)) {
       RedisModule_ReplyWithSimpleString(ctx, SPEC_SORTABLE_STR);
@@ -175,6 +218,10 @@ int IndexInfoCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
       RedisModule_ReplyWithSimpleString(ctx, SPEC_WITHSUFFIXTRIE_STR);
       ++nn;
     }
+    if (FieldSpec_HasNgrams(fs)) {
+      RedisModule_ReplyWithSimpleString(ctx, SPEC_WITHNGRAMS_STR);
+      ++nn;
+    }
     RedisModule_ReplySetArrayLength(ctx, nn);
   }
   n += 2;
@@ -198,7 +245,11 @@ int IndexInfoCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
   REPLY_KVNUM(n, "doc_table_size_mb", sp->docs.memsize / (float)0x100000);
   REPLY_KVNUM(n, "sortable_values_size_mb", sp->docs.sortablesSize / (float)0x100000);
 
-  REPLY_KVNUM(n, "key_table_size_mb", TrieMap_MemUsage(sp->docs.dim.tm) / (float)0x100000);
+  REPLY_KVNUM(n, "key_table_size_mb", DocIdMap_MemUsage(&sp->docs.dim) / (float)0x100000);
+  REPLY_KVNUM(n, "deleted_bitmap_size_mb", DocTable_DeletedMemUsage(&sp->docs) / (float)0x100000);
+  if (sp->ngrams) {
+    REPLY_KVNUM(n, "ngram_index_sz_mb", NgramIndex_MemUsage(sp->ngrams) / (float)0x100000);
+  }
   REPLY_KVNUM(n, "records_per_doc_avg",
               (float)sp->stats.numRecords / (float)sp->stats.numDocuments);
   REPLY_KVNUM(n, "bytes_per_record_avg",
@@ -224,6 +275,9 @@ int IndexInfoCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
   Cursors_RenderStats(&RSCursors, sp->name, ctx);
   n += 2;
 
+  n += renderExpansionCacheStats(ctx, sp);
+  n += renderResultCacheStats(ctx, sp);
+
   if (sp->flags & Index_HasCustomStopwords) {
     ReplyWithStopWordsList(ctx, sp->stopwords);
     n += 2;
@@ -32,6 +32,8 @@ uint64_t TotalIIBlocks = 0;
 static IndexReader *NewIndexReaderGeneric(const IndexSpec *sp, InvertedIndex *idx,
                                           IndexDecoderProcs decoder, IndexDecoderCtx decoderCtx,
                                           RSIndexResult *record);
+static void IndexReader_ResetBlock(IndexReader *ir);
+static void IndexBlock_SealNumeric(IndexBlock *blk);
 
 /* Add a new block to the index with a given document id as the initial id */
 IndexBlock *InvertedIndex_AddBlock(InvertedIndex *idx, t_docId firstId) {
@@ -119,8 +121,13 @@ void IndexReader_OnReopen(void *privdata) {
     // reset the state of the reader
     t_docId lastId = ir->lastId;
     ir->currentBlock = 0;
-    ir->br = NewBufferReader(&IR_CURRENT_BLOCK(ir).buf);
-    ir->lastId = IR_CURRENT_BLOCK(ir).firstId;
+    IndexReader_ResetBlock(ir);
+
+    // the decoded window is stale. The next window is filled from the intersection's position
+    if (ir->window) {
+      ir->window->len = ir->window->cur = 0;
+      return;
+    }
 
     // seek to the previous last id
     RSIndexResult *dummy = NULL;
@@ -218,6 +225,11 @@ ENCODER(encodeRawDocIdsOnly) {
   return Buffer_Write(bw, &delta, 4);
 }
 
+// 10. Encode only the doc ids, Elias-Fano packing the full blocks
+ENCODER(encodeDocIdsEliasFano) {
+  return WriteVarint(delta, bw);
+}
+
 /**
  * DeltaType{1,2} Float{3}(=1), IsInf{4}   -  Sign{5} IsDouble{6} Unused{7,8}
  * DeltaType{1,2} Float{3}(=0), Tiny{4}(1) -  Number{5,6,7,8}
@@ -415,6 +427,10 @@ IndexEncoder InvertedIndex_GetEncoder(IndexFlags flags) {
         return encodeDocIdsOnly;
       }
 
+    // 10. docid only, Elias-Fano packed
+    case Index_EliasFano:
+      return encodeDocIdsEliasFano;
+
     case Index_StoreNumeric:
       return encodeNumeric;
 
@@ -426,6 +442,248 @@ IndexEncoder InvertedIndex_GetEncoder(IndexFlags flags) {
   return NULL;
 }
 
+/******************************************************************************
+ * Packed blocks.
+ *
+ * Once full, the blocks of docId-only indexes are packed into whichever of these representations
+ * takes the least memory, keeping the varint encoded deltas if neither is smaller:
+ *
+ * Bitmap - bit i of an array of 64 bit words is set if firstId + i is in the block. Wins for
+ * dense blocks, e.g. tags matching a large share of the documents.
+ *
+ * Elias-Fano - only for indexes created with Index_EliasFano. The offset of each docId from
+ * firstId is split into its `l` low bits, stored bit-packed, and its high bits, stored in unary
+ * in a bitvector where docId i sets bit (offset >> l) + i. This takes at most 2 + log2(span / n)
+ * bits per docId, and a docId's bucket can be found directly by its high bits when skipping.
+ *
+ * Packed blocks can't be appended to, so only full blocks are packed.
+ ******************************************************************************/
+
+#define PACKED_WORD_BITS 64
+#define PACKED_WORDS(bits) (((bits) + PACKED_WORD_BITS - 1) / PACKED_WORD_BITS)
+
+typedef struct {
+  // number of docIds in the block
+  uint32_t n;
+  // number of low bits of each docId offset
+  uint32_t lowBits;
+} EliasFanoHeader;
+
+typedef struct {
+  const uint64_t *low;
+  const uint64_t *high;
+  size_t nhigh;
+  uint32_t n;
+  uint32_t l;
+} EliasFano;
+
+static size_t IndexBlock_BitmapSize(t_docId span) {
+  return PACKED_WORDS(span + 1) * sizeof(uint64_t);
+}
+
+static uint32_t EliasFano_LowBits(t_docId span, size_t n) {
+  t_docId q = span / n;
+  return q ? 63 - __builtin_clzll(q) : 0;
+}
+
+static size_t IndexBlock_EliasFanoSize(t_docId span, size_t n) {
+  uint32_t l = EliasFano_LowBits(span, n);
+  return sizeof(EliasFanoHeader) +
+         (PACKED_WORDS(n * l) + PACKED_WORDS((span >> l) + n)) * sizeof(uint64_t);
+}
+
+static EliasFano EliasFano_Open(const IndexBlock *blk) {
+  EliasFanoHeader hdr;
+  memcpy(&hdr, blk->buf.data, sizeof(hdr));
+  const uint64_t *low = (const uint64_t *)(blk->buf.data + sizeof(hdr));
+  size_t nlow = PACKED_WORDS(hdr.n * hdr.lowBits);
+  size_t nwords = (blk->buf.offset - sizeof(hdr)) / sizeof(uint64_t);
+  return (EliasFano){
+      .low = low, .high = low + nlow, .nhigh = nwords - nlow, .n = hdr.n, .l = hdr.lowBits};
+}
+
+/* The integer of the given number of bits (less than 64) at bit position pos of words */
+static inline uint64_t Packed_Get(const uint64_t *words, size_t pos, uint32_t bits) {
+  if (!bits) {
+    return 0;
+  }
+  size_t shift = pos % PACKED_WORD_BITS;
+  uint64_t v = words[pos / PACKED_WORD_BITS] >> shift;
+  if (shift + bits > PACKED_WORD_BITS) {
+    v |= words[pos / PACKED_WORD_BITS + 1] << (PACKED_WORD_BITS - shift);
+  }
+  return v & ((1ULL << bits) - 1);
+}
+
+/* Write v, which fits in the given number of bits, at bit position pos of zeroed words */
+static inline void Packed_Set(uint64_t *words, size_t pos, uint32_t bits, uint64_t v) {
+  if (!bits) {
+    return;
+  }
+  size_t shift = pos % PACKED_WORD_BITS;
+  words[pos / PACKED_WORD_BITS] |= v << shift;
+  if (shift + bits > PACKED_WORD_BITS) {
+    words[pos / PACKED_WORD_BITS + 1] |= v >> (PACKED_WORD_BITS - shift);
+  }
+}
+
+#define EliasFano_Low(ef, i) Packed_Get((ef)->low, (i) * (ef)->l, (ef)->l)
+
+/* The offset from firstId of docId i, whose high bits are at position pos of the bitvector */
+#define EliasFano_Get(ef, i, pos) ((((pos) - (i)) << (ef)->l) | EliasFano_Low(ef, i))
+
+/* Replace the content of a block with a zeroed buffer of the given size */
+static uint64_t *IndexBlock_ResetData(IndexBlock *blk, size_t size) {
+  Buffer_Free(&blk->buf);
+  Buffer_Init(&blk->buf, size);
+  memset(blk->buf.data, 0, size);
+  blk->buf.offset = size;
+  return (uint64_t *)blk->buf.data;
+}
+
+static void IndexBlock_SetBitmap(IndexBlock *blk, const t_docId *ids, size_t n) {
+  uint64_t *words = IndexBlock_ResetData(blk, IndexBlock_BitmapSize(ids[n - 1] - ids[0]));
+  for (size_t i = 0; i < n; ++i) {
+    t_docId bit = ids[i] - ids[0];
+    words[bit / PACKED_WORD_BITS] |= 1ULL << (bit % PACKED_WORD_BITS);
+  }
+  blk->type = IndexBlock_Bitmap;
+}
+
+static void IndexBlock_SetEliasFano(IndexBlock *blk, const t_docId *ids, size_t n) {
+  t_docId span = ids[n - 1] - ids[0];
+  EliasFanoHeader hdr = {.n = n, .lowBits = EliasFano_LowBits(span, n)};
+  IndexBlock_ResetData(blk, IndexBlock_EliasFanoSize(span, n));
+  memcpy(blk->buf.data, &hdr, sizeof(hdr));
+
+  uint64_t *low = (uint64_t *)(blk->buf.data + sizeof(hdr));
+  uint64_t *high = low + PACKED_WORDS(n * hdr.lowBits);
+  const uint32_t l = hdr.lowBits;
+  for (size_t i = 0; i < n; ++i) {
+    t_docId offset = ids[i] - ids[0];
+    Packed_Set(low, i * l, l, offset & ((1ULL << l) - 1));
+    size_t bit = (offset >> l) + i;
+    high[bit / PACKED_WORD_BITS] |= 1ULL << (bit % PACKED_WORD_BITS);
+  }
+  blk->type = IndexBlock_EliasFano;
+}
+
+/* Write the docIds of a block to ids, which has room for all of them. Returns their number */
+static size_t IndexBlock_UnpackDocIds(const IndexBlock *blk, t_docId *ids) {
+  size_t n = 0;
+  if (blk->type == IndexBlock_Bitmap) {
+    const uint64_t *words = (const uint64_t *)blk->buf.data;
+    size_t nwords = blk->buf.offset / sizeof(uint64_t);
+    for (size_t w = 0; w < nwords; ++w) {
+      for (uint64_t word = words[w]; word; word &= word - 1) {
+        ids[n++] = blk->firstId + w * PACKED_WORD_BITS + __builtin_ctzll(word);
+      }
+    }
+  } else if (blk->type == IndexBlock_EliasFano) {
+    EliasFano ef = EliasFano_Open(blk);
+    for (size_t w = 0; w < ef.nhigh; ++w) {
+      for (uint64_t word = ef.high[w]; word; word &= word - 1) {
+        size_t pos = w * PACKED_WORD_BITS + __builtin_ctzll(word);
+        ids[n] = blk->firstId + EliasFano_Get(&ef, n, pos);
+        n++;
+      }
+    }
+  } else {
+    t_docId docId = blk->firstId;
+    BufferReader br = NewBufferReader((Buffer *)&blk->buf);
+    while (!BufferReader_AtEnd(&br) && n < blk->numDocs) {
+      uint32_t delta = ReadVarint(&br);
+      // on an old rdb version, the first entry is the docid itself and not the delta
+      docId = (n == 0 && delta) ? delta : docId + delta;
+      ids[n++] = docId;
+    }
+  }
+  return n;
+}
+
+/* Store the given sorted docIds in a block, in the smallest representation available */
+static void IndexBlock_PackDocIds(IndexBlock *blk, const t_docId *ids, size_t n, int eliasFano) {
+  Buffer encoded = {0};
+  BufferWriter bw = NewBufferWriter(&encoded);
+  for (size_t i = 0; i < n; ++i) {
+    WriteVarint(i ? ids[i] - ids[i - 1] : 0, &bw);
+  }
+
+  t_docId span = ids[n - 1] - ids[0];
+  size_t bitmapSize = IndexBlock_BitmapSize(span);
+  size_t efSize = eliasFano ? IndexBlock_EliasFanoSize(span, n) : SIZE_MAX;
+  if (span > UINT32_MAX || (encoded.offset <= bitmapSize && encoded.offset <= efSize)) {
+    Buffer_Free(&blk->buf);
+    blk->buf = encoded;
+    Buffer_ShrinkToSize(&blk->buf);
+    blk->type = IndexBlock_Encoded;
+  } else {
+    Buffer_Free(&encoded);
+    if (bitmapSize <= efSize) {
+      IndexBlock_SetBitmap(blk, ids, n);
+    } else {
+      IndexBlock_SetEliasFano(blk, ids, n);
+    }
+  }
+  blk->firstId = ids[0];
+  blk->lastId = ids[n - 1];
+}
+
+/* Pack a full varint encoded docId-only block */
+static void IndexBlock_Seal(IndexBlock *blk, int eliasFano) {
+  if (blk->type != IndexBlock_Encoded || blk->numDocs == 0 ||
+      blk->lastId - blk->firstId > UINT32_MAX) {
+    return;
+  }
+  t_docId *ids = rm_malloc(blk->numDocs * sizeof(*ids));
+  size_t n = IndexBlock_UnpackDocIds(blk, ids);
+  if (n) {
+    IndexBlock_PackDocIds(blk, ids, n, eliasFano);
+  }
+  rm_free(ids);
+}
+
+void IndexBlock_EncodeDocIds(const IndexBlock *blk, Buffer *out) {
+  t_docId *ids = rm_malloc(blk->numDocs * sizeof(*ids));
+  size_t n = IndexBlock_UnpackDocIds(blk, ids);
+  BufferWriter bw = NewBufferWriter(out);
+  for (size_t i = 0; i < n; ++i) {
+    WriteVarint(i ? ids[i] - ids[i - 1] : 0, &bw);
+  }
+  rm_free(ids);
+}
+
+/* Whether the blocks of an index are packed once full */
+static int InvertedIndex_PacksBlocks(IndexFlags flags, IndexEncoder encoder) {
+  return (flags & INDEX_STORAGE_MASK & ~Index_EliasFano) == Index_DocIdsOnly &&
+         (encoder == encodeDocIdsOnly || encoder == encodeDocIdsEliasFano);
+}
+
+void InvertedIndex_SealBlocks(InvertedIndex *idx) {
+  if (!InvertedIndex_PacksBlocks(idx->flags, InvertedIndex_GetEncoder(idx->flags))) {
+    return;
+  }
+  for (uint32_t i = 0; i + 1 < idx->size; ++i) {
+    IndexBlock_Seal(&idx->blocks[i], idx->flags & Index_EliasFano);
+  }
+}
+
+/* The closest floats below and above a value, so that float bounds never exclude it */
+static inline float floatBelow(double v) {
+  if (v > FLT_MAX) return FLT_MAX;
+  if (v < -FLT_MAX) return -INFINITY;
+  float f = v;
+  return f > v ? nextafterf(f, -INFINITY) : f;
+}
+
+static inline float floatAbove(double v) {
+  if (v > FLT_MAX) return INFINITY;
+  if (v < -FLT_MAX) return -FLT_MAX;
+  float f = v;
+  return f < v ? nextafterf(f, INFINITY) : f;
+}
+
+
 /* Write a forward-index entry to an index writer */
 size_t InvertedIndex_WriteEntryGeneric(InvertedIndex *idx, IndexEncoder encoder, t_docId docId,
                                        RSIndexResult *entry) {
@@ -438,12 +696,12 @@ size_t InvertedIndex_WriteEntryGeneric(InvertedIndex *idx, IndexEncoder encoder,
   IndexBlock *blk = &INDEX_LAST_BLOCK(idx);
 
   // use proper block size. Index_DocIdsOnly == 0x00
-  uint16_t blockSize = (idx->flags & INDEX_STORAGE_MASK) ?
+  uint16_t blockSize = (idx->flags & INDEX_STORAGE_MASK & ~Index_EliasFano) ?
           INDEX_BLOCK_SIZE :
           INDEX_BLOCK_SIZE_DOCID_ONLY;
 
-  // see if we need to grow the current block
-  if (blk->numDocs >= blockSize) {
+  // see if we need to grow the current block. Packed blocks can't be appended to
+  if (blk->numDocs >= blockSize || blk->type != IndexBlock_Encoded) {
     blk = InvertedIndex_AddBlock(idx, docId);
   } else if (blk->numDocs == 0) {
     blk->firstId = blk->lastId = docId;
@@ -468,6 +726,20 @@ size_t InvertedIndex_WriteEntryGeneric(InvertedIndex *idx, IndexEncoder encoder,
   blk->lastId = docId;
   ++blk->numDocs;
   ++idx->numDocs;
+  if (entry->freq > blk->maxFreq) {
+    blk->maxFreq = entry->freq;
+  }
+  if (blk->numDocs == blockSize) {
+    if (InvertedIndex_PacksBlocks(idx->flags, encoder)) {
+      IndexBlock_Seal(blk, encoder == encodeDocIdsEliasFano);
+    } else if (encoder == encodeNumeric && (idx->flags & Index_PackNumeric)) {
+      IndexBlock_SealNumeric(blk);
+    }
+    // readers in the middle of a block which was packed must find their position again by docId
+    if (blk->type != IndexBlock_Encoded) {
+      ++idx->gcMarker;
+    }
+  }
 
   return ret;
 }
@@ -500,10 +772,84 @@ size_t InvertedIndex_WriteNumericEntry(InvertedIndex *idx, t_docId docId, double
   return InvertedIndex_WriteEntryGeneric(idx, encodeNumeric, docId, &rec);
 }
 
-static void IndexReader_AdvanceBlock(IndexReader *ir) {
-  ir->currentBlock++;
+/* Skip the blocks that cannot contain a top-k result, starting at the current one. Returns 1 if
+ * all the remaining blocks were skipped, leaving the reader at the last block */
+static int IndexReader_PruneBlocks(IndexReader *ir) {
+  IndexReaderPrune *prune = ir->prune;
+  const double threshold = *prune->ctx.threshold;
+  // nothing can be pruned before the heap is full
+  if (threshold <= 0) {
+    return 0;
+  }
+  while (1) {
+    const IndexBlock *blk = &IR_CURRENT_BLOCK(ir);
+    if (blk->maxFreq == UINT32_MAX ||
+        prune->rest + prune->weight * prune->ctx.TermBound(ir->record, blk->maxFreq,
+                                                            &prune->ctx.stats) >= threshold) {
+      return 0;
+    }
+    ++prune->blocksSkipped;
+    if (ir->currentBlock + 1 == ir->idx->size) {
+      return 1;
+    }
+    ir->currentBlock++;
+  }
+}
+
+/* Whether the reader tests its records against the value bounds of their numeric blocks. Geo
+ * filters are not tested by value, so their blocks can't be skipped by the bounds */
+static inline int IndexReader_FiltersNumericBlocks(const IndexReader *ir) {
+  const NumericFilter *f = ir->decoderCtx.ptr;
+  return ir->blockBounds && f && !f->geoFilter;
+}
+
+/* Skip the numeric blocks without a value matching the filter, starting at the current one, and
+ * note whether all the values of the block reached match it. The records of the last block, which
+ * may still be written to, and of blocks whose bounds are not known, are always tested */
+static void IndexReader_FilterNumericBlocks(IndexReader *ir) {
+  const NumericFilter *f = ir->decoderCtx.ptr;
+  NumericBlockBounds *bounds = *ir->blockBounds;
+  ir->decoderCtx.blockMatches = 0;
+  while (1) {
+    const IndexBlock *blk = &IR_CURRENT_BLOCK(ir);
+    if (!blk->numDocs || ir->currentBlock + 1 == ir->idx->size ||
+        ir->currentBlock >= array_len(bounds)) {
+      return;
+    }
+    const NumericBlockBounds *b = bounds + ir->currentBlock;
+    if (b->firstId != blk->firstId) {
+      // the bounds were computed before the GC changed the block
+      return;
+    }
+    if (NumericFilter_Overlaps(f, b->minVal, b->maxVal)) {
+      if (NumericFilter_Match(f, b->minVal) && NumericFilter_Match(f, b->maxVal)) {
+        ir->decoderCtx.blockMatches = 1;
+        ++ir->blocksMatched;
+      }
+      return;
+    }
+    ++ir->blocksSkipped;
+    ir->currentBlock++;
+  }
+}
+
+/* Position the reader at the beginning of the current block */
+static void IndexReader_ResetBlock(IndexReader *ir) {
+  int pruned = ir->prune && IndexReader_PruneBlocks(ir);
+  if (IndexReader_FiltersNumericBlocks(ir)) {
+    IndexReader_FilterNumericBlocks(ir);
+  }
   ir->br = NewBufferReader(&IR_CURRENT_BLOCK(ir).buf);
   ir->lastId = IR_CURRENT_BLOCK(ir).firstId;
+  ir->bitPos = 0;
+  if (pruned) {
+    ir->br.pos = ir->br.buf->offset;
+  }
+}
+
+static void IndexReader_AdvanceBlock(IndexReader *ir) {
+  ir->currentBlock++;
+  IndexReader_ResetBlock(ir);
 }
 
 /******************************************************************************
@@ -621,6 +967,18 @@ DECODER(readFreqOffsetsFlagsWide) {
   CHECK_FLAGS(ctx, res);
 }
 
+/* Whether a numeric value passes the numeric (or geo) filter of the decoder context, if any */
+static inline int IndexDecoderCtx_MatchesNumeric(const IndexDecoderCtx *ctx, double value) {
+  const NumericFilter *f = ctx->ptr;
+  if (!f || ctx->blockMatches) {
+    return 1;
+  }
+  if (f->geoFilter == NULL) {
+    return NumericFilter_Match(f, value);
+  }
+  return GeoFilter_Contains(f->geoFilter, value);
+}
+
 // special decoder for decoding numeric results
 DECODER(readNumeric) {
   EncodingHeader header;
@@ -658,18 +1016,200 @@ DECODER(readNumeric) {
 
   // printf("res->num.value: %lf\n", res->num.value);
 
-  NumericFilter *f = ctx->ptr;
-  if (f) {
-    if (f->geoFilter == NULL) {
-      int rv = NumericFilter_Match(f, res->num.value);
-      // printf("Checking against filter: %d\n", rv);
-      return rv;
-    } else {
-      return isWithinRadius(f->geoFilter, res->num.value, NULL);
+  return IndexDecoderCtx_MatchesNumeric(ctx, res->num.value);
+}
+
+/******************************************************************************
+ * Packed numeric blocks.
+ *
+ * Once full, the blocks of numeric indexes created with Index_PackNumeric are stored with
+ * frame-of-reference bit packing if all their values are integers and it takes less memory than
+ * the encoded records. The offset of each docId from firstId, and of each value from the smallest
+ * value of the block, are stored in as many bits as the largest offset needs: the docId offsets
+ * of all the records first, then their value offsets. Values binned in the same numeric range,
+ * like timestamps or counters, are close to each other and take a few bits each instead of up to
+ * 8 bytes, and the records can be read at any position.
+ ******************************************************************************/
+
+// Integers up to this magnitude are exactly represented by doubles
+#define NUMERIC_PACKED_MAX_INT (1LL << 53)
+
+typedef struct {
+  // the smallest value of the block
+  int64_t minVal;
+  uint32_t n;
+  uint8_t idBits;
+  uint8_t valBits;
+} NumericPackedHeader;
+
+typedef struct {
+  const uint64_t *words;
+  int64_t minVal;
+  uint32_t n;
+  uint32_t idBits;
+  uint32_t valBits;
+} NumericPacked;
+
+static inline uint32_t Packed_BitsFor(uint64_t maxVal) {
+  return maxVal ? PACKED_WORD_BITS - __builtin_clzll(maxVal) : 0;
+}
+
+static NumericPacked NumericPacked_Open(const IndexBlock *blk) {
+  NumericPackedHeader hdr;
+  memcpy(&hdr, blk->buf.data, sizeof(hdr));
+  return (NumericPacked){.words = (const uint64_t *)(blk->buf.data + sizeof(hdr)),
+                         .minVal = hdr.minVal,
+                         .n = hdr.n,
+                         .idBits = hdr.idBits,
+                         .valBits = hdr.valBits};
+}
+
+/* The docId offset and value of record i */
+#define NumericPacked_DocId(np, i) Packed_Get((np)->words, (size_t)(i) * (np)->idBits, (np)->idBits)
+#define NumericPacked_Value(np, i)                                                             \
+  ((double)((np)->minVal + (int64_t)Packed_Get((np)->words,                                    \
+                                               (size_t)(np)->n * (np)->idBits +                \
+                                                   (size_t)(i) * (np)->valBits,                \
+                                               (np)->valBits)))
+
+/* Fill the header of the packed form of the given records, and return its size. Returns
+ * SIZE_MAX if the records can't be packed */
+static size_t NumericPacked_Plan(const t_docId *ids, const double *values, size_t n,
+                                 NumericPackedHeader *hdr) {
+  t_docId span = ids[n - 1] - ids[0];
+  if (span > UINT32_MAX) {
+    return SIZE_MAX;
+  }
+  int64_t minVal = INT64_MAX, maxVal = INT64_MIN;
+  for (size_t i = 0; i < n; ++i) {
+    double v = values[i];
+    if (!(fabs(v) <= NUMERIC_PACKED_MAX_INT) || (double)(int64_t)v != v) {
+      return SIZE_MAX;
     }
+    minVal = MIN(minVal, (int64_t)v);
+    maxVal = MAX(maxVal, (int64_t)v);
   }
-  // printf("Field matches.. hurray!\n");
-  return 1;
+  *hdr = (NumericPackedHeader){.minVal = minVal,
+                               .n = n,
+                               .idBits = Packed_BitsFor(span),
+                               .valBits = Packed_BitsFor(maxVal - minVal)};
+  return sizeof(*hdr) + PACKED_WORDS(n * (hdr->idBits + hdr->valBits)) * sizeof(uint64_t);
+}
+
+static void IndexBlock_SetNumericPacked(IndexBlock *blk, const t_docId *ids, const double *values,
+                                        const NumericPackedHeader *hdr) {
+  size_t n = hdr->n;
+  IndexBlock_ResetData(blk,
+                       sizeof(*hdr) + PACKED_WORDS(n * (hdr->idBits + hdr->valBits)) * sizeof(uint64_t));
+  memcpy(blk->buf.data, hdr, sizeof(*hdr));
+  uint64_t *words = (uint64_t *)(blk->buf.data + sizeof(*hdr));
+  for (size_t i = 0; i < n; ++i) {
+    Packed_Set(words, i * hdr->idBits, hdr->idBits, ids[i] - ids[0]);
+    Packed_Set(words, n * hdr->idBits + i * hdr->valBits, hdr->valBits,
+               (uint64_t)((int64_t)values[i] - hdr->minVal));
+  }
+  blk->type = IndexBlock_NumericPacked;
+}
+
+/* Write the records of a numeric block to ids and values, which have room for all of them.
+ * Returns their number */
+static size_t IndexBlock_UnpackNumeric(const IndexBlock *blk, t_docId *ids, double *values) {
+  if (blk->type == IndexBlock_NumericPacked) {
+    NumericPacked np = NumericPacked_Open(blk);
+    for (size_t i = 0; i < np.n; ++i) {
+      ids[i] = blk->firstId + NumericPacked_DocId(&np, i);
+      values[i] = NumericPacked_Value(&np, i);
+    }
+    return np.n;
+  }
+
+  static const IndexDecoderCtx empty = {0};
+  RSIndexResult res = {.type = RSResultType_Numeric};
+  BufferReader br = NewBufferReader((Buffer *)&blk->buf);
+  t_docId docId = blk->firstId;
+  size_t n = 0;
+  while (!BufferReader_AtEnd(&br) && n < blk->numDocs) {
+    readNumeric(&br, &empty, &res);
+    docId += res.docId;
+    ids[n] = docId;
+    values[n++] = res.num.value;
+  }
+  return n;
+}
+
+/* Store the given sorted records in a numeric block, packed if it is smaller than encoded */
+static void IndexBlock_SetNumeric(IndexBlock *blk, const t_docId *ids, const double *values,
+                                  size_t n) {
+  Buffer encoded = {0};
+  BufferWriter bw = NewBufferWriter(&encoded);
+  for (size_t i = 0; i < n; ++i) {
+    RSIndexResult rec = {.type = RSResultType_Numeric, .num = {.value = values[i]}};
+    encodeNumeric(&bw, i ? ids[i] - ids[i - 1] : 0, &rec);
+  }
+
+  NumericPackedHeader hdr;
+  if (NumericPacked_Plan(ids, values, n, &hdr) < encoded.offset) {
+    Buffer_Free(&encoded);
+    IndexBlock_SetNumericPacked(blk, ids, values, &hdr);
+  } else {
+    Buffer_Free(&blk->buf);
+    blk->buf = encoded;
+    Buffer_ShrinkToSize(&blk->buf);
+    blk->type = IndexBlock_Encoded;
+  }
+  blk->firstId = ids[0];
+  blk->lastId = ids[n - 1];
+}
+
+void InvertedIndex_UpdateNumericBounds(const InvertedIndex *idx, NumericBlockBounds **bounds) {
+  // the last block may still be written to
+  uint32_t sealed = idx->size ? idx->size - 1 : 0;
+  uint32_t known = array_len(*bounds);
+  t_docId *ids = NULL;
+  double *values = NULL;
+  size_t cap = 0;
+  for (uint32_t i = 0; i < sealed; ++i) {
+    const IndexBlock *blk = idx->blocks + i;
+    NumericBlockBounds *b = array_ensure_at(bounds, i, NumericBlockBounds);
+    if ((i < known && b->firstId == blk->firstId) || !blk->numDocs) {
+      continue;
+    }
+    if (blk->numDocs > cap) {
+      cap = blk->numDocs;
+      ids = rm_realloc(ids, cap * sizeof(*ids));
+      values = rm_realloc(values, cap * sizeof(*values));
+    }
+    size_t n = IndexBlock_UnpackNumeric(blk, ids, values);
+    b->firstId = blk->firstId;
+    b->minVal = INFINITY;
+    b->maxVal = -INFINITY;
+    for (size_t j = 0; j < n; ++j) {
+      b->minVal = MIN(b->minVal, floatBelow(values[j]));
+      b->maxVal = MAX(b->maxVal, floatAbove(values[j]));
+    }
+  }
+  // the GC may have removed blocks
+  if (array_len(*bounds) > sealed) {
+    *bounds = array_trimm_len(*bounds, array_len(*bounds) - sealed);
+  }
+  rm_free(ids);
+  rm_free(values);
+}
+
+/* Pack a full encoded numeric block, if it saves memory */
+static void IndexBlock_SealNumeric(IndexBlock *blk) {
+  if (blk->type != IndexBlock_Encoded || blk->numDocs == 0) {
+    return;
+  }
+  t_docId *ids = rm_malloc(blk->numDocs * sizeof(*ids));
+  double *values = rm_malloc(blk->numDocs * sizeof(*values));
+  size_t n = IndexBlock_UnpackNumeric(blk, ids, values);
+  NumericPackedHeader hdr;
+  if (n && NumericPacked_Plan(ids, values, n, &hdr) < blk->buf.offset) {
+    IndexBlock_SetNumericPacked(blk, ids, values, &hdr);
+  }
+  rm_free(ids);
+  rm_free(values);
 }
 
 DECODER(readFreqs) {
@@ -813,6 +1353,10 @@ IndexDecoderProcs InvertedIndex_GetDecoder(uint32_t flags) {
         RETURN_DECODERS(readDocIdsOnly, NULL);
       }
 
+    // () Elias-Fano packed
+    case Index_EliasFano:
+      RETURN_DECODERS(readDocIdsOnly, NULL);
+
     // (freqs, offsets)
     case Index_StoreFreqs | Index_StoreTermOffsets:
       RETURN_DECODERS(readFreqsOffsets, NULL);
@@ -852,6 +1396,16 @@ IndexReader *NewNumericReader(const IndexSpec *sp, InvertedIndex *idx, const Num
   return NewIndexReaderGeneric(sp, idx, procs, ctx, res);
 }
 
+IndexReader *NewNumericBoundedReader(const IndexSpec *sp, InvertedIndex *idx,
+                                     const NumericFilter *flt, double rangeMin, double rangeMax,
+                                     NumericBlockBounds **bounds) {
+  InvertedIndex_UpdateNumericBounds(idx, bounds);
+  IndexReader *ir = NewNumericReader(sp, idx, flt, rangeMin, rangeMax);
+  ir->blockBounds = bounds;
+  IndexReader_ResetBlock(ir);
+  return ir;
+}
+
 typedef struct {
   IndexCriteriaTester base;
   union {
@@ -942,7 +1496,161 @@ IndexCriteriaTester *IR_GetCriteriaTester(void *ctx) {
 
 size_t IR_NumEstimated(void *ctx) {
   IndexReader *ir = ctx;
-  return ir->idx->numDocs;
+  const NumericFilter *flt = ir->decoders.decoder == readNumeric ? ir->decoderCtx.ptr : NULL;
+  if (!flt || !ir->idx->numDocs) {
+    return ir->idx->numDocs;
+  }
+  if (ir->numEstimated) {
+    return ir->numEstimated;
+  }
+  // the range is only partially covered by the filter. Assume its values are evenly spread
+  double rangeMin = ir->decoderCtx.rangeMin, rangeMax = ir->decoderCtx.rangeMax;
+  double width = rangeMax - rangeMin;
+  if (!(width > 0) || !isfinite(width)) {
+    return ir->idx->numDocs;
+  }
+  double covered = MIN(flt->max, rangeMax) - MAX(flt->min, rangeMin);
+  double ratio = MAX(0, MIN(1, covered / width));
+  return MAX(1, (size_t)ceil(ratio * ir->idx->numDocs));
+}
+
+/* The position of the first set bit at or after pos, or nwords * 64 if there is none */
+static size_t Packed_NextSetBit(const uint64_t *words, size_t nwords, size_t pos) {
+  size_t w = pos / PACKED_WORD_BITS;
+  if (w >= nwords) {
+    return nwords * PACKED_WORD_BITS;
+  }
+  uint64_t word = words[w] & (~0ULL << (pos % PACKED_WORD_BITS));
+  while (!word) {
+    if (++w == nwords) {
+      return nwords * PACKED_WORD_BITS;
+    }
+    word = words[w];
+  }
+  return w * PACKED_WORD_BITS + __builtin_ctzll(word);
+}
+
+/* Read the next docId of a packed block. The reader's bit position follows the last docId read:
+ * for bitmaps it is the next bit to check, and for Elias-Fano the next position in the high bits
+ * bitvector, where the index of the next docId is derived from the last one. For packed numeric
+ * blocks it is the index of the next record, and 0 is also returned if its value is filtered out.
+ * If there are no more docIds, moves the reader to the end of the block and returns 0 */
+static int IndexReader_ReadPacked(IndexReader *ir, RSIndexResult *res) {
+  const IndexBlock *blk = &IR_CURRENT_BLOCK(ir);
+  t_docId offset;
+  if (blk->type == IndexBlock_NumericPacked) {
+    NumericPacked np = NumericPacked_Open(blk);
+    if (ir->bitPos >= np.n) {
+      goto end;
+    }
+    uint32_t i = ir->bitPos++;
+    ir->lastId = res->docId = blk->firstId + NumericPacked_DocId(&np, i);
+    res->num.value = NumericPacked_Value(&np, i);
+    return IndexDecoderCtx_MatchesNumeric(&ir->decoderCtx, res->num.value);
+  } else if (blk->type == IndexBlock_Bitmap) {
+    size_t nwords = blk->buf.offset / sizeof(uint64_t);
+    size_t pos = Packed_NextSetBit((const uint64_t *)blk->buf.data, nwords, ir->bitPos);
+    if (pos == nwords * PACKED_WORD_BITS) {
+      goto end;
+    }
+    offset = pos;
+    ir->bitPos = pos + 1;
+  } else {
+    EliasFano ef = EliasFano_Open(blk);
+    size_t i = ir->bitPos ? ir->bitPos - ((ir->lastId - blk->firstId) >> ef.l) : 0;
+    if (i >= ef.n) {
+      goto end;
+    }
+    size_t pos = Packed_NextSetBit(ef.high, ef.nhigh, ir->bitPos);
+    offset = EliasFano_Get(&ef, i, pos);
+    ir->bitPos = pos + 1;
+  }
+  ir->lastId = res->docId = blk->firstId + offset;
+  res->freq = 1;
+  return 1;
+
+end:
+  ir->br.pos = blk->buf.offset;
+  return 0;
+}
+
+/* Move the reader of a packed block forward, so that the next read returns the first docId
+ * greater or equal to the given one */
+static void IndexReader_SeekPacked(IndexReader *ir, t_docId docId) {
+  const IndexBlock *blk = &IR_CURRENT_BLOCK(ir);
+  if (docId <= blk->firstId) {
+    return;
+  }
+  if (docId > blk->lastId) {
+    ir->br.pos = blk->buf.offset;
+    return;
+  }
+  t_docId offset = docId - blk->firstId;
+  if (blk->type == IndexBlock_Bitmap) {
+    ir->bitPos = MAX(ir->bitPos, offset);
+    return;
+  }
+  if (blk->type == IndexBlock_NumericPacked) {
+    // the docId offsets are sorted, find the first one not below the requested one
+    NumericPacked np = NumericPacked_Open(blk);
+    uint32_t lo = ir->bitPos, hi = np.n;
+    while (lo < hi) {
+      uint32_t mid = lo + (hi - lo) / 2;
+      if (NumericPacked_DocId(&np, mid) < offset) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    ir->bitPos = lo;
+    return;
+  }
+
+  // the docIds of bucket h start right after the h-th zero of the high bits
+  EliasFano ef = EliasFano_Open(blk);
+  size_t h = offset >> ef.l;
+  if (!h) {
+    return;
+  }
+  size_t zeros = 0;
+  for (size_t w = 0; w < ef.nhigh; ++w) {
+    uint64_t word = ~ef.high[w];
+    size_t count = __builtin_popcountll(word);
+    if (zeros + count >= h) {
+      for (; zeros + 1 < h; ++zeros) {
+        word &= word - 1;
+      }
+      size_t pos = w * PACKED_WORD_BITS + __builtin_ctzll(word) + 1;
+      if (pos > ir->bitPos) {
+        // pretend the last docId read had the bucket's high bits, for ReadPacked to find its index
+        ir->bitPos = pos;
+        ir->lastId = blk->firstId + ((t_docId)h << ef.l);
+      }
+      return;
+    }
+    zeros += count;
+  }
+}
+
+/* Decode the next record of the current block into the reader's result. The block must not be at
+ * its end. Returns 0 if the record is filtered out, or if a packed block turns out to have no more
+ * records */
+static inline int IndexReader_DecodeNext(IndexReader *ir) {
+  if (IR_CURRENT_BLOCK(ir).type != IndexBlock_Encoded) {
+    return IndexReader_ReadPacked(ir, ir->record);
+  }
+
+  int rv = ir->decoders.decoder(&ir->br, &ir->decoderCtx, ir->record);
+  RSIndexResult *record = ir->record;
+
+  // We write the docid as a 32 bit number when decoding it with qint.
+  uint32_t delta = *(uint32_t *)&record->docId;
+  if (ir->decoders.decoder != readRawDocIdsOnly) {
+    ir->lastId = record->docId = ir->lastId + delta;
+  } else {
+    ir->lastId = record->docId = IR_CURRENT_BLOCK(ir).firstId + delta;
+  }
+  return rv;
 }
 
 int IR_Read(void *ctx, RSIndexResult **e) {
@@ -962,26 +1670,14 @@ int IR_Read(void *ctx, RSIndexResult **e) {
       IndexReader_AdvanceBlock(ir);
     }
 
-    size_t pos = ir->br.pos;
-    int rv = ir->decoders.decoder(&ir->br, &ir->decoderCtx, ir->record);
-    RSIndexResult *record = ir->record;
-
-    // We write the docid as a 32 bit number when decoding it with qint.
-    uint32_t delta = *(uint32_t *)&record->docId;
-    if (ir->decoders.decoder != readRawDocIdsOnly) {
-      ir->lastId = record->docId = ir->lastId + delta;
-    } else {
-      ir->lastId = record->docId = IR_CURRENT_BLOCK(ir).firstId + delta;
-    }
-
     // The decoder also acts as a filter. A zero return value means that the
     // current record should not be processed.
-    if (!rv) {
+    if (!IndexReader_DecodeNext(ir)) {
       continue;
     }
 
     ++ir->len;
-    *e = record;
+    *e = ir->record;
     return INDEXREAD_OK;
 
   } while (1);
@@ -990,6 +1686,93 @@ eof:
   return INDEXREAD_EOF;
 }
 
+// The number of records decoded at once by IR_ReadBatch
+#define IR_BATCH_CHUNK 64
+
+/* Where the integers of a qint encoded record are, for batch decoding */
+typedef struct {
+  // number of integers in a record, the first one being the docId delta
+  int len;
+  // position of the frequency, or -1 if not stored
+  int freqPos;
+  // position of the field mask, or -1 if not stored
+  int maskPos;
+  // the last integer is the length of the term offsets following the record
+  int skipLast;
+} IndexBatchLayout;
+
+static int IR_GetBatchLayout(IndexDecoder decoder, IndexBatchLayout *layout) {
+  if (decoder == readFreqOffsetsFlags) {
+    *layout = (IndexBatchLayout){.len = 4, .freqPos = 1, .maskPos = 2, .skipLast = 1};
+  } else if (decoder == readFreqsFlags) {
+    *layout = (IndexBatchLayout){.len = 3, .freqPos = 1, .maskPos = 2, .skipLast = 0};
+  } else if (decoder == readFreqsOffsets) {
+    *layout = (IndexBatchLayout){.len = 3, .freqPos = 1, .maskPos = -1, .skipLast = 1};
+  } else if (decoder == readFlagsOffsets) {
+    *layout = (IndexBatchLayout){.len = 3, .freqPos = -1, .maskPos = 1, .skipLast = 1};
+  } else if (decoder == readFreqs) {
+    *layout = (IndexBatchLayout){.len = 2, .freqPos = 1, .maskPos = -1, .skipLast = 0};
+  } else if (decoder == readFlags) {
+    *layout = (IndexBatchLayout){.len = 2, .freqPos = -1, .maskPos = 1, .skipLast = 0};
+  } else if (decoder == readOffsets) {
+    *layout = (IndexBatchLayout){.len = 2, .freqPos = -1, .maskPos = -1, .skipLast = 1};
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+size_t IR_ReadBatch(IndexReader *ir, t_docId *docIds, uint32_t *freqs, t_fieldMask *fieldMasks,
+                    size_t max) {
+  IndexBatchLayout layout;
+  size_t n = 0;
+
+  if (!IR_GetBatchLayout(ir->decoders.decoder, &layout)) {
+    // not qint encoded, read the records one by one
+    RSIndexResult *res;
+    while (n < max && IR_Read(ir, &res) == INDEXREAD_OK) {
+      docIds[n] = res->docId;
+      if (freqs) freqs[n] = res->freq;
+      if (fieldMasks) fieldMasks[n] = res->fieldMask;
+      n++;
+    }
+    return n;
+  }
+
+  uint32_t recs[4 * IR_BATCH_CHUNK];
+  const t_fieldMask filter = ir->decoderCtx.num;
+  while (n < max && !IR_IS_AT_END(ir)) {
+    // skip to the next block (skipping empty blocks that may appear here due to GC)
+    if (BufferReader_AtEnd(&ir->br)) {
+      if (ir->currentBlock + 1 == ir->idx->size) {
+        IR_SetAtEnd(ir, 1);
+        break;
+      }
+      IndexReader_AdvanceBlock(ir);
+      continue;
+    }
+
+    size_t nrecs = qint_decode_batch(&ir->br, recs, layout.len, layout.skipLast,
+                                     MIN(max - n, IR_BATCH_CHUNK));
+    t_docId lastId = ir->lastId;
+    for (const uint32_t *rec = recs; rec < recs + 4 * nrecs; rec += 4) {
+      lastId += rec[0];
+      if (layout.maskPos >= 0 && !(rec[layout.maskPos] & filter)) {
+        continue;
+      }
+      docIds[n] = lastId;
+      if (freqs) freqs[n] = layout.freqPos >= 0 ? rec[layout.freqPos] : 1;
+      if (fieldMasks) {
+        fieldMasks[n] = layout.maskPos >= 0 ? rec[layout.maskPos] : RS_FIELDMASK_ALL;
+      }
+      n++;
+    }
+    ir->lastId = lastId;
+  }
+  ir->len += n;
+  return n;
+}
+
 #define BLOCK_MATCHES(blk, docId) ((blk).firstId <= docId && docId <= (blk).lastId)
 
 static int IndexReader_SkipToBlock(IndexReader *ir, t_docId docId) {
@@ -1023,8 +1806,7 @@ static int IndexReader_SkipToBlock(IndexReader *ir, t_docId docId) {
   ir->currentBlock = i;
 
 new_block:
-  ir->lastId = IR_CURRENT_BLOCK(ir).firstId;
-  ir->br = NewBufferReader(&IR_CURRENT_BLOCK(ir).buf);
+  IndexReader_ResetBlock(ir);
   return rc;
 }
 
@@ -1074,6 +1856,17 @@ int IR_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
    *    - ID is equal, return OK
    */
 
+  if (IR_CURRENT_BLOCK(ir).type != IndexBlock_Encoded) {
+    // jump straight to the requested docId's bit or bucket
+    IndexReader_SeekPacked(ir, docId);
+    while (IR_Read(ir, hit) != INDEXREAD_EOF) {
+      if (ir->lastId >= docId) {
+        return ir->lastId == docId ? INDEXREAD_OK : INDEXREAD_NOTFOUND;
+      }
+    }
+    return INDEXREAD_EOF;
+  }
+
   if (ir->decoders.seeker) {
     // // if needed - skip to the next block (skipping empty blocks that may appear here due to GC)
     while (BufferReader_AtEnd(&ir->br)) {
@@ -1091,6 +1884,10 @@ int IR_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
       if (BufferReader_AtEnd(&ir->br)) {
         if (ir->currentBlock < ir->idx->size - 1) {
           IndexReader_AdvanceBlock(ir);
+          // the remaining blocks were all pruned
+          if (BufferReader_AtEnd(&ir->br)) {
+            goto eof;
+          }
         } else {
           return INDEXREAD_EOF;
         }
@@ -1114,6 +1911,78 @@ eof:
   return INDEXREAD_EOF;
 }
 
+size_t IR_FillWindow(IndexReader *ir, t_docId minId) {
+  IndexReaderWindow *w = ir->window;
+  w->len = w->cur = 0;
+  if (IR_IS_AT_END(ir)) {
+    return 0;
+  }
+  if (minId > ir->idx->lastId) {
+    goto eof;
+  }
+  if (minId > IR_CURRENT_BLOCK(ir).lastId) {
+    IndexReader_SkipToBlock(ir, minId);
+  }
+  if (IR_CURRENT_BLOCK(ir).type != IndexBlock_Encoded) {
+    IndexReader_SeekPacked(ir, minId);
+  }
+
+  while (w->len < IR_WINDOW_SIZE) {
+    if (BufferReader_AtEnd(&ir->br)) {
+      // windows don't cross blocks, so that their records can be decoded again
+      if (w->len) {
+        break;
+      }
+      if (ir->currentBlock + 1 == ir->idx->size) {
+        goto eof;
+      }
+      IndexReader_AdvanceBlock(ir);
+      continue;
+    }
+    uint32_t pos = IR_CURRENT_BLOCK(ir).type != IndexBlock_Encoded ? ir->bitPos : ir->br.pos;
+    t_docId prevId = ir->lastId;
+    if (!IndexReader_DecodeNext(ir) || ir->lastId < minId) {
+      continue;
+    }
+    w->docIds[w->len] = ir->lastId;
+    w->pos[w->len] = pos;
+    w->prevIds[w->len] = prevId;
+    w->len++;
+  }
+  return w->len;
+
+eof:
+  IR_SetAtEnd(ir, 1);
+  return 0;
+}
+
+RSIndexResult *IR_ReadWindowRecord(IndexReader *ir, uint32_t i) {
+  IndexReaderWindow *w = ir->window;
+  size_t endPos = ir->br.pos;
+  uint32_t endBitPos = ir->bitPos;
+  t_docId endLastId = ir->lastId;
+
+  if (IR_CURRENT_BLOCK(ir).type != IndexBlock_Encoded) {
+    ir->bitPos = w->pos[i];
+  } else {
+    ir->br.pos = w->pos[i];
+  }
+  ir->lastId = w->prevIds[i];
+  IndexReader_DecodeNext(ir);
+  ++ir->len;
+
+  ir->br.pos = endPos;
+  ir->bitPos = endBitPos;
+  ir->lastId = endLastId;
+  return ir->record;
+}
+
+void IR_EnableWindow(IndexReader *ir) {
+  if (!ir->window) {
+    ir->window = rm_calloc(1, sizeof(*ir->window));
+  }
+}
+
 size_t IR_NumDocs(void *ctx) {
   IndexReader *ir = ctx;
   // otherwise we use our counter
@@ -1128,12 +1997,17 @@ static void IndexReader_Init(const IndexSpec *sp, IndexReader *ret, InvertedInde
   ret->gcMarker = idx->gcMarker;
   ret->record = record;
   ret->len = 0;
-  ret->lastId = IR_CURRENT_BLOCK(ret).firstId;
-  ret->br = NewBufferReader(&IR_CURRENT_BLOCK(ret).buf);
   ret->decoders = decoder;
   ret->decoderCtx = decoderCtx;
   ret->isValidP = NULL;
   ret->sp = sp;
+  ret->prune = NULL;
+  ret->window = NULL;
+  ret->blockBounds = NULL;
+  ret->blocksSkipped = 0;
+  ret->blocksMatched = 0;
+  ret->numEstimated = 0;
+  IndexReader_ResetBlock(ret);
   IR_SetAtEnd(ret, 0);
 }
 
@@ -1170,6 +2044,8 @@ IndexReader *NewTermIndexReader(InvertedIndex *idx, IndexSpec *sp, t_fieldMask f
 void IR_Free(IndexReader *ir) {
 
   IndexResult_Free(ir->record);
+  rm_free(ir->prune);
+  rm_free(ir->window);
   rm_free(ir);
 }
 
@@ -1197,8 +2073,28 @@ void IR_Rewind(void *ctx) {
   IR_SetAtEnd(ir, 0);
   ir->currentBlock = 0;
   ir->gcMarker = ir->idx->gcMarker;
-  ir->br = NewBufferReader(&IR_CURRENT_BLOCK(ir).buf);
-  ir->lastId = IR_CURRENT_BLOCK(ir).firstId;
+  IndexReader_ResetBlock(ir);
+  if (ir->window) {
+    ir->window->len = ir->window->cur = 0;
+  }
+}
+
+double IR_EnablePruning(IndexReader *ir, const TopKPruneCtx *ctx) {
+  // without stored frequencies the blocks carry no usable bound
+  if (ir->record->type != RSResultType_Term || !(ir->idx->flags & Index_StoreFreqs)) {
+    return -1;
+  }
+  uint32_t maxFreq = 0;
+  for (uint32_t i = 0; i < ir->idx->size; ++i) {
+    maxFreq = MAX(maxFreq, ir->idx->blocks[i].maxFreq);
+  }
+  if (!ir->prune) {
+    ir->prune = rm_calloc(1, sizeof(*ir->prune));
+  }
+  ir->prune->ctx = *ctx;
+  ir->prune->weight = 1;
+  ir->prune->bound = ctx->TermBound(ir->record, maxFreq, &ctx->stats);
+  return ir->prune->bound;
 }
 
 IndexIterator *NewReadIterator(IndexReader *ir) {
@@ -1223,26 +2119,128 @@ IndexIterator *NewReadIterator(IndexReader *ir) {
   return ri;
 }
 
+/* Repair a packed block. The remaining docIds are packed again, starting at the first one */
+static int IndexBlock_RepairPacked(IndexBlock *blk, DocTable *dt, IndexFlags flags,
+                                   IndexRepairParams *params) {
+  t_docId *ids = rm_malloc(blk->numDocs * sizeof(*ids));
+  size_t nids = IndexBlock_UnpackDocIds(blk, ids);
+  RSIndexResult *res = params->RepairCallback ? NewTokenRecord(NULL, 1) : NULL;
+  size_t n = 0;
+  int frags = 0;
+
+  params->bytesBeforFix = blk->buf.offset;
+  for (size_t i = 0; i < nids; ++i) {
+    if (!DocTable_Exists(dt, ids[i])) {
+      ++frags;
+      continue;
+    }
+    if (res) {
+      res->docId = ids[i];
+      params->RepairCallback(res, blk, params->arg);
+    }
+    ids[n++] = ids[i];
+  }
+
+  if (frags) {
+    blk->numDocs = n;
+    if (n) {
+      IndexBlock_PackDocIds(blk, ids, n, flags & Index_EliasFano);
+    } else {
+      // keep the first id so the binary search on the blocks still works, see IndexBlock_Repair
+      Buffer_Free(&blk->buf);
+      blk->buf = (Buffer){0};
+      blk->type = IndexBlock_Encoded;
+      blk->firstId = blk->lastId;
+      blk->lastId = 0;
+    }
+  }
+  params->bytesAfterFix = blk->buf.offset;
+  params->bytesCollected += params->bytesBeforFix - params->bytesAfterFix;
+
+  rm_free(ids);
+  if (res) {
+    IndexResult_Free(res);
+  }
+  return frags;
+}
+
+/* Repair a packed numeric block. The remaining records are stored again, packed or encoded,
+ * whichever is smaller */
+static int IndexBlock_RepairNumericPacked(IndexBlock *blk, DocTable *dt,
+                                          IndexRepairParams *params) {
+  t_docId *ids = rm_malloc(blk->numDocs * sizeof(*ids));
+  double *values = rm_malloc(blk->numDocs * sizeof(*values));
+  size_t nrecs = IndexBlock_UnpackNumeric(blk, ids, values);
+  RSIndexResult *res = params->RepairCallback ? NewNumericResult() : NULL;
+  size_t n = 0;
+  int frags = 0;
+
+  params->bytesBeforFix = blk->buf.offset;
+  for (size_t i = 0; i < nrecs; ++i) {
+    if (!DocTable_Exists(dt, ids[i])) {
+      ++frags;
+      continue;
+    }
+    if (res) {
+      res->docId = ids[i];
+      res->num.value = values[i];
+      params->RepairCallback(res, blk, params->arg);
+    }
+    ids[n] = ids[i];
+    values[n++] = values[i];
+  }
+
+  if (frags) {
+    blk->numDocs = n;
+    if (n) {
+      IndexBlock_SetNumeric(blk, ids, values, n);
+    } else {
+      // keep the first id so the binary search on the blocks still works, see IndexBlock_Repair
+      Buffer_Free(&blk->buf);
+      blk->buf = (Buffer){0};
+      blk->type = IndexBlock_Encoded;
+      blk->firstId = blk->lastId;
+      blk->lastId = 0;
+    }
+  }
+  params->bytesAfterFix = blk->buf.offset;
+  params->bytesCollected += params->bytesBeforFix - params->bytesAfterFix;
+
+  rm_free(ids);
+  rm_free(values);
+  if (res) {
+    IndexResult_Free(res);
+  }
+  return frags;
+}
+
 /* Repair an index block by removing garbage - records pointing at deleted documents.
  * Returns the number of records collected, and puts the number of bytes collected in the given
  * pointer. If an error occurred - returns -1
  */
 int IndexBlock_Repair(IndexBlock *blk, DocTable *dt, IndexFlags flags, IndexRepairParams *params) {
+  if (blk->type == IndexBlock_NumericPacked) {
+    return IndexBlock_RepairNumericPacked(blk, dt, params);
+  } else if (blk->type != IndexBlock_Encoded) {
+    return IndexBlock_RepairPacked(blk, dt, flags, params);
+  }
+
   t_docId firstReadId = blk->firstId;
   t_docId lastReadId = blk->firstId;
   bool isFirstRes = true;
 
   t_docId oldFirstBlock = blk->lastId;
+  uint32_t maxFreq = 0;
   blk->lastId = blk->firstId = 0;
   Buffer repair = {0};
   BufferReader br = NewBufferReader(&blk->buf);
   BufferWriter bw = NewBufferWriter(&repair);
 
-  RSIndexResult *res = flags == Index_StoreNumeric ? NewNumericResult() : NewTokenRecord(NULL, 1);
+  uint32_t readFlags = flags & INDEX_STORAGE_MASK;
+  RSIndexResult *res = readFlags == Index_StoreNumeric ? NewNumericResult() : NewTokenRecord(NULL, 1);
   size_t frags = 0;
   int isLastValid = 0;
 
-  uint32_t readFlags = flags & INDEX_STORAGE_MASK;
   IndexDecoderProcs decoders = InvertedIndex_GetDecoder(readFlags);
   IndexEncoder encoder = InvertedIndex_GetEncoder(readFlags);
 
@@ -1317,6 +2315,7 @@ int IndexBlock_Repair(IndexBlock *blk, DocTable *dt, IndexFlags flags, IndexRepa
         blk->firstId = res->docId;
       }
       blk->lastId = res->docId;
+      maxFreq = MAX(maxFreq, res->freq);
       isLastValid = 1;
     }
   }
@@ -1324,6 +2323,9 @@ int IndexBlock_Repair(IndexBlock *blk, DocTable *dt, IndexFlags flags, IndexRepa
     // If we deleted stuff from this block, we need to change the number of docs and the data
     // pointer
     blk->numDocs -= frags;
+    if (flags & Index_StoreFreqs) {
+      blk->maxFreq = maxFreq;
+    }
     Buffer_Free(&blk->buf);
     blk->buf = repair;
     Buffer_ShrinkToSize(&blk->buf);
@@ -1344,6 +2346,52 @@ int IndexBlock_Repair(IndexBlock *blk, DocTable *dt, IndexFlags flags, IndexRepa
   return frags;
 }
 
+static size_t InvertedIndex_BlocksSize(const InvertedIndex *idx) {
+  size_t sz = 0;
+  for (uint32_t i = 0; i < idx->size; ++i) {
+    sz += idx->blocks[i].buf.offset;
+  }
+  return sz;
+}
+
+void InvertedIndex_Renumber(InvertedIndex *idx, const DocIdRemap *remap, IndexRepairParams *params) {
+  if (!idx->size) {
+    return;
+  }
+  IndexEncoder encoder = InvertedIndex_GetEncoder(idx->flags);
+  IndexReader *ir = (idx->flags & INDEX_STORAGE_MASK) == Index_StoreNumeric
+                        ? NewNumericReader(NULL, idx, NULL, 0, 0)
+                        : NewTermIndexReader(idx, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  // the records are written to a new index, whose blocks then replace the old ones. Ids keep their
+  // order, so the records are still written in increasing order
+  InvertedIndex *tmp = NewInvertedIndex(idx->flags, 1);
+  RSIndexResult *res;
+  while (IR_Read(ir, &res) == INDEXREAD_OK) {
+    t_docId docId = DocIdRemap_Get(remap, res->docId);
+    if (!docId) {
+      ++params->docsCollected;
+      continue;
+    }
+    res->docId = docId;
+    InvertedIndex_WriteEntryGeneric(tmp, encoder, docId, res);
+  }
+  IR_Free(ir);
+
+  params->bytesBeforFix += InvertedIndex_BlocksSize(idx);
+  params->bytesAfterFix += InvertedIndex_BlocksSize(tmp);
+  TotalIIBlocks -= idx->size;
+  for (uint32_t i = 0; i < idx->size; i++) {
+    indexBlock_Free(&idx->blocks[i]);
+  }
+  rm_free(idx->blocks);
+  idx->blocks = tmp->blocks;
+  idx->size = tmp->size;
+  idx->lastId = tmp->lastId;
+  idx->numDocs = tmp->numDocs;
+  idx->gcMarker++;
+  rm_free(tmp);
+}
+
 int InvertedIndex_Repair(InvertedIndex *idx, DocTable *dt, uint32_t startBlock,
                          IndexRepairParams *params) {
   size_t limit = params->limit ? params->limit : SIZE_MAX;
@@ -18,12 +18,29 @@ extern "C" {
 
 extern uint64_t TotalIIBlocks;
 
+/* How the records of an index block are stored */
+typedef enum {
+  // records written one after the other by the index encoder
+  IndexBlock_Encoded = 0,
+  // a bitmap of the docIds from firstId to lastId. Used for dense blocks of docId-only indexes
+  IndexBlock_Bitmap = 1,
+  // Elias-Fano packed docIds, for docId-only indexes created with Index_EliasFano
+  IndexBlock_EliasFano = 2,
+  // bit-packed docIds and integer values, for numeric indexes created with Index_PackNumeric
+  IndexBlock_NumericPacked = 3,
+} IndexBlockType;
+
 /* A single block of data in the index. The index is basically a list of blocks we iterate */
 typedef struct {
   t_docId firstId;
   t_docId lastId;
   Buffer buf;
   uint16_t numDocs;
+  // IndexBlockType
+  uint8_t type;
+  // The highest term frequency stored in this block, used as a score upper bound when pruning.
+  // UINT32_MAX means the bound is unknown
+  uint32_t maxFreq;
 } IndexBlock;
 
 typedef struct InvertedIndex {
@@ -38,6 +55,22 @@ typedef struct InvertedIndex {
   t_fieldMask fieldMask;
 } InvertedIndex;
 
+/* The bounds of the values of a block of a numeric index, rounded outwards to floats. Used to skip
+ * the block, or to accept all of its records, without testing each value against a filter. They
+ * are kept in an array apart from the index, by the owner of the index, so that the blocks of other
+ * indexes don't grow. The GC only removes records, so the bounds of a block stay valid as long as
+ * its first id is the same */
+typedef struct {
+  t_docId firstId;
+  float minVal;
+  float maxVal;
+} NumericBlockBounds;
+
+/* Compute the value bounds of the blocks of a numeric index into the array *bounds, for the blocks
+ * without bounds or whose first id changed. The last block may still be written to, so it gets no
+ * bounds. Bounds computed before the ids of the index were renumbered must be dropped */
+void InvertedIndex_UpdateNumericBounds(const InvertedIndex *idx, NumericBlockBounds **bounds);
+
 struct indexReadCtx;
 
 /**
@@ -52,6 +85,9 @@ typedef struct {
   // used by profile
   double rangeMin;
   double rangeMax;
+
+  // set while all the values of the current numeric block match the filter in ptr
+  int blockMatches;
 } IndexDecoderCtx;
 
 /**
@@ -82,9 +118,22 @@ void InvertedIndex_Free(void *idx);
 #define IndexBlock_DataBuf(b) (b)->buf.data
 #define IndexBlock_DataLen(b) (b)->buf.offset
 
+/* Pack the blocks of a docId-only index, except for the last one, if it saves memory. Used after
+ * loading an index, as packed blocks are saved varint encoded */
+void InvertedIndex_SealBlocks(InvertedIndex *idx);
+
+/* Write the docIds of a packed block to `out` as varint deltas, the way they are encoded in a
+ * regular docId-only block */
+void IndexBlock_EncodeDocIds(const IndexBlock *blk, Buffer *out);
+
 int InvertedIndex_Repair(InvertedIndex *idx, DocTable *dt, uint32_t startBlock,
                          IndexRepairParams *params);
 
+/* Rewrite the index with the document ids given by the remap, dropping the records of documents
+ * which are not in it. The sizes of the blocks before and after are added to bytesBeforFix and
+ * bytesAfterFix, and the number of records dropped to docsCollected */
+void InvertedIndex_Renumber(InvertedIndex *idx, const DocIdRemap *remap, IndexRepairParams *params);
+
 /**
  * Decode a single record from the buffer reader. This function is responsible for:
  * (1) Decoding the record at the given position of br
@@ -117,6 +166,48 @@ typedef struct {
  * endoder/decoder when reading and writing */
 IndexDecoderProcs InvertedIndex_GetDecoder(uint32_t flags);
 
+/* Upper bound of the score contribution of a term record whose frequency is at most maxFreq */
+typedef double (*TermScoreBoundFunc)(const RSIndexResult *term, uint32_t maxFreq,
+                                     const RSIndexStats *stats);
+
+/* The scorer-dependent part of top-k pruning, shared by all the iterators of a query */
+typedef struct {
+  TermScoreBoundFunc TermBound;
+  RSIndexStats stats;
+  // Minimal score a result needs in order to enter the top-k heap. Updated by the sorter
+  const double *threshold;
+} TopKPruneCtx;
+
+/* Block-max pruning state of a reader. A block is skipped if even its highest frequency record,
+ * combined with the best the rest of the query can contribute, is below the threshold */
+typedef struct {
+  TopKPruneCtx ctx;
+  // product of the aggregate weights above the reader
+  double weight;
+  // score upper bound of the reader over the entire index
+  double bound;
+  // score upper bound of all the other terms in the query
+  double rest;
+  // number of blocks skipped so far
+  size_t blocksSkipped;
+} IndexReaderPrune;
+
+#define IR_WINDOW_SIZE 64
+
+/* A window of decoded docIds from the current block, used by intersections to gallop over
+ * contiguous ids instead of decoding record by record. A window never spans blocks, so each of its
+ * records can be decoded again from its saved position */
+typedef struct {
+  t_docId docIds[IR_WINDOW_SIZE];
+  // lastId before each record, for re-decoding its delta
+  t_docId prevIds[IR_WINDOW_SIZE];
+  // buffer position (or bit position in a packed block) of each record
+  uint32_t pos[IR_WINDOW_SIZE];
+  uint32_t len;
+  // index of the first record not yet consumed
+  uint32_t cur;
+} IndexReaderWindow;
+
 /* An IndexReader wraps an inverted index record for reading and iteration */
 typedef struct IndexReader {
   const IndexSpec *sp;
@@ -128,6 +219,8 @@ typedef struct IndexReader {
   // last docId, used for delta encoding/decoding
   t_docId lastId;
   uint32_t currentBlock;
+  // the next bit to read when the current block is a bitmap
+  uint32_t bitPos;
 
   /* The decoder's filtering context. It may be a number or a pointer. The number is used for
    * filtering field masks, the pointer for numeric filtering */
@@ -151,6 +244,24 @@ typedef struct IndexReader {
    * thread was asleep, and reset the state in a deeper way
    */
   uint32_t gcMarker;
+
+  /* Block-max pruning state, NULL unless top-k pruning is enabled for the query */
+  IndexReaderPrune *prune;
+
+  /* Decoded docId window, NULL unless the reader is driven by an intersection */
+  IndexReaderWindow *window;
+
+  /* The array of the value bounds of the blocks of a numeric index, NULL unless the reader skips
+   * blocks by them. It belongs to the owner of the index, and may be reallocated while reading */
+  NumericBlockBounds *const *blockBounds;
+
+  /* Numeric blocks skipped for having no value matching the filter, and read without testing the
+   * filter for having only matching values */
+  size_t blocksSkipped;
+  size_t blocksMatched;
+
+  /* Number of records expected to match the numeric filter, 0 if unknown */
+  size_t numEstimated;
 } IndexReader;
 
 void IndexReader_OnReopen(void *privdata);
@@ -176,6 +287,12 @@ size_t InvertedIndex_WriteEntryGeneric(InvertedIndex *idx, IndexEncoder encoder,
 IndexReader *NewNumericReader(const IndexSpec *sp, InvertedIndex *idx, const NumericFilter *flt,
                               double rangeMin, double rangeMax);
 
+/* Like NewNumericReader, but the blocks are skipped, or read without testing the filter, by their
+ * value bounds. The array *bounds is updated first, and must outlive the reader */
+IndexReader *NewNumericBoundedReader(const IndexSpec *sp, InvertedIndex *idx,
+                                     const NumericFilter *flt, double rangeMin, double rangeMax,
+                                     NumericBlockBounds **bounds);
+
 /* Get the appropriate encoder for an inverted index given its flags. Returns NULL on invalid flags
  */
 IndexEncoder InvertedIndex_GetEncoder(IndexFlags flags);
@@ -199,6 +316,13 @@ int IR_GenericRead(IndexReader *ir, RSIndexResult *res);
 /* Read an entry from an inverted index into RSIndexResult */
 int IR_Read(void *ctx, RSIndexResult **e);
 
+/* Read up to max records from an inverted index into contiguous arrays, for consumers that do not
+ * need the full records (e.g. accumulating scores). freqs and fieldMasks may be NULL. Records
+ * filtered by the reader's field mask are dropped. Returns the number of records read, which is
+ * smaller than max only at the end of the index. Does not update the reader's current record */
+size_t IR_ReadBatch(IndexReader *ir, t_docId *docIds, uint32_t *freqs, t_fieldMask *fieldMasks,
+                    size_t max);
+
 /* Move to the next entry in an inverted index, without reading the whole entry
  */
 int IR_Next(void *ctx);
@@ -229,6 +353,21 @@ IndexIterator *NewReadIterator(IndexReader *ir);
 
 int IndexBlock_Repair(IndexBlock *blk, DocTable *dt, IndexFlags flags, IndexRepairParams *params);
 
+/* Enable block-max pruning on a term reader. Returns the reader's score upper bound over the
+ * whole index, or a negative number if the reader cannot be pruned */
+double IR_EnablePruning(IndexReader *ir, const TopKPruneCtx *ctx);
+
+/* Enable the decoded docId window on a reader */
+void IR_EnableWindow(IndexReader *ir);
+
+/* Refill the reader's window with the next records of the current block whose docId is at least
+ * minId, advancing blocks only if none qualify. Returns the window length, 0 at EOF */
+size_t IR_FillWindow(IndexReader *ir, t_docId minId);
+
+/* Decode the i'th record of the window into the reader's record and return it. The reader's
+ * position is not changed */
+RSIndexResult *IR_ReadWindowRecord(IndexReader *ir, uint32_t i);
+
 static inline double CalculateIDF(size_t totalDocs, size_t termDocs) {
   return logb(1.0F + totalDocs / (termDocs ? termDocs : (double)1));
 }
@@ -235,12 +235,14 @@ size_t gc_TagIndex(RedisModuleCtx *ctx, GarbageCollectorCtx *gc, int *status) {
     goto end;
   }
 
-  InvertedIndex *iv;
-  tm_len_t len;
-
-  if (!TrieMap_RandomKey(indexTag->values, &randomKey, &len, (void **)&iv)) {
+  dictEntry *e = dictGetRandomKey(indexTag->values);
+  if (!e) {
     goto end;
   }
+  TagValue *tv = dictGetKey(e);
+  InvertedIndex *iv = tv->iv;
+  size_t len = tv->len;
+  randomKey = rm_strndup(tv->str, len);
 
   int blockNum = 0;
   do {
@@ -251,7 +253,10 @@ size_t gc_TagIndex(RedisModuleCtx *ctx, GarbageCollectorCtx *gc, int *status) {
     totalRemoved += params.docsCollected;
     gc_updateStats(sctx, gc, params.docsCollected, params.bytesCollected);
     // blockNum 0 means error or we've finished
-    if (!blockNum) break;
+    if (!blockNum) {
+      TagIndex_RebuildBitset(indexTag, randomKey, len);
+      break;
+    }
 
     // After each iteration we yield execution
     // First we close the relevant keys we're touching
@@ -268,8 +273,8 @@ size_t gc_TagIndex(RedisModuleCtx *ctx, GarbageCollectorCtx *gc, int *status) {
     if (!indexTag) {
       break;
     }
-    iv = TrieMap_Find(indexTag->values, randomKey, len);
-    if (iv == TRIEMAP_NOTFOUND) {
+    iv = TagIndex_OpenIndex(indexTag, randomKey, len, 0);
+    if (!iv) {
       break;
     }
 
@@ -0,0 +1,300 @@
+#include "ngram.h"
+#include "rmalloc.h"
+#include "util/arr.h"
+#include "util/dict.h"
+#include "util/khash.h"
+#include "util/timeout.h"
+#include "rmutil/rm_assert.h"
+
+#include <string.h>
+
+// the sorted ids of the terms containing an n-gram, by the n-gram packed into an integer
+KHASH_MAP_INIT_INT64(ngramPostings, uint32_t *)
+
+typedef struct {
+  const char *str;  // allocated along with the term
+  size_t len;
+  uint32_t id;
+} NgramTerm;
+
+struct NgramIndex {
+  int n;
+  // the term of each id, or NULL if it was deleted. Ids are only reused when the index is
+  // compacted, so the postings stay sorted by appending to them
+  NgramTerm **terms;
+  size_t numDeleted;
+  // the NgramTerm of each term, as the keys of the dictionary
+  dict *lookup;
+  khash_t(ngramPostings) *postings;
+};
+
+// the deleted ids are dropped once there are more of them than live ones
+#define NGRAM_COMPACT_MIN 1024
+
+static uint64_t ngramTerm_Hash(const void *key) {
+  const NgramTerm *t = key;
+  return dictGenHashFunction(t->str, t->len);
+}
+
+static int ngramTerm_Equal(void *privdata, const void *key1, const void *key2) {
+  const NgramTerm *t1 = key1, *t2 = key2;
+  return t1->len == t2->len && !memcmp(t1->str, t2->str, t1->len);
+}
+
+static void ngramTerm_Free(void *privdata, void *key) {
+  rm_free(key);
+}
+
+// the keys are NgramTerm structs, which are looked up by an NgramTerm on the stack
+static dictType ngramTermsType = {
+    .hashFunction = ngramTerm_Hash,
+    .keyCompare = ngramTerm_Equal,
+    .keyDestructor = ngramTerm_Free,
+};
+
+static inline uint64_t packGram(const char *s, int n) {
+  uint64_t gram = 0;
+  memcpy(&gram, s, n);
+  return gram;
+}
+
+static NgramTerm *ngramIndex_Find(const NgramIndex *idx, const char *term, size_t len) {
+  NgramTerm key = {.str = term, .len = len};
+  dictEntry *e = dictFind(idx->lookup, &key);
+  return e ? dictGetKey(e) : NULL;
+}
+
+/* Position of id in a sorted posting list, or of the first id after it */
+static size_t postings_Seek(const uint32_t *ids, size_t from, size_t n, uint32_t id) {
+  size_t lo = from, hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (ids[mid] < id) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+NgramIndex *NewNgramIndex(int n) {
+  RS_LOG_ASSERT(n > 0 && n <= NGRAM_MAX_LEN, "invalid n-gram length");
+  NgramIndex *idx = rm_new(NgramIndex);
+  idx->n = n;
+  idx->terms = array_new(NgramTerm *, 16);
+  idx->numDeleted = 0;
+  idx->lookup = dictCreate(&ngramTermsType, NULL);
+  idx->postings = kh_init(ngramPostings);
+  return idx;
+}
+
+size_t NgramIndex_NumTerms(const NgramIndex *idx) {
+  return dictSize(idx->lookup);
+}
+
+/* Renumber the live terms, keeping their order so the postings stay sorted */
+static void ngramIndex_Compact(NgramIndex *idx) {
+  size_t n = array_len(idx->terms);
+  uint32_t *newIds = rm_malloc(sizeof(*newIds) * (n ? n : 1));
+  uint32_t next = 0;
+  for (size_t i = 0; i < n; ++i) {
+    NgramTerm *t = idx->terms[i];
+    if (t) {
+      newIds[i] = t->id = next;
+      idx->terms[next++] = t;
+    }
+  }
+  idx->terms = array_trimm_len(idx->terms, n - next);
+  idx->numDeleted = 0;
+
+  for (khiter_t it = kh_begin(idx->postings); it != kh_end(idx->postings); ++it) {
+    if (!kh_exist(idx->postings, it)) {
+      continue;
+    }
+    uint32_t *ids = kh_val(idx->postings, it);
+    for (size_t i = 0; i < array_len(ids); ++i) {
+      ids[i] = newIds[ids[i]];
+    }
+  }
+  rm_free(newIds);
+}
+
+void NgramIndex_Add(NgramIndex *idx, const char *term, size_t len) {
+  if (!len || ngramIndex_Find(idx, term, len)) {
+    return;
+  }
+  NgramTerm *t = rm_malloc(sizeof(*t) + len + 1);
+  char *str = (char *)(t + 1);
+  memcpy(str, term, len);
+  str[len] = '\0';
+  t->str = str;
+  t->len = len;
+  t->id = array_len(idx->terms);
+  idx->terms = array_append(idx->terms, t);
+  dictAdd(idx->lookup, t, NULL);
+
+  for (size_t i = 0; i + idx->n <= len; ++i) {
+    int added;
+    khiter_t it = kh_put(ngramPostings, idx->postings, packGram(term + i, idx->n), &added);
+    if (added) {
+      kh_val(idx->postings, it) = array_new(uint32_t, 1);
+    }
+    uint32_t *ids = kh_val(idx->postings, it);
+    // an n-gram which appears more than once in the term is already in the list
+    if (array_len(ids) && array_tail(ids) == t->id) {
+      continue;
+    }
+    kh_val(idx->postings, it) = array_append(ids, t->id);
+  }
+}
+
+void NgramIndex_Delete(NgramIndex *idx, const char *term, size_t len) {
+  NgramTerm *t = ngramIndex_Find(idx, term, len);
+  if (!t) {
+    return;
+  }
+  for (size_t i = 0; i + idx->n <= len; ++i) {
+    khiter_t it = kh_get(ngramPostings, idx->postings, packGram(term + i, idx->n));
+    if (it == kh_end(idx->postings)) {
+      continue;
+    }
+    uint32_t *ids = kh_val(idx->postings, it);
+    size_t n = array_len(ids);
+    size_t pos = postings_Seek(ids, 0, n, t->id);
+    if (pos == n || ids[pos] != t->id) {
+      // an n-gram which appears more than once in the term was already removed
+      continue;
+    }
+    if (n == 1) {
+      array_free(ids);
+      kh_del(ngramPostings, idx->postings, it);
+    } else {
+      memmove(ids + pos, ids + pos + 1, sizeof(*ids) * (n - pos - 1));
+      kh_val(idx->postings, it) = array_trimm_len(ids, 1);
+    }
+  }
+  idx->terms[t->id] = NULL;
+  dictDelete(idx->lookup, t);
+  if (++idx->numDeleted >= NGRAM_COMPACT_MIN && idx->numDeleted > dictSize(idx->lookup)) {
+    ngramIndex_Compact(idx);
+  }
+}
+
+static inline bool ngramTerm_Match(const NgramTerm *t, const char *str, size_t len, bool contains) {
+  if (t->len < len) {
+    return false;
+  }
+  if (contains) {
+    return memmem(t->str, t->len, str, len) != NULL;
+  }
+  return !memcmp(t->str + t->len - len, str, len);
+}
+
+void NgramIndex_IterateContains(const NgramIndex *idx, const char *str, size_t len, bool contains,
+                                TrieSuffixCallback callback, void *ctx, struct timespec *timeout) {
+  size_t counter = 0;
+
+  // a pattern shorter than an n-gram is matched against all terms
+  if (len < idx->n) {
+    for (size_t i = 0; i < array_len(idx->terms); ++i) {
+      if (TimedOut_WithCounter(timeout, &counter)) {
+        return;
+      }
+      const NgramTerm *t = idx->terms[i];
+      if (t && ngramTerm_Match(t, str, len, contains) &&
+          callback(t->str, t->len, ctx) == REDISEARCH_ERR) {
+        return;
+      }
+    }
+    return;
+  }
+
+  // the posting lists of the n-grams of the pattern, with the shortest one first
+  size_t ngrams = len - idx->n + 1;
+  uint32_t **lists = rm_malloc(sizeof(*lists) * ngrams);
+  size_t *cursors = rm_calloc(ngrams, sizeof(*cursors));
+  size_t nlists = 0;
+  for (size_t i = 0; i < ngrams; ++i) {
+    khiter_t it = kh_get(ngramPostings, idx->postings, packGram(str + i, idx->n));
+    if (it == kh_end(idx->postings)) {
+      // no term has all the n-grams of the pattern
+      goto done;
+    }
+    uint32_t *ids = kh_val(idx->postings, it);
+    size_t j = 0;
+    while (j < nlists && lists[j] != ids) {
+      ++j;
+    }
+    if (j < nlists) {
+      // an n-gram which appears more than once in the pattern
+      continue;
+    }
+    lists[nlists++] = ids;
+    if (array_len(ids) < array_len(lists[0])) {
+      lists[nlists - 1] = lists[0];
+      lists[0] = ids;
+    }
+  }
+
+  uint32_t *candidates = lists[0];
+  for (size_t i = 0; i < array_len(candidates); ++i) {
+    if (TimedOut_WithCounter(timeout, &counter)) {
+      goto done;
+    }
+    uint32_t id = candidates[i];
+    bool found = true;
+    for (size_t j = 1; j < nlists && found; ++j) {
+      size_t n = array_len(lists[j]);
+      cursors[j] = postings_Seek(lists[j], cursors[j], n, id);
+      if (cursors[j] == n) {
+        // the candidates which follow are not in this list either
+        goto done;
+      }
+      found = lists[j][cursors[j]] == id;
+    }
+    const NgramTerm *t = idx->terms[id];
+    // the n-grams of a candidate may appear in a different order than in the pattern
+    if (found && ngramTerm_Match(t, str, len, contains) &&
+        callback(t->str, t->len, ctx) == REDISEARCH_ERR) {
+      goto done;
+    }
+  }
+
+done:
+  rm_free(lists);
+  rm_free(cursors);
+}
+
+size_t NgramIndex_MemUsage(const NgramIndex *idx) {
+  size_t sz = sizeof(*idx) + array_sizeof(array_hdr(idx->terms));
+  sz += dictSlots(idx->lookup) * sizeof(dictEntry *) + dictSize(idx->lookup) * sizeof(dictEntry);
+  for (size_t i = 0; i < array_len(idx->terms); ++i) {
+    if (idx->terms[i]) {
+      sz += sizeof(NgramTerm) + idx->terms[i]->len + 1;
+    }
+  }
+  const khash_t(ngramPostings) *h = idx->postings;
+  sz += kh_n_buckets(h) * (sizeof(uint64_t) + sizeof(uint32_t *)) + kh_n_buckets(h) / 4;
+  for (khiter_t it = kh_begin(h); it != kh_end(h); ++it) {
+    if (kh_exist(h, it)) {
+      sz += array_sizeof(array_hdr(kh_val(h, it)));
+    }
+  }
+  return sz;
+}
+
+void NgramIndex_Free(NgramIndex *idx) {
+  if (!idx) {
+    return;
+  }
+  for (khiter_t it = kh_begin(idx->postings); it != kh_end(idx->postings); ++it) {
+    if (kh_exist(idx->postings, it)) {
+      array_free(kh_val(idx->postings, it));
+    }
+  }
+  kh_destroy(ngramPostings, idx->postings);
+  dictRelease(idx->lookup);
+  array_free(idx->terms);
+  rm_free(idx);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "trie/trie.h"
+#include "redisearch.h"
+
+#include <stdbool.h>
+#include <time.h>
+
+// length of the n-grams of the fields with the WITHNGRAMS option
+#define NGRAM_LEN 3
+#define NGRAM_MAX_LEN 8
+
+/* An index of the n-grams of a set of terms, for contains and suffix queries. Every term gets an
+ * id, and every n-gram keeps the sorted list of the ids of the terms it appears in. The terms
+ * containing a pattern are found by intersecting the lists of the n-grams of the pattern, and the
+ * candidates are then matched against the pattern, since the n-grams may appear in a different
+ * order. Unlike the suffix trie, the index holds each term once and an id for each of its n-grams,
+ * so it grows linearly with the length of the terms */
+typedef struct NgramIndex NgramIndex;
+
+/* Create an index of the n-grams of length n, which must be between 1 and NGRAM_MAX_LEN */
+NgramIndex *NewNgramIndex(int n);
+
+/* Add a term to the index. Does nothing if the term is already in it */
+void NgramIndex_Add(NgramIndex *idx, const char *term, size_t len);
+
+/* Remove a term from the index. Does nothing if the term is not in it */
+void NgramIndex_Delete(NgramIndex *idx, const char *term, size_t len);
+
+/* Number of terms in the index */
+size_t NgramIndex_NumTerms(const NgramIndex *idx);
+
+/* Call the callback with each term which contains str, or only with the terms ending with it if
+ * contains is false. The iteration stops if the callback returns REDISEARCH_ERR or the timeout is
+ * reached */
+void NgramIndex_IterateContains(const NgramIndex *idx, const char *str, size_t len, bool contains,
+                                TrieSuffixCallback callback, void *ctx, struct timespec *timeout);
+
+/* Memory used by the index, in bytes */
+size_t NgramIndex_MemUsage(const NgramIndex *idx);
+
+void NgramIndex_Free(NgramIndex *idx);
+
+#ifdef __cplusplus
+}
+#endif
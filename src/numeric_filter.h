@@ -48,6 +48,13 @@ static inline int NumericFilter_Match(const NumericFilter *f, double score) {
   return rc;
 }
 
+/* Returns 1 if some value between min and max may match the filter */
+static inline int NumericFilter_Overlaps(const NumericFilter *f, double min, double max) {
+  int belowMin = f->inclusiveMin ? max < f->min : max <= f->min;
+  int aboveMax = f->inclusiveMax ? min > f->max : min >= f->max;
+  return !belowMin && !aboveMax;
+}
+
 #ifdef __cplusplus
 }
 #endif
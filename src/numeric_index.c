@@ -93,9 +93,9 @@ double NumericRange_Split(NumericRange *n, NumericRangeNode **lp, NumericRangeNo
 
   // printf("split point :%f\n", split);
   *lp = NewLeafNode(n->entries->numDocs / 2 + 1, 
-                    MIN(NR_MAXRANGE_CARD, 1 + n->splitCard * NR_EXPONENT));
+                    MIN(NR_MAXRANGE_CARD, 1 + n->splitCard * NR_EXPONENT), n->entries->flags);
   *rp = NewLeafNode(n->entries->numDocs / 2 + 1,
-                    MIN(NR_MAXRANGE_CARD, 1 + n->splitCard * NR_EXPONENT));
+                    MIN(NR_MAXRANGE_CARD, 1 + n->splitCard * NR_EXPONENT), n->entries->flags);
 
   RSIndexResult *res = NULL;
   IndexReader *ir = NewNumericReader(NULL, n->entries, NULL ,0, 0);
@@ -113,7 +113,7 @@ double NumericRange_Split(NumericRange *n, NumericRangeNode **lp, NumericRangeNo
   return split;
 }
 
-NumericRangeNode *NewLeafNode(size_t cap, size_t splitCard) {
+NumericRangeNode *NewLeafNode(size_t cap, size_t splitCard, IndexFlags flags) {
 
   NumericRangeNode *n = rm_malloc(sizeof(NumericRangeNode));
   n->left = NULL;
@@ -132,8 +132,11 @@ NumericRangeNode *NewLeafNode(size_t cap, size_t splitCard) {
       .splitCard = splitCard,
       .values = array_new(CardinalityValue, 1),
       //.values = rm_calloc(splitCard, sizeof(CardinalityValue)),
-      .entries = NewInvertedIndex(Index_StoreNumeric, 1),
+      .entries = NewInvertedIndex(flags, 1),
+      .blockBounds = NULL,
       .invertedIndexSize = 0,
+      // the deleted entries were never counted
+      .deletedEpoch = UINT64_MAX,
   };
   return n;
 }
@@ -152,30 +155,54 @@ static void removeRange(NumericRangeNode *n, NRN_AddRv *rv) {
   rv->numRecords -= temp->entries->numDocs;
   InvertedIndex_Free(temp->entries);
   array_free(temp->values);
+  array_free(temp->blockBounds);
   rm_free(temp);
 
   rv->numRanges--;
 }
 
-static void NumericRangeNode_Balance(NumericRangeNode **n) {
+static inline void NumericRangeNode_UpdateDepth(NumericRangeNode *n) {
+  n->maxDepth = MAX(n->left->maxDepth, n->right->maxDepth) + 1;
+}
+
+/* Rotate the subtree at *n, moving up its child on the given side. The ranges kept by the two
+ * rotated nodes no longer cover their subtrees, so they are removed */
+static void NumericRangeNode_Rotate(NumericRangeNode **n, int left, NRN_AddRv *rv) {
+  NumericRangeNode *node = *n;
+  NumericRangeNode *child = left ? node->left : node->right;
+  removeRange(node, rv);
+  removeRange(child, rv);
+  if (left) {
+    node->left = child->right;
+    child->right = node;
+  } else {
+    node->right = child->left;
+    child->left = node;
+  }
+  NumericRangeNode_UpdateDepth(node);
+  NumericRangeNode_UpdateDepth(child);
+  *n = child;
+}
+
+/* Update the depth of an inner node whose children are balanced, and rotate it if one of them is
+ * deeper than the other by more than NR_MAX_DEPTH_BALANCE */
+static void NumericRangeNode_Balance(NumericRangeNode **n, NRN_AddRv *rv) {
   NumericRangeNode *node = *n;
-  node->maxDepth = MAX(node->right->maxDepth, node->left->maxDepth) + 1;
-  // check if we need to rebalance the child.
-  // To ease the rebalance we don't rebalance the root
-  // nor do we rebalance nodes that are with ranges (node->maxDepth > NR_MAX_DEPTH)
-  if ((node->right->maxDepth - node->left->maxDepth) > NR_MAX_DEPTH_BALANCE) {  // role to the left
+  NumericRangeNode_UpdateDepth(node);
+  int diff = node->right->maxDepth - node->left->maxDepth;
+  if (diff > NR_MAX_DEPTH_BALANCE) {
     NumericRangeNode *right = node->right;
-    node->right = right->left;
-    right->left = node;
-    --node->maxDepth;
-    *n = right;
-  } else if ((node->left->maxDepth - node->right->maxDepth) >
-              NR_MAX_DEPTH_BALANCE) {  // role to the right
+    // the inner grandchild is the deeper one, move it up first so that it ends up in the middle
+    if (right->left->maxDepth > right->right->maxDepth) {
+      NumericRangeNode_Rotate(&node->right, 1, rv);
+    }
+    NumericRangeNode_Rotate(n, 0, rv);
+  } else if (-diff > NR_MAX_DEPTH_BALANCE) {
     NumericRangeNode *left = node->left;
-    node->left = left->right;
-    left->right = node;
-    --node->maxDepth;
-    *n = left;
+    if (left->right->maxDepth > left->left->maxDepth) {
+      NumericRangeNode_Rotate(&node->left, 0, rv);
+    }
+    NumericRangeNode_Rotate(n, 1, rv);
   }
 }
 
@@ -200,14 +227,16 @@ NRN_AddRv NumericRangeNode_Add(NumericRangeNode *n, t_docId docId, double value)
     rv.numRecords += nRecords;
 
     if (rv.changed) {
-      // if there was a split it means our max depth has increased.
-      // we are too deep - we don't retain this node's range anymore.
+      // if there was a split our max depth may have increased.
+      // if we are too deep - we don't retain this node's range anymore.
       // this keeps memory footprint in check
-      if (++n->maxDepth > RSGlobalConfig.numericTreeMaxDepthRange && n->range) {
+      if (!NumericRangeNode_IsLeaf(child)) {
+        NumericRangeNode_Balance(childP, &rv);
+      }
+      NumericRangeNode_UpdateDepth(n);
+      if (n->maxDepth > RSGlobalConfig.numericTreeMaxDepthRange && n->range) {
         removeRange(n, &rv);
       }
-
-      NumericRangeNode_Balance(childP);
     }
     // return 1 or 0 to our called, so this is done recursively
     return rv;
@@ -298,6 +327,7 @@ void NumericRangeNode_Free(NumericRangeNode *n) {
   if (n->range) {
     InvertedIndex_Free(n->range->entries);
     array_free(n->range->values);
+    array_free(n->range->blockBounds);
     rm_free(n->range);
     n->range = NULL;
   }
@@ -315,13 +345,14 @@ NumericRangeTree *NewNumericRangeTree() {
   NumericRangeTree *ret = rm_malloc(sizeof(NumericRangeTree));
 
   // updated value since splitCard should be >NR_CARD_CHECK
-  ret->root = NewLeafNode(2, 16);
+  ret->root = NewLeafNode(2, 16, Index_StoreNumeric);
   ret->numEntries = 0;
   ret->numRanges = 1;
   ret->revisionId = 0;
   ret->lastDocId = 0;
   ret->emptyLeaves = 0;
   ret->uniqueId = numericTreesUniqueId++;
+  ret->indexFlags = Index_StoreNumeric;
   return ret;
 }
 
@@ -335,6 +366,9 @@ NRN_AddRv NumericRangeTree_Add(NumericRangeTree *t, t_docId docId, double value)
   t->lastDocId = docId;
 
   NRN_AddRv rv = NumericRangeNode_Add(t->root, docId, value);
+  if (rv.changed && !NumericRangeNode_IsLeaf(t->root)) {
+    NumericRangeNode_Balance(&t->root, &rv);
+  }
   // rc != 0 means the tree nodes have changed, and concurrent iteration is not allowed now
   // we increment the revision id of the tree, so currently running query iterators on it
   // will abort the next time they get execution context
@@ -364,6 +398,17 @@ void NumericRangeNode_Traverse(NumericRangeNode *n,
   }
 }
 
+static void setIndexFlagsCallback(NumericRangeNode *n, void *ctx) {
+  if (n->range) {
+    n->range->entries->flags = *(IndexFlags *)ctx;
+  }
+}
+
+void NumericRangeTree_SetIndexFlags(NumericRangeTree *t, IndexFlags flags) {
+  t->indexFlags = flags;
+  NumericRangeNode_Traverse(t->root, setIndexFlagsCallback, &flags);
+}
+
 #define CHILD_EMPTY 1
 #define CHILD_NOT_EMPTY 0
 
@@ -387,7 +432,7 @@ int NumericRangeNode_RemoveChild(NumericRangeNode **node, NRN_AddRv *rv) {
   // balance if required
   if (rvRight == CHILD_NOT_EMPTY && rvLeft == CHILD_NOT_EMPTY) {
     if (rv->changed) {
-      NumericRangeNode_Balance(node);
+      NumericRangeNode_Balance(node, rv);
     }
     return CHILD_NOT_EMPTY;
   }
@@ -437,6 +482,115 @@ NRN_AddRv NumericRangeTree_TrimEmptyLeaves(NumericRangeTree *t) {
   return rv;
 }
 
+static void collectLeafRanges(NumericRangeNode *n, NumericRange ***ranges) {
+  if (NumericRangeNode_IsLeaf(n)) {
+    if (n->range) {
+      *ranges = array_append(*ranges, n->range);
+    }
+    return;
+  }
+  // the left child holds the values lower than the split value
+  collectLeafRanges(n->left, ranges);
+  collectLeafRanges(n->right, ranges);
+}
+
+NumericRange **NumericRangeTree_GetLeafRanges(NumericRangeTree *t) {
+  NumericRange **ranges = array_new(NumericRange *, t->numRanges ? t->numRanges : 1);
+  collectLeafRanges(t->root, &ranges);
+  return ranges;
+}
+
+typedef struct {
+  NumericRangeNode **leaves;
+  // the split value between leaves i and i + 1
+  double *splits;
+  NumericRangeNode **inner;
+} NumericTreeNodes;
+
+/* Collect the nodes of a subtree in order, and return its depth */
+static int collectNodes(NumericRangeNode *n, NumericTreeNodes *nodes) {
+  if (NumericRangeNode_IsLeaf(n)) {
+    nodes->leaves = array_append(nodes->leaves, n);
+    return 0;
+  }
+  int left = collectNodes(n->left, nodes);
+  nodes->splits = array_append(nodes->splits, n->value);
+  nodes->inner = array_append(nodes->inner, n);
+  int right = collectNodes(n->right, nodes);
+  return MAX(left, right) + 1;
+}
+
+/* Build a balanced tree over leaves [lo, hi), reusing the collected inner nodes */
+static NumericRangeNode *buildBalanced(NumericTreeNodes *nodes, size_t lo, size_t hi) {
+  if (hi - lo == 1) {
+    return nodes->leaves[lo];
+  }
+  size_t mid = lo + (hi - lo) / 2;
+  NumericRangeNode *n = array_pop(nodes->inner);
+  n->value = nodes->splits[mid - 1];
+  n->left = buildBalanced(nodes, lo, mid);
+  n->right = buildBalanced(nodes, mid, hi);
+  NumericRangeNode_UpdateDepth(n);
+  return n;
+}
+
+NRN_AddRv NumericRangeTree_Rebalance(NumericRangeTree *t) {
+  NRN_AddRv rv = {0};
+  if (NumericRangeNode_IsLeaf(t->root)) {
+    return rv;
+  }
+  NumericTreeNodes nodes = {
+      .leaves = array_new(NumericRangeNode *, t->numRanges),
+      .splits = array_new(double, t->numRanges),
+      .inner = array_new(NumericRangeNode *, t->numRanges),
+  };
+  int depth = collectNodes(t->root, &nodes);
+  size_t nleaves = array_len(nodes.leaves);
+  int minDepth = nleaves > 1 ? 64 - __builtin_clzll(nleaves - 1) : 0;
+
+  // the rotations done when adding keep the tree close to the minimal depth, but trimming empty
+  // leaves can leave some branches much deeper than others
+  if (depth > minDepth + NR_MAX_DEPTH_BALANCE) {
+    // the ranges kept by inner nodes don't cover their new subtrees
+    for (size_t i = 0; i < array_len(nodes.inner); ++i) {
+      removeRange(nodes.inner[i], &rv);
+    }
+    t->root = buildBalanced(&nodes, 0, nleaves);
+    rv.changed = 1;
+    t->revisionId++;
+  }
+  array_free(nodes.leaves);
+  array_free(nodes.splits);
+  array_free(nodes.inner);
+  return rv;
+}
+
+void NumericRangeTree_Renumber(NumericRangeTree *t, const DocIdRemap *remap,
+                               IndexRepairParams *params) {
+  NumericRangeTreeIterator *iter = NumericRangeTreeIterator_New(t);
+  NumericRangeNode *n;
+  // the last document may have been deleted, so the last id is the largest one left in the ranges
+  t_docId lastDocId = 0;
+  while ((n = NumericRangeTreeIterator_Next(iter))) {
+    if (!n->range) {
+      continue;
+    }
+    size_t before = params->bytesBeforFix, after = params->bytesAfterFix;
+    InvertedIndex_Renumber(n->range->entries, remap, params);
+    // the blocks were rewritten, and may start at the same ids with other records
+    array_free(n->range->blockBounds);
+    n->range->blockBounds = NULL;
+    n->range->invertedIndexSize += (params->bytesAfterFix - after) - (params->bytesBeforFix - before);
+    if (n->range->entries->size && n->range->entries->lastId > lastDocId) {
+      lastDocId = n->range->entries->lastId;
+    }
+  }
+  NumericRangeTreeIterator_Free(iter);
+  t->lastDocId = lastDocId;
+  // running iterators can't follow the new ids
+  t->revisionId++;
+}
+
 void NumericRangeTree_Free(NumericRangeTree *t) {
   NumericRangeNode_Free(t->root);
   rm_free(t);
@@ -451,11 +605,84 @@ IndexIterator *NewNumericRangeIterator(const IndexSpec *sp, NumericRange *nr,
     // make the filter NULL so the reader will ignore it
     f = NULL;
   }
-  IndexReader *ir = NewNumericReader(sp, nr->entries, f, nr->minVal, nr->maxVal);
+  IndexReader *ir =
+      f ? NewNumericBoundedReader(sp, nr->entries, f, nr->minVal, nr->maxVal, &nr->blockBounds)
+        : NewNumericReader(sp, nr->entries, f, nr->minVal, nr->maxVal);
+  if (f) {
+    ir->numEstimated = NumericRange_EstimateMatches(nr, f);
+  }
 
   return NewReadIterator(ir);
 }
 
+size_t NumericRange_EstimateMatches(const NumericRange *r, const NumericFilter *f) {
+  if (f->geoFilter || !r->entries->numDocs) {
+    return 0;
+  }
+  // the sample holds every NR_CARD_CHECK-th value added to the range, with its number of
+  // appearances in the sample
+  size_t sampled = 0, matched = 0;
+  for (uint32_t i = 0; i < array_len(r->values); ++i) {
+    sampled += r->values[i].appearances;
+    if (NumericFilter_Match(f, r->values[i].value)) {
+      matched += r->values[i].appearances;
+    }
+  }
+  if (!sampled) {
+    // a range with fewer than NR_CARD_CHECK entries has no sample, and any of them may match
+    return r->entries->numDocs;
+  }
+  double ratio = (double)matched / sampled;
+  return MAX(1, (size_t)ceil(ratio * r->entries->numDocs));
+}
+
+static size_t countRangeMatches(const IndexSpec *sp, NumericRange *rng, const NumericFilter *f) {
+  const DocTable *dt = &sp->docs;
+  int contained = NumericFilter_Match(f, rng->minVal) && NumericFilter_Match(f, rng->maxVal);
+  // every live entry of a contained range is a match. Its deleted entries are counted once, and
+  // again only after a document was deleted or the gc collected entries of the range
+  if (contained && rng->deletedEpoch == dt->deletedEpoch &&
+      rng->deletedGcMarker == rng->entries->gcMarker) {
+    return rng->entries->numDocs - rng->numDeleted;
+  }
+
+  IndexReader *ir = contained ? NewNumericReader(sp, rng->entries, NULL, rng->minVal, rng->maxVal)
+                              : NewNumericBoundedReader(sp, rng->entries, f, rng->minVal,
+                                                        rng->maxVal, &rng->blockBounds);
+  RSIndexResult *res = NULL;
+  size_t count = 0, numRead = 0;
+  while (IR_Read(ir, &res) == INDEXREAD_OK) {
+    ++numRead;
+    // documents deleted before a legacy rdb load are missing from the table without a mark
+    count += DocTable_Exists(dt, res->docId);
+  }
+  IR_Free(ir);
+  if (contained) {
+    rng->numDeleted = numRead - count;
+    rng->deletedEpoch = dt->deletedEpoch;
+    rng->deletedGcMarker = rng->entries->gcMarker;
+  }
+  return count;
+}
+
+size_t NumericRangeTree_CountMatches(NumericRangeTree *t, const IndexSpec *sp,
+                                     const NumericFilter *f) {
+  Vector *v = NumericRangeTree_Find(t, f->min, f->max);
+  if (!v) {
+    return 0;
+  }
+  size_t count = 0;
+  for (size_t i = 0; i < Vector_Size(v); ++i) {
+    NumericRange *rng;
+    Vector_Get(v, i, &rng);
+    if (rng) {
+      count += countRangeMatches(sp, rng, f);
+    }
+  }
+  Vector_Free(v);
+  return count;
+}
+
 /* Create a union iterator from the numeric filter, over all the sub-ranges in the tree that fit
  * the filter */
 IndexIterator *createNumericIterator(const IndexSpec *sp, NumericRangeTree *t,
@@ -524,25 +751,25 @@ static NumericRangeTree *openNumericKeysDict(RedisSearchCtx *ctx, RedisModuleStr
   return kdv->p;
 }
 
-struct indexIterator *NewNumericFilterIterator(RedisSearchCtx *ctx, const NumericFilter *flt,
-                                               ConcurrentSearchCtx *csx, FieldType forType) {
-  RedisModuleString *s = IndexSpec_GetFormattedKeyByName(ctx->spec, flt->fieldName, forType);
+NumericRangeTree *OpenNumericIndexForQuery(RedisSearchCtx *ctx, const char *fieldName,
+                                           FieldType forType) {
+  RedisModuleString *s = IndexSpec_GetFormattedKeyByName(ctx->spec, fieldName, forType);
   if (!s) {
     return NULL;
   }
-  RedisModuleKey *key = NULL;
-  NumericRangeTree *t = NULL;
-  if (!ctx->spec->keysDict) {
-    key = RedisModule_OpenKey(ctx->redisCtx, s, REDISMODULE_READ);
-    if (!key || RedisModule_ModuleTypeGetType(key) != NumericIndexType) {
-      return NULL;
-    }
-
-    t = RedisModule_ModuleTypeGetValue(key);
-  } else {
-    t = openNumericKeysDict(ctx, s, 0);
+  if (ctx->spec->keysDict) {
+    return openNumericKeysDict(ctx, s, 0);
   }
+  RedisModuleKey *key = RedisModule_OpenKey(ctx->redisCtx, s, REDISMODULE_READ);
+  if (!key || RedisModule_ModuleTypeGetType(key) != NumericIndexType) {
+    return NULL;
+  }
+  return RedisModule_ModuleTypeGetValue(key);
+}
 
+struct indexIterator *NewNumericFilterIterator(RedisSearchCtx *ctx, const NumericFilter *flt,
+                                               ConcurrentSearchCtx *csx, FieldType forType) {
+  NumericRangeTree *t = OpenNumericIndexForQuery(ctx, flt->fieldName, forType);
   if (!t) {
     return NULL;
   }
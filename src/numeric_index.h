@@ -42,6 +42,14 @@ typedef struct {
   uint32_t splitCard;
   CardinalityValue *values;
   InvertedIndex *entries;
+  // the value bounds of the blocks of the entries, used by filtered readers to skip blocks
+  NumericBlockBounds *blockBounds;
+
+  // number of entries of deleted documents, as counted at the deletedEpoch of the doc table and
+  // the gcMarker of the entries. Entries added since are of live documents
+  size_t numDeleted;
+  uint64_t deletedEpoch;
+  uint32_t deletedGcMarker;
 } NumericRange;
 
 /* NumericRangeNode is a node in the range tree that can have a range in it or not, and can be a
@@ -78,6 +86,9 @@ typedef struct {
 
   uint32_t uniqueId;
 
+  // flags of the inverted indexes of the ranges
+  IndexFlags indexFlags;
+
   size_t emptyLeaves;
 
 } NumericRangeTree;
@@ -87,6 +98,16 @@ typedef struct {
 struct indexIterator *NewNumericRangeIterator(const IndexSpec *sp, NumericRange *nr,
                                               const NumericFilter *f);
 
+/* Estimate the number of entries of a range matching the filter, from the sample of its values
+ * kept to track its cardinality. Returns the number of entries of the range if it has no sample
+ * to estimate from, so the estimate remains an upper bound */
+size_t NumericRange_EstimateMatches(const NumericRange *r, const NumericFilter *f);
+
+/* Count the documents of the tree matching a (non geo) filter, leaving out the documents deleted
+ * from sp. Expects every document to have a single value in the tree */
+size_t NumericRangeTree_CountMatches(NumericRangeTree *t, const IndexSpec *sp,
+                                     const NumericFilter *f);
+
 struct indexIterator *NewNumericFilterIterator(RedisSearchCtx *ctx, const NumericFilter *flt,
                                                ConcurrentSearchCtx *csx, FieldType forType);
 
@@ -99,8 +120,9 @@ size_t NumericRange_Add(NumericRange *r, t_docId docId, double value, int checkC
 double NumericRange_Split(NumericRange *n, NumericRangeNode **lp, NumericRangeNode **rp,
                           NRN_AddRv *rv);
 
-/* Create a new range node with the given capacity, minimum and maximum values */
-NumericRangeNode *NewLeafNode(size_t cap, size_t splitCard);
+/* Create a new range node with the given capacity, minimum and maximum values. The entries of the
+ * range are stored in an inverted index with the given flags */
+NumericRangeNode *NewLeafNode(size_t cap, size_t splitCard, IndexFlags flags);
 
 /* Add a value to a tree node or its children recursively. Splits the relevant node if needed.
  * Returns 0 if no nodes were split, 1 if we splitted nodes */
@@ -116,9 +138,28 @@ void NumericRangeNode_Free(NumericRangeNode *n);
 /* Recursively trim empty nodes from tree  */
 NRN_AddRv NumericRangeTree_TrimEmptyLeaves(NumericRangeTree *t);
 
+/* Rebuild the inner nodes of the tree as a balanced tree over its leaves, if it got much deeper
+ * than that. Ranges kept by inner nodes are removed. Returns whether the tree changed and the
+ * number of ranges removed */
+NRN_AddRv NumericRangeTree_Rebalance(NumericRangeTree *t);
+
+/* An array of the ranges of the tree's leaves, in ascending order of their values. The array
+ * should be freed with array_free */
+NumericRange **NumericRangeTree_GetLeafRanges(NumericRangeTree *t);
+
+/* Rewrite the entries of all the ranges with the document ids given by the remap, see
+ * InvertedIndex_Renumber */
+void NumericRangeTree_Renumber(NumericRangeTree *t, const DocIdRemap *remap,
+                               IndexRepairParams *params);
+
 /* Create a new tree */
 NumericRangeTree *NewNumericRangeTree();
 
+/* Set the flags of the inverted indexes of the tree's ranges, including those of the ranges
+ * created by later splits. Only flags which affect how full blocks are stored, like
+ * Index_PackNumeric, can be changed this way */
+void NumericRangeTree_SetIndexFlags(NumericRangeTree *t, IndexFlags flags);
+
 /* Add a value to a tree. Returns 0 if no nodes were split, 1 if we splitted nodes */
 NRN_AddRv NumericRangeTree_Add(NumericRangeTree *t, t_docId docId, double value);
 
@@ -138,6 +179,11 @@ extern RedisModuleType *NumericIndexType;
 NumericRangeTree *OpenNumericIndex(RedisSearchCtx *ctx, RedisModuleString *keyName,
                                    RedisModuleKey **idxKey);
 
+/* Find the tree of a numeric field for reading, without creating it. Returns NULL if the field
+ * has no tree */
+NumericRangeTree *OpenNumericIndexForQuery(RedisSearchCtx *ctx, const char *fieldName,
+                                           FieldType forType);
+
 int NumericIndexType_Register(RedisModuleCtx *ctx);
 void *NumericIndexType_RdbLoad(RedisModuleIO *rdb, int encver);
 void NumericIndexType_RdbSave(RedisModuleIO *rdb, void *value);
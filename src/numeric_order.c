@@ -0,0 +1,206 @@
+#include "numeric_order.h"
+#include "inverted_index.h"
+#include "doc_table.h"
+#include "sortable.h"
+#include "value.h"
+#include "rmalloc.h"
+#include "util/arr.h"
+#include <sys/param.h>
+
+static int cmpEntries(const void *p1, const void *p2) {
+  const NumericOrderEntry *e1 = p1, *e2 = p2;
+  if (e1->value != e2->value) {
+    return e1->value < e2->value ? -1 : 1;
+  }
+  return e1->docId < e2->docId ? -1 : e1->docId > e2->docId ? 1 : 0;
+}
+
+static void clearEntries(NumericOrderIterator *it) {
+  for (size_t i = 0; i < array_len(it->entries); ++i) {
+    IndexResult_Free(it->entries[i].hit);
+  }
+  array_clear(it->entries);
+  it->entryIdx = 0;
+}
+
+/* Read the entries of a leaf which match the filter into the entries array, sorted by value */
+static int loadRange(NumericOrderIterator *it, NumericRange *rng) {
+  IndexIterator *filter = it->child;
+  filter->Rewind(filter->ctx);
+
+  IndexReader *ir = NewNumericReader(it->sp, rng->entries, NULL, rng->minVal, rng->maxVal);
+  RSIndexResult *res = NULL, *fhit = NULL;
+  t_docId filterId = 0;
+  int rc = INDEXREAD_OK;
+  while (IR_Read(ir, &res) == INDEXREAD_OK) {
+    if (res->docId > filterId) {
+      rc = filter->SkipTo(filter->ctx, res->docId, &fhit);
+      if (rc == INDEXREAD_TIMEOUT || rc == INDEXREAD_EOF) {
+        break;
+      } else if (rc == INDEXREAD_NOTFOUND) {
+        // the filter read its next match, which may be one of the next entries
+        filterId = MAX(fhit->docId, res->docId);
+        continue;
+      }
+      filterId = res->docId;
+    } else if (res->docId < filterId) {
+      // the filter is already past this document
+      continue;
+    }
+    NumericOrderEntry e = {
+        .docId = res->docId, .value = res->num.value, .hit = IndexResult_DeepCopy(fhit)};
+    it->entries = array_append(it->entries, e);
+  }
+  IR_Free(ir);
+
+  // a single value leaf is already sorted by docId
+  if (rng->minVal != rng->maxVal) {
+    qsort(it->entries, array_len(it->entries), sizeof(*it->entries), cmpEntries);
+  }
+  return rc == INDEXREAD_TIMEOUT ? INDEXREAD_TIMEOUT : INDEXREAD_OK;
+}
+
+static int hasValue(const NumericOrderIterator *it, t_docId docId) {
+  const RSDocumentMetadata *dmd = DocTable_Get(&it->sp->docs, docId);
+  // deleted documents are dropped by the caller anyway
+  if (!dmd || !dmd->sortVector) {
+    return !dmd;
+  }
+  const RSValue *v = RSSortingVector_Get(dmd->sortVector, it->sortIdx);
+  return v && v->t == RSValue_Number;
+}
+
+static int NOI_ReadMissing(NumericOrderIterator *it, RSIndexResult **hit) {
+  IndexIterator *filter = it->child;
+  if (!it->sp || it->sortIdx < 0) {
+    IITER_SET_EOF(&it->base);
+    return INDEXREAD_EOF;
+  }
+  RSIndexResult *res = NULL;
+  while (1) {
+    int rc = filter->Read(filter->ctx, &res);
+    if (rc == INDEXREAD_EOF) {
+      IITER_SET_EOF(&it->base);
+      return INDEXREAD_EOF;
+    } else if (rc == INDEXREAD_TIMEOUT) {
+      return INDEXREAD_TIMEOUT;
+    } else if (rc == INDEXREAD_OK && !hasValue(it, res->docId)) {
+      it->lastDocId = res->docId;
+      *hit = it->base.current = res;
+      return INDEXREAD_OK;
+    }
+  }
+}
+
+static int NOI_Read(void *ctx, RSIndexResult **hit) {
+  NumericOrderIterator *it = ctx;
+  if (!it->base.isValid) {
+    return INDEXREAD_EOF;
+  }
+  if (it->readingMissing) {
+    return NOI_ReadMissing(it, hit);
+  }
+
+  while (it->entryIdx == array_len(it->entries)) {
+    clearEntries(it);
+    if (it->rangeIdx == array_len(it->ranges)) {
+      it->readingMissing = 1;
+      it->child->Rewind(it->child->ctx);
+      return NOI_ReadMissing(it, hit);
+    }
+    if (loadRange(it, it->ranges[it->rangeIdx++]) == INDEXREAD_TIMEOUT) {
+      return INDEXREAD_TIMEOUT;
+    }
+  }
+
+  // the entries are sorted in ascending order, so equal values are returned by descending docId
+  // when the order is descending, same as the sorter does
+  size_t n = array_len(it->entries);
+  NumericOrderEntry *e = &it->entries[it->ascending ? it->entryIdx : n - 1 - it->entryIdx];
+  it->entryIdx++;
+  it->lastDocId = e->docId;
+  *hit = it->base.current = e->hit;
+  return INDEXREAD_OK;
+}
+
+static int NOI_HasNext(void *ctx) {
+  NumericOrderIterator *it = ctx;
+  return it->base.isValid;
+}
+
+static size_t NOI_NumEstimated(void *ctx) {
+  NumericOrderIterator *it = ctx;
+  return it->child->NumEstimated(it->child->ctx);
+}
+
+static size_t NOI_Len(void *ctx) {
+  return NOI_NumEstimated(ctx);
+}
+
+static t_docId NOI_LastDocId(void *ctx) {
+  NumericOrderIterator *it = ctx;
+  return it->lastDocId;
+}
+
+static void NOI_Abort(void *ctx) {
+  NumericOrderIterator *it = ctx;
+  IITER_SET_EOF(&it->base);
+  it->child->Abort(it->child->ctx);
+}
+
+static void NOI_Rewind(void *ctx) {
+  NumericOrderIterator *it = ctx;
+  clearEntries(it);
+  it->rangeIdx = 0;
+  it->readingMissing = 0;
+  it->lastDocId = 0;
+  it->base.current = NULL;
+  IITER_CLEAR_EOF(&it->base);
+  it->child->Rewind(it->child->ctx);
+}
+
+static void NOI_Free(IndexIterator *self) {
+  NumericOrderIterator *it = self->ctx;
+  clearEntries(it);
+  array_free(it->entries);
+  array_free(it->ranges);
+  it->child->Free(it->child);
+  rm_free(it);
+}
+
+IndexIterator *NewNumericOrderIterator(const IndexSpec *sp, NumericRangeTree *t,
+                                       IndexIterator *filter, int sortIdx, int ascending) {
+  NumericOrderIterator *it = rm_calloc(1, sizeof(*it));
+  it->child = filter;
+  it->sp = sp;
+  it->sortIdx = sortIdx;
+  it->ascending = ascending;
+  it->entries = array_new(NumericOrderEntry, 16);
+  it->ranges = NumericRangeTree_GetLeafRanges(t);
+  if (!ascending) {
+    size_t n = array_len(it->ranges);
+    for (size_t i = 0; i < n / 2; ++i) {
+      NumericRange *tmp = it->ranges[i];
+      it->ranges[i] = it->ranges[n - 1 - i];
+      it->ranges[n - 1 - i] = tmp;
+    }
+  }
+
+  IndexIterator *ri = &it->base;
+  ri->ctx = it;
+  ri->type = NUMERIC_ORDER_ITERATOR;
+  ri->mode = MODE_UNSORTED;  // results are ordered by value, not by docId
+  ri->isValid = 1;
+  ri->current = NULL;
+  ri->NumEstimated = NOI_NumEstimated;
+  ri->GetCriteriaTester = NULL;
+  ri->Read = NOI_Read;
+  ri->SkipTo = NULL;  // the iterator is always the root, and has no meaningful docId order
+  ri->LastDocId = NOI_LastDocId;
+  ri->HasNext = NOI_HasNext;
+  ri->Free = NOI_Free;
+  ri->Len = NOI_Len;
+  ri->Abort = NOI_Abort;
+  ri->Rewind = NOI_Rewind;
+  return ri;
+}
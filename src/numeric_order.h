@@ -0,0 +1,45 @@
+#pragma once
+
+#include "index_iterator.h"
+#include "numeric_index.h"
+#include "spec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  t_docId docId;
+  double value;
+  RSIndexResult *hit;  // copy of the filter's hit, owned by the iterator
+} NumericOrderEntry;
+
+/* Reads the documents matching a filter iterator in the order of their value in a numeric field.
+ * The leaves of the numeric range tree are visited in the order of the sort, and the matches of
+ * each leaf are sorted by value (and then by docId) before they are returned. Since a leaf is only
+ * read once the previous ones are exhausted, reading the first results touches only the first
+ * leaves */
+typedef struct {
+  IndexIterator base;
+  IndexIterator *child;  // the filter of the query
+  const IndexSpec *sp;
+  NumericRange **ranges;  // array of the leaves, in the order of the sort
+  size_t rangeIdx;
+  NumericOrderEntry *entries;  // array of the matches of the current leaf, sorted by value
+  size_t entryIdx;
+  t_docId lastDocId;
+  int sortIdx;
+  int ascending;
+  int readingMissing;  // all leaves were read, reading the matches without a value
+} NumericOrderIterator;
+
+/* Create an iterator over the matches of filter in the order of their value in the numeric range
+ * tree t. The iterator takes ownership of the filter.
+ * Documents without a value are returned after all others, in the order of their docId. They are
+ * found by their sorting vector at sortIdx, and are not returned at all if sp is NULL */
+IndexIterator *NewNumericOrderIterator(const IndexSpec *sp, NumericRangeTree *t,
+                                       IndexIterator *filter, int sortIdx, int ascending);
+
+#ifdef __cplusplus
+}
+#endif
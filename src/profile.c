@@ -6,7 +6,7 @@ void printReadIt(RedisModuleCtx *ctx, IndexIterator *root, size_t counter, doubl
   size_t nlen = 0;
   RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
 
-  if (ir->idx->flags == Index_DocIdsOnly) {
+  if ((ir->idx->flags & ~Index_EliasFano) == Index_DocIdsOnly) {
     printProfileType("TAG");
     RedisModule_ReplyWithSimpleString(ctx, "Term");
     RedisModule_ReplyWithSimpleString(ctx, ir->record->term.term->str);
@@ -45,9 +45,19 @@ void printReadIt(RedisModuleCtx *ctx, IndexIterator *root, size_t counter, doubl
   nlen += 2;
 
   RedisModule_ReplyWithSimpleString(ctx, "Size");
-  RedisModule_ReplyWithLongLong(ctx, root->NumEstimated(ir));
+  RedisModule_ReplyWithLongLong(ctx, ir->idx->numDocs);
   nlen += 2;
 
+  // numeric readers with a filter test the value bounds of each block first
+  if ((ir->idx->flags & Index_StoreNumeric) && ir->decoderCtx.ptr &&
+      !((NumericFilter *)ir->decoderCtx.ptr)->geoFilter) {
+    RedisModule_ReplyWithSimpleString(ctx, "Blocks skipped");
+    RedisModule_ReplyWithLongLong(ctx, ir->blocksSkipped);
+    RedisModule_ReplyWithSimpleString(ctx, "Blocks matched");
+    RedisModule_ReplyWithLongLong(ctx, ir->blocksMatched);
+    nlen += 4;
+  }
+
   RedisModule_ReplySetArrayLength(ctx, nlen);
 }
 
@@ -71,6 +81,10 @@ static double _recursiveProfilePrint(RedisModuleCtx *ctx, ResultProcessor *rp, s
       case RP_HIGHLIGHTER:
       case RP_GROUP:
       case RP_NETWORK:
+      case RP_CACHED_RESULTS:
+      case RP_RESULT_CACHE_WRITER:
+      case RP_COUNTED_RESULTS:
+      case RP_TAG_FACETS:
         printProfileType(RPTypeToString(rp->type));
         break;
 
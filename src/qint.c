@@ -196,6 +196,109 @@ QINT_API size_t qint_decode4(BufferReader *br, uint32_t *i, uint32_t *i2, uint32
   return total + 1;
 }
 
+/******************************************************************************
+ * Batch decoding.
+ *
+ * A record is a leading byte holding 2 bits of width per integer, followed by the integers' bytes.
+ * With SSSE3 we decode a whole record with a single shuffle: a per-leading-byte mask moves the
+ * bytes of each integer into its own 32 bit lane, zeroing the rest. The shuffle reads 16 bytes past
+ * the leading byte, so records too close to the end of the buffer are decoded by the scalar path.
+ ******************************************************************************/
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#define QINT_HAVE_SSSE3 1
+#endif
+
+// Record size (including the leading byte) for 4 integers, by leading byte
+static uint8_t qintRecordSize[256];
+// Shuffle masks, by leading byte
+static uint8_t qintShuffle[256][16] __attribute__((aligned(16)));
+
+typedef size_t (*qintBatchDecoder)(const uint8_t *p, const uint8_t *end, uint32_t *out, int len,
+                                   int skipLast, size_t n, size_t *nread);
+static qintBatchDecoder qintDecodeBatchImpl;
+
+// The leading byte of a record of len integers, and its size. Unused integers have width 0 (one
+// byte), which we subtract
+#define QINT_LEADING(p, len) ((len) == 4 ? *(p) : *(p) & ((1 << ((len) * 2)) - 1))
+#define QINT_RECORD_SIZE(lead, len) (qintRecordSize[lead] - (4 - (len)))
+
+static size_t qint_decode_batch_scalar(const uint8_t *p, const uint8_t *end, uint32_t *out,
+                                       int len, int skipLast, size_t n, size_t *nread) {
+  const uint8_t *start = p;
+  size_t i = 0;
+  for (; i < n && p < end; i++, out += 4) {
+    const uint8_t header = *p;
+    const uint8_t *vp = p + 1;
+    for (int j = 0; j < len; j++) {
+      size_t nused;
+      QINT_DECODE_VALUE(out[j], (header >> (j * 2)) & 0x03, vp, nused);
+      vp += nused;
+    }
+    p = vp + (skipLast ? out[len - 1] : 0);
+  }
+  *nread = p - start;
+  return i;
+}
+
+#ifdef QINT_HAVE_SSSE3
+__attribute__((target("ssse3"))) static size_t qint_decode_batch_ssse3(
+    const uint8_t *p, const uint8_t *end, uint32_t *out, int len, int skipLast, size_t n,
+    size_t *nread) {
+  const uint8_t *start = p;
+  size_t i = 0;
+  for (; i < n && p + 17 <= end; i++, out += 4) {
+    const uint8_t lead = QINT_LEADING(p, len);
+    __m128i data = _mm_loadu_si128((const __m128i *)(p + 1));
+    __m128i mask = _mm_load_si128((const __m128i *)qintShuffle[lead]);
+    _mm_storeu_si128((__m128i *)out, _mm_shuffle_epi8(data, mask));
+    p += QINT_RECORD_SIZE(lead, len) + (skipLast ? out[len - 1] : 0);
+  }
+  // finish the tail safely
+  size_t tail = 0;
+  if (i < n && p < end) {
+    i += qint_decode_batch_scalar(p, end, out, len, skipLast, n - i, &tail);
+  }
+  *nread = p - start + tail;
+  return i;
+}
+#endif
+
+static void __attribute__((constructor)) qint_initBatchDecoder(void) {
+  for (int lead = 0; lead < 256; lead++) {
+    uint8_t off = 0;
+    for (int i = 0; i < 4; i++) {
+      int width = ((lead >> (i * 2)) & 0x03) + 1;
+      for (int j = 0; j < 4; j++) {
+        qintShuffle[lead][i * 4 + j] = j < width ? off + j : 0x80;
+      }
+      off += width;
+    }
+    qintRecordSize[lead] = off + 1;
+  }
+
+  qintDecodeBatchImpl = qint_decode_batch_scalar;
+#ifdef QINT_HAVE_SSSE3
+  // we may run before the cpu model is initialized by the runtime's own constructors
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("ssse3")) {
+    qintDecodeBatchImpl = qint_decode_batch_ssse3;
+  }
+#endif
+}
+
+QINT_API size_t qint_decode_batch(BufferReader *br, uint32_t *out, int len, int skipLast,
+                                  size_t n) {
+  if (len <= 0 || len > 4) return 0;
+  const uint8_t *p = (uint8_t *)BufferReader_Current(br);
+  const uint8_t *end = (uint8_t *)br->buf->data + br->buf->offset;
+  size_t nread = 0;
+  size_t ret = qintDecodeBatchImpl(p, end, out, len, skipLast, n, &nread);
+  Buffer_Skip(br, nread);
+  return ret;
+}
+
 // void printConfig(unsigned char c) {
 
 //   int off = 1;
@@ -49,4 +49,10 @@ QINT_API size_t qint_decode3(BufferReader *br, uint32_t *i, uint32_t *i2, uint32
 QINT_API size_t qint_decode4(BufferReader *br, uint32_t *i, uint32_t *i2, uint32_t *i3,
                              uint32_t *i4);
 
+/* Decode up to n consecutive records of len (1-4) integers each, as written by qint_encode, into
+ * out. Record k is written to out[4k .. 4k+len-1]. If skipLast is set, the last integer of each
+ * record is the length of a byte blob following it (e.g. term offsets), which is skipped. Decoding
+ * stops at the end of the buffer. Returns the number of records decoded */
+QINT_API size_t qint_decode_batch(BufferReader *br, uint32_t *out, int len, int skipLast, size_t n);
+
 #endif
\ No newline at end of file
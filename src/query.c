@@ -5,6 +5,7 @@
 #include <sys/param.h>
 
 #include "geo_index.h"
+#include "geo_knn.h"
 #include "index.h"
 #include "query.h"
 #include "config.h"
@@ -26,6 +27,8 @@
 #include "query_internal.h"
 #include "aggregate/aggregate.h"
 #include "suffix.h"
+#include "ngram.h"
+#include "bitset_iterator.h"
 
 #define EFFECTIVE_FIELDMASK(q_, qn_) ((qn_)->opts.fieldMask & (q)->opts->fieldmask)
 
@@ -383,6 +386,32 @@ IndexIterator *Query_EvalTokenNode(QueryEvalCtx *q, QueryNode *qn) {
   return NewReadIterator(ir);
 }
 
+/* Create the union of a prefix, fuzzy, suffix or range expansion. Large expansions are read
+ * term-at-a-time, unless the positions of their terms are needed. Expansions of any size are read
+ * term-at-a-time if cacheable is set, since their postings are to be cached */
+static IndexIterator *newExpansionUnion(QueryEvalCtx *q, IndexIterator **its, size_t num,
+                                        double weight, QueryNodeType type, const char *str,
+                                        int cacheable) {
+  IndexIterator *ret = NewUnionIterator(its, num, q->docTable, 1, weight, type, str);
+  if (!q->checkPositions && !(q->reqFlags & QEXEC_F_SEND_HIGHLIGHT)) {
+    IndexIterator_EnableAccumulation(ret, cacheable);
+  }
+  return ret;
+}
+
+/* Create a union over the cached postings of a prefix, suffix or contains expansion */
+static IndexIterator *newCachedExpansionUnion(QueryEvalCtx *q, const ExpansionCacheEntry *e,
+                                              double weight, const char *str) {
+  RSQueryTerm **terms = rm_malloc(e->nterms * sizeof(*terms));
+  for (size_t i = 0; i < e->nterms; ++i) {
+    RSToken tok = {.str = e->terms[i].str, .len = e->terms[i].len};
+    terms[i] = NewQueryTerm(&tok, q->tokenId++);
+    terms[i]->idf = CalculateIDF(q->sctx->spec->docs.size, e->terms[i].numDocs);
+  }
+  return NewCachedUnionIterator(e->postings, terms, e->nterms, q->docTable, weight, QN_PREFIX,
+                                str);
+}
+
 static IndexIterator *iterateExpandedTerms(QueryEvalCtx *q, Trie *terms, const char *str,
                                            size_t len, int maxDist, int prefixMode,
                                            QueryNodeOptions *opts) {
@@ -441,7 +470,7 @@ static IndexIterator *iterateExpandedTerms(QueryEvalCtx *q, Trie *terms, const c
     return NULL;
   }
   QueryNodeType type = prefixMode ? QN_PREFIX : QN_FUZZY;
-  return NewUnionIterator(its, itsSz, q->docTable, 1, opts->weight, type, str);
+  return newExpansionUnion(q, its, itsSz, opts->weight, type, str, 0);
 }
 
 typedef struct {
@@ -454,8 +483,20 @@ typedef struct {
 } ContainsCtx;
 
 static int rangeIterCb(const rune *r, size_t n, void *p);
+static int Query_EvalTagBitset(QueryEvalCtx *q, QueryNode *qn, uint64_t **words, size_t *nwords);
 static int suffixIterCb(const char *s, size_t n, void *p);
 
+static t_fieldMask textFieldsMask(const IndexSpec *spec) {
+  t_fieldMask mask = 0;
+  for (size_t i = 0; i < spec->numFields; ++i) {
+    const FieldSpec *fs = spec->fields + i;
+    if (FIELD_IS(fs, INDEXFLD_T_FULLTEXT)) {
+      mask |= FIELD_BIT(fs);
+    }
+  }
+  return mask;
+}
+
 /* Ealuate a prefix node by expanding all its possible matches and creating one big UNION on all
  * of them.
  * Used for Prefix, Contains and suffix nodes.
@@ -482,15 +523,47 @@ static IndexIterator *Query_EvalPrefixNode(QueryEvalCtx *q, QueryNode *qn) {
     str = strToFoldedRunes(qn->pfx.tok.str, &nstr);
   }
 
+  // the cache holds term-at-a-time postings, which have no term offsets
+  ExpansionKind kind = qn->pfx.suffix ? (qn->pfx.prefix ? ExpansionKind_Contains
+                                                        : ExpansionKind_Suffix)
+                                      : ExpansionKind_Prefix;
+  t_fieldMask mask = q->opts->fieldmask & qn->opts.fieldMask;
+  char *pattern = NULL;
+  size_t plen = 0;
+  // the n-gram index holds the terms of its fields only, so it is used when all the text fields
+  // the node is evaluated on have one
+  int withNgrams = str && qn->pfx.suffix && spec->ngrams &&
+                   !(mask & textFieldsMask(spec) & ~spec->ngramMask);
+  // all modifier fields of a spec with a suffix trie must support contains queries
+  int supported = withNgrams || !spec->suffix || qn->opts.fieldMask == RS_FIELDMASK_ALL ||
+                  (spec->suffixMask & qn->opts.fieldMask) == qn->opts.fieldMask;
+  int useCache = str && supported && RSGlobalConfig.expansionCacheMaxMemory &&
+                 !q->checkPositions && !(q->reqFlags & QEXEC_F_SEND_HIGHLIGHT);
+  if (useCache) {
+    pattern = runesToStr(str, nstr, &plen);
+    if (!spec->expcache) {
+      spec->expcache = NewExpansionCache();
+    }
+    const ExpansionCacheEntry *e = ExpansionCache_Get(spec->expcache, kind, pattern, plen, mask);
+    if (e) {
+      rm_free(str);
+      rm_free(pattern);
+      return newCachedExpansionUnion(q, e, qn->opts.weight, qn->pfx.tok.str);
+    }
+  }
+
   ctx.cap = 8;
   ctx.its = rm_malloc(sizeof(*ctx.its) * ctx.cap);
   ctx.nits = 0;
 
-  // spec support contains queries
-  if (spec->suffix) {
-    // all modifier fields are supported
-    if (qn->opts.fieldMask == RS_FIELDMASK_ALL ||
-       (spec->suffixMask & qn->opts.fieldMask) == qn->opts.fieldMask) {
+  if (withNgrams) {
+    size_t slen;
+    char *s = runesToStr(str, nstr, &slen);
+    NgramIndex_IterateContains(spec->ngrams, s, slen, qn->pfx.prefix, suffixIterCb, &ctx,
+                               &q->sctx->timeout);
+    rm_free(s);
+  } else if (spec->suffix) {  // spec support contains queries
+    if (supported) {
     Suffix_IterateContains(spec->suffix->root, str, nstr, qn->pfx.prefix,
                            suffixIterCb, &ctx);
     } else {
@@ -505,11 +578,30 @@ static IndexIterator *Query_EvalPrefixNode(QueryEvalCtx *q, QueryNode *qn) {
   rm_free(str);
   if (!ctx.its || ctx.nits == 0) {
     rm_free(ctx.its);
+    rm_free(pattern);
     return NULL;
-  } else {
-    return NewUnionIterator(ctx.its, ctx.nits, q->docTable, 1, qn->opts.weight,
-                            QN_PREFIX, qn->pfx.tok.str);
   }
+  size_t nits = ctx.nits;
+  IndexIterator **its = ctx.its;
+  IndexIterator *ret = newExpansionUnion(q, its, nits, qn->opts.weight, QN_PREFIX, qn->pfx.tok.str,
+                                         useCache);
+  // an expansion cut short by the timeout is not cached
+  if (useCache && TimedOut(&q->sctx->timeout) == NOT_TIMED_OUT) {
+    ExpansionPostings *postings = IndexIterator_AccumulatedPostings(ret);
+    if (postings) {
+      ExpansionTerm *terms = rm_malloc(nits * sizeof(*terms));
+      for (size_t i = 0; i < nits; ++i) {
+        const IndexReader *ir = its[i]->ctx;
+        const RSQueryTerm *term = ir->record->term.term;
+        terms[i] = (ExpansionTerm){.str = rm_strndup(term->str, term->len),
+                                   .len = term->len,
+                                   .numDocs = ir->idx->numDocs};
+      }
+      ExpansionCache_Put(spec->expcache, kind, pattern, plen, mask, postings, terms, nits);
+    }
+  }
+  rm_free(pattern);
+  return ret;
 }
 
 typedef struct {
@@ -615,7 +707,7 @@ static IndexIterator *Query_EvalLexRangeNode(QueryEvalCtx *q, QueryNode *lx) {
     rm_free(ctx.its);
     return NULL;
   } else {
-    return NewUnionIterator(ctx.its, ctx.nits, q->docTable, 1, lx->opts.weight, QN_LEXRANGE, NULL);
+    return newExpansionUnion(q, ctx.its, ctx.nits, lx->opts.weight, QN_LEXRANGE, NULL, 0);
   }
 }
 
@@ -629,6 +721,40 @@ static IndexIterator *Query_EvalFuzzyNode(QueryEvalCtx *q, QueryNode *qn) {
   return iterateExpandedTerms(q, terms, qn->pfx.tok.str, qn->pfx.tok.len, qn->fz.maxDist, 0, &qn->opts);
 }
 
+static IndexIterator *Query_EvalGeoKnnNode(QueryEvalCtx *q, QueryNode *node,
+                                           IndexIterator *filter) {
+  const GeoFilter *gf = node->gn.gf;
+  const FieldSpec *fs = IndexSpec_GetField(q->sctx->spec, gf->property, strlen(gf->property));
+  if (!fs || !FIELD_IS(fs, INDEXFLD_T_GEO)) {
+    goto error;
+  }
+  if (q->reqFlags & QEXEC_F_IS_EXTENDED) {
+    QueryError_SetErrorFmt(q->status, QUERY_EAGGPLAN, "Geo KNN is not yet supported on FT.AGGREGATE");
+    goto error;
+  }
+  // the distance is written to the results like the score of a vector query, which can only hold
+  // a single field
+  if (array_len(*q->vecScoreFieldNamesP)) {
+    QueryError_SetError(q->status, QUERY_EGENERIC, "Only one KNN clause is allowed in a query");
+    goto error;
+  }
+  if (!GeoFilter_Validate(gf, q->status)) {
+    goto error;
+  }
+  NumericRangeTree *t = OpenNumericIndexForQuery(q->sctx, gf->property, INDEXFLD_T_GEO);
+  if (!t) {
+    goto error;
+  }
+  array_ensure_append_1(*q->vecScoreFieldNamesP, gf->scoreField);
+  return NewGeoKnnIterator(q->sctx->spec, t, gf, filter);
+
+error:
+  if (filter) {
+    filter->Free(filter);
+  }
+  return NULL;
+}
+
 static IndexIterator *Query_EvalPhraseNode(QueryEvalCtx *q, QueryNode *qn) {
   if (qn->type != QN_PHRASE) {
     // printf("Not a phrase node!\n");
@@ -642,24 +768,15 @@ static IndexIterator *Query_EvalPhraseNode(QueryEvalCtx *q, QueryNode *qn) {
     return Query_EvalNode(q, qn->children[0]);
   }
 
-  // recursively eval the children
-  IndexIterator **iters = rm_calloc(QueryNode_NumChildren(qn), sizeof(IndexIterator *));
-  for (size_t ii = 0; ii < QueryNode_NumChildren(qn); ++ii) {
-    qn->children[ii]->opts.fieldMask &= qn->opts.fieldMask;
-    iters[ii] = Query_EvalNode(q, qn->children[ii]);
-  }
-  IndexIterator *ret;
-
-  if (node->exact) {
-    ret = NewIntersecIterator(iters, QueryNode_NumChildren(qn), q->docTable,
-                              EFFECTIVE_FIELDMASK(q, qn), 0, 1, qn->opts.weight);
-  } else {
+  int slop = 0;
+  int inOrder = 1;
+  if (!node->exact) {
     // Let the query node override the slop/order parameters
-    int slop = qn->opts.maxSlop;
+    slop = qn->opts.maxSlop;
     if (slop == -1) slop = q->opts->slop;
 
     // Let the query node override the inorder of the whole query
-    int inOrder = q->opts->flags & Search_InOrder;
+    inOrder = q->opts->flags & Search_InOrder;
     if (qn->opts.inOrder) inOrder = 1;
 
     // If in order was specified and not slop, set slop to maximum possible value.
@@ -667,11 +784,74 @@ static IndexIterator *Query_EvalPhraseNode(QueryEvalCtx *q, QueryNode *qn) {
     if (inOrder && slop == -1) {
       slop = __INT_MAX__;
     }
+  }
 
-    ret = NewIntersecIterator(iters, QueryNode_NumChildren(qn), q->docTable,
-                              EFFECTIVE_FIELDMASK(q, qn), slop, inOrder, qn->opts.weight);
+  // a geo knn clause looks for the nearest of the matches of the rest of the intersection, rather
+  // than intersecting the nearest points of the whole index with them
+  QueryNode *knn = NULL;
+  if (!node->exact) {
+    for (size_t ii = 0; ii < QueryNode_NumChildren(qn) && !knn; ++ii) {
+      QueryNode *child = qn->children[ii];
+      if (child->type == QN_GEO && child->gn.gf->knn) {
+        knn = child;
+      }
+    }
   }
-  return ret;
+
+  // the tag clauses of fields with bitsets are intersected word by word, into a single child
+  uint64_t *tagWords = NULL;
+  size_t tagNwords = 0, ntags = 0;
+  int isTagBitset[MAX(QueryNode_NumChildren(qn), 1)];
+  for (size_t ii = 0; ii < QueryNode_NumChildren(qn); ++ii) {
+    uint64_t *words;
+    size_t nwords;
+    isTagBitset[ii] = !node->exact && qn->children[ii]->type == QN_TAG &&
+                      Query_EvalTagBitset(q, qn->children[ii], &words, &nwords);
+    if (!isTagBitset[ii]) {
+      continue;
+    } else if (ntags++ == 0) {
+      tagWords = words;
+      tagNwords = nwords;
+      continue;
+    }
+    tagNwords = MIN(tagNwords, nwords);
+    for (size_t w = 0; w < tagNwords; ++w) {
+      tagWords[w] &= words[w];
+    }
+    rm_free(words);
+  }
+
+  // recursively eval the children
+  IndexIterator **iters = rm_calloc(QueryNode_NumChildren(qn), sizeof(IndexIterator *));
+  size_t nits = 0;
+  q->checkPositions += slop >= 0;
+  for (size_t ii = 0; ii < QueryNode_NumChildren(qn); ++ii) {
+    qn->children[ii]->opts.fieldMask &= qn->opts.fieldMask;
+    if (qn->children[ii] != knn && !isTagBitset[ii]) {
+      iters[nits++] = Query_EvalNode(q, qn->children[ii]);
+    }
+  }
+  q->checkPositions -= slop >= 0;
+  if (ntags) {
+    iters[nits++] = NewBitsetIterator(tagWords, tagNwords, qn->opts.weight);
+  }
+
+  if (!knn) {
+    return NewIntersecIterator(iters, nits, q->docTable, EFFECTIVE_FIELDMASK(q, qn), slop,
+                               inOrder, qn->opts.weight);
+  }
+  IndexIterator *filter = iters[0];
+  if (nits == 1) {
+    rm_free(iters);
+    // nothing matches the filter
+    if (!filter) {
+      return NULL;
+    }
+  } else {
+    filter = NewIntersecIterator(iters, nits, q->docTable, EFFECTIVE_FIELDMASK(q, qn), slop,
+                                 inOrder, qn->opts.weight);
+  }
+  return Query_EvalGeoKnnNode(q, knn, filter);
 }
 
 static IndexIterator *Query_EvalWildcardNode(QueryEvalCtx *q, QueryNode *qn) {
@@ -679,7 +859,7 @@ static IndexIterator *Query_EvalWildcardNode(QueryEvalCtx *q, QueryNode *qn) {
     return NULL;
   }
 
-  return NewWildcardIterator(q->docTable->maxDocId);
+  return NewWildcardIterator(q->docTable, q->docTable->maxDocId);
 }
 
 static IndexIterator *Query_EvalNotNode(QueryEvalCtx *q, QueryNode *qn) {
@@ -689,7 +869,7 @@ static IndexIterator *Query_EvalNotNode(QueryEvalCtx *q, QueryNode *qn) {
   QueryNotNode *node = &qn->inverted;
 
   return NewNotIterator(QueryNode_NumChildren(qn) ? Query_EvalNode(q, qn->children[0]) : NULL,
-                        q->docTable->maxDocId, qn->opts.weight);
+                        q->docTable, q->docTable->maxDocId, qn->opts.weight);
 }
 
 static IndexIterator *Query_EvalOptionalNode(QueryEvalCtx *q, QueryNode *qn) {
@@ -713,11 +893,18 @@ static IndexIterator *Query_EvalNumericNode(QueryEvalCtx *q, QueryNode *node) {
 
 static IndexIterator *Query_EvalGeofilterNode(QueryEvalCtx *q, QueryNode *node,
                                               double weight) {
+  if (node->gn.gf->knn) {
+    return Query_EvalGeoKnnNode(q, node, NULL);
+  }
   const FieldSpec *fs =
       IndexSpec_GetField(q->sctx->spec, node->gn.gf->property, strlen(node->gn.gf->property));
   if (!fs || !FIELD_IS(fs, INDEXFLD_T_GEO)) {
     return NULL;
   }
+  // the coordinates of a shape are only validated at parse time when they are parameters
+  if (node->gn.gf->shape != GEO_SHAPE_RADIUS && !GeoFilter_Validate(node->gn.gf, q->status)) {
+    return NULL;
+  }
   return NewGeoRangeIterator(q->sctx, node->gn.gf);
 }
 
@@ -796,10 +983,9 @@ typedef IndexIterator **IndexIteratorArray;
 
 static IndexIterator *Query_EvalTagLexRangeNode(QueryEvalCtx *q, TagIndex *idx, QueryNode *qn,
                                                 IndexIteratorArray *iterout, double weight) {
-  TrieMap *t = idx->values;
   LexRangeCtx ctx = {.q = q, .opts = &qn->opts, .weight = weight};
 
-  if (!t) {
+  if (!idx) {
     return NULL;
   }
 
@@ -807,19 +993,57 @@ static IndexIterator *Query_EvalTagLexRangeNode(QueryEvalCtx *q, TagIndex *idx,
   ctx.its = rm_malloc(sizeof(*ctx.its) * ctx.cap);
   ctx.nits = 0;
 
+  // the range is read from the sorted values, between the positions of its bounds. Bounds which
+  // are equal ignoring case only match the value of the lower bound itself
   const char *begin = qn->lxrng.begin, *end = qn->lxrng.end;
-  int nbegin = begin ? strlen(begin) : -1, nend = end ? strlen(end) : -1;
-
-  TrieMap_IterateRange(t, begin, nbegin, qn->lxrng.includeBegin, end, nend, qn->lxrng.includeEnd,
-                       rangeIterCbStrs, &ctx);
+  if (begin && end && !strcasecmp(begin, end)) {
+    InvertedIndex *iv = TagIndex_OpenIndex(idx, begin, strlen(begin), 0);
+    if (iv && (qn->lxrng.includeBegin || qn->lxrng.includeEnd)) {
+      rangeIterCbStrs(begin, strlen(begin), &ctx, iv);
+    }
+  } else {
+    TagValue **sorted = TagIndex_SortedValues(idx);
+    size_t first =
+        begin ? TagIndex_SeekValue(idx, begin, strlen(begin), !qn->lxrng.includeBegin) : 0;
+    size_t last = end ? TagIndex_SeekValue(idx, end, strlen(end), qn->lxrng.includeEnd)
+                      : TagIndex_NumValues(idx);
+    for (size_t i = first; i < last; ++i) {
+      rangeIterCbStrs(sorted[i]->str, sorted[i]->len, &ctx, sorted[i]->iv);
+    }
+  }
   if (ctx.nits == 0) {
     rm_free(ctx.its);
     return NULL;
   } else {
-    return NewUnionIterator(ctx.its, ctx.nits, q->docTable, 1, qn->opts.weight, QN_LEXRANGE, NULL);
+    return newExpansionUnion(q, ctx.its, ctx.nits, qn->opts.weight, QN_LEXRANGE, NULL, 0);
   }
 }
 
+typedef struct {
+  QueryEvalCtx *q;
+  TagIndex *idx;
+  IndexIterator **its;
+  size_t nits;
+  size_t cap;
+} TagExpansionCtx;
+
+static int tagNgramIterCb(const char *s, size_t n, void *p) {
+  TagExpansionCtx *ctx = p;
+  if (ctx->nits >= RSGlobalConfig.maxPrefixExpansions) {
+    return REDISEARCH_ERR;
+  }
+  IndexIterator *ret = TagIndex_OpenReader(ctx->idx, ctx->q->sctx->spec, s, n, 1);
+  if (!ret) {
+    return REDISEARCH_OK;
+  }
+  ctx->its[ctx->nits++] = ret;
+  if (ctx->nits == ctx->cap) {
+    ctx->cap *= 2;
+    ctx->its = rm_realloc(ctx->its, ctx->cap * sizeof(*ctx->its));
+  }
+  return REDISEARCH_OK;
+}
+
 /* Evaluate a tag prefix by expanding it with a lookup on the tag index */
 static IndexIterator *Query_EvalTagPrefixNode(QueryEvalCtx *q, TagIndex *idx, QueryNode *qn,
                                               IndexIteratorArray *iterout, double weight,
@@ -833,38 +1057,66 @@ static IndexIterator *Query_EvalTagPrefixNode(QueryEvalCtx *q, TagIndex *idx, Qu
   if (tok->len < RSGlobalConfig.minTermPrefix) {
     return NULL;
   }
-  if (!idx || !idx->values) return NULL;
+  if (!idx) return NULL;
 
   size_t itsSz = 0, itsCap = 8;
   IndexIterator **its = rm_calloc(itsCap, sizeof(*its));
 
-  if (!qn->pfx.suffix || !withSuffixTrie) {    // prefix query or no suffix triemap, use bruteforce
-    TrieMapIterator *it = TrieMap_Iterate(idx->values, tok->str, tok->len);
-    TrieMapIterator_SetTimeout(it, q->sctx->timeout);
-    TrieMapIterator_NextFunc nextFunc = TrieMapIterator_Next;
-    if (!it) return NULL;
+  if (qn->pfx.suffix && idx->ngrams) {    // TAG field has an n-gram index
+    TagExpansionCtx ctx = {.q = q, .idx = idx, .its = its, .nits = itsSz, .cap = itsCap};
+    NgramIndex_IterateContains(idx->ngrams, tok->str, tok->len, qn->pfx.prefix, tagNgramIterCb,
+                               &ctx, &q->sctx->timeout);
+    its = ctx.its;
+    itsSz = ctx.nits;
+    itsCap = ctx.cap;
+  } else if (!qn->pfx.suffix) {    // prefix query, use the sorted values
+    // the completions of a prefix follow its position in the sorted values, among the values
+    // which start with it ignoring case
+    TagValue **sorted = TagIndex_SortedValues(idx);
+    size_t n = TagIndex_NumValues(idx), counter = 0;
 
-    if (qn->pfx.suffix) {
-      nextFunc = TrieMapIterator_NextContains;
-      if (qn->pfx.prefix) { // contains mode
-        it->mode = TM_CONTAINS_MODE;
-      } else {
-        it->mode = TM_SUFFIX_MODE;
+    // an upper limit on the number of expansions is enforced to avoid stuff like "*"
+    for (size_t i = TagIndex_SeekValue(idx, tok->str, tok->len, 0);
+         i < n && itsSz < RSGlobalConfig.maxPrefixExpansions; ++i) {
+      if (TimedOut_WithCounter(&q->sctx->timeout, &counter)) {
+        break;
       }
-    }
-
+      const TagValue *tv = sorted[i];
+      if (tv->len < tok->len || strncasecmp(tv->str, tok->str, tok->len)) {
+        break;
+      } else if (memcmp(tv->str, tok->str, tok->len)) {
+        continue;
+      }
+      IndexIterator *ret = TagIndex_OpenReader(idx, q->sctx->spec, tv->str, tv->len, 1);
+      if (!ret) continue;
 
-    // an upper limit on the number of expansions is enforced to avoid stuff like "*"
-    char *s;
-    tm_len_t sl;
-    void *ptr;
-
-    // Find all completions of the prefix
-    while (nextFunc(it, &s, &sl, &ptr) &&
-          (itsSz < RSGlobalConfig.maxPrefixExpansions)) {
-            // TODO: use NewIndexReaderGeneric
-      //NewIndexReaderGeneric(ptr, q->sctx->spec, )
-      IndexIterator *ret = TagIndex_OpenReader(idx, q->sctx->spec, s, sl, 1);
+      // Add the reader to the iterator array
+      its[itsSz++] = ret;
+      if (itsSz == itsCap) {
+        itsCap *= 2;
+        its = rm_realloc(its, itsCap * sizeof(*its));
+      }
+    }
+  } else if (!withSuffixTrie) {    // no suffix triemap, use bruteforce
+    // the values containing or ending with the token are looked for among all values, in no
+    // particular order. Opening the readers looks the values up, which must not rehash the dict
+    size_t counter = 0;
+    dictIterator *it = dictGetSafeIterator(idx->values);
+    dictEntry *e;
+    while ((e = dictNext(it)) && itsSz < RSGlobalConfig.maxPrefixExpansions) {
+      if (TimedOut_WithCounter(&q->sctx->timeout, &counter)) {
+        break;
+      }
+      const TagValue *tv = dictGetKey(e);
+      if (qn->pfx.prefix) {  // contains mode
+        if (!memmem(tv->str, tv->len, tok->str, tok->len)) {
+          continue;
+        }
+      } else if (tv->len < tok->len ||
+                 memcmp(tv->str + tv->len - tok->len, tok->str, tok->len)) {
+        continue;
+      }
+      IndexIterator *ret = TagIndex_OpenReader(idx, q->sctx->spec, tv->str, tv->len, 1);
       if (!ret) continue;
 
       // Add the reader to the iterator array
@@ -874,7 +1126,7 @@ static IndexIterator *Query_EvalTagPrefixNode(QueryEvalCtx *q, TagIndex *idx, Qu
         its = rm_realloc(its, itsCap * sizeof(*its));
       }
     }
-    TrieMapIterator_Free(it);
+    dictReleaseIterator(it);
   } else {    // TAG field has suffix triemap
     arrayof(char**) arr = GetList_SuffixTrieMap(idx->suffix, tok->str, tok->len,
                                                 qn->pfx.prefix, q->sctx->timeout);
@@ -913,7 +1165,7 @@ static IndexIterator *Query_EvalTagPrefixNode(QueryEvalCtx *q, TagIndex *idx, Qu
   }
 
   *iterout = array_ensure_append(*iterout, its, itsSz, IndexIterator *);
-  return NewUnionIterator(its, itsSz, q->docTable, 1, weight, QN_PREFIX, qn->pfx.tok.str);
+  return newExpansionUnion(q, its, itsSz, weight, QN_PREFIX, qn->pfx.tok.str, 0);
 }
 
 static void tag_strtolower(char *str, size_t *len, int caseSensitive) {
@@ -985,10 +1237,79 @@ static IndexIterator *query_EvalSingleTagNode(QueryEvalCtx *q, TagIndex *idx, Qu
   return ret;
 }
 
+/* Compute the union of the bitsets of the values of a tag node into words. This is only done when
+ * the field keeps bitsets, the node has no prefixes or ranges, and its values have at least one
+ * document per word of the bitsets on average, so that the word-level union costs no more than
+ * merging the inverted indexes of the values. Returns 1 if the union was computed */
+static int Query_EvalTagBitset(QueryEvalCtx *q, QueryNode *qn, uint64_t **words, size_t *nwords) {
+  const FieldSpec *fs =
+      IndexSpec_GetField(q->sctx->spec, qn->tag.fieldName, strlen(qn->tag.fieldName));
+  if (!fs || !(fs->tagOpts.tagFlags & TagField_Bitset) || !QueryNode_NumChildren(qn)) {
+    return 0;
+  }
+  for (size_t i = 0; i < QueryNode_NumChildren(qn); i++) {
+    if (qn->children[i]->type != QN_TOKEN) {
+      return 0;
+    }
+  }
+  RedisModuleKey *k = NULL;
+  RedisModuleString *kstr = IndexSpec_GetFormattedKey(q->sctx->spec, fs, INDEXFLD_T_TAG);
+  TagIndex *idx = TagIndex_Open(q->sctx, kstr, 0, &k);
+  if (!idx) {
+    if (k) {
+      RedisModule_CloseKey(k);
+    }
+    return 0;
+  }
+  // the bitsets are not saved, so they are built on the first use after a reload
+  TagIndex_EnableBitsets(idx);
+
+  size_t n = QueryNode_NumChildren(qn), numDocs = 0;
+  const TagBitset *bitsets[n];
+  for (size_t i = 0; i < n; i++) {
+    // the values are normalized as by query_EvalSingleTagNode, which may still evaluate the node
+    size_t len = qn->children[i]->tn.len;
+    char *value = rm_strndup(qn->children[i]->tn.str, len);
+    tag_strtolower(value, &len, fs->tagOpts.tagFlags & TagField_CaseSensitive);
+    bitsets[i] = TagIndex_GetBitset(idx, value, len);
+    InvertedIndex *iv = TagIndex_OpenIndex(idx, value, len, 0);
+    if (iv) {
+      numDocs += iv->numDocs;
+    }
+    rm_free(value);
+  }
+
+  int ret = numDocs * 64 >= q->docTable->maxDocId;
+  if (ret) {
+    *nwords = 0;
+    for (size_t i = 0; i < n; i++) {
+      if (bitsets[i]) {
+        *nwords = MAX(*nwords, bitsets[i]->nwords);
+      }
+    }
+    *words = rm_calloc(MAX(*nwords, 1), sizeof(**words));
+    for (size_t i = 0; i < n; i++) {
+      for (size_t w = 0; bitsets[i] && w < bitsets[i]->nwords; ++w) {
+        (*words)[w] |= bitsets[i]->words[w];
+      }
+    }
+  }
+  if (k) {
+    RedisModule_CloseKey(k);
+  }
+  return ret;
+}
+
 static IndexIterator *Query_EvalTagNode(QueryEvalCtx *q, QueryNode *qn) {
   if (qn->type != QN_TAG) {
     return NULL;
   }
+  // a union of the values of a field with bitsets is read from the union of their bitsets
+  uint64_t *words;
+  size_t nwords;
+  if (QueryNode_NumChildren(qn) > 1 && Query_EvalTagBitset(q, qn, &words, &nwords)) {
+    return NewBitsetIterator(words, nwords, qn->opts.weight);
+  }
   QueryTagNode *node = &qn->tag;
   RedisModuleKey *k = NULL;
   const FieldSpec *fs = IndexSpec_GetField(q->sctx->spec, node->fieldName, strlen(node->fieldName));
@@ -1391,6 +1712,19 @@ static sds QueryNode_DumpSds(sds s, const IndexSpec *spec, const QueryNode *qs,
       break;
     case QN_GEO:
 
+      if (qs->gn.gf->knn) {
+        s = sdscatprintf(s, "GEO %s:{KNN %zu %f,%f", qs->gn.gf->property, qs->gn.gf->k,
+                         qs->gn.gf->lon, qs->gn.gf->lat);
+        break;
+      }
+      if (qs->gn.gf->shape != GEO_SHAPE_RADIUS) {
+        s = sdscatprintf(s, "GEO %s:{%s", qs->gn.gf->property,
+                         qs->gn.gf->shape == GEO_SHAPE_BOX ? "BBOX" : "POLYGON");
+        for (size_t ii = 0; ii < qs->gn.gf->numCoords; ii += 2) {
+          s = sdscatprintf(s, " %f,%f", qs->gn.gf->coords[ii], qs->gn.gf->coords[ii + 1]);
+        }
+        break;
+      }
       s = sdscatprintf(s, "GEO %s:{%f,%f --> %f %s", qs->gn.gf->property, qs->gn.gf->lon,
                        qs->gn.gf->lat, qs->gn.gf->radius,
                        GeoDistance_ToString(qs->gn.gf->unitType));
@@ -1491,6 +1825,114 @@ void QAST_Print(const QueryAST *ast, const IndexSpec *spec) {
   sdsfree(s);
 }
 
+/* Strings are length prefixed so that no two trees serialize alike. Strings containing a NUL byte
+ * cannot be part of a key */
+static sds serializeKeyStr(sds s, const char *str, size_t len) {
+  if (!str) {
+    return sdscat(s, "-;");
+  }
+  if (memchr(str, '\0', len)) {
+    sdsfree(s);
+    return NULL;
+  }
+  s = sdscatprintf(s, "%zu:", len);
+  return sdscatlen(s, str, len);
+}
+
+static sds QueryNode_SerializeKey(sds s, const QueryNode *qn) {
+  const QueryNodeOptions *o = &qn->opts;
+  s = sdscatprintf(s, "(%d %x %llx:%llx %d %d %a %d ", (int)qn->type, (unsigned)o->flags,
+                   (unsigned long long)(o->fieldMask >> 32 >> 32),
+                   (unsigned long long)o->fieldMask, o->maxSlop, o->inOrder, o->weight,
+                   o->phonetic);
+
+  switch (qn->type) {
+    case QN_PHRASE:
+      s = sdscatprintf(s, "%d", qn->pn.exact);
+      break;
+    case QN_TOKEN:
+      s = sdscatprintf(s, "%d %x ", (int)qn->tn.expanded, (unsigned)qn->tn.flags);
+      s = serializeKeyStr(s, qn->tn.str, qn->tn.len);
+      break;
+    case QN_PREFIX:
+      s = sdscatprintf(s, "%d %d ", (int)qn->pfx.prefix, (int)qn->pfx.suffix);
+      s = serializeKeyStr(s, qn->pfx.tok.str, qn->pfx.tok.len);
+      break;
+    case QN_FUZZY:
+      s = sdscatprintf(s, "%d ", qn->fz.maxDist);
+      s = serializeKeyStr(s, qn->fz.tok.str, qn->fz.tok.len);
+      break;
+    case QN_LEXRANGE:
+      s = sdscatprintf(s, "%d %d ", (int)qn->lxrng.includeBegin, (int)qn->lxrng.includeEnd);
+      s = serializeKeyStr(s, qn->lxrng.begin, qn->lxrng.begin ? strlen(qn->lxrng.begin) : 0);
+      if (s) {
+        s = serializeKeyStr(s, qn->lxrng.end, qn->lxrng.end ? strlen(qn->lxrng.end) : 0);
+      }
+      break;
+    case QN_NUMERIC: {
+      const NumericFilter *f = qn->nn.nf;
+      s = sdscatprintf(s, "%a %d %a %d ", f->min, f->inclusiveMin, f->max, f->inclusiveMax);
+      s = serializeKeyStr(s, f->fieldName, f->fieldName ? strlen(f->fieldName) : 0);
+      break;
+    }
+    case QN_GEO: {
+      const GeoFilter *gf = qn->gn.gf;
+      // the distances of a knn query are not kept by the cache, like vector scores
+      if (gf->knn) {
+        sdsfree(s);
+        return NULL;
+      }
+      s = sdscatprintf(s, "%a %a %a %d %d ", gf->lon, gf->lat, gf->radius, (int)gf->unitType,
+                       (int)gf->shape);
+      for (size_t ii = 0; ii < gf->numCoords; ++ii) {
+        s = sdscatprintf(s, "%a ", gf->coords[ii]);
+      }
+      s = serializeKeyStr(s, gf->property, gf->property ? strlen(gf->property) : 0);
+      break;
+    }
+    case QN_IDS:
+      for (size_t ii = 0; ii < qn->fn.len; ++ii) {
+        s = sdscatprintf(s, "%llu,", (unsigned long long)qn->fn.ids[ii]);
+      }
+      break;
+    case QN_TAG:
+      s = serializeKeyStr(s, qn->tag.fieldName, qn->tag.len);
+      break;
+    case QN_VECTOR:
+      // vector queries carry their own scores, which are not kept by the cache
+      sdsfree(s);
+      return NULL;
+    case QN_UNION:
+    case QN_NOT:
+    case QN_OPTIONAL:
+    case QN_WILDCARD:
+    case QN_NULL:
+      break;
+  }
+
+  for (size_t ii = 0; s && ii < QueryNode_NumChildren(qn); ++ii) {
+    s = sdscat(s, " ");
+    s = QueryNode_SerializeKey(s, qn->children[ii]);
+  }
+  return s ? sdscat(s, ")") : NULL;
+}
+
+sds QAST_SerializeKey(const QueryAST *q, const RSSearchOptions *opts) {
+  sds s = sdsempty();
+  s = sdscatprintf(s, "%x %llx:%llx %d %d ", opts->flags,
+                   (unsigned long long)(opts->fieldmask >> 32 >> 32),
+                   (unsigned long long)opts->fieldmask, opts->slop, (int)opts->language);
+  s = serializeKeyStr(s, opts->scorerName, opts->scorerName ? strlen(opts->scorerName) : 0);
+  if (s) {
+    s = serializeKeyStr(s, q->udata, q->udatalen);
+  }
+  if (s && q->root) {
+    s = sdscat(s, " ");
+    s = QueryNode_SerializeKey(s, q->root);
+  }
+  return s;
+}
+
 int QueryNode_ForEach(QueryNode *q, QueryNode_ForEachCallback callback, void *ctx, int reverse) {
 #define INITIAL_ARRAY_NODE_SIZE 5
   QueryNode **nodes = array_new(QueryNode *, INITIAL_ARRAY_NODE_SIZE);
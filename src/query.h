@@ -115,6 +115,14 @@ char *QAST_DumpExplain(const QueryAST *q, const IndexSpec *spec);
 /** Print a representation of the query to standard output */
 void QAST_Print(const QueryAST *ast, const IndexSpec *spec);
 
+/**
+ * Serialize the parsed and expanded query, along with the search options affecting its results,
+ * into a key identifying its results. Unlike the explain output, two queries have the same key
+ * only if they match the same documents with the same scores. Returns NULL if the query cannot be
+ * identified this way. The key should be freed by the caller with sdsfree
+ */
+sds QAST_SerializeKey(const QueryAST *q, const RSSearchOptions *opts);
+
 /* Cleanup a query AST */
 void QAST_Destroy(QueryAST *q);
 
@@ -13,4 +13,6 @@ typedef struct QueryEvalCtx {
   uint32_t tokenId;
   DocTable *docTable;
   uint32_t reqFlags;
+  // number of enclosing phrases which check the positions of their terms
+  uint32_t checkPositions;
 } QueryEvalCtx;
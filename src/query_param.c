@@ -28,6 +28,35 @@ QueryParam *NewGeoFilterQueryParam_WithParams(struct QueryParseCtx *q, QueryToke
   return ret;
 }
 
+QueryParam *NewGeoKnnQueryParam_WithParams(struct QueryParseCtx *q, QueryToken *k, QueryToken *lon, QueryToken *lat) {
+  QueryParam *ret = NewQueryParam(QP_GEO_FILTER);
+
+  GeoFilter *gf = NewGeoFilter(0, 0, 0, NULL, 0);
+  gf->knn = 1;
+  ret->gf = gf;
+  QueryParam_InitParams(ret, 3);
+  QueryParam_SetParam(q, &ret->params[0], &gf->k, NULL, k);
+  QueryParam_SetParam(q, &ret->params[1], &gf->lon, NULL, lon);
+  QueryParam_SetParam(q, &ret->params[2], &gf->lat, NULL, lat);
+  return ret;
+}
+
+QueryParam *NewGeoShapeQueryParam_WithParams(struct QueryParseCtx *q, GeoShape shape, QueryToken *coords, size_t n) {
+  QueryParam *ret = NewQueryParam(QP_GEO_FILTER);
+
+  GeoFilter *gf = NewGeoFilter(0, 0, 0, NULL, 0);
+  gf->shape = shape;
+  // the params point into the coords, so they are allocated up front
+  gf->coords = rm_calloc(n, sizeof(*gf->coords));
+  gf->numCoords = n;
+  ret->gf = gf;
+  QueryParam_InitParams(ret, n);
+  for (size_t ii = 0; ii < n; ++ii) {
+    QueryParam_SetParam(q, &ret->params[ii], &gf->coords[ii], NULL, &coords[ii]);
+  }
+  return ret;
+}
+
 QueryParam *NewNumericFilterQueryParam_WithParams(struct QueryParseCtx *q, QueryToken *min, QueryToken *max, int inclusiveMin, int inclusiveMax) {
   QueryParam *ret = NewQueryParam(QP_NUMERIC_FILTER);
   NumericFilter *nf = NewNumericFilter(0, 0, inclusiveMin, inclusiveMax);
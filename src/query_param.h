@@ -22,6 +22,8 @@ typedef struct {
 
 QueryParam *NewQueryParam(QueryParamType type);
 QueryParam *NewGeoFilterQueryParam_WithParams(struct QueryParseCtx *q, QueryToken *lon, QueryToken *lat, QueryToken *radius, QueryToken *unit);
+QueryParam *NewGeoKnnQueryParam_WithParams(struct QueryParseCtx *q, QueryToken *k, QueryToken *lon, QueryToken *lat);
+QueryParam *NewGeoShapeQueryParam_WithParams(struct QueryParseCtx *q, GeoShape shape, QueryToken *coords, size_t n);
 
 QueryParam *NewNumericFilterQueryParam_WithParams(struct QueryParseCtx *q, QueryToken *min, QueryToken *max, int inclusiveMin, int inclusiveMax);
 
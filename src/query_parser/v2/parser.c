@@ -187,20 +187,21 @@ static void reportSyntaxError(QueryError *status, QueryToken* tok, const char *m
 #endif
 /************* Begin control #defines *****************************************/
 #define YYCODETYPE unsigned char
-#define YYNOCODE 62
+#define YYNOCODE 63
 #define YYACTIONTYPE unsigned short int
 #define RSQueryParser_v2_TOKENTYPE QueryToken
 typedef union {
   int yyinit;
   RSQueryParser_v2_TOKENTYPE yy0;
-  QueryParam * yy6;
-  VectorQueryParams yy46;
-  SingleVectorQueryParam yy53;
-  RangeNumber yy95;
-  QueryAttribute yy99;
-  QueryNode * yy103;
-  Vector* yy110;
-  QueryAttribute * yy121;
+  SingleVectorQueryParam yy5;
+  QueryToken * yy14;
+  QueryAttribute * yy27;
+  VectorQueryParams yy32;
+  QueryNode * yy35;
+  QueryParam * yy50;
+  QueryAttribute yy55;
+  RangeNumber yy83;
+  Vector* yy120;
 } YYMINORTYPE;
 #ifndef YYSTACKDEPTH
 #define YYSTACKDEPTH 256
@@ -216,18 +217,18 @@ typedef union {
 #define RSQueryParser_v2_CTX_FETCH
 #define RSQueryParser_v2_CTX_STORE
 #define YYFALLBACK 1
-#define YYNSTATE             115
-#define YYNRULE              99
-#define YYNRULE_WITH_ACTION  95
+#define YYNSTATE             116
+#define YYNRULE              102
+#define YYNRULE_WITH_ACTION  98
 #define YYNTOKEN             33
-#define YY_MAX_SHIFT         114
-#define YY_MIN_SHIFTREDUCE   181
-#define YY_MAX_SHIFTREDUCE   279
-#define YY_ERROR_ACTION      280
-#define YY_ACCEPT_ACTION     281
-#define YY_NO_ACTION         282
-#define YY_MIN_REDUCE        283
-#define YY_MAX_REDUCE        381
+#define YY_MAX_SHIFT         115
+#define YY_MIN_SHIFTREDUCE   185
+#define YY_MAX_SHIFTREDUCE   286
+#define YY_ERROR_ACTION      287
+#define YY_ACCEPT_ACTION     288
+#define YY_NO_ACTION         289
+#define YY_MIN_REDUCE        290
+#define YY_MAX_REDUCE        391
 /************* End control #defines *******************************************/
 #define YY_NLOOKAHEAD ((int)(sizeof(yy_lookahead)/sizeof(yy_lookahead[0])))
 
@@ -294,192 +295,197 @@ typedef union {
 **  yy_default[]       Default action for each state.
 **
 *********** Begin parsing tables **********************************************/
-#define YY_ACTTAB_COUNT (668)
+#define YY_ACTTAB_COUNT (693)
 static const YYACTIONTYPE yy_action[] = {
- /*     0 */    84,   42,  314,  104,   12,  230,  199,  113,   38,  266,
- /*    10 */    44,   15,  360,   45,   13,   14,   57,   92,   72,  267,
- /*    20 */   268,  213,  313,  352,   58,  221,  222,  223,   56,  269,
- /*    30 */    16,  230,  200,   68,  110,  266,   44,   15,  266,  111,
- /*    40 */    13,   14,   63,  112,  105,  267,  268,  213,  267,  268,
- /*    50 */    96,  221,  222,  223,   56,  269,  283,   62,  269,  317,
- /*    60 */    12,  230,  377,  279,  278,  266,   44,   15,  266,   47,
- /*    70 */    13,   14,  355,   77,  363,  267,  268,  213,  267,  268,
- /*    80 */    94,  221,  222,  223,   56,  269,  284,   55,  269,  342,
- /*    90 */   270,  230,   60,   87,   42,  266,   44,    1,  314,  271,
- /*   100 */    13,   14,  102,  113,   39,  267,  268,  213,  276,   66,
- /*   110 */   358,  221,  222,  223,   56,  269,   16,  230,  313,  304,
- /*   120 */    78,  266,   44,   15,  266,  208,   13,   14,  364,   75,
- /*   130 */   316,  267,  268,  213,  267,  268,  216,  221,  222,  223,
- /*   140 */    56,  269,   12,  230,  269,   91,   42,  266,   44,   15,
- /*   150 */   266,  206,   13,   14,  303,   92,   73,  267,  268,  213,
- /*   160 */   267,  268,  254,  221,  222,  223,   56,  269,   16,  230,
- /*   170 */   269,  304,   82,  266,   44,   15,   74,  108,   13,   14,
- /*   180 */   334,  112,  333,  267,  268,  213,  285,  107,  106,  221,
- /*   190 */   222,  223,   56,  269,   34,   43,  200,  109,  233,  266,
- /*   200 */    44,   33,  266,   88,   31,   32,   70,  112,  230,  267,
- /*   210 */   268,  213,  267,  268,  216,  221,  222,  223,   56,  269,
- /*   220 */    30,  230,  269,   54,   50,  266,   44,    1,  314,  266,
- /*   230 */    13,   14,   71,  113,   36,  267,  268,  213,  276,  267,
- /*   240 */   268,  221,  222,  223,   56,  269,   26,  230,  313,  269,
- /*   250 */    89,  266,   44,   15,  266,  305,   13,   14,  349,   92,
- /*   260 */    83,  267,  268,  213,  267,  268,   99,  221,  222,  223,
- /*   270 */    56,  269,  338,  230,  269,   61,  350,  266,   44,   15,
- /*   280 */    80,  207,   13,   14,  255,  112,  277,  267,  268,  213,
- /*   290 */    53,   52,   67,  221,  222,  223,   56,  269,  266,   44,
- /*   300 */    33,   40,   49,   31,   32,   51,   74,  314,  267,  268,
- /*   310 */   213,  359,  113,   37,  221,  222,  223,   56,  269,   34,
- /*   320 */    86,  377,  351,   58,  266,   44,   33,  313,   93,   31,
- /*   330 */    32,  348,  112,  314,  267,  268,  213,  263,  113,   27,
- /*   340 */   221,  222,  223,   56,  269,   90,  230,  264,  265,  227,
- /*   350 */   266,   44,   15,  313,   53,   13,   14,  245,  228,  282,
- /*   360 */   267,  268,  213,   95,  229,  367,  221,  222,  223,   56,
- /*   370 */   269,  266,   44,   33,   97,   98,   31,   32,  226,  112,
- /*   380 */   314,  267,  268,  213,  366,  113,   29,  221,  222,  223,
- /*   390 */    56,  269,  266,   44,   33,  100,  101,   31,   32,  377,
- /*   400 */   313,  225,  267,  268,  213,  103,   46,  377,  221,  222,
- /*   410 */   223,   56,  269,    4,   48,   92,  314,  267,  268,  213,
- /*   420 */   114,  113,    5,  221,  222,  223,   56,  269,  224,  365,
- /*   430 */    79,   69,   54,  281,   76,   81,  313,    2,   35,  112,
- /*   440 */   314,  267,  268,  213,  114,  113,    3,  221,  222,  223,
- /*   450 */    56,  269,  210,  209,   79,   17,  282,  314,   85,   81,
- /*   460 */   313,   22,  113,   28,  314,  282,  282,  282,  114,  113,
- /*   470 */    25,  282,  282,   23,  282,  282,  314,  313,   79,  282,
- /*   480 */   114,  113,   24,   81,  313,    9,  282,  282,  314,  282,
- /*   490 */    79,  282,  114,  113,   10,   81,  313,  282,  282,  282,
- /*   500 */   282,  282,   79,   19,  282,  282,  314,   81,  313,  282,
- /*   510 */   114,  113,   20,  282,   18,  282,  282,  314,  282,  282,
- /*   520 */    79,  114,  113,   21,   65,   81,  313,  282,   64,  282,
- /*   530 */   282,   79,  260,  259,  282,  282,   81,  313,  282,  282,
- /*   540 */     2,  282,  273,  314,  282,  282,  282,  114,  113,    3,
- /*   550 */   282,    8,  282,  282,  314,  282,  282,   79,  114,  113,
- /*   560 */    11,   65,   81,  313,  282,   64,  282,  282,   79,  260,
- /*   570 */   259,  282,  282,   81,  313,  282,  282,    6,  282,  282,
- /*   580 */   314,  282,  282,  282,  114,  113,    7,  274,  282,   59,
- /*   590 */   282,  282,  282,   64,   79,  282,  282,  260,  259,   81,
- /*   600 */   313,  282,  282,  282,  267,  268,  213,  272,  282,  266,
- /*   610 */   221,  222,  223,   56,  269,  282,  282,  282,  282,  267,
- /*   620 */   268,  235,  266,  282,  282,  221,  222,  223,  282,  269,
- /*   630 */   282,  282,  267,  268,  239,  282,  282,  282,  221,  222,
- /*   640 */   223,  282,  269,  243,  274,  282,   59,  314,  282,  282,
- /*   650 */    64,  282,  113,   41,  260,  259,  346,  282,  282,  282,
- /*   660 */   282,  282,  282,  344,  272,  282,  282,  313,
+ /*     0 */    86,   42,  321,  105,   12,  234,  203,  114,   38,  273,
+ /*    10 */    45,   15,   65,   43,   13,   14,  237,   94,  106,  274,
+ /*    20 */   275,  217,  292,  320,   74,  225,  226,  227,   58,  276,
+ /*    30 */    16,  234,  204,  286,  285,  273,   45,   15,  273,   90,
+ /*    40 */    13,   14,  112,  113,   59,  274,  275,  217,  274,  275,
+ /*    50 */    97,  225,  226,  227,   58,  276,  290,   64,  276,  324,
+ /*    60 */    12,  234,   70,  111,  210,  273,   45,   15,  273,  349,
+ /*    70 */    13,   14,   62,   79,  211,  274,  275,  217,  274,  275,
+ /*    80 */    95,  225,  226,  227,   58,  276,  291,   57,  276,   76,
+ /*    90 */    68,  234,   89,   42,  365,  273,   45,    1,  321,   76,
+ /*   100 */    13,   14,  387,  114,   39,  274,  275,  217,  283,  357,
+ /*   110 */   373,  225,  226,  227,   58,  276,   16,  234,  103,  320,
+ /*   120 */   368,  273,   45,   15,  273,  212,   13,   14,  374,   77,
+ /*   130 */   323,  274,  275,  217,  274,  275,  220,  225,  226,  227,
+ /*   140 */    58,  276,   12,  234,  276,   93,   42,  273,   45,   15,
+ /*   150 */   273,  310,   13,   14,  341,   94,   91,  274,  275,  217,
+ /*   160 */   274,  275,  261,  225,  226,  227,   58,  276,   16,  234,
+ /*   170 */   276,  277,  340,  273,   45,   15,  370,   46,   13,   14,
+ /*   180 */   278,  113,   75,  274,  275,  217,  369,  362,   60,  225,
+ /*   190 */   226,  227,   58,  276,   34,  312,  204,  361,   60,  273,
+ /*   200 */    45,   33,  273,  234,   31,   32,   72,  113,  359,  274,
+ /*   210 */   275,  217,  274,  275,  220,  225,  226,  227,   58,  276,
+ /*   220 */    30,  234,  276,  311,   80,  273,   45,    1,  321,  270,
+ /*   230 */    13,   14,   73,  114,   36,  274,  275,  217,  283,  271,
+ /*   240 */   272,  225,  226,  227,   58,  276,   26,  234,   85,  320,
+ /*   250 */   284,  273,   45,   15,  273,  360,   13,   14,  262,   94,
+ /*   260 */    88,  274,  275,  217,  274,  275,  100,  225,  226,  227,
+ /*   270 */    58,  276,  358,  234,  276,  311,   84,  273,   45,   15,
+ /*   280 */    53,   92,   13,   14,  231,  113,  321,  274,  275,  217,
+ /*   290 */    55,  114,   37,  225,  226,  227,   58,  276,  273,   45,
+ /*   300 */    33,   40,   51,   31,   32,  232,  321,  320,  274,  275,
+ /*   310 */   217,  114,   27,   96,  225,  226,  227,   58,  276,   34,
+ /*   320 */   233,  387,   56,   52,  273,   45,   33,  320,   49,   31,
+ /*   330 */    32,   98,  113,  321,  274,  275,  217,  109,  114,   29,
+ /*   340 */   225,  226,  227,   58,  276,  377,  234,  108,  107,   99,
+ /*   350 */   273,   45,   15,  321,  320,   13,   14,  110,  114,   28,
+ /*   360 */   274,  275,  217,   55,   54,  230,  225,  226,  227,   58,
+ /*   370 */   276,  273,   45,   33,  320,  376,   31,   32,  387,  113,
+ /*   380 */   101,  274,  275,  217,  102,   44,  229,  225,  226,  227,
+ /*   390 */    58,  276,  273,   45,   33,  104,  228,   31,   32,  387,
+ /*   400 */   375,   47,  274,  275,  217,  214,   48,  387,  225,  226,
+ /*   410 */   227,   58,  276,    4,  356,   94,  321,  274,  275,  217,
+ /*   420 */   115,  114,    5,  225,  226,  227,   58,  276,  213,   71,
+ /*   430 */    35,   81,   56,   17,  288,   78,   83,  320,    2,  289,
+ /*   440 */   113,  321,  274,  275,  217,  115,  114,    3,  225,  226,
+ /*   450 */   227,   58,  276,  289,  289,  289,   81,  289,  321,  387,
+ /*   460 */    87,   83,  320,  114,   41,   22,   50,  353,  321,  289,
+ /*   470 */   289,  273,  115,  114,   25,  351,  289,   23,  289,  320,
+ /*   480 */   321,  274,  275,   81,  115,  114,   24,  289,   83,  320,
+ /*   490 */     9,  276,  289,  321,  289,   81,  289,  115,  114,   10,
+ /*   500 */    83,  320,   19,  289,  289,  321,  289,  289,   81,  115,
+ /*   510 */   114,   20,  289,   83,  320,  289,  289,  289,  289,  289,
+ /*   520 */    81,  289,  289,  289,   18,   83,  320,  321,  289,  289,
+ /*   530 */   289,  115,  114,   21,  289,  289,    2,  289,  289,  321,
+ /*   540 */   289,  289,   81,  115,  114,    3,  289,   83,  320,  289,
+ /*   550 */   289,  289,  289,  289,   81,  289,  289,  289,    8,   83,
+ /*   560 */   320,  321,  289,  289,  289,  115,  114,   11,  289,  289,
+ /*   570 */     6,  289,  289,  321,  289,  289,   81,  115,  114,    7,
+ /*   580 */   289,   83,  320,  289,  289,  289,  289,  289,   81,  289,
+ /*   590 */   274,  275,  217,   83,  320,  289,  225,  226,  227,   58,
+ /*   600 */   276,  273,  289,  249,  281,  289,   61,  289,  289,  289,
+ /*   610 */    66,  274,  275,  239,  267,  266,  289,  225,  226,  227,
+ /*   620 */   289,  276,  273,  289,  279,  281,  289,   61,  289,  289,
+ /*   630 */   289,   66,  274,  275,  243,  267,  266,  289,  225,  226,
+ /*   640 */   227,  289,  276,  250,  281,  279,   61,  289,  345,  289,
+ /*   650 */    66,   63,  289,  289,  267,  266,   82,  289,  289,  247,
+ /*   660 */   281,  289,   61,  289,  279,  289,   66,  289,   67,   69,
+ /*   670 */   267,  266,   66,  289,   67,  289,  267,  266,   66,  289,
+ /*   680 */   279,  289,  267,  266,  289,  289,  289,  289,  289,  289,
+ /*   690 */   289,  289,  280,
 };
 static const YYCODETYPE yy_lookahead[] = {
- /*     0 */    46,   47,   36,   56,    4,    5,    6,   41,   42,    9,
- /*    10 */    10,   11,   48,   49,   14,   15,   39,   17,    9,   19,
- /*    20 */    20,   21,   56,   59,   60,   25,   26,   27,   28,   29,
- /*    30 */     4,    5,    6,   56,   57,    9,   10,   11,    9,   29,
- /*    40 */    14,   15,    9,   17,   56,   19,   20,   21,   19,   20,
- /*    50 */    21,   25,   26,   27,   28,   29,    0,   28,   29,   56,
- /*    60 */     4,    5,   51,   30,   31,    9,   10,   11,    9,   58,
- /*    70 */    14,   15,   56,   17,   51,   19,   20,   21,   19,   20,
- /*    80 */    21,   25,   26,   27,   28,   29,    0,   28,   29,   36,
- /*    90 */    20,    5,   39,   46,   47,    9,   10,   11,   36,   29,
- /*   100 */    14,   15,   56,   41,   42,   19,   20,   21,   22,   56,
- /*   110 */    56,   25,   26,   27,   28,   29,    4,    5,   56,   34,
- /*   120 */    35,    9,   10,   11,    9,   10,   14,   15,   51,   17,
- /*   130 */    56,   19,   20,   21,   19,   20,   21,   25,   26,   27,
- /*   140 */    28,   29,    4,    5,   29,   46,   47,    9,   10,   11,
- /*   150 */     9,    7,   14,   15,   56,   17,   61,   19,   20,   21,
+ /*     0 */    47,   48,   36,   57,    4,    5,    6,   41,   42,    9,
+ /*    10 */    10,   11,    9,    4,   14,   15,    7,   17,   57,   19,
+ /*    20 */    20,   21,    0,   57,    9,   25,   26,   27,   28,   29,
+ /*    30 */     4,    5,    6,   30,   31,    9,   10,   11,    9,   17,
+ /*    40 */    14,   15,   29,   17,   39,   19,   20,   21,   19,   20,
+ /*    50 */    21,   25,   26,   27,   28,   29,    0,   28,   29,   57,
+ /*    60 */     4,    5,   57,   58,    7,    9,   10,   11,    9,   36,
+ /*    70 */    14,   15,   39,   17,    7,   19,   20,   21,   19,   20,
+ /*    80 */    21,   25,   26,   27,   28,   29,    0,   28,   29,   32,
+ /*    90 */    57,    5,   47,   48,   57,    9,   10,   11,   36,   32,
+ /*   100 */    14,   15,   52,   41,   42,   19,   20,   21,   22,   59,
+ /*   110 */    52,   25,   26,   27,   28,   29,    4,    5,   57,   57,
+ /*   120 */    57,    9,   10,   11,    9,   10,   14,   15,   52,   17,
+ /*   130 */    57,   19,   20,   21,   19,   20,   21,   25,   26,   27,
+ /*   140 */    28,   29,    4,    5,   29,   47,   48,    9,   10,   11,
+ /*   150 */     9,   57,   14,   15,   58,   17,   56,   19,   20,   21,
  /*   160 */    19,   20,   21,   25,   26,   27,   28,   29,    4,    5,
- /*   170 */    29,   34,   35,    9,   10,   11,   32,    9,   14,   15,
- /*   180 */    57,   17,   57,   19,   20,   21,    0,   19,   20,   25,
- /*   190 */    26,   27,   28,   29,    4,    4,    6,   29,    7,    9,
- /*   200 */    10,   11,    9,   17,   14,   15,    4,   17,    5,   19,
+ /*   170 */    29,   20,   58,    9,   10,   11,   49,   50,   14,   15,
+ /*   180 */    29,   17,   62,   19,   20,   21,   49,   60,   61,   25,
+ /*   190 */    26,   27,   28,   29,    4,   34,    6,   60,   61,    9,
+ /*   200 */    10,   11,    9,    5,   14,   15,    4,   17,    0,   19,
  /*   210 */    20,   21,   19,   20,   21,   25,   26,   27,   28,   29,
- /*   220 */    18,    5,   29,   12,   13,    9,   10,   11,   36,    9,
+ /*   220 */    18,    5,   29,   34,   35,    9,   10,   11,   36,    9,
  /*   230 */    14,   15,    4,   41,   42,   19,   20,   21,   22,   19,
- /*   240 */    20,   25,   26,   27,   28,   29,   18,    5,   56,   29,
- /*   250 */    55,    9,   10,   11,    9,   34,   14,   15,    0,   17,
+ /*   240 */    20,   25,   26,   27,   28,   29,   18,    5,    8,   57,
+ /*   250 */     6,    9,   10,   11,    9,    0,   14,   15,   29,   17,
  /*   260 */     8,   19,   20,   21,   19,   20,   21,   25,   26,   27,
- /*   270 */    28,   29,   36,    5,   29,   39,    0,    9,   10,   11,
- /*   280 */    44,    7,   14,   15,   29,   17,    6,   19,   20,   21,
- /*   290 */    12,   13,   56,   25,   26,   27,   28,   29,    9,   10,
- /*   300 */    11,   12,   13,   14,   15,   13,   32,   36,   19,   20,
- /*   310 */    21,   48,   41,   42,   25,   26,   27,   28,   29,    4,
- /*   320 */     8,   51,   59,   60,    9,   10,   11,   56,   58,   14,
- /*   330 */    15,    0,   17,   36,   19,   20,   21,    9,   41,   42,
- /*   340 */    25,   26,   27,   28,   29,    8,    5,   19,   20,   28,
- /*   350 */     9,   10,   11,   56,   12,   14,   15,    8,   28,   62,
- /*   360 */    19,   20,   21,   28,   28,   10,   25,   26,   27,   28,
- /*   370 */    29,    9,   10,   11,   28,   28,   14,   15,   28,   17,
- /*   380 */    36,   19,   20,   21,   10,   41,   42,   25,   26,   27,
- /*   390 */    28,   29,    9,   10,   11,   28,   28,   14,   15,   51,
- /*   400 */    56,   28,   19,   20,   21,   28,   58,   51,   25,   26,
- /*   410 */    27,   28,   29,   33,   58,   17,   36,   19,   20,   21,
- /*   420 */    40,   41,   42,   25,   26,   27,   28,   29,   28,   10,
- /*   430 */    50,   18,   12,   53,   54,   55,   56,   33,    4,   17,
- /*   440 */    36,   19,   20,   21,   40,   41,   42,   25,   26,   27,
- /*   450 */    28,   29,   10,   10,   50,    4,   62,   36,   54,   55,
- /*   460 */    56,   33,   41,   42,   36,   62,   62,   62,   40,   41,
- /*   470 */    42,   62,   62,   33,   62,   62,   36,   56,   50,   62,
- /*   480 */    40,   41,   42,   55,   56,   33,   62,   62,   36,   62,
- /*   490 */    50,   62,   40,   41,   42,   55,   56,   62,   62,   62,
- /*   500 */    62,   62,   50,   33,   62,   62,   36,   55,   56,   62,
- /*   510 */    40,   41,   42,   62,   33,   62,   62,   36,   62,   62,
- /*   520 */    50,   40,   41,   42,   11,   55,   56,   62,   15,   62,
- /*   530 */    62,   50,   19,   20,   62,   62,   55,   56,   62,   62,
- /*   540 */    33,   62,   29,   36,   62,   62,   62,   40,   41,   42,
- /*   550 */    62,   33,   62,   62,   36,   62,   62,   50,   40,   41,
- /*   560 */    42,   11,   55,   56,   62,   15,   62,   62,   50,   19,
- /*   570 */    20,   62,   62,   55,   56,   62,   62,   33,   62,   62,
- /*   580 */    36,   62,   62,   62,   40,   41,   42,    9,   62,   11,
- /*   590 */    62,   62,   62,   15,   50,   62,   62,   19,   20,   55,
- /*   600 */    56,   62,   62,   62,   19,   20,   21,   29,   62,    9,
- /*   610 */    25,   26,   27,   28,   29,   62,   62,   62,   62,   19,
- /*   620 */    20,   21,    9,   62,   62,   25,   26,   27,   62,   29,
- /*   630 */    62,   62,   19,   20,   21,   62,   62,   62,   25,   26,
- /*   640 */    27,   62,   29,    8,    9,   62,   11,   36,   62,   62,
- /*   650 */    15,   62,   41,   42,   19,   20,   45,   62,   62,   62,
- /*   660 */    62,   62,   62,   52,   29,   62,   62,   56,   62,   62,
- /*   670 */    62,   62,   62,   62,   62,   62,   62,   33,   33,   33,
- /*   680 */    33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
- /*   690 */    33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
- /*   700 */    33,
+ /*   270 */    28,   29,    0,    5,   29,   34,   35,    9,   10,   11,
+ /*   280 */    13,    8,   14,   15,   28,   17,   36,   19,   20,   21,
+ /*   290 */    12,   41,   42,   25,   26,   27,   28,   29,    9,   10,
+ /*   300 */    11,   12,   13,   14,   15,   28,   36,   57,   19,   20,
+ /*   310 */    21,   41,   42,   28,   25,   26,   27,   28,   29,    4,
+ /*   320 */    28,   52,   12,   13,    9,   10,   11,   57,   59,   14,
+ /*   330 */    15,   28,   17,   36,   19,   20,   21,    9,   41,   42,
+ /*   340 */    25,   26,   27,   28,   29,   10,    5,   19,   20,   28,
+ /*   350 */     9,   10,   11,   36,   57,   14,   15,   29,   41,   42,
+ /*   360 */    19,   20,   21,   12,   13,   28,   25,   26,   27,   28,
+ /*   370 */    29,    9,   10,   11,   57,   10,   14,   15,   52,   17,
+ /*   380 */    28,   19,   20,   21,   28,   59,   28,   25,   26,   27,
+ /*   390 */    28,   29,    9,   10,   11,   28,   28,   14,   15,   52,
+ /*   400 */    10,   46,   19,   20,   21,   10,   59,   52,   25,   26,
+ /*   410 */    27,   28,   29,   33,   59,   17,   36,   19,   20,   21,
+ /*   420 */    40,   41,   42,   25,   26,   27,   28,   29,   10,   18,
+ /*   430 */     4,   51,   12,    4,   54,   55,   56,   57,   33,   63,
+ /*   440 */    17,   36,   19,   20,   21,   40,   41,   42,   25,   26,
+ /*   450 */    27,   28,   29,   63,   63,   63,   51,   63,   36,   52,
+ /*   460 */    55,   56,   57,   41,   42,   33,   59,   45,   36,   63,
+ /*   470 */    63,    9,   40,   41,   42,   53,   63,   33,   63,   57,
+ /*   480 */    36,   19,   20,   51,   40,   41,   42,   63,   56,   57,
+ /*   490 */    33,   29,   63,   36,   63,   51,   63,   40,   41,   42,
+ /*   500 */    56,   57,   33,   63,   63,   36,   63,   63,   51,   40,
+ /*   510 */    41,   42,   63,   56,   57,   63,   63,   63,   63,   63,
+ /*   520 */    51,   63,   63,   63,   33,   56,   57,   36,   63,   63,
+ /*   530 */    63,   40,   41,   42,   63,   63,   33,   63,   63,   36,
+ /*   540 */    63,   63,   51,   40,   41,   42,   63,   56,   57,   63,
+ /*   550 */    63,   63,   63,   63,   51,   63,   63,   63,   33,   56,
+ /*   560 */    57,   36,   63,   63,   63,   40,   41,   42,   63,   63,
+ /*   570 */    33,   63,   63,   36,   63,   63,   51,   40,   41,   42,
+ /*   580 */    63,   56,   57,   63,   63,   63,   63,   63,   51,   63,
+ /*   590 */    19,   20,   21,   56,   57,   63,   25,   26,   27,   28,
+ /*   600 */    29,    9,   63,    8,    9,   63,   11,   63,   63,   63,
+ /*   610 */    15,   19,   20,   21,   19,   20,   63,   25,   26,   27,
+ /*   620 */    63,   29,    9,   63,   29,    9,   63,   11,   63,   63,
+ /*   630 */    63,   15,   19,   20,   21,   19,   20,   63,   25,   26,
+ /*   640 */    27,   63,   29,    8,    9,   29,   11,   63,   36,   63,
+ /*   650 */    15,   39,   63,   63,   19,   20,   44,   63,   63,    8,
+ /*   660 */     9,   63,   11,   63,   29,   63,   15,   63,   11,   57,
+ /*   670 */    19,   20,   15,   63,   11,   63,   19,   20,   15,   63,
+ /*   680 */    29,   63,   19,   20,   63,   63,   63,   63,   63,   63,
+ /*   690 */    63,   63,   29,   63,   63,   63,   63,   63,   63,   63,
+ /*   700 */    63,   63,   63,   63,   63,   63,   63,   63,   33,   33,
+ /*   710 */    33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
+ /*   720 */    33,   33,   33,   33,   33,   33,
 };
-#define YY_SHIFT_COUNT    (114)
+#define YY_SHIFT_COUNT    (115)
 #define YY_SHIFT_MIN      (0)
-#define YY_SHIFT_MAX      (635)
+#define YY_SHIFT_MAX      (663)
 static const unsigned short int yy_shift_ofst[] = {
  /*     0 */    86,  216,    0,   26,   56,  112,  138,  164,  242,  242,
  /*    10 */   268,  268,  341,  341,  341,  341,  341,  341,  398,  398,
- /*    20 */   422,  422,  398,  398,  422,  422,  289,  190,  315,  362,
- /*    30 */   383,  383,  383,  383,  383,  383,  422,  422,  422,  585,
- /*    40 */   600,  585,   33,  613,  168,   33,  635,  578,  578,  578,
- /*    50 */     9,    9,    9,   10,   10,   29,   59,  115,  141,  513,
- /*    60 */   193,  193,  245,  220,  550,  550,  220,  220,  220,  220,
- /*    70 */   328,  328,   70,  203,   10,  211,  186,  278,  144,  202,
- /*    80 */   191,  228,  274,  258,  252,  280,  276,  312,  292,  255,
- /*    90 */   331,  337,  342,  349,  321,  330,  335,  336,  346,  347,
- /*   100 */   350,  367,  368,  373,  377,  400,  355,  374,  419,  442,
- /*   110 */   443,  413,  420,  434,  451,
+ /*    20 */   423,  423,  398,  398,  423,  423,  289,  190,  315,  362,
+ /*    30 */   383,  383,  383,  383,  383,  383,  423,  423,  423,  571,
+ /*    40 */   592,  571,    3,  613,  595,  328,    3,  635,  651,  616,
+ /*    50 */   616,  616,   15,   15,   15,   13,   13,   29,   59,  115,
+ /*    60 */   141,  663,  193,  193,  245,  462,  657,  657,  462,  462,
+ /*    70 */   462,  462,  220,  220,  151,  198,   13,  310,   22,  351,
+ /*    80 */    57,  202,    9,  228,   67,  208,  240,  244,  255,  252,
+ /*    90 */   267,  229,  272,  273,  278,  256,  277,  285,  292,  303,
+ /*   100 */   321,  337,  352,  356,  358,  367,  368,  335,  365,  390,
+ /*   110 */   395,  418,  411,  420,  426,  429,
 };
-#define YY_REDUCE_COUNT (74)
-#define YY_REDUCE_MIN   (-53)
-#define YY_REDUCE_MAX   (611)
+#define YY_REDUCE_COUNT (76)
+#define YY_REDUCE_MIN   (-54)
+#define YY_REDUCE_MAX   (612)
 static const short yy_reduce_ofst[] = {
- /*     0 */   380,  404,  428,  440,  428,  440,  428,  440,  428,  428,
- /*    10 */   440,  440,  452,  470,  481,  507,  518,  544,  428,  428,
- /*    20 */   440,  440,  428,  428,  440,  440,  611,  -34,  -34,  -34,
- /*    30 */    62,  192,  271,  297,  344,  421,  -34,  -34,  -34,  -34,
- /*    40 */   236,  -34,  -36,   53,  -23,  263,   11,  270,  348,  356,
- /*    50 */   -46,   47,   99,   85,  137,  -53,  -12,    3,   16,   23,
- /*    60 */     3,    3,   46,   54,   77,   23,   74,   74,   74,   98,
- /*    70 */   123,  125,   95,  195,  221,
+ /*     0 */   380,  405,  432,  444,  432,  444,  432,  444,  432,  432,
+ /*    10 */   444,  444,  457,  469,  491,  503,  525,  537,  432,  432,
+ /*    20 */   444,  444,  432,  432,  444,  444,  422,  -34,  -34,  -34,
+ /*    30 */    62,  192,  250,  270,  297,  317,  -34,  -34,  -34,  -34,
+ /*    40 */   612,  -34,  127,   33,  355,    5,  137,   50,  269,  326,
+ /*    50 */   347,  407,  -47,   45,   98,  189,  241,  -54,  -39,    2,
+ /*    60 */    37,   58,    2,    2,   61,   63,   76,   58,   73,   73,
+ /*    70 */    73,   94,   96,  114,  120,  100,  161,
 };
 static const YYACTIONTYPE yy_default[] = {
- /*     0 */   280,  280,  280,  280,  280,  286,  293,  286,  294,  292,
- /*    10 */   295,  297,  280,  280,  280,  280,  280,  280,  319,  321,
- /*    20 */   322,  320,  287,  288,  290,  289,  280,  280,  298,  297,
- /*    30 */   280,  280,  280,  280,  280,  280,  322,  320,  290,  300,
- /*    40 */   280,  299,  354,  280,  280,  353,  280,  280,  280,  280,
- /*    50 */   280,  280,  280,  307,  307,  280,  280,  280,  280,  280,
- /*    60 */   343,  339,  280,  280,  280,  280,  340,  336,  280,  280,
- /*    70 */   280,  280,  280,  280,  306,  280,  280,  280,  280,  280,
- /*    80 */   280,  280,  280,  280,  280,  280,  280,  280,  280,  280,
- /*    90 */   280,  280,  280,  280,  280,  280,  280,  280,  280,  280,
- /*   100 */   280,  280,  280,  280,  280,  280,  370,  369,  368,  371,
- /*   110 */   280,  280,  280,  296,  291,
+ /*     0 */   287,  287,  287,  287,  287,  293,  300,  293,  301,  299,
+ /*    10 */   302,  304,  287,  287,  287,  287,  287,  287,  326,  328,
+ /*    20 */   329,  327,  294,  295,  297,  296,  287,  287,  305,  304,
+ /*    30 */   287,  287,  287,  287,  287,  287,  329,  327,  297,  307,
+ /*    40 */   287,  306,  364,  287,  287,  287,  363,  287,  287,  287,
+ /*    50 */   287,  287,  287,  287,  287,  314,  314,  287,  287,  287,
+ /*    60 */   287,  287,  350,  346,  287,  287,  287,  287,  347,  343,
+ /*    70 */   287,  287,  287,  287,  287,  287,  313,  287,  287,  287,
+ /*    80 */   287,  287,  287,  287,  287,  287,  287,  287,  287,  287,
+ /*    90 */   287,  287,  287,  287,  287,  287,  287,  287,  287,  287,
+ /*   100 */   287,  287,  287,  287,  287,  287,  287,  380,  379,  378,
+ /*   110 */   381,  287,  287,  287,  303,  298,
 };
 /********** End of lemon-generated parsing tables *****************************/
 
@@ -666,22 +672,23 @@ static const char *const yyTokenName[] = {
   /*   43 */ "fuzzy",
   /*   44 */ "tag_list",
   /*   45 */ "geo_filter",
-  /*   46 */ "vector_query",
-  /*   47 */ "vector_command",
-  /*   48 */ "vector_attribute",
-  /*   49 */ "vector_attribute_list",
-  /*   50 */ "modifierlist",
-  /*   51 */ "num",
-  /*   52 */ "numeric_range",
-  /*   53 */ "query",
-  /*   54 */ "star",
-  /*   55 */ "modifier",
-  /*   56 */ "param_term",
-  /*   57 */ "term",
-  /*   58 */ "param_any",
-  /*   59 */ "vector_score_field",
-  /*   60 */ "as",
-  /*   61 */ "param_size",
+  /*   46 */ "geo_coords",
+  /*   47 */ "vector_query",
+  /*   48 */ "vector_command",
+  /*   49 */ "vector_attribute",
+  /*   50 */ "vector_attribute_list",
+  /*   51 */ "modifierlist",
+  /*   52 */ "num",
+  /*   53 */ "numeric_range",
+  /*   54 */ "query",
+  /*   55 */ "star",
+  /*   56 */ "modifier",
+  /*   57 */ "param_term",
+  /*   58 */ "term",
+  /*   59 */ "param_any",
+  /*   60 */ "vector_score_field",
+  /*   61 */ "as",
+  /*   62 */ "param_size",
 };
 #endif /* defined(YYCOVERAGE) || !defined(NDEBUG) */
 
@@ -754,40 +761,43 @@ static const char *const yyRuleName[] = {
  /*  62 */ "numeric_range ::= LSQB param_any param_any RSQB",
  /*  63 */ "expr ::= modifier COLON geo_filter",
  /*  64 */ "geo_filter ::= LSQB param_any param_any param_any param_any RSQB",
- /*  65 */ "query ::= expr ARROW LSQB vector_query RSQB",
- /*  66 */ "query ::= text_expr ARROW LSQB vector_query RSQB",
- /*  67 */ "query ::= star ARROW LSQB vector_query RSQB",
- /*  68 */ "vector_query ::= vector_command vector_attribute_list vector_score_field",
- /*  69 */ "vector_query ::= vector_command vector_score_field",
- /*  70 */ "vector_query ::= vector_command vector_attribute_list",
- /*  71 */ "vector_query ::= vector_command",
- /*  72 */ "vector_score_field ::= as param_term",
- /*  73 */ "vector_score_field ::= as STOPWORD",
- /*  74 */ "vector_command ::= TERM param_size modifier ATTRIBUTE",
- /*  75 */ "vector_attribute ::= TERM param_term",
- /*  76 */ "vector_attribute_list ::= vector_attribute_list vector_attribute",
- /*  77 */ "vector_attribute_list ::= vector_attribute",
- /*  78 */ "num ::= SIZE",
- /*  79 */ "num ::= NUMBER",
- /*  80 */ "num ::= LP num",
- /*  81 */ "num ::= MINUS num",
- /*  82 */ "term ::= TERM",
- /*  83 */ "term ::= NUMBER",
- /*  84 */ "term ::= SIZE",
- /*  85 */ "param_term ::= TERM",
- /*  86 */ "param_term ::= NUMBER",
- /*  87 */ "param_term ::= SIZE",
- /*  88 */ "param_term ::= ATTRIBUTE",
- /*  89 */ "param_size ::= SIZE",
- /*  90 */ "param_size ::= ATTRIBUTE",
- /*  91 */ "param_any ::= ATTRIBUTE",
- /*  92 */ "param_any ::= LP ATTRIBUTE",
- /*  93 */ "param_any ::= TERM",
- /*  94 */ "param_any ::= num",
- /*  95 */ "star ::= STAR",
- /*  96 */ "star ::= LP star RP",
- /*  97 */ "as ::= AS_T",
- /*  98 */ "as ::= AS_S",
+ /*  65 */ "geo_filter ::= LSQB param_any param_any param_any param_any geo_coords RSQB",
+ /*  66 */ "geo_coords ::= param_any",
+ /*  67 */ "geo_coords ::= geo_coords param_any",
+ /*  68 */ "query ::= expr ARROW LSQB vector_query RSQB",
+ /*  69 */ "query ::= text_expr ARROW LSQB vector_query RSQB",
+ /*  70 */ "query ::= star ARROW LSQB vector_query RSQB",
+ /*  71 */ "vector_query ::= vector_command vector_attribute_list vector_score_field",
+ /*  72 */ "vector_query ::= vector_command vector_score_field",
+ /*  73 */ "vector_query ::= vector_command vector_attribute_list",
+ /*  74 */ "vector_query ::= vector_command",
+ /*  75 */ "vector_score_field ::= as param_term",
+ /*  76 */ "vector_score_field ::= as STOPWORD",
+ /*  77 */ "vector_command ::= TERM param_size modifier ATTRIBUTE",
+ /*  78 */ "vector_attribute ::= TERM param_term",
+ /*  79 */ "vector_attribute_list ::= vector_attribute_list vector_attribute",
+ /*  80 */ "vector_attribute_list ::= vector_attribute",
+ /*  81 */ "num ::= SIZE",
+ /*  82 */ "num ::= NUMBER",
+ /*  83 */ "num ::= LP num",
+ /*  84 */ "num ::= MINUS num",
+ /*  85 */ "term ::= TERM",
+ /*  86 */ "term ::= NUMBER",
+ /*  87 */ "term ::= SIZE",
+ /*  88 */ "param_term ::= TERM",
+ /*  89 */ "param_term ::= NUMBER",
+ /*  90 */ "param_term ::= SIZE",
+ /*  91 */ "param_term ::= ATTRIBUTE",
+ /*  92 */ "param_size ::= SIZE",
+ /*  93 */ "param_size ::= ATTRIBUTE",
+ /*  94 */ "param_any ::= ATTRIBUTE",
+ /*  95 */ "param_any ::= LP ATTRIBUTE",
+ /*  96 */ "param_any ::= TERM",
+ /*  97 */ "param_any ::= num",
+ /*  98 */ "star ::= STAR",
+ /*  99 */ "star ::= LP star RP",
+ /* 100 */ "as ::= AS_T",
+ /* 101 */ "as ::= AS_S",
 };
 #endif /* NDEBUG */
 
@@ -914,17 +924,17 @@ static void yy_destructor(
     */
 /********* Begin destructor definitions ***************************************/
       /* Default NON-TERMINAL Destructor */
-    case 48: /* vector_attribute */
-    case 51: /* num */
-    case 53: /* query */
-    case 54: /* star */
-    case 55: /* modifier */
-    case 56: /* param_term */
-    case 57: /* term */
-    case 58: /* param_any */
-    case 59: /* vector_score_field */
-    case 60: /* as */
-    case 61: /* param_size */
+    case 49: /* vector_attribute */
+    case 52: /* num */
+    case 54: /* query */
+    case 55: /* star */
+    case 56: /* modifier */
+    case 57: /* param_term */
+    case 58: /* term */
+    case 59: /* param_any */
+    case 60: /* vector_score_field */
+    case 61: /* as */
+    case 62: /* param_size */
 {
  
 }
@@ -939,54 +949,59 @@ static void yy_destructor(
     case 42: /* text_expr */
     case 43: /* fuzzy */
     case 44: /* tag_list */
-    case 46: /* vector_query */
-    case 47: /* vector_command */
+    case 47: /* vector_query */
+    case 48: /* vector_command */
 {
- QueryNode_Free((yypminor->yy103)); 
+ QueryNode_Free((yypminor->yy35)); 
 }
       break;
     case 34: /* attribute */
 {
- rm_free((char*)(yypminor->yy99).value); 
+ rm_free((char*)(yypminor->yy55).value); 
 }
       break;
     case 35: /* attribute_list */
 {
- array_free_ex((yypminor->yy121), rm_free((char*)((QueryAttribute*)ptr )->value)); 
+ array_free_ex((yypminor->yy27), rm_free((char*)((QueryAttribute*)ptr )->value)); 
 }
       break;
     case 45: /* geo_filter */
 {
- QueryParam_Free((yypminor->yy6)); 
+ QueryParam_Free((yypminor->yy50)); 
 }
       break;
-    case 49: /* vector_attribute_list */
+    case 46: /* geo_coords */
+{
+ array_free((yypminor->yy14)); 
+}
+      break;
+    case 50: /* vector_attribute_list */
 {
 
-  array_free((yypminor->yy46).needResolve);
-  array_free_ex((yypminor->yy46).params, {
+  array_free((yypminor->yy32).needResolve);
+  array_free_ex((yypminor->yy32).params, {
     rm_free((char*)((VecSimRawParam*)ptr)->value);
     rm_free((char*)((VecSimRawParam*)ptr)->name);
   });
 
 }
       break;
-    case 50: /* modifierlist */
+    case 51: /* modifierlist */
 {
 
-    for (size_t i = 0; i < Vector_Size((yypminor->yy110)); i++) {
+    for (size_t i = 0; i < Vector_Size((yypminor->yy120)); i++) {
         char *s;
-        Vector_Get((yypminor->yy110), i, &s);
+        Vector_Get((yypminor->yy120), i, &s);
         rm_free(s);
     }
-    Vector_Free((yypminor->yy110));
+    Vector_Free((yypminor->yy120));
 
 }
       break;
-    case 52: /* numeric_range */
+    case 53: /* numeric_range */
 {
 
-  QueryParam_Free((yypminor->yy6));
+  QueryParam_Free((yypminor->yy50));
 
 }
       break;
@@ -1279,9 +1294,9 @@ static void yy_shift(
 /* For rule J, yyRuleInfoLhs[J] contains the symbol on the left-hand side
 ** of that rule */
 static const YYCODETYPE yyRuleInfoLhs[] = {
-    53,  /* (0) query ::= expr */
-    53,  /* (1) query ::= */
-    53,  /* (2) query ::= star */
+    54,  /* (0) query ::= expr */
+    54,  /* (1) query ::= */
+    54,  /* (2) query ::= star */
     33,  /* (3) expr ::= text_expr */
     33,  /* (4) expr ::= expr expr */
     33,  /* (5) expr ::= text_expr expr */
@@ -1328,9 +1343,9 @@ static const YYCODETYPE yyRuleInfoLhs[] = {
     42,  /* (46) text_expr ::= PERCENT STOPWORD PERCENT */
     42,  /* (47) text_expr ::= PERCENT PERCENT STOPWORD PERCENT PERCENT */
     42,  /* (48) text_expr ::= PERCENT PERCENT PERCENT STOPWORD PERCENT PERCENT PERCENT */
-    55,  /* (49) modifier ::= MODIFIER */
-    50,  /* (50) modifierlist ::= modifier OR term */
-    50,  /* (51) modifierlist ::= modifierlist OR term */
+    56,  /* (49) modifier ::= MODIFIER */
+    51,  /* (50) modifierlist ::= modifier OR term */
+    51,  /* (51) modifierlist ::= modifierlist OR term */
     33,  /* (52) expr ::= modifier COLON LB tag_list RB */
     44,  /* (53) tag_list ::= param_term */
     44,  /* (54) tag_list ::= STOPWORD */
@@ -1341,43 +1356,46 @@ static const YYCODETYPE yyRuleInfoLhs[] = {
     44,  /* (59) tag_list ::= tag_list OR affix */
     44,  /* (60) tag_list ::= tag_list OR termlist */
     33,  /* (61) expr ::= modifier COLON numeric_range */
-    52,  /* (62) numeric_range ::= LSQB param_any param_any RSQB */
+    53,  /* (62) numeric_range ::= LSQB param_any param_any RSQB */
     33,  /* (63) expr ::= modifier COLON geo_filter */
     45,  /* (64) geo_filter ::= LSQB param_any param_any param_any param_any RSQB */
-    53,  /* (65) query ::= expr ARROW LSQB vector_query RSQB */
-    53,  /* (66) query ::= text_expr ARROW LSQB vector_query RSQB */
-    53,  /* (67) query ::= star ARROW LSQB vector_query RSQB */
-    46,  /* (68) vector_query ::= vector_command vector_attribute_list vector_score_field */
-    46,  /* (69) vector_query ::= vector_command vector_score_field */
-    46,  /* (70) vector_query ::= vector_command vector_attribute_list */
-    46,  /* (71) vector_query ::= vector_command */
-    59,  /* (72) vector_score_field ::= as param_term */
-    59,  /* (73) vector_score_field ::= as STOPWORD */
-    47,  /* (74) vector_command ::= TERM param_size modifier ATTRIBUTE */
-    48,  /* (75) vector_attribute ::= TERM param_term */
-    49,  /* (76) vector_attribute_list ::= vector_attribute_list vector_attribute */
-    49,  /* (77) vector_attribute_list ::= vector_attribute */
-    51,  /* (78) num ::= SIZE */
-    51,  /* (79) num ::= NUMBER */
-    51,  /* (80) num ::= LP num */
-    51,  /* (81) num ::= MINUS num */
-    57,  /* (82) term ::= TERM */
-    57,  /* (83) term ::= NUMBER */
-    57,  /* (84) term ::= SIZE */
-    56,  /* (85) param_term ::= TERM */
-    56,  /* (86) param_term ::= NUMBER */
-    56,  /* (87) param_term ::= SIZE */
-    56,  /* (88) param_term ::= ATTRIBUTE */
-    61,  /* (89) param_size ::= SIZE */
-    61,  /* (90) param_size ::= ATTRIBUTE */
-    58,  /* (91) param_any ::= ATTRIBUTE */
-    58,  /* (92) param_any ::= LP ATTRIBUTE */
-    58,  /* (93) param_any ::= TERM */
-    58,  /* (94) param_any ::= num */
-    54,  /* (95) star ::= STAR */
-    54,  /* (96) star ::= LP star RP */
-    60,  /* (97) as ::= AS_T */
-    60,  /* (98) as ::= AS_S */
+    45,  /* (65) geo_filter ::= LSQB param_any param_any param_any param_any geo_coords RSQB */
+    46,  /* (66) geo_coords ::= param_any */
+    46,  /* (67) geo_coords ::= geo_coords param_any */
+    54,  /* (68) query ::= expr ARROW LSQB vector_query RSQB */
+    54,  /* (69) query ::= text_expr ARROW LSQB vector_query RSQB */
+    54,  /* (70) query ::= star ARROW LSQB vector_query RSQB */
+    47,  /* (71) vector_query ::= vector_command vector_attribute_list vector_score_field */
+    47,  /* (72) vector_query ::= vector_command vector_score_field */
+    47,  /* (73) vector_query ::= vector_command vector_attribute_list */
+    47,  /* (74) vector_query ::= vector_command */
+    60,  /* (75) vector_score_field ::= as param_term */
+    60,  /* (76) vector_score_field ::= as STOPWORD */
+    48,  /* (77) vector_command ::= TERM param_size modifier ATTRIBUTE */
+    49,  /* (78) vector_attribute ::= TERM param_term */
+    50,  /* (79) vector_attribute_list ::= vector_attribute_list vector_attribute */
+    50,  /* (80) vector_attribute_list ::= vector_attribute */
+    52,  /* (81) num ::= SIZE */
+    52,  /* (82) num ::= NUMBER */
+    52,  /* (83) num ::= LP num */
+    52,  /* (84) num ::= MINUS num */
+    58,  /* (85) term ::= TERM */
+    58,  /* (86) term ::= NUMBER */
+    58,  /* (87) term ::= SIZE */
+    57,  /* (88) param_term ::= TERM */
+    57,  /* (89) param_term ::= NUMBER */
+    57,  /* (90) param_term ::= SIZE */
+    57,  /* (91) param_term ::= ATTRIBUTE */
+    62,  /* (92) param_size ::= SIZE */
+    62,  /* (93) param_size ::= ATTRIBUTE */
+    59,  /* (94) param_any ::= ATTRIBUTE */
+    59,  /* (95) param_any ::= LP ATTRIBUTE */
+    59,  /* (96) param_any ::= TERM */
+    59,  /* (97) param_any ::= num */
+    55,  /* (98) star ::= STAR */
+    55,  /* (99) star ::= LP star RP */
+    61,  /* (100) as ::= AS_T */
+    61,  /* (101) as ::= AS_S */
 };
 
 /* For rule J, yyRuleInfoNRhs[J] contains the negative of the number
@@ -1448,40 +1466,43 @@ static const signed char yyRuleInfoNRhs[] = {
    -4,  /* (62) numeric_range ::= LSQB param_any param_any RSQB */
    -3,  /* (63) expr ::= modifier COLON geo_filter */
    -6,  /* (64) geo_filter ::= LSQB param_any param_any param_any param_any RSQB */
-   -5,  /* (65) query ::= expr ARROW LSQB vector_query RSQB */
-   -5,  /* (66) query ::= text_expr ARROW LSQB vector_query RSQB */
-   -5,  /* (67) query ::= star ARROW LSQB vector_query RSQB */
-   -3,  /* (68) vector_query ::= vector_command vector_attribute_list vector_score_field */
-   -2,  /* (69) vector_query ::= vector_command vector_score_field */
-   -2,  /* (70) vector_query ::= vector_command vector_attribute_list */
-   -1,  /* (71) vector_query ::= vector_command */
-   -2,  /* (72) vector_score_field ::= as param_term */
-   -2,  /* (73) vector_score_field ::= as STOPWORD */
-   -4,  /* (74) vector_command ::= TERM param_size modifier ATTRIBUTE */
-   -2,  /* (75) vector_attribute ::= TERM param_term */
-   -2,  /* (76) vector_attribute_list ::= vector_attribute_list vector_attribute */
-   -1,  /* (77) vector_attribute_list ::= vector_attribute */
-   -1,  /* (78) num ::= SIZE */
-   -1,  /* (79) num ::= NUMBER */
-   -2,  /* (80) num ::= LP num */
-   -2,  /* (81) num ::= MINUS num */
-   -1,  /* (82) term ::= TERM */
-   -1,  /* (83) term ::= NUMBER */
-   -1,  /* (84) term ::= SIZE */
-   -1,  /* (85) param_term ::= TERM */
-   -1,  /* (86) param_term ::= NUMBER */
-   -1,  /* (87) param_term ::= SIZE */
-   -1,  /* (88) param_term ::= ATTRIBUTE */
-   -1,  /* (89) param_size ::= SIZE */
-   -1,  /* (90) param_size ::= ATTRIBUTE */
-   -1,  /* (91) param_any ::= ATTRIBUTE */
-   -2,  /* (92) param_any ::= LP ATTRIBUTE */
-   -1,  /* (93) param_any ::= TERM */
-   -1,  /* (94) param_any ::= num */
-   -1,  /* (95) star ::= STAR */
-   -3,  /* (96) star ::= LP star RP */
-   -1,  /* (97) as ::= AS_T */
-   -1,  /* (98) as ::= AS_S */
+   -7,  /* (65) geo_filter ::= LSQB param_any param_any param_any param_any geo_coords RSQB */
+   -1,  /* (66) geo_coords ::= param_any */
+   -2,  /* (67) geo_coords ::= geo_coords param_any */
+   -5,  /* (68) query ::= expr ARROW LSQB vector_query RSQB */
+   -5,  /* (69) query ::= text_expr ARROW LSQB vector_query RSQB */
+   -5,  /* (70) query ::= star ARROW LSQB vector_query RSQB */
+   -3,  /* (71) vector_query ::= vector_command vector_attribute_list vector_score_field */
+   -2,  /* (72) vector_query ::= vector_command vector_score_field */
+   -2,  /* (73) vector_query ::= vector_command vector_attribute_list */
+   -1,  /* (74) vector_query ::= vector_command */
+   -2,  /* (75) vector_score_field ::= as param_term */
+   -2,  /* (76) vector_score_field ::= as STOPWORD */
+   -4,  /* (77) vector_command ::= TERM param_size modifier ATTRIBUTE */
+   -2,  /* (78) vector_attribute ::= TERM param_term */
+   -2,  /* (79) vector_attribute_list ::= vector_attribute_list vector_attribute */
+   -1,  /* (80) vector_attribute_list ::= vector_attribute */
+   -1,  /* (81) num ::= SIZE */
+   -1,  /* (82) num ::= NUMBER */
+   -2,  /* (83) num ::= LP num */
+   -2,  /* (84) num ::= MINUS num */
+   -1,  /* (85) term ::= TERM */
+   -1,  /* (86) term ::= NUMBER */
+   -1,  /* (87) term ::= SIZE */
+   -1,  /* (88) param_term ::= TERM */
+   -1,  /* (89) param_term ::= NUMBER */
+   -1,  /* (90) param_term ::= SIZE */
+   -1,  /* (91) param_term ::= ATTRIBUTE */
+   -1,  /* (92) param_size ::= SIZE */
+   -1,  /* (93) param_size ::= ATTRIBUTE */
+   -1,  /* (94) param_any ::= ATTRIBUTE */
+   -2,  /* (95) param_any ::= LP ATTRIBUTE */
+   -1,  /* (96) param_any ::= TERM */
+   -1,  /* (97) param_any ::= num */
+   -1,  /* (98) star ::= STAR */
+   -3,  /* (99) star ::= LP star RP */
+   -1,  /* (100) as ::= AS_T */
+   -1,  /* (101) as ::= AS_S */
 };
 
 static void yy_accept(yyParser*);  /* Forward Declaration */
@@ -1526,7 +1547,7 @@ static YYACTIONTYPE yy_reduce(
       case 0: /* query ::= expr */
 {
   setup_trace(ctx);
-  ctx->root = yymsp[0].minor.yy103;
+  ctx->root = yymsp[0].minor.yy35;
 }
         break;
       case 1: /* query ::= */
@@ -1535,7 +1556,7 @@ static YYACTIONTYPE yy_reduce(
 }
         break;
       case 2: /* query ::= star */
-{  yy_destructor(yypParser,54,&yymsp[0].minor);
+{  yy_destructor(yypParser,55,&yymsp[0].minor);
 {
   setup_trace(ctx);
   ctx->root = NewWildcardNode();
@@ -1545,119 +1566,119 @@ static YYACTIONTYPE yy_reduce(
       case 3: /* expr ::= text_expr */
       case 8: /* expr ::= union */ yytestcase(yyruleno==8);
       case 13: /* text_expr ::= text_union */ yytestcase(yyruleno==13);
-      case 71: /* vector_query ::= vector_command */ yytestcase(yyruleno==71);
+      case 74: /* vector_query ::= vector_command */ yytestcase(yyruleno==74);
 {
-  yylhsminor.yy103 = yymsp[0].minor.yy103;
+  yylhsminor.yy35 = yymsp[0].minor.yy35;
 }
-  yymsp[0].minor.yy103 = yylhsminor.yy103;
+  yymsp[0].minor.yy35 = yylhsminor.yy35;
         break;
       case 4: /* expr ::= expr expr */
       case 5: /* expr ::= text_expr expr */ yytestcase(yyruleno==5);
       case 6: /* expr ::= expr text_expr */ yytestcase(yyruleno==6);
       case 7: /* text_expr ::= text_expr text_expr */ yytestcase(yyruleno==7);
 {
-    int rv = one_not_null(yymsp[-1].minor.yy103, yymsp[0].minor.yy103, (void**)&yylhsminor.yy103);
+    int rv = one_not_null(yymsp[-1].minor.yy35, yymsp[0].minor.yy35, (void**)&yylhsminor.yy35);
     if (rv == NODENN_BOTH_INVALID) {
-        yylhsminor.yy103 = NULL;
+        yylhsminor.yy35 = NULL;
     } else if (rv == NODENN_ONE_NULL) {
         // Nothing- `out` is already assigned
     } else {
-        if (yymsp[-1].minor.yy103 && yymsp[-1].minor.yy103->type == QN_PHRASE && yymsp[-1].minor.yy103->pn.exact == 0 &&
-            yymsp[-1].minor.yy103->opts.fieldMask == RS_FIELDMASK_ALL ) {
-            yylhsminor.yy103 = yymsp[-1].minor.yy103;
+        if (yymsp[-1].minor.yy35 && yymsp[-1].minor.yy35->type == QN_PHRASE && yymsp[-1].minor.yy35->pn.exact == 0 &&
+            yymsp[-1].minor.yy35->opts.fieldMask == RS_FIELDMASK_ALL ) {
+            yylhsminor.yy35 = yymsp[-1].minor.yy35;
         } else {
-            yylhsminor.yy103 = NewPhraseNode(0);
-            QueryNode_AddChild(yylhsminor.yy103, yymsp[-1].minor.yy103);
+            yylhsminor.yy35 = NewPhraseNode(0);
+            QueryNode_AddChild(yylhsminor.yy35, yymsp[-1].minor.yy35);
         }
-        QueryNode_AddChild(yylhsminor.yy103, yymsp[0].minor.yy103);
+        QueryNode_AddChild(yylhsminor.yy35, yymsp[0].minor.yy35);
     }
 }
-  yymsp[-1].minor.yy103 = yylhsminor.yy103;
+  yymsp[-1].minor.yy35 = yylhsminor.yy35;
         break;
       case 9: /* union ::= expr OR expr */
       case 11: /* union ::= text_expr OR expr */ yytestcase(yyruleno==11);
       case 12: /* union ::= expr OR text_expr */ yytestcase(yyruleno==12);
       case 14: /* text_union ::= text_expr OR text_expr */ yytestcase(yyruleno==14);
 {
-    int rv = one_not_null(yymsp[-2].minor.yy103, yymsp[0].minor.yy103, (void**)&yylhsminor.yy103);
+    int rv = one_not_null(yymsp[-2].minor.yy35, yymsp[0].minor.yy35, (void**)&yylhsminor.yy35);
     if (rv == NODENN_BOTH_INVALID) {
-        yylhsminor.yy103 = NULL;
+        yylhsminor.yy35 = NULL;
     } else if (rv == NODENN_ONE_NULL) {
         // Nothing- already assigned
     } else {
-        if (yymsp[-2].minor.yy103->type == QN_UNION && yymsp[-2].minor.yy103->opts.fieldMask == RS_FIELDMASK_ALL) {
-            yylhsminor.yy103 = yymsp[-2].minor.yy103;
+        if (yymsp[-2].minor.yy35->type == QN_UNION && yymsp[-2].minor.yy35->opts.fieldMask == RS_FIELDMASK_ALL) {
+            yylhsminor.yy35 = yymsp[-2].minor.yy35;
         } else {
-            yylhsminor.yy103 = NewUnionNode();
-            QueryNode_AddChild(yylhsminor.yy103, yymsp[-2].minor.yy103);
-            yylhsminor.yy103->opts.fieldMask |= yymsp[-2].minor.yy103->opts.fieldMask;
+            yylhsminor.yy35 = NewUnionNode();
+            QueryNode_AddChild(yylhsminor.yy35, yymsp[-2].minor.yy35);
+            yylhsminor.yy35->opts.fieldMask |= yymsp[-2].minor.yy35->opts.fieldMask;
         }
-        // Handle yymsp[0].minor.yy103
-        QueryNode_AddChild(yylhsminor.yy103, yymsp[0].minor.yy103);
-        yylhsminor.yy103->opts.fieldMask |= yymsp[0].minor.yy103->opts.fieldMask;
-        QueryNode_SetFieldMask(yylhsminor.yy103, yylhsminor.yy103->opts.fieldMask);
+        // Handle yymsp[0].minor.yy35
+        QueryNode_AddChild(yylhsminor.yy35, yymsp[0].minor.yy35);
+        yylhsminor.yy35->opts.fieldMask |= yymsp[0].minor.yy35->opts.fieldMask;
+        QueryNode_SetFieldMask(yylhsminor.yy35, yylhsminor.yy35->opts.fieldMask);
     }
 }
-  yymsp[-2].minor.yy103 = yylhsminor.yy103;
+  yymsp[-2].minor.yy35 = yylhsminor.yy35;
         break;
       case 10: /* union ::= union OR expr */
       case 15: /* text_union ::= text_union OR text_expr */ yytestcase(yyruleno==15);
 {
-    yylhsminor.yy103 = yymsp[-2].minor.yy103;
-    if (yymsp[0].minor.yy103) {
-        QueryNode_AddChild(yylhsminor.yy103, yymsp[0].minor.yy103);
-        yylhsminor.yy103->opts.fieldMask |= yymsp[0].minor.yy103->opts.fieldMask;
-        QueryNode_SetFieldMask(yymsp[0].minor.yy103, yylhsminor.yy103->opts.fieldMask);
+    yylhsminor.yy35 = yymsp[-2].minor.yy35;
+    if (yymsp[0].minor.yy35) {
+        QueryNode_AddChild(yylhsminor.yy35, yymsp[0].minor.yy35);
+        yylhsminor.yy35->opts.fieldMask |= yymsp[0].minor.yy35->opts.fieldMask;
+        QueryNode_SetFieldMask(yymsp[0].minor.yy35, yylhsminor.yy35->opts.fieldMask);
     }
 }
-  yymsp[-2].minor.yy103 = yylhsminor.yy103;
+  yymsp[-2].minor.yy35 = yylhsminor.yy35;
         break;
       case 16: /* expr ::= modifier COLON text_expr */
 {
-    if (yymsp[0].minor.yy103 == NULL) {
-        yylhsminor.yy103 = NULL;
+    if (yymsp[0].minor.yy35 == NULL) {
+        yylhsminor.yy35 = NULL;
     } else {
         if (ctx->sctx->spec) {
-            QueryNode_SetFieldMask(yymsp[0].minor.yy103, IndexSpec_GetFieldBit(ctx->sctx->spec, yymsp[-2].minor.yy0.s, yymsp[-2].minor.yy0.len));
+            QueryNode_SetFieldMask(yymsp[0].minor.yy35, IndexSpec_GetFieldBit(ctx->sctx->spec, yymsp[-2].minor.yy0.s, yymsp[-2].minor.yy0.len));
         }
-        yylhsminor.yy103 = yymsp[0].minor.yy103;
+        yylhsminor.yy35 = yymsp[0].minor.yy35;
     }
 }
-  yymsp[-2].minor.yy103 = yylhsminor.yy103;
+  yymsp[-2].minor.yy35 = yylhsminor.yy35;
         break;
       case 17: /* expr ::= modifierlist COLON text_expr */
 {
 
-    if (yymsp[0].minor.yy103 == NULL) {
-        for (size_t i = 0; i < Vector_Size(yymsp[-2].minor.yy110); i++) {
+    if (yymsp[0].minor.yy35 == NULL) {
+        for (size_t i = 0; i < Vector_Size(yymsp[-2].minor.yy120); i++) {
           char *s;
-          Vector_Get(yymsp[-2].minor.yy110, i, &s);
+          Vector_Get(yymsp[-2].minor.yy120, i, &s);
           rm_free(s);
         }
-        Vector_Free(yymsp[-2].minor.yy110);
-        yylhsminor.yy103 = NULL;
+        Vector_Free(yymsp[-2].minor.yy120);
+        yylhsminor.yy35 = NULL;
     } else {
-        //yymsp[0].minor.yy103->opts.fieldMask = 0;
+        //yymsp[0].minor.yy35->opts.fieldMask = 0;
         t_fieldMask mask = 0;
-        for (int i = 0; i < Vector_Size(yymsp[-2].minor.yy110); i++) {
+        for (int i = 0; i < Vector_Size(yymsp[-2].minor.yy120); i++) {
             char *p;
-            Vector_Get(yymsp[-2].minor.yy110, i, &p);
+            Vector_Get(yymsp[-2].minor.yy120, i, &p);
             if (ctx->sctx->spec) {
               mask |= IndexSpec_GetFieldBit(ctx->sctx->spec, p, strlen(p));
             }
             rm_free(p);
         }
-        Vector_Free(yymsp[-2].minor.yy110);
-        QueryNode_SetFieldMask(yymsp[0].minor.yy103, mask);
-        yylhsminor.yy103=yymsp[0].minor.yy103;
+        Vector_Free(yymsp[-2].minor.yy120);
+        QueryNode_SetFieldMask(yymsp[0].minor.yy35, mask);
+        yylhsminor.yy35=yymsp[0].minor.yy35;
     }
 }
-  yymsp[-2].minor.yy103 = yylhsminor.yy103;
+  yymsp[-2].minor.yy35 = yylhsminor.yy35;
         break;
       case 18: /* expr ::= LP expr RP */
       case 19: /* text_expr ::= LP text_expr RP */ yytestcase(yyruleno==19);
 {
-  yymsp[-2].minor.yy103 = yymsp[-1].minor.yy103;
+  yymsp[-2].minor.yy35 = yymsp[-1].minor.yy35;
 }
         break;
       case 20: /* attribute ::= ATTRIBUTE COLON param_term */
@@ -1673,60 +1694,60 @@ static YYACTIONTYPE yy_reduce(
       value_len = found_value_len;
     }
   }
-  yylhsminor.yy99 = (QueryAttribute){ .name = yymsp[-2].minor.yy0.s, .namelen = yymsp[-2].minor.yy0.len, .value = value, .vallen = value_len };
+  yylhsminor.yy55 = (QueryAttribute){ .name = yymsp[-2].minor.yy0.s, .namelen = yymsp[-2].minor.yy0.len, .value = value, .vallen = value_len };
 }
-  yymsp[-2].minor.yy99 = yylhsminor.yy99;
+  yymsp[-2].minor.yy55 = yylhsminor.yy55;
         break;
       case 21: /* attribute_list ::= attribute */
 {
-  yylhsminor.yy121 = array_new(QueryAttribute, 2);
-  yylhsminor.yy121 = array_append(yylhsminor.yy121, yymsp[0].minor.yy99);
+  yylhsminor.yy27 = array_new(QueryAttribute, 2);
+  yylhsminor.yy27 = array_append(yylhsminor.yy27, yymsp[0].minor.yy55);
 }
-  yymsp[0].minor.yy121 = yylhsminor.yy121;
+  yymsp[0].minor.yy27 = yylhsminor.yy27;
         break;
       case 22: /* attribute_list ::= attribute_list SEMICOLON attribute */
 {
-  yylhsminor.yy121 = array_append(yymsp[-2].minor.yy121, yymsp[0].minor.yy99);
+  yylhsminor.yy27 = array_append(yymsp[-2].minor.yy27, yymsp[0].minor.yy55);
 }
-  yymsp[-2].minor.yy121 = yylhsminor.yy121;
+  yymsp[-2].minor.yy27 = yylhsminor.yy27;
         break;
       case 23: /* attribute_list ::= attribute_list SEMICOLON */
 {
-  yylhsminor.yy121 = yymsp[-1].minor.yy121;
+  yylhsminor.yy27 = yymsp[-1].minor.yy27;
 }
-  yymsp[-1].minor.yy121 = yylhsminor.yy121;
+  yymsp[-1].minor.yy27 = yylhsminor.yy27;
         break;
       case 24: /* attribute_list ::= */
 {
-  yymsp[1].minor.yy121 = NULL;
+  yymsp[1].minor.yy27 = NULL;
 }
         break;
       case 25: /* expr ::= expr ARROW LB attribute_list RB */
       case 26: /* text_expr ::= text_expr ARROW LB attribute_list RB */ yytestcase(yyruleno==26);
 {
 
-    if (yymsp[-4].minor.yy103 && yymsp[-1].minor.yy121) {
-        QueryNode_ApplyAttributes(yymsp[-4].minor.yy103, yymsp[-1].minor.yy121, array_len(yymsp[-1].minor.yy121), ctx->status);
+    if (yymsp[-4].minor.yy35 && yymsp[-1].minor.yy27) {
+        QueryNode_ApplyAttributes(yymsp[-4].minor.yy35, yymsp[-1].minor.yy27, array_len(yymsp[-1].minor.yy27), ctx->status);
     }
-    array_free_ex(yymsp[-1].minor.yy121, rm_free((char*)((QueryAttribute*)ptr )->value));
-    yylhsminor.yy103 = yymsp[-4].minor.yy103;
+    array_free_ex(yymsp[-1].minor.yy27, rm_free((char*)((QueryAttribute*)ptr )->value));
+    yylhsminor.yy35 = yymsp[-4].minor.yy35;
 }
-  yymsp[-4].minor.yy103 = yylhsminor.yy103;
+  yymsp[-4].minor.yy35 = yylhsminor.yy35;
         break;
       case 27: /* text_expr ::= QUOTE termlist QUOTE */
 {
   // TODO: Quoted/verbatim string in termlist should not be handled as parameters
   // Also need to add the leading '$' which was consumed by the lexer
-  yymsp[-1].minor.yy103->pn.exact = 1;
-  yymsp[-1].minor.yy103->opts.flags |= QueryNode_Verbatim;
+  yymsp[-1].minor.yy35->pn.exact = 1;
+  yymsp[-1].minor.yy35->opts.flags |= QueryNode_Verbatim;
 
-  yymsp[-2].minor.yy103 = yymsp[-1].minor.yy103;
+  yymsp[-2].minor.yy35 = yymsp[-1].minor.yy35;
 }
         break;
       case 28: /* text_expr ::= QUOTE term QUOTE */
 {
-  yymsp[-2].minor.yy103 = NewTokenNode(ctx, rm_strdupcase(yymsp[-1].minor.yy0.s, yymsp[-1].minor.yy0.len), -1);
-  yymsp[-2].minor.yy103->opts.flags |= QueryNode_Verbatim;
+  yymsp[-2].minor.yy35 = NewTokenNode(ctx, rm_strdupcase(yymsp[-1].minor.yy0.s, yymsp[-1].minor.yy0.len), -1);
+  yymsp[-2].minor.yy35->opts.flags |= QueryNode_Verbatim;
 }
         break;
       case 29: /* text_expr ::= QUOTE ATTRIBUTE QUOTE */
@@ -1736,103 +1757,103 @@ static YYACTIONTYPE yy_reduce(
   char *s = rm_malloc(yymsp[-1].minor.yy0.len + 1);
   *s = '$';
   memcpy(s + 1, yymsp[-1].minor.yy0.s, yymsp[-1].minor.yy0.len);
-  yymsp[-2].minor.yy103 = NewTokenNode(ctx, rm_strdupcase(s, yymsp[-1].minor.yy0.len + 1), -1);
+  yymsp[-2].minor.yy35 = NewTokenNode(ctx, rm_strdupcase(s, yymsp[-1].minor.yy0.len + 1), -1);
   rm_free(s);
-  yymsp[-2].minor.yy103->opts.flags |= QueryNode_Verbatim;
+  yymsp[-2].minor.yy35->opts.flags |= QueryNode_Verbatim;
 }
         break;
       case 30: /* text_expr ::= param_term */
 {
-  yylhsminor.yy103 = NewTokenNode_WithParams(ctx, &yymsp[0].minor.yy0);
+  yylhsminor.yy35 = NewTokenNode_WithParams(ctx, &yymsp[0].minor.yy0);
 }
-  yymsp[0].minor.yy103 = yylhsminor.yy103;
+  yymsp[0].minor.yy35 = yylhsminor.yy35;
         break;
       case 31: /* text_expr ::= affix */
 {
-yylhsminor.yy103 = yymsp[0].minor.yy103;
+yylhsminor.yy35 = yymsp[0].minor.yy35;
 }
-  yymsp[0].minor.yy103 = yylhsminor.yy103;
+  yymsp[0].minor.yy35 = yylhsminor.yy35;
         break;
       case 32: /* text_expr ::= STOPWORD */
 {
-  yymsp[0].minor.yy103 = NULL;
+  yymsp[0].minor.yy35 = NULL;
 }
         break;
       case 33: /* termlist ::= param_term param_term */
 {
-  yylhsminor.yy103 = NewPhraseNode(0);
-  QueryNode_AddChild(yylhsminor.yy103, NewTokenNode_WithParams(ctx, &yymsp[-1].minor.yy0));
-  QueryNode_AddChild(yylhsminor.yy103, NewTokenNode_WithParams(ctx, &yymsp[0].minor.yy0));
+  yylhsminor.yy35 = NewPhraseNode(0);
+  QueryNode_AddChild(yylhsminor.yy35, NewTokenNode_WithParams(ctx, &yymsp[-1].minor.yy0));
+  QueryNode_AddChild(yylhsminor.yy35, NewTokenNode_WithParams(ctx, &yymsp[0].minor.yy0));
 }
-  yymsp[-1].minor.yy103 = yylhsminor.yy103;
+  yymsp[-1].minor.yy35 = yylhsminor.yy35;
         break;
       case 34: /* termlist ::= termlist param_term */
 {
-  yylhsminor.yy103 = yymsp[-1].minor.yy103;
-  QueryNode_AddChild(yylhsminor.yy103, NewTokenNode_WithParams(ctx, &yymsp[0].minor.yy0));
+  yylhsminor.yy35 = yymsp[-1].minor.yy35;
+  QueryNode_AddChild(yylhsminor.yy35, NewTokenNode_WithParams(ctx, &yymsp[0].minor.yy0));
 }
-  yymsp[-1].minor.yy103 = yylhsminor.yy103;
+  yymsp[-1].minor.yy35 = yylhsminor.yy35;
         break;
       case 35: /* termlist ::= termlist STOPWORD */
 {
-  yylhsminor.yy103 = yymsp[-1].minor.yy103;
+  yylhsminor.yy35 = yymsp[-1].minor.yy35;
 }
-  yymsp[-1].minor.yy103 = yylhsminor.yy103;
+  yymsp[-1].minor.yy35 = yylhsminor.yy35;
         break;
       case 36: /* expr ::= MINUS expr */
       case 37: /* text_expr ::= MINUS text_expr */ yytestcase(yyruleno==37);
 {
-    if (yymsp[0].minor.yy103) {
-        yymsp[-1].minor.yy103 = NewNotNode(yymsp[0].minor.yy103);
+    if (yymsp[0].minor.yy35) {
+        yymsp[-1].minor.yy35 = NewNotNode(yymsp[0].minor.yy35);
     } else {
-        yymsp[-1].minor.yy103 = NULL;
+        yymsp[-1].minor.yy35 = NULL;
     }
 }
         break;
       case 38: /* expr ::= TILDE expr */
       case 39: /* text_expr ::= TILDE text_expr */ yytestcase(yyruleno==39);
 {
-    if (yymsp[0].minor.yy103) {
-        yymsp[-1].minor.yy103 = NewOptionalNode(yymsp[0].minor.yy103);
+    if (yymsp[0].minor.yy35) {
+        yymsp[-1].minor.yy35 = NewOptionalNode(yymsp[0].minor.yy35);
     } else {
-        yymsp[-1].minor.yy103 = NULL;
+        yymsp[-1].minor.yy35 = NULL;
     }
 }
         break;
       case 40: /* affix ::= PREFIX */
 {
-    yylhsminor.yy103 = NewPrefixNode_WithParams(ctx, &yymsp[0].minor.yy0, true, false);
+    yylhsminor.yy35 = NewPrefixNode_WithParams(ctx, &yymsp[0].minor.yy0, true, false);
 }
-  yymsp[0].minor.yy103 = yylhsminor.yy103;
+  yymsp[0].minor.yy35 = yylhsminor.yy35;
         break;
       case 41: /* affix ::= SUFFIX */
 {
-    yylhsminor.yy103 = NewPrefixNode_WithParams(ctx, &yymsp[0].minor.yy0, false, true);
+    yylhsminor.yy35 = NewPrefixNode_WithParams(ctx, &yymsp[0].minor.yy0, false, true);
 }
-  yymsp[0].minor.yy103 = yylhsminor.yy103;
+  yymsp[0].minor.yy35 = yylhsminor.yy35;
         break;
       case 42: /* affix ::= CONTAINS */
 {
-    yylhsminor.yy103 = NewPrefixNode_WithParams(ctx, &yymsp[0].minor.yy0, true, true);
+    yylhsminor.yy35 = NewPrefixNode_WithParams(ctx, &yymsp[0].minor.yy0, true, true);
 }
-  yymsp[0].minor.yy103 = yylhsminor.yy103;
+  yymsp[0].minor.yy35 = yylhsminor.yy35;
         break;
       case 43: /* text_expr ::= PERCENT param_term PERCENT */
       case 46: /* text_expr ::= PERCENT STOPWORD PERCENT */ yytestcase(yyruleno==46);
 {
-  yymsp[-2].minor.yy103 = NewFuzzyNode_WithParams(ctx, &yymsp[-1].minor.yy0, 1);
+  yymsp[-2].minor.yy35 = NewFuzzyNode_WithParams(ctx, &yymsp[-1].minor.yy0, 1);
 }
         break;
       case 44: /* text_expr ::= PERCENT PERCENT param_term PERCENT PERCENT */
       case 47: /* text_expr ::= PERCENT PERCENT STOPWORD PERCENT PERCENT */ yytestcase(yyruleno==47);
 {
-  yymsp[-4].minor.yy103 = NewFuzzyNode_WithParams(ctx, &yymsp[-2].minor.yy0, 2);
+  yymsp[-4].minor.yy35 = NewFuzzyNode_WithParams(ctx, &yymsp[-2].minor.yy0, 2);
 }
         break;
       case 45: /* text_expr ::= PERCENT PERCENT PERCENT param_term PERCENT PERCENT PERCENT */
       case 48: /* text_expr ::= PERCENT PERCENT PERCENT STOPWORD PERCENT PERCENT PERCENT */ yytestcase(yyruleno==48);
 {
-  yymsp[-6].minor.yy103 = NewFuzzyNode_WithParams(ctx, &yymsp[-3].minor.yy0, 3);
+  yymsp[-6].minor.yy35 = NewFuzzyNode_WithParams(ctx, &yymsp[-3].minor.yy0, 3);
 }
         break;
       case 49: /* modifier ::= MODIFIER */
@@ -1844,66 +1865,66 @@ yylhsminor.yy103 = yymsp[0].minor.yy103;
         break;
       case 50: /* modifierlist ::= modifier OR term */
 {
-    yylhsminor.yy110 = NewVector(char *, 2);
+    yylhsminor.yy120 = NewVector(char *, 2);
     char *s = rm_strndup(yymsp[-2].minor.yy0.s, yymsp[-2].minor.yy0.len);
-    Vector_Push(yylhsminor.yy110, s);
+    Vector_Push(yylhsminor.yy120, s);
     s = rm_strndup(yymsp[0].minor.yy0.s, yymsp[0].minor.yy0.len);
-    Vector_Push(yylhsminor.yy110, s);
+    Vector_Push(yylhsminor.yy120, s);
 }
-  yymsp[-2].minor.yy110 = yylhsminor.yy110;
+  yymsp[-2].minor.yy120 = yylhsminor.yy120;
         break;
       case 51: /* modifierlist ::= modifierlist OR term */
 {
     char *s = rm_strndup(yymsp[0].minor.yy0.s, yymsp[0].minor.yy0.len);
-    Vector_Push(yymsp[-2].minor.yy110, s);
-    yylhsminor.yy110 = yymsp[-2].minor.yy110;
+    Vector_Push(yymsp[-2].minor.yy120, s);
+    yylhsminor.yy120 = yymsp[-2].minor.yy120;
 }
-  yymsp[-2].minor.yy110 = yylhsminor.yy110;
+  yymsp[-2].minor.yy120 = yylhsminor.yy120;
         break;
       case 52: /* expr ::= modifier COLON LB tag_list RB */
 {
-    if (!yymsp[-1].minor.yy103) {
-        yylhsminor.yy103 = NULL;
+    if (!yymsp[-1].minor.yy35) {
+        yylhsminor.yy35 = NULL;
     } else {
       // Tag field names must be case sensitive, we can't do rm_strdupcase
         char *s = rm_strndup(yymsp[-4].minor.yy0.s, yymsp[-4].minor.yy0.len);
         size_t slen = unescapen((char*)s, yymsp[-4].minor.yy0.len);
 
-        yylhsminor.yy103 = NewTagNode(s, slen);
-        QueryNode_AddChildren(yylhsminor.yy103, yymsp[-1].minor.yy103->children, QueryNode_NumChildren(yymsp[-1].minor.yy103));
+        yylhsminor.yy35 = NewTagNode(s, slen);
+        QueryNode_AddChildren(yylhsminor.yy35, yymsp[-1].minor.yy35->children, QueryNode_NumChildren(yymsp[-1].minor.yy35));
 
-        // Set the children count on yymsp[-1].minor.yy103 to 0 so they won't get recursively free'd
-        QueryNode_ClearChildren(yymsp[-1].minor.yy103, 0);
-        QueryNode_Free(yymsp[-1].minor.yy103);
+        // Set the children count on yymsp[-1].minor.yy35 to 0 so they won't get recursively free'd
+        QueryNode_ClearChildren(yymsp[-1].minor.yy35, 0);
+        QueryNode_Free(yymsp[-1].minor.yy35);
     }
 }
-  yymsp[-4].minor.yy103 = yylhsminor.yy103;
+  yymsp[-4].minor.yy35 = yylhsminor.yy35;
         break;
       case 53: /* tag_list ::= param_term */
 {
-  yylhsminor.yy103 = NewPhraseNode(0);
+  yylhsminor.yy35 = NewPhraseNode(0);
   if (yymsp[0].minor.yy0.type == QT_TERM)
     yymsp[0].minor.yy0.type = QT_TERM_CASE;
   else if (yymsp[0].minor.yy0.type == QT_PARAM_TERM)
     yymsp[0].minor.yy0.type = QT_PARAM_TERM_CASE;
-  QueryNode_AddChild(yylhsminor.yy103, NewTokenNode_WithParams(ctx, &yymsp[0].minor.yy0));
+  QueryNode_AddChild(yylhsminor.yy35, NewTokenNode_WithParams(ctx, &yymsp[0].minor.yy0));
 }
-  yymsp[0].minor.yy103 = yylhsminor.yy103;
+  yymsp[0].minor.yy35 = yylhsminor.yy35;
         break;
       case 54: /* tag_list ::= STOPWORD */
 {
-    yylhsminor.yy103 = NewPhraseNode(0);
-    QueryNode_AddChild(yylhsminor.yy103, NewTokenNode(ctx, rm_strndup(yymsp[0].minor.yy0.s, yymsp[0].minor.yy0.len), -1));
+    yylhsminor.yy35 = NewPhraseNode(0);
+    QueryNode_AddChild(yylhsminor.yy35, NewTokenNode(ctx, rm_strndup(yymsp[0].minor.yy0.s, yymsp[0].minor.yy0.len), -1));
 }
-  yymsp[0].minor.yy103 = yylhsminor.yy103;
+  yymsp[0].minor.yy35 = yylhsminor.yy35;
         break;
       case 55: /* tag_list ::= affix */
       case 56: /* tag_list ::= termlist */ yytestcase(yyruleno==56);
 {
-    yylhsminor.yy103 = NewPhraseNode(0);
-    QueryNode_AddChild(yylhsminor.yy103, yymsp[0].minor.yy103);
+    yylhsminor.yy35 = NewPhraseNode(0);
+    QueryNode_AddChild(yylhsminor.yy35, yymsp[0].minor.yy35);
 }
-  yymsp[0].minor.yy103 = yylhsminor.yy103;
+  yymsp[0].minor.yy35 = yylhsminor.yy35;
         break;
       case 57: /* tag_list ::= tag_list OR param_term */
 {
@@ -1911,37 +1932,37 @@ yylhsminor.yy103 = yymsp[0].minor.yy103;
     yymsp[0].minor.yy0.type = QT_TERM_CASE;
   else if (yymsp[0].minor.yy0.type == QT_PARAM_TERM)
     yymsp[0].minor.yy0.type = QT_PARAM_TERM_CASE;
-  QueryNode_AddChild(yymsp[-2].minor.yy103, NewTokenNode_WithParams(ctx, &yymsp[0].minor.yy0));
-  yylhsminor.yy103 = yymsp[-2].minor.yy103;
+  QueryNode_AddChild(yymsp[-2].minor.yy35, NewTokenNode_WithParams(ctx, &yymsp[0].minor.yy0));
+  yylhsminor.yy35 = yymsp[-2].minor.yy35;
 }
-  yymsp[-2].minor.yy103 = yylhsminor.yy103;
+  yymsp[-2].minor.yy35 = yylhsminor.yy35;
         break;
       case 58: /* tag_list ::= tag_list OR STOPWORD */
 {
-    QueryNode_AddChild(yymsp[-2].minor.yy103, NewTokenNode(ctx, rm_strndup(yymsp[0].minor.yy0.s, yymsp[0].minor.yy0.len), -1));
-    yylhsminor.yy103 = yymsp[-2].minor.yy103;
+    QueryNode_AddChild(yymsp[-2].minor.yy35, NewTokenNode(ctx, rm_strndup(yymsp[0].minor.yy0.s, yymsp[0].minor.yy0.len), -1));
+    yylhsminor.yy35 = yymsp[-2].minor.yy35;
 }
-  yymsp[-2].minor.yy103 = yylhsminor.yy103;
+  yymsp[-2].minor.yy35 = yylhsminor.yy35;
         break;
       case 59: /* tag_list ::= tag_list OR affix */
       case 60: /* tag_list ::= tag_list OR termlist */ yytestcase(yyruleno==60);
 {
-    QueryNode_AddChild(yymsp[-2].minor.yy103, yymsp[0].minor.yy103);
-    yylhsminor.yy103 = yymsp[-2].minor.yy103;
+    QueryNode_AddChild(yymsp[-2].minor.yy35, yymsp[0].minor.yy35);
+    yylhsminor.yy35 = yymsp[-2].minor.yy35;
 }
-  yymsp[-2].minor.yy103 = yylhsminor.yy103;
+  yymsp[-2].minor.yy35 = yylhsminor.yy35;
         break;
       case 61: /* expr ::= modifier COLON numeric_range */
 {
-  if (yymsp[0].minor.yy6) {
+  if (yymsp[0].minor.yy50) {
     // we keep the capitalization as is
-    yymsp[0].minor.yy6->nf->fieldName = rm_strndup(yymsp[-2].minor.yy0.s, yymsp[-2].minor.yy0.len);
-    yylhsminor.yy103 = NewNumericNode(yymsp[0].minor.yy6);
+    yymsp[0].minor.yy50->nf->fieldName = rm_strndup(yymsp[-2].minor.yy0.s, yymsp[-2].minor.yy0.len);
+    yylhsminor.yy35 = NewNumericNode(yymsp[0].minor.yy50);
   } else {
-    yylhsminor.yy103 = NewQueryNode(QN_NULL);
+    yylhsminor.yy35 = NewQueryNode(QN_NULL);
   }
 }
-  yymsp[-2].minor.yy103 = yylhsminor.yy103;
+  yymsp[-2].minor.yy35 = yylhsminor.yy35;
         break;
       case 62: /* numeric_range ::= LSQB param_any param_any RSQB */
 {
@@ -1958,24 +1979,27 @@ yylhsminor.yy103 = yymsp[0].minor.yy103;
     badToken = &yymsp[-1].minor.yy0;
 
   if (!badToken) {
-    yymsp[-3].minor.yy6 = NewNumericFilterQueryParam_WithParams(ctx, &yymsp[-2].minor.yy0, &yymsp[-1].minor.yy0, yymsp[-2].minor.yy0.inclusive, yymsp[-1].minor.yy0.inclusive);
+    yymsp[-3].minor.yy50 = NewNumericFilterQueryParam_WithParams(ctx, &yymsp[-2].minor.yy0, &yymsp[-1].minor.yy0, yymsp[-2].minor.yy0.inclusive, yymsp[-1].minor.yy0.inclusive);
   } else {
     reportSyntaxError(ctx->status, badToken, "Expecting numeric or parameter");
-    yymsp[-3].minor.yy6 = NULL;
+    yymsp[-3].minor.yy50 = NULL;
   }
 }
         break;
       case 63: /* expr ::= modifier COLON geo_filter */
 {
-  if (yymsp[0].minor.yy6) {
+  if (yymsp[0].minor.yy50) {
     // we keep the capitalization as is
-    yymsp[0].minor.yy6->gf->property = rm_strndup(yymsp[-2].minor.yy0.s, yymsp[-2].minor.yy0.len);
-    yylhsminor.yy103 = NewGeofilterNode(yymsp[0].minor.yy6);
+    yymsp[0].minor.yy50->gf->property = rm_strndup(yymsp[-2].minor.yy0.s, yymsp[-2].minor.yy0.len);
+    if (yymsp[0].minor.yy50->gf->knn) {
+      RedisModule_Assert(-1 != (rm_asprintf(&yymsp[0].minor.yy50->gf->scoreField, "__%.*s_distance", yymsp[-2].minor.yy0.len, yymsp[-2].minor.yy0.s)));
+    }
+    yylhsminor.yy35 = NewGeofilterNode(yymsp[0].minor.yy50);
   } else {
-    yylhsminor.yy103 = NewQueryNode(QN_NULL);
+    yylhsminor.yy35 = NewQueryNode(QN_NULL);
   }
 }
-  yymsp[-2].minor.yy103 = yylhsminor.yy103;
+  yymsp[-2].minor.yy35 = yylhsminor.yy35;
         break;
       case 64: /* geo_filter ::= LSQB param_any param_any param_any param_any RSQB */
 {
@@ -1983,212 +2007,286 @@ yylhsminor.yy103 = yymsp[0].minor.yy103;
   // and detect syntax errors
   QueryToken *badToken = NULL;
 
-  if (yymsp[-4].minor.yy0.type == QT_PARAM_ANY)
-    yymsp[-4].minor.yy0.type = QT_PARAM_GEO_COORD;
-  else if (yymsp[-4].minor.yy0.type != QT_NUMERIC)
-    badToken = &yymsp[-4].minor.yy0;
-  if (yymsp[-3].minor.yy0.type == QT_PARAM_ANY)
-    yymsp[-3].minor.yy0.type = QT_PARAM_GEO_COORD;
-  else if (!badToken && yymsp[-3].minor.yy0.type != QT_NUMERIC)
-    badToken = &yymsp[-3].minor.yy0;
-  if (yymsp[-2].minor.yy0.type == QT_PARAM_ANY)
-    yymsp[-2].minor.yy0.type = QT_PARAM_NUMERIC;
-  else if (!badToken && yymsp[-2].minor.yy0.type != QT_NUMERIC)
-    badToken = &yymsp[-2].minor.yy0;
-  if (yymsp[-1].minor.yy0.type == QT_PARAM_ANY)
-    yymsp[-1].minor.yy0.type = QT_PARAM_GEO_UNIT;
-  else if (!badToken && yymsp[-1].minor.yy0.type != QT_TERM)
-    badToken = &yymsp[-1].minor.yy0;
+  // [KNN k lon lat] asks for the k nearest points instead of the points within a radius
+  if (yymsp[-4].minor.yy0.type == QT_TERM && yymsp[-4].minor.yy0.len == 3 && !strncasecmp("KNN", yymsp[-4].minor.yy0.s, yymsp[-4].minor.yy0.len)) {
+    if (yymsp[-3].minor.yy0.type == QT_PARAM_ANY)
+      yymsp[-3].minor.yy0.type = QT_PARAM_SIZE;
+    else if (yymsp[-3].minor.yy0.type == QT_NUMERIC && yymsp[-3].minor.yy0.numval >= 1 && yymsp[-3].minor.yy0.numval == (size_t)yymsp[-3].minor.yy0.numval && yymsp[-3].minor.yy0.inclusive)
+      yymsp[-3].minor.yy0.type = QT_SIZE;
+    else
+      badToken = &yymsp[-3].minor.yy0;
+    if (yymsp[-2].minor.yy0.type == QT_PARAM_ANY)
+      yymsp[-2].minor.yy0.type = QT_PARAM_GEO_COORD;
+    else if (!badToken && yymsp[-2].minor.yy0.type != QT_NUMERIC)
+      badToken = &yymsp[-2].minor.yy0;
+    if (yymsp[-1].minor.yy0.type == QT_PARAM_ANY)
+      yymsp[-1].minor.yy0.type = QT_PARAM_GEO_COORD;
+    else if (!badToken && yymsp[-1].minor.yy0.type != QT_NUMERIC)
+      badToken = &yymsp[-1].minor.yy0;
+
+    if (!badToken) {
+      yymsp[-5].minor.yy50 = NewGeoKnnQueryParam_WithParams(ctx, &yymsp[-3].minor.yy0, &yymsp[-2].minor.yy0, &yymsp[-1].minor.yy0);
+    } else {
+      reportSyntaxError(ctx->status, badToken, "Syntax error");
+      yymsp[-5].minor.yy50 = NULL;
+    }
+  } else {
+    if (yymsp[-4].minor.yy0.type == QT_PARAM_ANY)
+      yymsp[-4].minor.yy0.type = QT_PARAM_GEO_COORD;
+    else if (yymsp[-4].minor.yy0.type != QT_NUMERIC)
+      badToken = &yymsp[-4].minor.yy0;
+    if (yymsp[-3].minor.yy0.type == QT_PARAM_ANY)
+      yymsp[-3].minor.yy0.type = QT_PARAM_GEO_COORD;
+    else if (!badToken && yymsp[-3].minor.yy0.type != QT_NUMERIC)
+      badToken = &yymsp[-3].minor.yy0;
+    if (yymsp[-2].minor.yy0.type == QT_PARAM_ANY)
+      yymsp[-2].minor.yy0.type = QT_PARAM_NUMERIC;
+    else if (!badToken && yymsp[-2].minor.yy0.type != QT_NUMERIC)
+      badToken = &yymsp[-2].minor.yy0;
+    if (yymsp[-1].minor.yy0.type == QT_PARAM_ANY)
+      yymsp[-1].minor.yy0.type = QT_PARAM_GEO_UNIT;
+    else if (!badToken && yymsp[-1].minor.yy0.type != QT_TERM)
+      badToken = &yymsp[-1].minor.yy0;
+
+    if (!badToken) {
+      yymsp[-5].minor.yy50 = NewGeoFilterQueryParam_WithParams(ctx, &yymsp[-4].minor.yy0, &yymsp[-3].minor.yy0, &yymsp[-2].minor.yy0, &yymsp[-1].minor.yy0);
+    } else {
+      reportSyntaxError(ctx->status, badToken, "Syntax error");
+      yymsp[-5].minor.yy50 = NULL;
+    }
+  }
+}
+        break;
+      case 65: /* geo_filter ::= LSQB param_any param_any param_any param_any geo_coords RSQB */
+{
+  QueryToken *coords = array_new(QueryToken, array_len(yymsp[-1].minor.yy14) + 3);
+  coords = array_append(coords, yymsp[-4].minor.yy0);
+  coords = array_append(coords, yymsp[-3].minor.yy0);
+  coords = array_append(coords, yymsp[-2].minor.yy0);
+  for (size_t i = 0; i < array_len(yymsp[-1].minor.yy14); ++i) {
+    coords = array_append(coords, yymsp[-1].minor.yy14[i]);
+  }
+  array_free(yymsp[-1].minor.yy14);
+  size_t n = array_len(coords);
+
+  QueryToken *badToken = NULL;
+  GeoShape shape = GEO_SHAPE_RADIUS;
+  if (yymsp[-5].minor.yy0.type == QT_TERM && yymsp[-5].minor.yy0.len == 4 && !strncasecmp("BBOX", yymsp[-5].minor.yy0.s, yymsp[-5].minor.yy0.len) && n == 4)
+    shape = GEO_SHAPE_BOX;
+  else if (yymsp[-5].minor.yy0.type == QT_TERM && yymsp[-5].minor.yy0.len == 7 && !strncasecmp("POLYGON", yymsp[-5].minor.yy0.s, yymsp[-5].minor.yy0.len) && n >= 6 && n % 2 == 0)
+    shape = GEO_SHAPE_POLYGON;
+  else
+    badToken = &yymsp[-5].minor.yy0;
+  for (size_t i = 0; i < n && !badToken; ++i) {
+    if (coords[i].type == QT_PARAM_ANY)
+      coords[i].type = QT_PARAM_GEO_COORD;
+    else if (coords[i].type != QT_NUMERIC)
+      badToken = &coords[i];
+  }
 
   if (!badToken) {
-    yymsp[-5].minor.yy6 = NewGeoFilterQueryParam_WithParams(ctx, &yymsp[-4].minor.yy0, &yymsp[-3].minor.yy0, &yymsp[-2].minor.yy0, &yymsp[-1].minor.yy0);
+    yymsp[-6].minor.yy50 = NewGeoShapeQueryParam_WithParams(ctx, shape, coords, n);
   } else {
     reportSyntaxError(ctx->status, badToken, "Syntax error");
-    yymsp[-5].minor.yy6 = NULL;
+    yymsp[-6].minor.yy50 = NULL;
   }
+  array_free(coords);
+}
+        break;
+      case 66: /* geo_coords ::= param_any */
+{
+  yylhsminor.yy14 = array_new(QueryToken, 8);
+  yylhsminor.yy14 = array_append(yylhsminor.yy14, yymsp[0].minor.yy0);
+}
+  yymsp[0].minor.yy14 = yylhsminor.yy14;
+        break;
+      case 67: /* geo_coords ::= geo_coords param_any */
+{
+  yylhsminor.yy14 = array_append(yymsp[-1].minor.yy14, yymsp[0].minor.yy0);
 }
+  yymsp[-1].minor.yy14 = yylhsminor.yy14;
         break;
-      case 65: /* query ::= expr ARROW LSQB vector_query RSQB */
-      case 66: /* query ::= text_expr ARROW LSQB vector_query RSQB */ yytestcase(yyruleno==66);
+      case 68: /* query ::= expr ARROW LSQB vector_query RSQB */
+      case 69: /* query ::= text_expr ARROW LSQB vector_query RSQB */ yytestcase(yyruleno==69);
 { // main parse, hybrid query as entire query case.
   setup_trace(ctx);
-  switch (yymsp[-1].minor.yy103->vn.vq->type) {
+  switch (yymsp[-1].minor.yy35->vn.vq->type) {
     case VECSIM_QT_KNN:
-      yymsp[-1].minor.yy103->vn.vq->knn.order = BY_SCORE;
+      yymsp[-1].minor.yy35->vn.vq->knn.order = BY_SCORE;
       break;
   }
-  ctx->root = yymsp[-1].minor.yy103;
-  if (yymsp[-4].minor.yy103) {
-    QueryNode_AddChild(yymsp[-1].minor.yy103, yymsp[-4].minor.yy103);
+  ctx->root = yymsp[-1].minor.yy35;
+  if (yymsp[-4].minor.yy35) {
+    QueryNode_AddChild(yymsp[-1].minor.yy35, yymsp[-4].minor.yy35);
   }
 }
         break;
-      case 67: /* query ::= star ARROW LSQB vector_query RSQB */
-{  yy_destructor(yypParser,54,&yymsp[-4].minor);
+      case 70: /* query ::= star ARROW LSQB vector_query RSQB */
+{  yy_destructor(yypParser,55,&yymsp[-4].minor);
 { // main parse, simple vecsim search as entire query case.
   setup_trace(ctx);
-  switch (yymsp[-1].minor.yy103->vn.vq->type) {
+  switch (yymsp[-1].minor.yy35->vn.vq->type) {
     case VECSIM_QT_KNN:
-      yymsp[-1].minor.yy103->vn.vq->knn.order = BY_SCORE;
+      yymsp[-1].minor.yy35->vn.vq->knn.order = BY_SCORE;
       break;
   }
-  ctx->root = yymsp[-1].minor.yy103;
+  ctx->root = yymsp[-1].minor.yy35;
 }
 }
         break;
-      case 68: /* vector_query ::= vector_command vector_attribute_list vector_score_field */
+      case 71: /* vector_query ::= vector_command vector_attribute_list vector_score_field */
 {
-  if (yymsp[-2].minor.yy103->vn.vq->scoreField) {
-    rm_free(yymsp[-2].minor.yy103->vn.vq->scoreField);
-    yymsp[-2].minor.yy103->vn.vq->scoreField = NULL;
+  if (yymsp[-2].minor.yy35->vn.vq->scoreField) {
+    rm_free(yymsp[-2].minor.yy35->vn.vq->scoreField);
+    yymsp[-2].minor.yy35->vn.vq->scoreField = NULL;
   }
-  yymsp[-2].minor.yy103->params = array_grow(yymsp[-2].minor.yy103->params, 1);
-  memset(&array_tail(yymsp[-2].minor.yy103->params), 0, sizeof(*yymsp[-2].minor.yy103->params));
-  QueryNode_SetParam(ctx, &(array_tail(yymsp[-2].minor.yy103->params)), &(yymsp[-2].minor.yy103->vn.vq->scoreField), NULL, &yymsp[0].minor.yy0);
-  yymsp[-2].minor.yy103->vn.vq->params = yymsp[-1].minor.yy46;
-  yylhsminor.yy103 = yymsp[-2].minor.yy103;
+  yymsp[-2].minor.yy35->params = array_grow(yymsp[-2].minor.yy35->params, 1);
+  memset(&array_tail(yymsp[-2].minor.yy35->params), 0, sizeof(*yymsp[-2].minor.yy35->params));
+  QueryNode_SetParam(ctx, &(array_tail(yymsp[-2].minor.yy35->params)), &(yymsp[-2].minor.yy35->vn.vq->scoreField), NULL, &yymsp[0].minor.yy0);
+  yymsp[-2].minor.yy35->vn.vq->params = yymsp[-1].minor.yy32;
+  yylhsminor.yy35 = yymsp[-2].minor.yy35;
 }
-  yymsp[-2].minor.yy103 = yylhsminor.yy103;
+  yymsp[-2].minor.yy35 = yylhsminor.yy35;
         break;
-      case 69: /* vector_query ::= vector_command vector_score_field */
+      case 72: /* vector_query ::= vector_command vector_score_field */
 {
-  if (yymsp[-1].minor.yy103->vn.vq->scoreField) {
-    rm_free(yymsp[-1].minor.yy103->vn.vq->scoreField);
-    yymsp[-1].minor.yy103->vn.vq->scoreField = NULL;
+  if (yymsp[-1].minor.yy35->vn.vq->scoreField) {
+    rm_free(yymsp[-1].minor.yy35->vn.vq->scoreField);
+    yymsp[-1].minor.yy35->vn.vq->scoreField = NULL;
   }
-  yymsp[-1].minor.yy103->params = array_grow(yymsp[-1].minor.yy103->params, 1);
-  memset(&array_tail(yymsp[-1].minor.yy103->params), 0, sizeof(*yymsp[-1].minor.yy103->params));
-  QueryNode_SetParam(ctx, &(array_tail(yymsp[-1].minor.yy103->params)), &(yymsp[-1].minor.yy103->vn.vq->scoreField), NULL, &yymsp[0].minor.yy0);
-  yylhsminor.yy103 = yymsp[-1].minor.yy103;
+  yymsp[-1].minor.yy35->params = array_grow(yymsp[-1].minor.yy35->params, 1);
+  memset(&array_tail(yymsp[-1].minor.yy35->params), 0, sizeof(*yymsp[-1].minor.yy35->params));
+  QueryNode_SetParam(ctx, &(array_tail(yymsp[-1].minor.yy35->params)), &(yymsp[-1].minor.yy35->vn.vq->scoreField), NULL, &yymsp[0].minor.yy0);
+  yylhsminor.yy35 = yymsp[-1].minor.yy35;
 }
-  yymsp[-1].minor.yy103 = yylhsminor.yy103;
+  yymsp[-1].minor.yy35 = yylhsminor.yy35;
         break;
-      case 70: /* vector_query ::= vector_command vector_attribute_list */
+      case 73: /* vector_query ::= vector_command vector_attribute_list */
 {
-  yymsp[-1].minor.yy103->vn.vq->params = yymsp[0].minor.yy46;
-  yylhsminor.yy103 = yymsp[-1].minor.yy103;
+  yymsp[-1].minor.yy35->vn.vq->params = yymsp[0].minor.yy32;
+  yylhsminor.yy35 = yymsp[-1].minor.yy35;
 }
-  yymsp[-1].minor.yy103 = yylhsminor.yy103;
+  yymsp[-1].minor.yy35 = yylhsminor.yy35;
         break;
-      case 72: /* vector_score_field ::= as param_term */
-{  yy_destructor(yypParser,60,&yymsp[-1].minor);
+      case 75: /* vector_score_field ::= as param_term */
+{  yy_destructor(yypParser,61,&yymsp[-1].minor);
 {
   yymsp[-1].minor.yy0 = yymsp[0].minor.yy0;
 }
 }
         break;
-      case 73: /* vector_score_field ::= as STOPWORD */
-{  yy_destructor(yypParser,60,&yymsp[-1].minor);
+      case 76: /* vector_score_field ::= as STOPWORD */
+{  yy_destructor(yypParser,61,&yymsp[-1].minor);
 {
   yymsp[-1].minor.yy0 = yymsp[0].minor.yy0;
   yymsp[-1].minor.yy0.type = QT_TERM;
 }
 }
         break;
-      case 74: /* vector_command ::= TERM param_size modifier ATTRIBUTE */
+      case 77: /* vector_command ::= TERM param_size modifier ATTRIBUTE */
 {
   if (!strncasecmp("KNN", yymsp[-3].minor.yy0.s, yymsp[-3].minor.yy0.len)) {
     yymsp[0].minor.yy0.type = QT_PARAM_VEC;
-    yylhsminor.yy103 = NewVectorNode_WithParams(ctx, VECSIM_QT_KNN, &yymsp[-2].minor.yy0, &yymsp[0].minor.yy0);
-    yylhsminor.yy103->vn.vq->property = rm_strndup(yymsp[-1].minor.yy0.s, yymsp[-1].minor.yy0.len);
-    RedisModule_Assert(-1 != (rm_asprintf(&yylhsminor.yy103->vn.vq->scoreField, "__%.*s_score", yymsp[-1].minor.yy0.len, yymsp[-1].minor.yy0.s)));
+    yylhsminor.yy35 = NewVectorNode_WithParams(ctx, VECSIM_QT_KNN, &yymsp[-2].minor.yy0, &yymsp[0].minor.yy0);
+    yylhsminor.yy35->vn.vq->property = rm_strndup(yymsp[-1].minor.yy0.s, yymsp[-1].minor.yy0.len);
+    RedisModule_Assert(-1 != (rm_asprintf(&yylhsminor.yy35->vn.vq->scoreField, "__%.*s_score", yymsp[-1].minor.yy0.len, yymsp[-1].minor.yy0.s)));
   } else {
     reportSyntaxError(ctx->status, &yymsp[-3].minor.yy0, "Syntax error: Expecting Vector Similarity command");
-    yylhsminor.yy103 = NULL;
+    yylhsminor.yy35 = NULL;
   }
 }
-  yymsp[-3].minor.yy103 = yylhsminor.yy103;
+  yymsp[-3].minor.yy35 = yylhsminor.yy35;
         break;
-      case 75: /* vector_attribute ::= TERM param_term */
+      case 78: /* vector_attribute ::= TERM param_term */
 {
   const char *value = rm_strndup(yymsp[0].minor.yy0.s, yymsp[0].minor.yy0.len);
   const char *name = rm_strndup(yymsp[-1].minor.yy0.s, yymsp[-1].minor.yy0.len);
-  yylhsminor.yy53.param = (VecSimRawParam){ .name = name, .nameLen = yymsp[-1].minor.yy0.len, .value = value, .valLen = yymsp[0].minor.yy0.len };
+  yylhsminor.yy5.param = (VecSimRawParam){ .name = name, .nameLen = yymsp[-1].minor.yy0.len, .value = value, .valLen = yymsp[0].minor.yy0.len };
   if (yymsp[0].minor.yy0.type == QT_PARAM_TERM) {
-    yylhsminor.yy53.needResolve = true;
+    yylhsminor.yy5.needResolve = true;
   }
   else { // if yymsp[0].minor.yy0.type == QT_TERM
-    yylhsminor.yy53.needResolve = false;
+    yylhsminor.yy5.needResolve = false;
   }
 }
-  yymsp[-1].minor.yy53 = yylhsminor.yy53;
+  yymsp[-1].minor.yy5 = yylhsminor.yy5;
         break;
-      case 76: /* vector_attribute_list ::= vector_attribute_list vector_attribute */
+      case 79: /* vector_attribute_list ::= vector_attribute_list vector_attribute */
 {
-  yylhsminor.yy46.params = array_append(yymsp[-1].minor.yy46.params, yymsp[0].minor.yy53.param);
-  yylhsminor.yy46.needResolve = array_append(yymsp[-1].minor.yy46.needResolve, yymsp[0].minor.yy53.needResolve);
+  yylhsminor.yy32.params = array_append(yymsp[-1].minor.yy32.params, yymsp[0].minor.yy5.param);
+  yylhsminor.yy32.needResolve = array_append(yymsp[-1].minor.yy32.needResolve, yymsp[0].minor.yy5.needResolve);
 }
-  yymsp[-1].minor.yy46 = yylhsminor.yy46;
+  yymsp[-1].minor.yy32 = yylhsminor.yy32;
         break;
-      case 77: /* vector_attribute_list ::= vector_attribute */
+      case 80: /* vector_attribute_list ::= vector_attribute */
 {
-  yylhsminor.yy46.params = array_new(VecSimRawParam, 1);
-  yylhsminor.yy46.needResolve = array_new(bool, 1);
-  yylhsminor.yy46.params = array_append(yylhsminor.yy46.params, yymsp[0].minor.yy53.param);
-  yylhsminor.yy46.needResolve = array_append(yylhsminor.yy46.needResolve, yymsp[0].minor.yy53.needResolve);
+  yylhsminor.yy32.params = array_new(VecSimRawParam, 1);
+  yylhsminor.yy32.needResolve = array_new(bool, 1);
+  yylhsminor.yy32.params = array_append(yylhsminor.yy32.params, yymsp[0].minor.yy5.param);
+  yylhsminor.yy32.needResolve = array_append(yylhsminor.yy32.needResolve, yymsp[0].minor.yy5.needResolve);
 }
-  yymsp[0].minor.yy46 = yylhsminor.yy46;
+  yymsp[0].minor.yy32 = yylhsminor.yy32;
         break;
-      case 78: /* num ::= SIZE */
-      case 79: /* num ::= NUMBER */ yytestcase(yyruleno==79);
+      case 81: /* num ::= SIZE */
+      case 82: /* num ::= NUMBER */ yytestcase(yyruleno==82);
 {
-  yylhsminor.yy95.num = yymsp[0].minor.yy0.numval;
-  yylhsminor.yy95.inclusive = 1;
+  yylhsminor.yy83.num = yymsp[0].minor.yy0.numval;
+  yylhsminor.yy83.inclusive = 1;
 }
-  yymsp[0].minor.yy95 = yylhsminor.yy95;
+  yymsp[0].minor.yy83 = yylhsminor.yy83;
         break;
-      case 80: /* num ::= LP num */
+      case 83: /* num ::= LP num */
 {
-  yymsp[-1].minor.yy95=yymsp[0].minor.yy95;
-  yymsp[-1].minor.yy95.inclusive = 0;
+  yymsp[-1].minor.yy83=yymsp[0].minor.yy83;
+  yymsp[-1].minor.yy83.inclusive = 0;
 }
         break;
-      case 81: /* num ::= MINUS num */
+      case 84: /* num ::= MINUS num */
 {
-  yymsp[0].minor.yy95.num = -yymsp[0].minor.yy95.num;
-  yymsp[-1].minor.yy95 = yymsp[0].minor.yy95;
+  yymsp[0].minor.yy83.num = -yymsp[0].minor.yy83.num;
+  yymsp[-1].minor.yy83 = yymsp[0].minor.yy83;
 }
         break;
-      case 82: /* term ::= TERM */
-      case 83: /* term ::= NUMBER */ yytestcase(yyruleno==83);
-      case 84: /* term ::= SIZE */ yytestcase(yyruleno==84);
+      case 85: /* term ::= TERM */
+      case 86: /* term ::= NUMBER */ yytestcase(yyruleno==86);
+      case 87: /* term ::= SIZE */ yytestcase(yyruleno==87);
 {
   yylhsminor.yy0 = yymsp[0].minor.yy0;
 }
   yymsp[0].minor.yy0 = yylhsminor.yy0;
         break;
-      case 85: /* param_term ::= TERM */
-      case 86: /* param_term ::= NUMBER */ yytestcase(yyruleno==86);
-      case 87: /* param_term ::= SIZE */ yytestcase(yyruleno==87);
-      case 93: /* param_any ::= TERM */ yytestcase(yyruleno==93);
+      case 88: /* param_term ::= TERM */
+      case 89: /* param_term ::= NUMBER */ yytestcase(yyruleno==89);
+      case 90: /* param_term ::= SIZE */ yytestcase(yyruleno==90);
+      case 96: /* param_any ::= TERM */ yytestcase(yyruleno==96);
 {
   yylhsminor.yy0 = yymsp[0].minor.yy0;
   yylhsminor.yy0.type = QT_TERM;
 }
   yymsp[0].minor.yy0 = yylhsminor.yy0;
         break;
-      case 88: /* param_term ::= ATTRIBUTE */
+      case 91: /* param_term ::= ATTRIBUTE */
 {
   yylhsminor.yy0 = yymsp[0].minor.yy0;
   yylhsminor.yy0.type = QT_PARAM_TERM;
 }
   yymsp[0].minor.yy0 = yylhsminor.yy0;
         break;
-      case 89: /* param_size ::= SIZE */
+      case 92: /* param_size ::= SIZE */
 {
   yylhsminor.yy0 = yymsp[0].minor.yy0;
   yylhsminor.yy0.type = QT_SIZE;
 }
   yymsp[0].minor.yy0 = yylhsminor.yy0;
         break;
-      case 90: /* param_size ::= ATTRIBUTE */
+      case 93: /* param_size ::= ATTRIBUTE */
 {
   yylhsminor.yy0 = yymsp[0].minor.yy0;
   yylhsminor.yy0.type = QT_PARAM_SIZE;
 }
   yymsp[0].minor.yy0 = yylhsminor.yy0;
         break;
-      case 91: /* param_any ::= ATTRIBUTE */
+      case 94: /* param_any ::= ATTRIBUTE */
 {
   yylhsminor.yy0 = yymsp[0].minor.yy0;
   yylhsminor.yy0.type = QT_PARAM_ANY;
@@ -2196,30 +2294,30 @@ yylhsminor.yy103 = yymsp[0].minor.yy103;
 }
   yymsp[0].minor.yy0 = yylhsminor.yy0;
         break;
-      case 92: /* param_any ::= LP ATTRIBUTE */
+      case 95: /* param_any ::= LP ATTRIBUTE */
 {
   yymsp[-1].minor.yy0 = yymsp[0].minor.yy0;
   yymsp[-1].minor.yy0.type = QT_PARAM_ANY;
   yymsp[-1].minor.yy0.inclusive = 0; // Could be relevant if type is refined
 }
         break;
-      case 94: /* param_any ::= num */
+      case 97: /* param_any ::= num */
 {
-  yylhsminor.yy0.numval = yymsp[0].minor.yy95.num;
-  yylhsminor.yy0.inclusive = yymsp[0].minor.yy95.inclusive;
+  yylhsminor.yy0.numval = yymsp[0].minor.yy83.num;
+  yylhsminor.yy0.inclusive = yymsp[0].minor.yy83.inclusive;
   yylhsminor.yy0.type = QT_NUMERIC;
 }
   yymsp[0].minor.yy0 = yylhsminor.yy0;
         break;
-      case 96: /* star ::= LP star RP */
+      case 99: /* star ::= LP star RP */
 {
 }
-  yy_destructor(yypParser,54,&yymsp[-1].minor);
+  yy_destructor(yypParser,55,&yymsp[-1].minor);
         break;
       default:
-      /* (95) star ::= STAR */ yytestcase(yyruleno==95);
-      /* (97) as ::= AS_T */ yytestcase(yyruleno==97);
-      /* (98) as ::= AS_S */ yytestcase(yyruleno==98);
+      /* (98) star ::= STAR */ yytestcase(yyruleno==98);
+      /* (100) as ::= AS_T */ yytestcase(yyruleno==100);
+      /* (101) as ::= AS_S */ yytestcase(yyruleno==101);
         break;
 /********** End reduce actions ************************************************/
   };
@@ -176,6 +176,9 @@ static void reportSyntaxError(QueryError *status, QueryToken* tok, const char *m
 %type geo_filter { QueryParam *}
 %destructor geo_filter { QueryParam_Free($$); }
 
+%type geo_coords { QueryToken *}
+%destructor geo_coords { array_free($$); }
+
 %type vector_query { QueryNode *}
 %destructor vector_query { QueryNode_Free($$); }
 
@@ -814,6 +817,9 @@ expr(A) ::= modifier(B) COLON geo_filter(C). {
   if (C) {
     // we keep the capitalization as is
     C->gf->property = rm_strndup(B.s, B.len);
+    if (C->gf->knn) {
+      RedisModule_Assert(-1 != (rm_asprintf(&C->gf->scoreField, "__%.*s_distance", B.len, B.s)));
+    }
     A = NewGeofilterNode(C);
   } else {
     A = NewQueryNode(QN_NULL);
@@ -825,29 +831,100 @@ geo_filter(A) ::= LSQB param_any(B) param_any(C) param_any(D) param_any(E) RSQB.
   // and detect syntax errors
   QueryToken *badToken = NULL;
 
-  if (B.type == QT_PARAM_ANY)
-    B.type = QT_PARAM_GEO_COORD;
-  else if (B.type != QT_NUMERIC)
+  // [KNN k lon lat] asks for the k nearest points instead of the points within a radius
+  if (B.type == QT_TERM && B.len == 3 && !strncasecmp("KNN", B.s, B.len)) {
+    if (C.type == QT_PARAM_ANY)
+      C.type = QT_PARAM_SIZE;
+    else if (C.type == QT_NUMERIC && C.numval >= 1 && C.numval == (size_t)C.numval && C.inclusive)
+      C.type = QT_SIZE;
+    else
+      badToken = &C;
+    if (D.type == QT_PARAM_ANY)
+      D.type = QT_PARAM_GEO_COORD;
+    else if (!badToken && D.type != QT_NUMERIC)
+      badToken = &D;
+    if (E.type == QT_PARAM_ANY)
+      E.type = QT_PARAM_GEO_COORD;
+    else if (!badToken && E.type != QT_NUMERIC)
+      badToken = &E;
+
+    if (!badToken) {
+      A = NewGeoKnnQueryParam_WithParams(ctx, &C, &D, &E);
+    } else {
+      reportSyntaxError(ctx->status, badToken, "Syntax error");
+      A = NULL;
+    }
+  } else {
+    if (B.type == QT_PARAM_ANY)
+      B.type = QT_PARAM_GEO_COORD;
+    else if (B.type != QT_NUMERIC)
+      badToken = &B;
+    if (C.type == QT_PARAM_ANY)
+      C.type = QT_PARAM_GEO_COORD;
+    else if (!badToken && C.type != QT_NUMERIC)
+      badToken = &C;
+    if (D.type == QT_PARAM_ANY)
+      D.type = QT_PARAM_NUMERIC;
+    else if (!badToken && D.type != QT_NUMERIC)
+      badToken = &D;
+    if (E.type == QT_PARAM_ANY)
+      E.type = QT_PARAM_GEO_UNIT;
+    else if (!badToken && E.type != QT_TERM)
+      badToken = &E;
+
+    if (!badToken) {
+      A = NewGeoFilterQueryParam_WithParams(ctx, &B, &C, &D, &E);
+    } else {
+      reportSyntaxError(ctx->status, badToken, "Syntax error");
+      A = NULL;
+    }
+  }
+}
+
+// [BBOX minLon minLat maxLon maxLat] and [POLYGON lon1 lat1 lon2 lat2 lon3 lat3 ...] ask for the
+// points within a shape
+geo_filter(A) ::= LSQB param_any(B) param_any(C) param_any(D) param_any(E) geo_coords(F) RSQB. [NUMBER] {
+  QueryToken *coords = array_new(QueryToken, array_len(F) + 3);
+  coords = array_append(coords, C);
+  coords = array_append(coords, D);
+  coords = array_append(coords, E);
+  for (size_t i = 0; i < array_len(F); ++i) {
+    coords = array_append(coords, F[i]);
+  }
+  array_free(F);
+  size_t n = array_len(coords);
+
+  QueryToken *badToken = NULL;
+  GeoShape shape = GEO_SHAPE_RADIUS;
+  if (B.type == QT_TERM && B.len == 4 && !strncasecmp("BBOX", B.s, B.len) && n == 4)
+    shape = GEO_SHAPE_BOX;
+  else if (B.type == QT_TERM && B.len == 7 && !strncasecmp("POLYGON", B.s, B.len) && n >= 6 && n % 2 == 0)
+    shape = GEO_SHAPE_POLYGON;
+  else
     badToken = &B;
-  if (C.type == QT_PARAM_ANY)
-    C.type = QT_PARAM_GEO_COORD;
-  else if (!badToken && C.type != QT_NUMERIC)
-    badToken = &C;
-  if (D.type == QT_PARAM_ANY)
-    D.type = QT_PARAM_NUMERIC;
-  else if (!badToken && D.type != QT_NUMERIC)
-    badToken = &D;
-  if (E.type == QT_PARAM_ANY)
-    E.type = QT_PARAM_GEO_UNIT;
-  else if (!badToken && E.type != QT_TERM)
-    badToken = &E;
+  for (size_t i = 0; i < n && !badToken; ++i) {
+    if (coords[i].type == QT_PARAM_ANY)
+      coords[i].type = QT_PARAM_GEO_COORD;
+    else if (coords[i].type != QT_NUMERIC)
+      badToken = &coords[i];
+  }
 
   if (!badToken) {
-    A = NewGeoFilterQueryParam_WithParams(ctx, &B, &C, &D, &E);
+    A = NewGeoShapeQueryParam_WithParams(ctx, shape, coords, n);
   } else {
     reportSyntaxError(ctx->status, badToken, "Syntax error");
     A = NULL;
   }
+  array_free(coords);
+}
+
+geo_coords(A) ::= param_any(B). {
+  A = array_new(QueryToken, 8);
+  A = array_append(A, B);
+}
+
+geo_coords(A) ::= geo_coords(B) param_any(C). {
+  A = array_append(B, C);
 }
 
 /////////////////////////////////////////////////////////////////
@@ -34,6 +34,8 @@ void *InvertedIndex_RdbLoad(RedisModuleIO *rdb, int encver) {
     blk->firstId = RedisModule_LoadUnsigned(rdb);
     blk->lastId = RedisModule_LoadUnsigned(rdb);
     blk->numDocs = RedisModule_LoadUnsigned(rdb);
+    // the frequency bound is not persisted, so it is unknown for loaded blocks
+    blk->maxFreq = UINT32_MAX;
     if (blk->numDocs > 0) {
       ++actualSize;
     }
@@ -57,6 +59,8 @@ void *InvertedIndex_RdbLoad(RedisModuleIO *rdb, int encver) {
   } else {
     idx->blocks = rm_realloc(idx->blocks, idx->size * sizeof(IndexBlock));
   }
+  // packed blocks are saved varint encoded
+  InvertedIndex_SealBlocks(idx);
   return idx;
 }
 void InvertedIndex_RdbSave(RedisModuleIO *rdb, void *value) {
@@ -83,7 +87,13 @@ void InvertedIndex_RdbSave(RedisModuleIO *rdb, void *value) {
     RedisModule_SaveUnsigned(rdb, blk->firstId);
     RedisModule_SaveUnsigned(rdb, blk->lastId);
     RedisModule_SaveUnsigned(rdb, blk->numDocs);
-    if (IndexBlock_DataLen(blk)) {
+    if (blk->type != IndexBlock_Encoded) {
+      // save the docIds as a regular docId-only block, to keep the rdb format unchanged
+      Buffer encoded = {0};
+      IndexBlock_EncodeDocIds(blk, &encoded);
+      RedisModule_SaveStringBuffer(rdb, encoded.data, encoded.offset);
+      Buffer_Free(&encoded);
+    } else if (IndexBlock_DataLen(blk)) {
       RedisModule_SaveStringBuffer(rdb, IndexBlock_DataBuf(blk), IndexBlock_DataLen(blk));
     } else {
       RedisModule_SaveStringBuffer(rdb, "", 0);
@@ -107,7 +107,6 @@ typedef struct RSDocumentMetadata_s {
   struct RSSortingVector *sortVector;
   /* Offsets of all terms in the document (in bytes). Used by highlighter */
   struct RSByteOffsets *byteOffsets;
-  DLLIST2_node llnode;
 
   /* Optional user payload */
   RSPayload *payload;
@@ -8,6 +8,7 @@
 #include "query_internal.h"
 #include "numeric_filter.h"
 #include "suffix.h"
+#include "ngram.h"
 #include "query.h"
 #include "indexer.h"
 #include "extension.h"
@@ -159,6 +160,15 @@ RSFieldID RediSearch_CreateField(IndexSpec* sp, const char* name, unsigned types
       }    
     }
   }
+  if (options & RSFLDOPT_WITHNGRAMS) {
+    fs->options |= FieldSpec_WithNgrams;
+    if (fs->types == INDEXFLD_T_FULLTEXT) {
+      sp->ngramMask |= FIELD_BIT(fs);
+      if (!sp->ngrams) {
+        sp->ngrams = NewNgramIndex(NGRAM_LEN);
+      }
+    }
+  }
 
   RWLOCK_RELEASE();
   return fs->index;
@@ -227,6 +237,7 @@ int RediSearch_DeleteDocument(IndexSpec* sp, const void* docKey, size_t len) {
     if (DocTable_Delete(&sp->docs, docKey, len)) {
       // Delete returns true/false, not RM_{OK,ERR}
       sp->stats.numDocuments--;
+      sp->revision++;
       if (sp->gc) {
         GCContext_OnDelete(sp->gc);
       }
@@ -366,7 +377,7 @@ QueryNode* RediSearch_CreateGeoNode(IndexSpec* sp, const char* field, double lat
   QueryNode* ret = NewQueryNode(QN_GEO);
   ret->opts.fieldMask = IndexSpec_GetFieldBit(sp, field, strlen(field));
 
-  GeoFilter *flt = rm_malloc(sizeof(*flt));
+  GeoFilter *flt = rm_calloc(1, sizeof(*flt));
   flt->lat = lat;
   flt->lon = lon;
   flt->radius = radius;
@@ -804,7 +815,7 @@ int RediSearch_IndexInfo(RSIndex* sp, RSIdxInfo *info) {
   info->maxDocId = sp->docs.maxDocId;
   info->docTableSize = sp->docs.memsize;
   info->sortablesSize = sp->docs.sortablesSize;
-  info->docTrieSize = TrieMap_MemUsage(sp->docs.dim.tm);
+  info->docTrieSize = DocIdMap_MemUsage(&sp->docs.dim);
   info->numTerms = sp->stats.numTerms;
   info->numRecords = sp->stats.numRecords;
   info->invertedSize = sp->stats.invertedSize;
@@ -60,6 +60,7 @@ typedef struct RSIdxOptions RSIndexOptions;
 #define RSFLDOPT_TXTNOSTEM 0x04
 #define RSFLDOPT_TXTPHONETIC 0x08
 #define RSFLDOPT_WITHSUFFIXTRIE 0x10
+#define RSFLDOPT_WITHNGRAMS 0x20
 
 // This enum copies
 typedef enum {
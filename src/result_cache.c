@@ -0,0 +1,109 @@
+#include "result_cache.h"
+#include "config.h"
+#include "rmalloc.h"
+#include "util/dict.h"
+
+#include <string.h>
+#include <time.h>
+
+CachedResultPage *NewCachedResultPage(void) {
+  CachedResultPage *p = rm_calloc(1, sizeof(*p));
+  p->refcount = 1;
+  return p;
+}
+
+void CachedResultPage_Decref(CachedResultPage *p) {
+  if (__sync_sub_and_fetch(&p->refcount, 1)) {
+    return;
+  }
+  rm_free(p->results);
+  rm_free(p);
+}
+
+ResultCache *NewResultCache(void) {
+  ResultCache *c = rm_calloc(1, sizeof(*c));
+  c->entries = dictCreate(&dictTypeHeapStrings, NULL);
+  dllist_init(&c->lru);
+  return c;
+}
+
+static long long nowMillis(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static void ResultCache_Remove(ResultCache *c, ResultCacheEntry *e) {
+  dictDelete(c->entries, e->key);
+  dllist_delete(&e->llnode);
+  c->memsize -= e->memsize;
+  CachedResultPage_Decref(e->page);
+  rm_free(e->key);
+  rm_free(e);
+}
+
+CachedResultPage *ResultCache_Get(ResultCache *c, const char *key, uint64_t revision) {
+  dictEntry *de = dictFind(c->entries, key);
+  if (!de) {
+    c->misses++;
+    return NULL;
+  }
+  ResultCacheEntry *e = dictGetVal(de);
+  if (e->revision != revision || (e->expires && e->expires <= nowMillis())) {
+    ResultCache_Remove(c, e);
+    c->misses++;
+    return NULL;
+  }
+  c->hits++;
+  dllist_delete(&e->llnode);
+  dllist_prepend(&c->lru, &e->llnode);
+  CachedResultPage_Incref(e->page);
+  return e->page;
+}
+
+void ResultCache_Put(ResultCache *c, const char *key, uint64_t revision, CachedResultPage *page) {
+  size_t capacity = RSGlobalConfig.resultCacheSize;
+  size_t maxMemory = RSGlobalConfig.resultCacheMaxMemory;
+  dictEntry *de = dictFind(c->entries, key);
+  if (de) {
+    ResultCache_Remove(c, dictGetVal(de));
+  }
+  // the page is shared with the queries reading it, so all of it is accounted to the cache
+  size_t memsize = sizeof(ResultCacheEntry) + strlen(key) + 1 + sizeof(*page) +
+                   page->len * sizeof(*page->results);
+  if (!capacity || memsize > maxMemory) {
+    return;
+  }
+  while (dictSize(c->entries) >= capacity || c->memsize + memsize > maxMemory) {
+    ResultCache_Remove(c, DLLIST_ITEM(c->lru.prev, ResultCacheEntry, llnode));
+  }
+
+  ResultCacheEntry *e = rm_calloc(1, sizeof(*e));
+  e->memsize = memsize;
+  c->memsize += memsize;
+  e->key = rm_strdup(key);
+  e->revision = revision;
+  if (RSGlobalConfig.resultCacheTTL) {
+    e->expires = nowMillis() + RSGlobalConfig.resultCacheTTL;
+  }
+  e->page = page;
+  CachedResultPage_Incref(page);
+  dictAdd(c->entries, e->key, e);
+  dllist_prepend(&c->lru, &e->llnode);
+}
+
+void ResultCache_Clear(ResultCache *c) {
+  while (!DLLIST_IS_EMPTY(&c->lru)) {
+    ResultCache_Remove(c, DLLIST_ITEM(c->lru.next, ResultCacheEntry, llnode));
+  }
+}
+
+size_t ResultCache_NumEntries(const ResultCache *c) {
+  return dictSize(c->entries);
+}
+
+void ResultCache_Free(ResultCache *c) {
+  ResultCache_Clear(c);
+  dictRelease(c->entries);
+  rm_free(c);
+}
@@ -0,0 +1,76 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "redisearch.h"
+#include "util/dllist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  t_docId docId;
+  double score;
+} CachedResult;
+
+/* The results of a query as they leave the sorter, i.e. the top offset+limit documents in their
+ * final order, along with the total number of matches. Pages are immutable once cached and are
+ * shared by reference between the cache and the queries reading them */
+typedef struct {
+  CachedResult *results;
+  size_t len;
+  uint32_t total;
+  // atomic, a request reading a page may be freed by a search thread without holding the GIL
+  uint32_t refcount;
+} CachedResultPage;
+
+CachedResultPage *NewCachedResultPage(void);
+
+static inline void CachedResultPage_Incref(CachedResultPage *p) {
+  __sync_fetch_and_add(&p->refcount, 1);
+}
+void CachedResultPage_Decref(CachedResultPage *p);
+
+typedef struct {
+  DLLIST_node llnode;
+  char *key;
+  // the index revision the page was computed at
+  uint64_t revision;
+  // expiration time in milliseconds of the monotonic clock, or 0 if the entry never expires
+  long long expires;
+  CachedResultPage *page;
+  size_t memsize;
+} ResultCacheEntry;
+
+/* A least recently used cache of the result pages of an index, keyed by the normalized query and
+ * the search options affecting its results. An entry is only served while the index revision it
+ * was computed at is still current, so any write to the index invalidates all the entries */
+typedef struct ResultCache {
+  struct dict *entries;
+  // most recently used first
+  DLLIST lru;
+  size_t memsize;
+  size_t hits;
+  size_t misses;
+} ResultCache;
+
+ResultCache *NewResultCache(void);
+void ResultCache_Free(ResultCache *c);
+
+/* Returns a new reference to the page cached for key at the given revision, or NULL. Stale and
+ * expired entries are evicted on lookup */
+CachedResultPage *ResultCache_Get(ResultCache *c, const char *key, uint64_t revision);
+
+/* Caches a page computed at the given revision, taking a reference to it. Least recently used
+ * entries are evicted to stay within RESULT_CACHE_SIZE entries and RESULT_CACHE_MAX_MEMORY bytes.
+ * A page larger than RESULT_CACHE_MAX_MEMORY is not cached */
+void ResultCache_Put(ResultCache *c, const char *key, uint64_t revision, CachedResultPage *page);
+
+void ResultCache_Clear(ResultCache *c);
+
+size_t ResultCache_NumEntries(const ResultCache *c);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -5,6 +5,7 @@
 #include "ext/default.h"
 #include "rmutil/rm_assert.h"
 #include "util/timeout.h"
+#include "tag_index.h"
 
 /*******************************************************************************************************************
  *  General Result Processor Helper functions
@@ -98,7 +99,11 @@ static int rpidxNext(ResultProcessor *base, SearchResult *res) {
         continue;
     }
 
-    dmd = DocTable_Get(&RP_SPEC(base)->docs, r->docId);
+    const DocTable *dt = &RP_SPEC(base)->docs;
+    if (DocTable_IsDeleted(dt, r->docId)) {
+      continue;
+    }
+    dmd = DocTable_Get(dt, r->docId);
     if (!dmd || (dmd->flags & Document_Deleted)) {
       continue;
     }
@@ -171,6 +176,325 @@ void QITR_FreeChain(QueryIterator *qitr) {
   }
 }
 
+/*******************************************************************************************************************
+ *  Cached Results Processor
+ *
+ * Replaces the index iterator when the results of the query are found in the result cache of the
+ * index. Results are yielded with the score they were cached with, and the total number of
+ * results is the one computed when they were cached.
+ *******************************************************************************************************************/
+
+typedef struct {
+  ResultProcessor base;
+  CachedResultPage *page;
+  size_t pos;
+} RPCachedResults;
+
+static int rpcachedNext(ResultProcessor *base, SearchResult *res) {
+  RPCachedResults *self = (RPCachedResults *)base;
+  if (!self->pos) {
+    base->parent->totalResults = self->page->total;
+  }
+
+  while (self->pos < self->page->len) {
+    const CachedResult *cr = &self->page->results[self->pos++];
+    RSDocumentMetadata *dmd = DocTable_Get(&RP_SPEC(base)->docs, cr->docId);
+    if (!dmd || (dmd->flags & Document_Deleted)) {
+      continue;
+    }
+    res->docId = cr->docId;
+    res->score = cr->score;
+    res->dmd = dmd;
+    res->rowdata.sv = dmd->sortVector;
+    DMD_Incref(dmd);
+    return RS_RESULT_OK;
+  }
+  // don't reset the total on the next call
+  self->pos = self->page->len + 1;
+  return RS_RESULT_EOF;
+}
+
+static void rpcachedFree(ResultProcessor *base) {
+  rm_free(base);
+}
+
+ResultProcessor *RPCachedResults_New(CachedResultPage *page) {
+  RPCachedResults *ret = rm_calloc(1, sizeof(*ret));
+  ret->page = page;
+  ret->base.Next = rpcachedNext;
+  ret->base.Free = rpcachedFree;
+  ret->base.type = RP_CACHED_RESULTS;
+  return &ret->base;
+}
+
+/*******************************************************************************************************************
+ *  Counted Results Processor
+ *
+ * Replaces the index iterator of count requests whose number of results was computed from the
+ * index without reading the results.
+ *******************************************************************************************************************/
+
+typedef struct {
+  ResultProcessor base;
+  size_t total;
+} RPCountedResults;
+
+static int rpcountedNext(ResultProcessor *base, SearchResult *res) {
+  RPCountedResults *self = (RPCountedResults *)base;
+  base->parent->totalResults = self->total;
+  return RS_RESULT_EOF;
+}
+
+static void rpcountedFree(ResultProcessor *base) {
+  rm_free(base);
+}
+
+ResultProcessor *RPCountedResults_New(size_t total) {
+  RPCountedResults *ret = rm_calloc(1, sizeof(*ret));
+  ret->total = total;
+  ret->base.Next = rpcountedNext;
+  ret->base.Free = rpcountedFree;
+  ret->base.type = RP_COUNTED_RESULTS;
+  return &ret->base;
+}
+
+/*******************************************************************************************************************
+ *  Tag Facets Processor
+ *
+ * Replaces the grouper of a GROUPBY on a tag field with bitsets whose reducers are all COUNT. The
+ * docIds of the results are set in a bitmap, and the count of each value of the field is the
+ * popcount of the bitmap and the bitset of the value, so the documents are never loaded. The
+ * documents without any value are counted in a group whose value is null.
+ *******************************************************************************************************************/
+
+typedef struct {
+  char *value;  // NULL for the documents without a value
+  size_t len;
+  size_t count;
+} TagFacet;
+
+typedef struct {
+  ResultProcessor base;
+  char *fieldName;
+  const RLookupKey *valueKey;
+  const RLookupKey **countKeys;
+  size_t ncounts;
+  uint64_t *words;  // bitmap of the docIds of the results
+  size_t nwords;
+  size_t numResults;
+  TagFacet *facets;
+  size_t nfacets;
+  size_t pos;
+} RPTagFacets;
+
+static size_t tagFacets_Count(const RPTagFacets *self, const TagBitset *b, uint64_t *seen) {
+  size_t count = 0, n = MIN(self->nwords, b->nwords);
+  for (size_t i = 0; i < n; ++i) {
+    count += __builtin_popcountll(self->words[i] & b->words[i]);
+    seen[i] |= b->words[i];
+  }
+  return count;
+}
+
+static void tagFacets_Compute(RPTagFacets *self) {
+  RedisSearchCtx *sctx = self->base.parent->sctx;
+  const FieldSpec *fs = IndexSpec_GetField(sctx->spec, self->fieldName, strlen(self->fieldName));
+  RedisModuleKey *k = NULL;
+  TagIndex *idx = NULL;
+  if (fs) {
+    RedisModuleString *kstr = IndexSpec_GetFormattedKey(sctx->spec, fs, INDEXFLD_T_TAG);
+    idx = TagIndex_Open(sctx, kstr, 0, &k);
+  }
+
+  // union of the bitsets of all values, to count the results without any value
+  uint64_t *seen = rm_calloc(MAX(self->nwords, 1), sizeof(*seen));
+  size_t withValue = 0;
+  if (idx) {
+    TagIndex_EnableBitsets(idx);
+    self->facets = rm_calloc(TagIndex_NumValues(idx) + 1, sizeof(*self->facets));
+    TrieMapIterator *it = TrieMap_Iterate(idx->bitsets, "", 0);
+    char *value;
+    tm_len_t len;
+    TagBitset *b;
+    while (TrieMapIterator_Next(it, &value, &len, (void **)&b)) {
+      size_t count = tagFacets_Count(self, b, seen);
+      if (count) {
+        self->facets[self->nfacets++] =
+            (TagFacet){.value = rm_strndup(value, len), .len = len, .count = count};
+      }
+    }
+    TrieMapIterator_Free(it);
+  }
+  if (k) {
+    RedisModule_CloseKey(k);
+  }
+
+  for (size_t i = 0; i < self->nwords; ++i) {
+    withValue += __builtin_popcountll(self->words[i] & seen[i]);
+  }
+  rm_free(seen);
+  if (withValue < self->numResults) {
+    if (!self->facets) {
+      self->facets = rm_calloc(1, sizeof(*self->facets));
+    }
+    self->facets[self->nfacets++] = (TagFacet){.count = self->numResults - withValue};
+  }
+}
+
+static int rptagfacetsYield(ResultProcessor *base, SearchResult *res) {
+  RPTagFacets *self = (RPTagFacets *)base;
+  if (self->pos == self->nfacets) {
+    return RS_RESULT_EOF;
+  }
+  const TagFacet *f = &self->facets[self->pos++];
+  RLookup_WriteOwnKey(self->valueKey, &res->rowdata,
+                      f->value ? RS_NewCopiedString(f->value, f->len) : RS_NullVal());
+  for (size_t i = 0; i < self->ncounts; ++i) {
+    RLookup_WriteOwnKey(self->countKeys[i], &res->rowdata, RS_NumVal(f->count));
+  }
+  return RS_RESULT_OK;
+}
+
+static int rptagfacetsAccum(ResultProcessor *base, SearchResult *res) {
+  RPTagFacets *self = (RPTagFacets *)base;
+  int rc;
+  while ((rc = base->upstream->Next(base->upstream, res)) == RS_RESULT_OK) {
+    size_t w = res->docId / 64;
+    if (w >= self->nwords) {
+      size_t nwords = MAX(w + 1, self->nwords + self->nwords / 2);
+      self->words = rm_realloc(self->words, nwords * sizeof(*self->words));
+      memset(self->words + self->nwords, 0, (nwords - self->nwords) * sizeof(*self->words));
+      self->nwords = nwords;
+    }
+    // a document is counted once, even if the upstream yields it more than once
+    if (!(self->words[w] & (1ULL << (res->docId % 64)))) {
+      self->words[w] |= 1ULL << (res->docId % 64);
+      self->numResults++;
+    }
+    SearchResult_Clear(res);
+  }
+  if (rc != RS_RESULT_EOF) {
+    return rc;
+  }
+  tagFacets_Compute(self);
+  base->Next = rptagfacetsYield;
+  base->parent->totalResults = self->nfacets;
+  return rptagfacetsYield(base, res);
+}
+
+static void rptagfacetsFree(ResultProcessor *base) {
+  RPTagFacets *self = (RPTagFacets *)base;
+  for (size_t i = 0; i < self->nfacets; ++i) {
+    rm_free(self->facets[i].value);
+  }
+  rm_free(self->facets);
+  rm_free(self->words);
+  rm_free(self->countKeys);
+  rm_free(self->fieldName);
+  rm_free(self);
+}
+
+ResultProcessor *RPTagFacets_New(const char *fieldName, const RLookupKey *valueKey,
+                                 const RLookupKey **countKeys, size_t ncounts) {
+  RPTagFacets *ret = rm_calloc(1, sizeof(*ret));
+  ret->fieldName = rm_strdup(fieldName);
+  ret->valueKey = valueKey;
+  ret->countKeys = rm_calloc(MAX(ncounts, 1), sizeof(*countKeys));
+  memcpy(ret->countKeys, countKeys, ncounts * sizeof(*countKeys));
+  ret->ncounts = ncounts;
+  ret->base.Next = rptagfacetsAccum;
+  ret->base.Free = rptagfacetsFree;
+  ret->base.type = RP_TAG_FACETS;
+  return &ret->base;
+}
+
+/*******************************************************************************************************************
+ *  Result Cache Writer Processor
+ *
+ * Placed right after the sorter (or the counter), it drains its upstream, which holds at most
+ * offset+limit results, caches their docIds and scores, and then yields them as they came. The
+ * results are not cached if the query timed out or if the index was written to while the query
+ * was running.
+ *******************************************************************************************************************/
+
+typedef struct {
+  ResultProcessor base;
+  const char *key;
+  uint64_t revision;
+  SearchResult **pending;
+  size_t pos;
+  // the return code of the upstream, yielded once the pending results are exhausted
+  int rc;
+} RPResultCacheWriter;
+
+static int rpcachewriterNext_Yield(ResultProcessor *base, SearchResult *r) {
+  RPResultCacheWriter *self = (RPResultCacheWriter *)base;
+  if (self->pos < array_len(self->pending)) {
+    SearchResult *sr = self->pending[self->pos++];
+    RLookupRow oldrow = r->rowdata;
+    *r = *sr;
+    rm_free(sr);
+    RLookupRow_Cleanup(&oldrow);
+    return RS_RESULT_OK;
+  }
+  return self->rc;
+}
+
+static int rpcachewriterNext_Accum(ResultProcessor *base, SearchResult *r) {
+  RPResultCacheWriter *self = (RPResultCacheWriter *)base;
+  SearchResult *sr = rm_calloc(1, sizeof(*sr));
+  int rc;
+  while ((rc = base->upstream->Next(base->upstream, sr)) == RS_RESULT_OK) {
+    self->pending = array_append(self->pending, sr);
+    sr = rm_calloc(1, sizeof(*sr));
+  }
+  SearchResult_Destroy(sr);
+  rm_free(sr);
+
+  IndexSpec *spec = RP_SPEC(base);
+  if (rc == RS_RESULT_EOF && spec->revision == self->revision &&
+      (RS_IsMock || TimedOut(&base->parent->sctx->timeout) == NOT_TIMED_OUT)) {
+    CachedResultPage *page = NewCachedResultPage();
+    page->len = array_len(self->pending);
+    page->total = base->parent->totalResults;
+    page->results = rm_malloc(page->len * sizeof(*page->results));
+    for (size_t ii = 0; ii < page->len; ++ii) {
+      page->results[ii].docId = self->pending[ii]->docId;
+      page->results[ii].score = self->pending[ii]->score;
+    }
+    if (!spec->rescache) {
+      spec->rescache = NewResultCache();
+    }
+    ResultCache_Put(spec->rescache, self->key, self->revision, page);
+    CachedResultPage_Decref(page);
+  }
+
+  self->rc = rc;
+  base->Next = rpcachewriterNext_Yield;
+  return rpcachewriterNext_Yield(base, r);
+}
+
+static void rpcachewriterFree(ResultProcessor *base) {
+  RPResultCacheWriter *self = (RPResultCacheWriter *)base;
+  for (size_t ii = self->pos; ii < array_len(self->pending); ++ii) {
+    SearchResult_Destroy(self->pending[ii]);
+    rm_free(self->pending[ii]);
+  }
+  array_free(self->pending);
+  rm_free(self);
+}
+
+ResultProcessor *RPResultCacheWriter_New(const char *key, uint64_t revision) {
+  RPResultCacheWriter *ret = rm_calloc(1, sizeof(*ret));
+  ret->key = key;
+  ret->revision = revision;
+  ret->pending = array_new(SearchResult *, 0);
+  ret->base.Next = rpcachewriterNext_Accum;
+  ret->base.Free = rpcachewriterFree;
+  ret->base.type = RP_RESULT_CACHE_WRITER;
+  return &ret->base;
+}
+
 /*******************************************************************************************************************
  *  Scoring Processor
  *
@@ -256,6 +580,21 @@ typedef struct {
   size_t nkeys;
 } RPVecSim;
 
+static const RSIndexResult *findDistance(const RSIndexResult *r) {
+  if (r->type == RSResultType_Distance) {
+    return r;
+  } else if (!(r->type & RS_RESULT_AGGREGATE)) {
+    return NULL;
+  }
+  for (size_t i = 0; i < r->agg.numChildren; i++) {
+    const RSIndexResult *dist = findDistance(r->agg.children[i]);
+    if (dist) {
+      return dist;
+    }
+  }
+  return NULL;
+}
+
 static int rpvecsimNext(ResultProcessor *base, SearchResult *res) {
   int rc;
   RPVecSim *self = (RPVecSim *)base;
@@ -270,16 +609,12 @@ static int rpvecsimNext(ResultProcessor *base, SearchResult *res) {
   //  this will require scanning the entire IndexResult tree and looking for vector nodes whose score field name
   //  stored in some entry of the self->keys array
   RS_LOG_ASSERT(self->nkeys == 1, "Internal error, number of vector fields in a query is at most 1");
-  for (size_t i = 0; i < self->nkeys; i++) {
-    RSValue *val;
-    if (res->indexResult->type == RSResultType_HybridDistance) {
-      val = RS_NumVal(res->indexResult->agg.children[0]->dist.distance);
-    } else {
-      // The entire query is a TOP-K query, or this is hybrid query that doesn't use the doc score,
-      // so the distance is saved in the root of indexResult.
-      val = RS_NumVal(res->indexResult->dist.distance);
-    }
-    RLookup_WriteOwnKey(self->keys[i], &(res->rowdata), val);
+  // The distance is the root of indexResult when the entire query is a TOP-K query, or a hybrid
+  // query that doesn't use the doc score. Otherwise it is the first distance in the tree, which is
+  // where hybrid and geo KNN results keep it.
+  const RSIndexResult *dist = findDistance(res->indexResult);
+  for (size_t i = 0; i < self->nkeys && dist; i++) {
+    RLookup_WriteOwnKey(self->keys[i], &(res->rowdata), RS_NumVal(dist->dist.distance));
   }
 
   return rc;
@@ -732,7 +1067,8 @@ ResultProcessor *RPLoader_New(RLookup *lk, const RLookupKey **keys, size_t nkeys
 static char *RPTypeLookup[RP_MAX] = {"Index",     "Loader",        "Scorer",      "Sorter",
                                      "Counter",   "Pager/Limiter", "Highlighter", "Grouper",
                                      "Projector", "Filter",        "Profile",     "Network",
-                                     "Vector Similarity Scores Loader"};
+                                     "Vector Similarity Scores Loader", "Cached Results",
+                                     "Result Cache Writer", "Counted Results", "Tag Facets"};
 
 const char *RPTypeToString(ResultProcessorType type) {
   RS_LOG_ASSERT(type >= 0 && type < RP_MAX, "enum is out of range");
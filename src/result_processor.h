@@ -11,6 +11,7 @@
 #include "rlookup.h"
 #include "extension.h"
 #include "score_explain.h"
+#include "result_cache.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +60,10 @@ typedef enum {
   RP_PROFILE,
   RP_NETWORK,
   RP_VECSIM,
+  RP_CACHED_RESULTS,
+  RP_RESULT_CACHE_WRITER,
+  RP_COUNTED_RESULTS,
+  RP_TAG_FACETS,
   RP_MAX,
 } ResultProcessorType;
 
@@ -194,6 +199,30 @@ ResultProcessor *RPIndexIterator_New(IndexIterator *itr, struct timespec timeout
 ResultProcessor *RPScorer_New(const ExtScoringFunctionCtx *funcs,
                               const ScoringFunctionArgs *fnargs);
 
+/**
+ * Root processor yielding the results of a cached page instead of reading the index. The page
+ * must outlive the processor
+ */
+ResultProcessor *RPCachedResults_New(CachedResultPage *page);
+
+/**
+ * Root processor of a count request whose number of results is already known. Yields no results
+ */
+ResultProcessor *RPCountedResults_New(size_t total);
+
+/**
+ * Groups the results of its upstream by the values of a tag field which keeps bitsets, and counts
+ * them. Each value is written to valueKey and its count to each of the countKeys
+ */
+ResultProcessor *RPTagFacets_New(const char *fieldName, const RLookupKey *valueKey,
+                                 const RLookupKey **countKeys, size_t ncounts);
+
+/**
+ * Caches the results of its upstream in the result cache of the index under key, if they were
+ * computed at the given index revision. The key must outlive the processor
+ */
+ResultProcessor *RPResultCacheWriter_New(const char *key, uint64_t revision);
+
 ResultProcessor *RPVecSim_New(const RLookupKey **keys, size_t nkeys);
 
 /** Functions abstracting the sortmap. Hides the bitwise logic */
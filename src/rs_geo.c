@@ -1,4 +1,6 @@
 #include "rs_geo.h"
+#include <math.h>
+#include <sys/param.h>
 
 int encodeGeo(double lon, double lat, double *bits) {
   GeoHashBits hash;
@@ -90,6 +92,73 @@ void calcRanges(double longitude, double latitude, double radius_meters, GeoHash
   calcAllNeighbors(&georadius, longitude, latitude, radius_meters, ranges);
 }
 
+/* The index of the square of a value at a step, out of the 2^step squares of [min, max] */
+static uint64_t squareIndex(double v, double min, double max, int step) {
+  double squares = (double)(1ULL << step);
+  double i = floor((v - min) / (max - min) * squares);
+  return i < 0 ? 0 : i >= squares ? (uint64_t)squares - 1 : (uint64_t)i;
+}
+
+void calcBoxRanges(double minLon, double minLat, double maxLon, double maxLat,
+                   GeoHashRange *ranges) {
+  // points beyond the latitude limits cannot be indexed
+  minLat = MAX(minLat, GEO_LAT_MIN);
+  maxLat = MIN(maxLat, GEO_LAT_MAX);
+  if (minLat > maxLat) {
+    return;
+  }
+  // the longitude intervals of the box, which is split in two at the antimeridian
+  double lons[2][2] = {{minLon, maxLon}, {GEO_LONG_MIN, maxLon}};
+  int nlons = 1;
+  if (minLon > maxLon) {
+    lons[0][1] = GEO_LONG_MAX;
+    nlons = 2;
+  }
+
+  // the finest step has squares which are small enough to only intersect a few of them
+  int step;
+  uint64_t lonFrom[2], lonTo[2], latFrom, latTo;
+  for (step = GEO_STEP_MAX; step >= 1; --step) {
+    latFrom = squareIndex(minLat, GEO_LAT_MIN, GEO_LAT_MAX, step);
+    latTo = squareIndex(maxLat, GEO_LAT_MIN, GEO_LAT_MAX, step);
+    uint64_t count = 0;
+    for (int i = 0; i < nlons; ++i) {
+      lonFrom[i] = squareIndex(lons[i][0], GEO_LONG_MIN, GEO_LONG_MAX, step);
+      lonTo[i] = squareIndex(lons[i][1], GEO_LONG_MIN, GEO_LONG_MAX, step);
+      count += (lonTo[i] - lonFrom[i] + 1) * (latTo - latFrom + 1);
+    }
+    // at step 1 a box intersects at most 2x2 squares on each side of the antimeridian
+    if (count <= GEO_RANGE_COUNT || step == 1) {
+      break;
+    }
+  }
+
+  double lonSize = (double)(GEO_LONG_MAX - GEO_LONG_MIN) / (1ULL << step);
+  double latSize = (GEO_LAT_MAX - GEO_LAT_MIN) / (1ULL << step);
+  size_t n = 0;
+  for (int i = 0; i < nlons; ++i) {
+    for (uint64_t x = lonFrom[i]; x <= lonTo[i]; ++x) {
+      for (uint64_t y = latFrom; y <= latTo; ++y) {
+        GeoHashBits hash;
+        geohashEncodeWGS84(GEO_LONG_MIN + (x + 0.5) * lonSize, GEO_LAT_MIN + (y + 0.5) * latSize,
+                           step, &hash);
+        GeoHashFix52Bits min, max;
+        scoresOfGeoHashBox(hash, &min, &max);
+        // both sides of the antimeridian may share the squares of a coarse step
+        int seen = 0;
+        for (size_t j = 0; j < n; ++j) {
+          seen |= ranges[j].min == min;
+        }
+        if (!seen) {
+          ranges[n].min = min;
+          ranges[n].max = max;
+          ++n;
+        }
+      }
+    }
+  }
+}
+
 bool isWithinRadiusLonLat(double lon1, double lat1, double lon2, double lat2, double radius,
                           double *distance) {
   double dist = geohashGetDistance(lon1, lat1, lon2, lat2);
@@ -124,29 +193,3 @@ int parseGeo(const char *c, size_t len, double *lon, double *lat) {
 
   return REDISMODULE_OK;
 }
-
-/*
-int isWithinRadius(double center, double point, double radius, double *distance) {
-  double xyCenter[2], xyPoint[2];
-  decodeGeo(center, xyCenter);
-  decodeGeo(point, xyPoint);
-  return isWithinRadiusLonLat(xyCenter[0], xyCenter[1], xyPoint[0], xyPoint[1],
-                                    radius, distance);
-}
-
-IndexIterator *NewGeoRangeIterator(GeoIndex *gi, const GeoFilter *gf, double weight) {
-  GeoHashRange ranges[GEO_RANGE_COUNT] = {0};
-  calcRanges(gf, ranges);
-
-  int iterCount = 0;
-  IndexIterator **iters = rm_calloc(GEO_RANGE_COUNT, sizeof(*iters));
-  for (size_t ii = 0; ii < GEO_RANGE_COUNT; ++ii) {
-    if (ranges[ii].min != ranges[ii].max) {
-      NumericFilter *filt = NewNumericFilter(ranges[ii].min, ranges[ii].max, 1, 1);
-      iters[iterCount++] = NewNumericFilterIterator(NULL, filt, NULL);
-    }
-  }
-  iters = rm_realloc(iters, iterCount * sizeof(*iters));
-  IndexIterator *it = NewUnionIterator(iters, iterCount, NULL, 1, 1);
-  return it;
-}*/
\ No newline at end of file
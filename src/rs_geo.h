@@ -25,6 +25,16 @@ int  decodeGeo(double bits, double *xy);
 void calcRanges(double longitude, double latitude, double radius_meters,
                 GeoHashRange *ranges);
 
+/*
+ * Calculate the squares which cover a box, at the finest step at which it
+ * intersects at most GEO_RANGE_COUNT of them. A box whose min longitude is
+ * larger than its max longitude crosses the antimeridian.
+ *
+ * The squares may contain points outside the box, which must be filtered out.
+ */
+void calcBoxRanges(double minLon, double minLat, double maxLon, double maxLat,
+                   GeoHashRange *ranges);
+
 /*
  * Return true is distance is smaller than radius. radius must be in meters.
  * If `distance' is not NULL, the distance value is returned.
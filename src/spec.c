@@ -16,6 +16,9 @@
 #include "redis_index.h"
 #include "indexer.h"
 #include "suffix.h"
+#include "ngram.h"
+#include "expansion_cache.h"
+#include "result_cache.h"
 #include "alias.h"
 #include "module.h"
 #include "aggregate/expr/expression.h"
@@ -355,6 +358,8 @@ static int parseTextField(FieldSpec *fs, ArgsCursor *ac, QueryError *status) {
       continue;
     } else if(AC_AdvanceIfMatch(ac, SPEC_WITHSUFFIXTRIE_STR)) {
       fs->options |= FieldSpec_WithSuffixTrie;
+    } else if (AC_AdvanceIfMatch(ac, SPEC_WITHNGRAMS_STR)) {
+      fs->options |= FieldSpec_WithNgrams;
     } else {
       break;
     }
@@ -678,6 +683,9 @@ static int parseFieldSpec(ArgsCursor *ac, IndexSpec *sp, FieldSpec *fs, QueryErr
     }
   } else if (AC_AdvanceIfMatch(ac, SPEC_NUMERIC_STR)) {  // numeric field
     fs->types |= INDEXFLD_T_NUMERIC;
+    if (AC_AdvanceIfMatch(ac, SPEC_COMPRESSED_STR)) {
+      fs->options |= FieldSpec_Compressed;
+    }
   } else if (AC_AdvanceIfMatch(ac, SPEC_GEO_STR)) {  // geo field
     fs->types |= INDEXFLD_T_GEO;
   } else if (AC_AdvanceIfMatch(ac, SPEC_VECTOR_STR)) {  // vector field
@@ -704,8 +712,14 @@ static int parseFieldSpec(ArgsCursor *ac, IndexSpec *sp, FieldSpec *fs, QueryErr
         fs->tagOpts.tagSep = *sep;
       } else if (AC_AdvanceIfMatch(ac, SPEC_TAG_CASE_SENSITIVE_STR)) {
         fs->tagOpts.tagFlags |= TagField_CaseSensitive;
+      } else if (AC_AdvanceIfMatch(ac, SPEC_COMPRESSED_STR)) {
+        fs->tagOpts.tagFlags |= TagField_Compressed;
+      } else if (AC_AdvanceIfMatch(ac, SPEC_TAG_BITSET_STR)) {
+        fs->tagOpts.tagFlags |= TagField_Bitset;
       } else if (AC_AdvanceIfMatch(ac, SPEC_WITHSUFFIXTRIE_STR)) {
         fs->options |= FieldSpec_WithSuffixTrie;
+      } else if (AC_AdvanceIfMatch(ac, SPEC_WITHNGRAMS_STR)) {
+        fs->options |= FieldSpec_WithNgrams;
       } else {
         break;
       }
@@ -868,6 +882,12 @@ static int IndexSpec_AddFieldsInternal(IndexSpec *sp, ArgsCursor *ac, QueryError
         sp->suffix = NewTrie(suffixTrie_freeCallback);
       }
     }
+    if (FIELD_IS(fs, INDEXFLD_T_FULLTEXT) && FieldSpec_HasNgrams(fs)) {
+      sp->ngramMask |= FIELD_BIT(fs);
+      if (!sp->ngrams) {
+        sp->ngrams = NewNgramIndex(NGRAM_LEN);
+      }
+    }
     fs = NULL;
   }
   return 1;
@@ -894,6 +914,13 @@ int IndexSpec_AddFields(IndexSpec *sp, RedisModuleCtx *ctx, ArgsCursor *ac, bool
                         QueryError *status) {
   setMemoryInfo(ctx);
   int rc = IndexSpec_AddFieldsInternal(sp, ac, status, 0);
+  if (rc) {
+    sp->revision++;
+  }
+  if (rc && sp->expcache) {
+    // a new field can change how expansions are evaluated, e.g. by adding a suffix trie
+    ExpansionCache_Clear(sp->expcache);
+  }
   if (rc && initialScan) {
     IndexSpec_ScanAndReindex(ctx, sp);
   }
@@ -1015,6 +1042,9 @@ int IndexSpec_AddTerm(IndexSpec *sp, const char *term, size_t len) {
     sp->stats.numTerms++;
     sp->stats.termsSize += len;
   }
+  if (sp->expcache) {
+    ExpansionCache_OnTermWrite(sp->expcache, term, len);
+  }
   return isNew;
 }
 
@@ -1202,6 +1232,16 @@ static void IndexSpec_FreeUnlinkedData(IndexSpec *spec) {
   if (spec->suffix) {
     TrieType_Free(spec->suffix);
   }
+  // Free n-gram index
+  NgramIndex_Free(spec->ngrams);
+  // Free cached expansions
+  if (spec->expcache) {
+    ExpansionCache_Free(spec->expcache);
+  }
+  // Free cached results
+  if (spec->rescache) {
+    ResultCache_Free(spec->rescache);
+  }
   // Free spec struct
   rm_free(spec);
 }
@@ -1468,6 +1508,8 @@ IndexSpec *NewIndexSpec(const char *name) {
   sp->terms = NewTrie(NULL);
   sp->suffix = NULL;
   sp->suffixMask = (t_fieldMask)0;
+  sp->ngrams = NULL;
+  sp->ngramMask = (t_fieldMask)0;
   sp->keysDict = NULL;
   sp->getValue = NULL;
   sp->getValueCtx = NULL;
@@ -1963,7 +2005,8 @@ void IndexSpec_AddToInfo(RedisModuleInfoCtx *ctx, IndexSpec *sp) {
   RedisModule_InfoAddFieldDouble(ctx, "offset_vectors_size", sp->stats.offsetVecsSize / (float)0x100000);
   RedisModule_InfoAddFieldDouble(ctx, "doc_table_size", sp->docs.memsize / (float)0x100000);
   RedisModule_InfoAddFieldDouble(ctx, "sortable_values_size", sp->docs.sortablesSize / (float)0x100000);
-  RedisModule_InfoAddFieldDouble(ctx, "key_table_size", TrieMap_MemUsage(sp->docs.dim.tm) / (float)0x100000);
+  RedisModule_InfoAddFieldDouble(ctx, "key_table_size", DocIdMap_MemUsage(&sp->docs.dim) / (float)0x100000);
+  RedisModule_InfoAddFieldDouble(ctx, "deleted_bitmap_size", DocTable_DeletedMemUsage(&sp->docs) / (float)0x100000);
   RedisModule_InfoEndDictField(ctx);
 
   RedisModule_InfoAddFieldULongLong(ctx, "total_inverted_index_blocks", TotalIIBlocks);
@@ -2114,6 +2157,12 @@ IndexSpec *IndexSpec_CreateFromRdb(RedisModuleCtx *ctx, RedisModuleIO *rdb, int
         sp->suffix = NewTrie(suffixTrie_freeCallback);
       }
     }
+    if (FIELD_IS(fs, INDEXFLD_T_FULLTEXT) && FieldSpec_HasNgrams(fs)) {
+      sp->ngramMask |= FIELD_BIT(fs);
+      if (!sp->ngrams) {
+        sp->ngrams = NewNgramIndex(NGRAM_LEN);
+      }
+    }
 
   }
 
@@ -2522,6 +2571,7 @@ int IndexSpec_DeleteDoc(IndexSpec *spec, RedisModuleCtx *ctx, RedisModuleString
   int rc = DocTable_DeleteR(&spec->docs, key);
   if (rc) {
     spec->stats.numDocuments--;
+    spec->revision++;
 
     // Increment the index's garbage collector's scanning frequency after document deletions
     if (spec->gc) {
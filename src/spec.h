@@ -50,10 +50,13 @@ struct DocumentIndexer;
 #define SPEC_NOINDEX_STR "NOINDEX"
 #define SPEC_TAG_SEPARATOR_STR "SEPARATOR"
 #define SPEC_TAG_CASE_SENSITIVE_STR "CASESENSITIVE"
+#define SPEC_COMPRESSED_STR "COMPRESSED"
+#define SPEC_TAG_BITSET_STR "BITSET"
 #define SPEC_MULTITYPE_STR "MULTITYPE"
 #define SPEC_ASYNC_STR "ASYNC"
 #define SPEC_SKIPINITIALSCAN_STR "SKIPINITIALSCAN"
 #define SPEC_WITHSUFFIXTRIE_STR "WITHSUFFIXTRIE"
+#define SPEC_WITHNGRAMS_STR "WITHNGRAMS"
 
 #define DEFAULT_SCORE 1.0
 
@@ -138,6 +141,11 @@ typedef enum {
   Index_HasFieldAlias = 0x4000,
   Index_HasVecSim = 0x8000,
   Index_HasSuffixTrie = 0x10000,
+
+  // Pack the full blocks of a docId-only inverted index with Elias-Fano
+  Index_EliasFano = 0x20000,
+  // Bit-pack the full blocks of a numeric inverted index whose values are integers
+  Index_PackNumeric = 0x40000,
 } IndexFlags;
 
 // redis version (its here because most file include it with no problem,
@@ -168,7 +176,7 @@ typedef uint16_t FieldSpecDedupeArray[SPEC_MAX_FIELDS];
 
 #define INDEX_STORAGE_MASK                                                                  \
   (Index_StoreFreqs | Index_StoreFieldFlags | Index_StoreTermOffsets | Index_StoreNumeric | \
-   Index_WideSchema)
+   Index_WideSchema | Index_EliasFano)
 
 #define INDEX_CURRENT_VERSION 20
 #define INDEX_VECSIM_2_VERSION 20
@@ -241,6 +249,12 @@ typedef struct IndexSpec {
   Trie *terms;                    // Trie of all terms. Used for GC and fuzzy queries
   Trie *suffix;                   // Trie of suffix tokens of terms. Used for contains queries
   t_fieldMask suffixMask;         // Mask of all field that support contains query
+  struct NgramIndex *ngrams;      // N-gram index of terms. Used for contains and suffix queries
+  t_fieldMask ngramMask;          // Mask of all fields with an n-gram index
+  struct ExpansionCache *expcache;// Cached postings of prefix, suffix and contains expansions
+  struct ResultCache *rescache;   // Cached result pages of recent queries
+  uint64_t revision;              // Incremented by every write that can change query results
+  uint32_t activeQueries;         // Requests holding docIds of the index, changed atomically
   dict *keysDict;                 // Global dictionary. Contains inverted indexes of all TEXT terms
 
   RSSortingTable *sortables;      // Contains sortable data of documents
@@ -1,5 +1,6 @@
 #include "tag_index.h"
 #include "suffix.h"
+#include "ngram.h"
 #include "rmalloc.h"
 #include "rmutil/vector.h"
 #include "inverted_index.h"
@@ -9,18 +10,58 @@
 #include "util/arr.h"
 #include "rmutil/rm_assert.h"
 
+#include <ctype.h>
+
 extern RedisModuleCtx *RSDummyContext;
 
 static uint32_t tagUniqueId = 0;
 
 // Tags are limited to 4096 each
 #define MAX_TAG_LEN 0x1000
+// the number of values added to the sorted view of a tag index which are merged into it at once,
+// unless the view is read before
+#define TAG_SORTED_PENDING_MAX 1024
+
+static uint64_t tagValue_Hash(const void *key) {
+  const TagValue *tv = key;
+  return dictGenHashFunction(tv->str, tv->len);
+}
+
+static int tagValue_Equal(void *privdata, const void *key1, const void *key2) {
+  const TagValue *tv1 = key1, *tv2 = key2;
+  return tv1->len == tv2->len && !memcmp(tv1->str, tv2->str, tv1->len);
+}
+
+static void tagValue_Free(void *privdata, void *key) {
+  TagValue *tv = key;
+  InvertedIndex_Free(tv->iv);
+  rm_free(tv);
+}
+
+// the keys are TagValue structs, which are looked up by a TagValue on the stack
+static dictType tagValuesType = {
+    .hashFunction = tagValue_Hash,
+    .keyCompare = tagValue_Equal,
+    .keyDestructor = tagValue_Free,
+};
+
+static TagValue *tagIndex_Find(const TagIndex *idx, const char *value, size_t len) {
+  TagValue key = {.str = value, .len = len};
+  dictEntry *e = dictFind(idx->values, &key);
+  return e ? dictGetKey(e) : NULL;
+}
+
 /* See tag_index.h for documentation  */
 TagIndex *NewTagIndex() {
   TagIndex *idx = rm_new(TagIndex);
-  idx->values = NewTrieMap();
+  idx->values = dictCreate(&tagValuesType, NULL);
+  idx->sorted = NULL;
+  idx->pending = NULL;
   idx->uniqueId = tagUniqueId++;
   idx->suffix = NULL;
+  idx->ngrams = NULL;
+  idx->invIdxFlags = Index_DocIdsOnly;
+  idx->bitsets = NULL;
   return idx;
 }
 
@@ -116,23 +157,195 @@ char **TagIndex_Preprocess(char sep, TagFieldFlags flags, const DocumentField *d
   return ret;
 }
 
-struct InvertedIndex *TagIndex_OpenIndex(TagIndex *idx, const char *value, size_t len, int create) {
-  InvertedIndex *iv = TrieMap_Find(idx->values, (char *)value, len);
-  if (iv == TRIEMAP_NOTFOUND) {
-    if (create) {
-      iv = NewInvertedIndex(Index_DocIdsOnly, 1);
-      TrieMap_Add(idx->values, (char *)value, len, iv, NULL);
+// values are ordered ignoring case, as lexical ranges always compared them
+static int tagValue_Cmp(const char *s1, size_t len1, const char *s2, size_t len2) {
+  for (size_t i = 0; i < MIN(len1, len2); ++i) {
+    int rc = tolower((unsigned char)s1[i]) - tolower((unsigned char)s2[i]);
+    if (rc) {
+      return rc;
     }
   }
+  return len1 < len2 ? -1 : len1 > len2;
+}
+
+static int tagValue_CmpSorted(const void *p1, const void *p2) {
+  const TagValue *tv1 = *(const TagValue **)p1, *tv2 = *(const TagValue **)p2;
+  int rc = tagValue_Cmp(tv1->str, tv1->len, tv2->str, tv2->len);
+  // values which differ only by case are ordered by their bytes
+  return rc ? rc : memcmp(tv1->str, tv2->str, tv1->len);
+}
+
+/* Sort the values added since the sorted view was last read and merge them into it */
+static void tagIndex_MergePending(TagIndex *idx) {
+  size_t n = array_len(idx->sorted), k = array_len(idx->pending);
+  qsort(idx->pending, k, sizeof(*idx->pending), tagValue_CmpSorted);
+  idx->sorted = array_ensure_len(idx->sorted, n + k);
+  // merge from the back, so that the sorted values are moved at most once
+  TagValue **sorted = idx->sorted, **pending = idx->pending;
+  while (k) {
+    if (n && tagValue_CmpSorted(&sorted[n - 1], &pending[k - 1]) > 0) {
+      sorted[n + k - 1] = sorted[n - 1];
+      --n;
+    } else {
+      sorted[n + k - 1] = pending[k - 1];
+      --k;
+    }
+  }
+  array_clear(idx->pending);
+}
+
+/* Remove a value which is about to be deleted from the sorted view or from the pending values */
+static void tagIndex_RemoveSorted(TagIndex *idx, TagValue *tv) {
+  size_t npending = array_len(idx->pending);
+  for (size_t i = 0; i < npending; ++i) {
+    if (idx->pending[i] == tv) {
+      idx->pending[i] = idx->pending[--npending];
+      array_trimm_len(idx->pending, 1);
+      return;
+    }
+  }
+  size_t lo = 0, hi = array_len(idx->sorted);
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (tagValue_CmpSorted(&idx->sorted[mid], &tv) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  RS_LOG_ASSERT(lo < array_len(idx->sorted) && idx->sorted[lo] == tv, "tag value is not sorted");
+  memmove(idx->sorted + lo, idx->sorted + lo + 1,
+          (array_len(idx->sorted) - lo - 1) * sizeof(*idx->sorted));
+  array_trimm_len(idx->sorted, 1);
+}
+
+/* Add a value which is not in the index yet, taking ownership of its inverted index */
+static void tagIndex_AddValue(TagIndex *idx, const char *value, size_t len, InvertedIndex *iv) {
+  TagValue *tv = rm_malloc(sizeof(*tv) + len + 1);
+  char *str = (char *)(tv + 1);
+  memcpy(str, value, len);
+  str[len] = '\0';
+  tv->str = str;
+  tv->len = len;
+  tv->iv = iv;
+  dictAdd(idx->values, tv, NULL);
+  if (idx->sorted) {
+    if (!idx->pending) {
+      idx->pending = array_new(TagValue *, 8);
+    }
+    idx->pending = array_append(idx->pending, tv);
+    if (array_len(idx->pending) >= TAG_SORTED_PENDING_MAX) {
+      tagIndex_MergePending(idx);
+    }
+  }
+}
+
+struct InvertedIndex *TagIndex_OpenIndex(TagIndex *idx, const char *value, size_t len, int create) {
+  TagValue *tv = tagIndex_Find(idx, value, len);
+  if (tv) {
+    return tv->iv;
+  } else if (!create) {
+    return NULL;
+  }
+  InvertedIndex *iv = NewInvertedIndex(idx->invIdxFlags, 1);
+  tagIndex_AddValue(idx, value, len, iv);
   return iv;
 }
 
+void TagIndex_DeleteValue(TagIndex *idx, const char *value, size_t len) {
+  TagValue *tv = tagIndex_Find(idx, value, len);
+  if (!tv) {
+    return;
+  }
+  if (idx->sorted) {
+    tagIndex_RemoveSorted(idx, tv);
+  }
+  dictDelete(idx->values, tv);
+}
+
+size_t TagIndex_NumValues(const TagIndex *idx) {
+  return dictSize(idx->values);
+}
+
+TagValue **TagIndex_SortedValues(TagIndex *idx) {
+  if (!idx->sorted) {
+    size_t i = 0;
+    idx->sorted = array_newlen(TagValue *, dictSize(idx->values));
+    dictIterator *it = dictGetIterator(idx->values);
+    dictEntry *e;
+    while ((e = dictNext(it))) {
+      idx->sorted[i++] = dictGetKey(e);
+    }
+    dictReleaseIterator(it);
+    qsort(idx->sorted, i, sizeof(*idx->sorted), tagValue_CmpSorted);
+  } else if (array_len(idx->pending)) {
+    tagIndex_MergePending(idx);
+  }
+  return idx->sorted;
+}
+
+size_t TagIndex_SeekValue(TagIndex *idx, const char *value, size_t len, int after) {
+  TagValue **sorted = TagIndex_SortedValues(idx);
+  size_t lo = 0, hi = dictSize(idx->values);
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    int rc = tagValue_Cmp(sorted[mid]->str, sorted[mid]->len, value, len);
+    if (rc < 0 || (after && rc == 0)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+static void tagBitset_Set(TagBitset *b, t_docId docId) {
+  size_t word = docId >> 6;
+  if (word >= b->nwords) {
+    // grow by at least a half to keep the number of reallocations logarithmic
+    size_t words = MAX(word + 1, b->nwords + b->nwords / 2);
+    b->words = rm_realloc(b->words, words * sizeof(*b->words));
+    memset(b->words + b->nwords, 0, (words - b->nwords) * sizeof(*b->words));
+    b->nwords = words;
+  }
+  b->words[word] |= 1ULL << (docId & 63);
+}
+
+static void tagBitset_Free(void *p) {
+  TagBitset *b = p;
+  rm_free(b->words);
+  rm_free(b);
+}
+
+static TagBitset *tagBitset_Build(InvertedIndex *iv) {
+  TagBitset *b = rm_calloc(1, sizeof(*b));
+  if (iv->lastId) {
+    b->nwords = (iv->lastId >> 6) + 1;
+    b->words = rm_calloc(b->nwords, sizeof(*b->words));
+  }
+  IndexReader *ir = NewTermIndexReader(iv, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  RSIndexResult *res;
+  while (IR_Read(ir, &res) == INDEXREAD_OK) {
+    tagBitset_Set(b, res->docId);
+  }
+  IR_Free(ir);
+  return b;
+}
+
 /* Ecode a single docId into a specific tag value */
 static inline size_t tagIndex_Put(TagIndex *idx, const char *value, size_t len, t_docId docId) {
 
-  IndexEncoder enc = InvertedIndex_GetEncoder(Index_DocIdsOnly);
   RSIndexResult rec = {.type = RSResultType_Virtual, .docId = docId, .offsetsSz = 0, .freq = 0};
   InvertedIndex *iv = TagIndex_OpenIndex(idx, value, len, 1);
+  IndexEncoder enc = InvertedIndex_GetEncoder(iv->flags);
+  if (idx->bitsets) {
+    TagBitset *b = TrieMap_Find(idx->bitsets, (char *)value, len);
+    if (b == TRIEMAP_NOTFOUND) {
+      b = rm_calloc(1, sizeof(*b));
+      TrieMap_Add(idx->bitsets, (char *)value, len, b, NULL);
+    }
+    tagBitset_Set(b, docId);
+  }
   return InvertedIndex_WriteEntryGeneric(iv, enc, docId, &rec);
 }
 
@@ -147,6 +360,9 @@ size_t TagIndex_Index(TagIndex *idx, const char **values, size_t n, t_docId docI
       if (idx->suffix) { // add to suffix triemap if exist 
         addSuffixTrieMap(idx->suffix, tok, strlen(tok));
       }
+      if (idx->ngrams) {
+        NgramIndex_Add(idx->ngrams, tok, strlen(tok));
+      }
     }
   }
   return ret;
@@ -171,7 +387,7 @@ static void TagReader_OnReopen(void *privdata) {
       // the GC might have deleted it by now.
       InvertedIndex *idx = TagIndex_OpenIndex(ctx->idx, ir->record->term.term->str,
                                                     ir->record->term.term->len, 0);
-      if (idx == TRIEMAP_NOTFOUND || ir->idx != idx) {
+      if (!idx || ir->idx != idx) {
         // the inverted index was collected entirely by GC, lets stop searching.
         // notice, it might be that a new inverted index was created, we will not
         // continue read those results and we are not promise that documents
@@ -196,6 +412,11 @@ static void TagReader_OnReopen(void *privdata) {
       ir->currentBlock = 0;
       ir->br = NewBufferReader(&ir->idx->blocks[ir->currentBlock].buf);
       ir->lastId = 0;
+      ir->bitPos = 0;
+      if (ir->window) {
+        ir->window->len = ir->window->cur = 0;
+        continue;
+      }
 
       // seek to the previous last id
       RSIndexResult *dummy = NULL;
@@ -236,8 +457,8 @@ IndexIterator *TagIndex_GetReader(IndexSpec *sp, InvertedIndex *iv, const char *
 IndexIterator *TagIndex_OpenReader(TagIndex *idx, IndexSpec *sp, const char *value, size_t len,
                                    double weight) {
 
-  InvertedIndex *iv = TrieMap_Find(idx->values, (char *)value, len);
-  if (iv == TRIEMAP_NOTFOUND || !iv || iv->numDocs == 0) {
+  InvertedIndex *iv = TagIndex_OpenIndex(idx, value, len, 0);
+  if (!iv || iv->numDocs == 0) {
     return NULL;
   }
   return TagIndex_GetReader(sp, iv, value, len, weight);
@@ -297,23 +518,63 @@ TagIndex *TagIndex_Open(RedisSearchCtx *sctx, RedisModuleString *formattedKey, i
   return ret;
 }
 
-/* Serialize all the tags in the index to the redis client */
-void TagIndex_SerializeValues(TagIndex *idx, RedisModuleCtx *ctx) {
-  TrieMapIterator *it = TrieMap_Iterate(idx->values, "", 0);
+void TagIndex_Renumber(TagIndex *idx, const DocIdRemap *remap, IndexRepairParams *params) {
+  dictIterator *it = dictGetIterator(idx->values);
+  dictEntry *e;
+  while ((e = dictNext(it))) {
+    InvertedIndex_Renumber(((TagValue *)dictGetKey(e))->iv, remap, params);
+  }
+  dictReleaseIterator(it);
 
-  char *str;
-  tm_len_t slen;
-  void *ptr;
-  RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
-  long long count = 0;
-  while (TrieMapIterator_Next(it, &str, &slen, &ptr)) {
-    ++count;
-    RedisModule_ReplyWithStringBuffer(ctx, str, slen);
+  // the bitsets are built again with the new docIds
+  if (idx->bitsets) {
+    TrieMap_Free(idx->bitsets, tagBitset_Free);
+    idx->bitsets = NULL;
+    TagIndex_EnableBitsets(idx);
+  }
+}
+
+void TagIndex_EnableBitsets(TagIndex *idx) {
+  if (idx->bitsets) {
+    return;
+  }
+  idx->bitsets = NewTrieMap();
+  dictIterator *it = dictGetIterator(idx->values);
+  dictEntry *e;
+  while ((e = dictNext(it))) {
+    TagValue *tv = dictGetKey(e);
+    TrieMap_Add(idx->bitsets, (char *)tv->str, tv->len, tagBitset_Build(tv->iv), NULL);
   }
+  dictReleaseIterator(it);
+}
 
-  RedisModule_ReplySetArrayLength(ctx, count);
+void TagIndex_RebuildBitset(TagIndex *idx, const char *value, size_t len) {
+  if (!idx->bitsets) {
+    return;
+  }
+  TrieMap_Delete(idx->bitsets, value, len, tagBitset_Free);
+  InvertedIndex *iv = TagIndex_OpenIndex(idx, value, len, 0);
+  if (iv && iv->numDocs) {
+    TrieMap_Add(idx->bitsets, (char *)value, len, tagBitset_Build(iv), NULL);
+  }
+}
+
+const TagBitset *TagIndex_GetBitset(const TagIndex *idx, const char *value, size_t len) {
+  if (!idx->bitsets) {
+    return NULL;
+  }
+  TagBitset *b = TrieMap_Find(idx->bitsets, (char *)value, len);
+  return b == TRIEMAP_NOTFOUND ? NULL : b;
+}
 
-  TrieMapIterator_Free(it);
+/* Serialize all the tags in the index to the redis client */
+void TagIndex_SerializeValues(TagIndex *idx, RedisModuleCtx *ctx) {
+  TagValue **sorted = TagIndex_SortedValues(idx);
+  size_t n = TagIndex_NumValues(idx);
+  RedisModule_ReplyWithArray(ctx, n);
+  for (size_t i = 0; i < n; ++i) {
+    RedisModule_ReplyWithStringBuffer(ctx, sorted[i]->str, sorted[i]->len);
+  }
 }
 
 RedisModuleType *TagIndexType;
@@ -321,40 +582,47 @@ RedisModuleType *TagIndexType;
 void *TagIndex_RdbLoad(RedisModuleIO *rdb, int encver) {
   unsigned long long elems = RedisModule_LoadUnsigned(rdb);
   TagIndex *idx = NewTagIndex();
+  // the rdb holds the values and their inverted indexes, not the structure they were kept in, so
+  // the values saved by versions which kept them in a trie are loaded into the dictionary as is
+  dictExpand(idx->values, elems);
 
   while (elems--) {
     size_t slen;
     char *s = RedisModule_LoadStringBuffer(rdb, &slen);
     InvertedIndex *inv = InvertedIndex_RdbLoad(rdb, INVERTED_INDEX_ENCVER);
     RS_LOG_ASSERT(inv, "loading inverted index from rdb failed");
-    TrieMap_Add(idx->values, s, MIN(slen, MAX_TAG_LEN), inv, NULL);
+    // a value truncated to the same length as a previous one replaces it, as it did in the trie
+    slen = MIN(slen, MAX_TAG_LEN);
+    TagIndex_DeleteValue(idx, s, slen);
+    tagIndex_AddValue(idx, s, slen, inv);
     RedisModule_Free(s);
   }
   return idx;
 }
 void TagIndex_RdbSave(RedisModuleIO *rdb, void *value) {
   TagIndex *idx = value;
-  RedisModule_SaveUnsigned(rdb, idx->values->cardinality);
-  TrieMapIterator *it = TrieMap_Iterate(idx->values, "", 0);
-
-  char *str;
-  tm_len_t slen;
-  void *ptr;
+  RedisModule_SaveUnsigned(rdb, TagIndex_NumValues(idx));
+  dictIterator *it = dictGetIterator(idx->values);
+  dictEntry *e;
   size_t count = 0;
-  while (TrieMapIterator_Next(it, &str, &slen, &ptr)) {
+  while ((e = dictNext(it))) {
+    TagValue *tv = dictGetKey(e);
     count++;
-    RedisModule_SaveStringBuffer(rdb, str, slen);
-    InvertedIndex *inv = ptr;
-    InvertedIndex_RdbSave(rdb, inv);
+    RedisModule_SaveStringBuffer(rdb, tv->str, tv->len);
+    InvertedIndex_RdbSave(rdb, tv->iv);
   }
-  RS_LOG_ASSERT(count == idx->values->cardinality, "not all inverted indexes save to rdb");
-  TrieMapIterator_Free(it);
+  RS_LOG_ASSERT(count == TagIndex_NumValues(idx), "not all inverted indexes save to rdb");
+  dictReleaseIterator(it);
 }
 
 void TagIndex_Free(void *p) {
   TagIndex *idx = p;
-  TrieMap_Free(idx->values, InvertedIndex_Free);
+  dictRelease(idx->values);
+  array_free(idx->sorted);
+  array_free(idx->pending);
   TrieMap_Free(idx->suffix, suffixTrieMap_freeCallback);
+  NgramIndex_Free(idx->ngrams);
+  TrieMap_Free(idx->bitsets, tagBitset_Free);
   rm_free(idx);
 }
 
@@ -362,15 +630,26 @@ size_t TagIndex_MemUsage(const void *value) {
   const TagIndex *idx = value;
   size_t sz = sizeof(*idx);
 
-  TrieMapIterator *it = TrieMap_Iterate(idx->values, "", 0);
+  sz += dictSlots(idx->values) * sizeof(dictEntry *) + dictSize(idx->values) * sizeof(dictEntry);
+  dictIterator *dit = dictGetIterator(idx->values);
+  dictEntry *e;
+  while ((e = dictNext(dit))) {
+    TagValue *tv = dictGetKey(e);
+    sz += sizeof(*tv) + tv->len + 1 + InvertedIndex_MemUsage(tv->iv);
+  }
+  dictReleaseIterator(dit);
+  sz += (array_len(idx->sorted) + array_len(idx->pending)) * sizeof(*idx->sorted);
 
   char *str;
   tm_len_t slen;
   void *ptr;
-  while (TrieMapIterator_Next(it, &str, &slen, &ptr)) {
-    sz += slen + InvertedIndex_MemUsage((InvertedIndex *)ptr);
+  if (idx->bitsets) {
+    TrieMapIterator *it = TrieMap_Iterate(idx->bitsets, "", 0);
+    while (TrieMapIterator_Next(it, &str, &slen, &ptr)) {
+      sz += sizeof(TagBitset) + ((TagBitset *)ptr)->nwords * sizeof(uint64_t);
+    }
+    TrieMapIterator_Free(it);
   }
-  TrieMapIterator_Free(it);
   return sz;
 }
 
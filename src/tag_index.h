@@ -7,6 +7,7 @@
 #include "value.h"
 #include "geo_index.h"
 #include "vector_index.h"
+#include "util/dict.h"
 
 struct InvertedIndex;
 
@@ -93,10 +94,39 @@ extern "C" {
  *
  *
  */
+/* The docIds of a tag value as a bitset over the docId space, where the bit b of word w is set for
+ * the docId w * 64 + b. Kept alongside the inverted index of the value, so the values of a low
+ * cardinality field can be combined and counted with word-level operations */
+typedef struct {
+  uint64_t *words;
+  size_t nwords;
+} TagBitset;
+
+/* A value of a tag index with its inverted index. The values are the keys of a hash dictionary, so
+ * finding a value costs the same however long and random the values are */
+typedef struct {
+  const char *str;  // allocated along with the value
+  size_t len;
+  struct InvertedIndex *iv;
+} TagValue;
+
 typedef struct {
   uint32_t uniqueId;
-  TrieMap *values;
+  // the TagValue of each value, as the keys of the dictionary
+  dict *values;
+  // the values sorted ignoring case, for prefix and range queries. Built on demand, and then kept
+  // up to date: removed values are taken out of it, and added values are kept in pending until
+  // they are sorted and merged in
+  arrayof(TagValue *) sorted;
+  arrayof(TagValue *) pending;
   TrieMap *suffix;
+  // n-gram index of the values, for the fields with the WITHNGRAMS option. Not saved to the rdb
+  struct NgramIndex *ngrams;
+  // flags of the inverted indexes created for new tag values
+  IndexFlags invIdxFlags;
+  // the TagBitset of each value, for the fields with the BITSET option. Not saved to the rdb, but
+  // built from the inverted indexes
+  TrieMap *bitsets;
 } TagIndex;
 
 #define TAG_INDEX_KEY_FMT "tag:%s/%s"
@@ -131,8 +161,39 @@ void TagIndex_RegisterConcurrentIterators(TagIndex *idx, ConcurrentSearchCtx *co
 TagIndex *TagIndex_Open(RedisSearchCtx *sctx, RedisModuleString *formattedKey, int openWrite,
                         RedisModuleKey **keyp);
 
+/* Returns the inverted index of a value, creating it if create is set. Returns NULL if the value
+ * has no inverted index and create is not set */
 struct InvertedIndex *TagIndex_OpenIndex(TagIndex *idx, const char *value, size_t len, int create);
 
+/* Remove a value and free its inverted index */
+void TagIndex_DeleteValue(TagIndex *idx, const char *value, size_t len);
+
+/* Returns the number of values in the index */
+size_t TagIndex_NumValues(const TagIndex *idx);
+
+/* Returns the TagIndex_NumValues values of the index sorted ignoring case, and then by their bytes.
+ * The array is owned by the index, and is valid until a value is added or removed */
+TagValue **TagIndex_SortedValues(TagIndex *idx);
+
+/* Returns the position in the sorted values of the first value which is greater than or equal to
+ * value ignoring case, or strictly greater if after is set */
+size_t TagIndex_SeekValue(TagIndex *idx, const char *value, size_t len, int after);
+
+/* Rewrite the inverted indexes of all the values with the document ids given by the remap, see
+ * InvertedIndex_Renumber */
+void TagIndex_Renumber(TagIndex *idx, const DocIdRemap *remap, IndexRepairParams *params);
+
+/* Keep a bitset of the docIds of each value from now on, building the bitsets of the values which
+ * are already indexed from their inverted indexes */
+void TagIndex_EnableBitsets(TagIndex *idx);
+
+/* Build the bitset of a value from its inverted index again, once deleted documents were collected
+ * from it. The bitset is removed if the value has no documents left */
+void TagIndex_RebuildBitset(TagIndex *idx, const char *value, size_t len);
+
+/* Returns the bitset of a value, or NULL if the value has none */
+const TagBitset *TagIndex_GetBitset(const TagIndex *idx, const char *value, size_t len);
+
 /* Serialize all the tags in the index to the redis client */
 void TagIndex_SerializeValues(TagIndex *idx, RedisModuleCtx *ctx);
 
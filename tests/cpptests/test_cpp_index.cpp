@@ -7,6 +7,8 @@
 #include "src/tokenize.h"
 #include "src/varint.h"
 #include "src/hybrid_reader.h"
+#include "src/numeric_filter.h"
+#include "src/numeric_index.h"
 
 #include "rmutil/alloc.h"
 
@@ -21,6 +23,7 @@
 #include <time.h>
 #include <float.h>
 #include <vector>
+#include <set>
 #include <cstdint>
 #include <random>
 #include <chrono>
@@ -216,6 +219,30 @@ TEST_P(IndexFlagsTest, testRWFlags) {
     IR_Free(ir);
   }
 
+  // batch reads return the same records as reading one by one
+  IndexReader *ir = NewTermIndexReader(idx, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  IndexReader *bir = NewTermIndexReader(idx, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  t_docId docIds[64];
+  uint32_t freqs[64];
+  t_fieldMask fieldMasks[64];
+  size_t total = 0, nread;
+  while ((nread = IR_ReadBatch(bir, docIds, freqs, fieldMasks, 64)) > 0) {
+    for (size_t i = 0; i < nread; i++) {
+      RSIndexResult *h = NULL;
+      ASSERT_EQ(INDEXREAD_OK, IR_Read(ir, &h));
+      ASSERT_EQ(h->docId, docIds[i]);
+      ASSERT_EQ(h->freq, freqs[i]);
+      if (idx->flags & Index_StoreFieldFlags) {
+        // the narrow decoders only write the low 32 bits of the record's mask
+        ASSERT_EQ((uint32_t)h->fieldMask, (uint32_t)fieldMasks[i]);
+      }
+    }
+    total += nread;
+  }
+  ASSERT_EQ(200, total);
+  IR_Free(ir);
+  IR_Free(bir);
+
   // IW_Free(w);
   // // overriding the regular IW_Free because we already deleted the buffer
   InvertedIndex_Free(idx);
@@ -312,6 +339,197 @@ TEST_F(IndexTest, testUnion) {
   RSGlobalConfig.minUnionIterHeap = oldConfig;
 }
 
+TEST_F(IndexTest, testUnionAccumulate) {
+  const size_t nterms = 150;
+  std::vector<InvertedIndex *> idxs;
+  std::set<t_docId> expected;
+  for (size_t i = 0; i < nterms; ++i) {
+    idxs.push_back(createIndex(40, 7 + i, i + 1));
+    for (t_docId id = i + 1, n = 0; n < 40; id += 7 + i, ++n) {
+      expected.insert(id);
+    }
+  }
+
+  IndexIterator *uis[2];
+  for (int i = 0; i < 2; ++i) {
+    IndexIterator **irs = (IndexIterator **)calloc(nterms, sizeof(IndexIterator *));
+    for (size_t j = 0; j < nterms; ++j) {
+      irs[j] = NewReadIterator(NewTermIndexReader(idxs[j], NULL, RS_FIELDMASK_ALL, NULL, 1));
+    }
+    uis[i] = NewUnionIterator(irs, nterms, NULL, 1, 1, QN_PREFIX, NULL);
+  }
+  ASSERT_TRUE(IndexIterator_EnableAccumulation(uis[1], 0));
+
+  // the same docIds as merging the readers, with the record of one of the terms
+  RSIndexResult *h = NULL, *h2 = NULL;
+  auto it = expected.begin();
+  while (uis[0]->Read(uis[0]->ctx, &h) != INDEXREAD_EOF) {
+    ASSERT_EQ(INDEXREAD_OK, uis[1]->Read(uis[1]->ctx, &h2));
+    ASSERT_EQ(*it++, h2->docId);
+    ASSERT_EQ(h->docId, h2->docId);
+    ASSERT_EQ(1, h2->agg.numChildren);
+    ASSERT_EQ(RSResultType_Term, h2->agg.children[0]->type);
+    ASSERT_EQ(1, h2->agg.children[0]->freq);
+    ASSERT_EQ(1, h2->agg.children[0]->fieldMask);
+  }
+  ASSERT_EQ(INDEXREAD_EOF, uis[1]->Read(uis[1]->ctx, &h2));
+  ASSERT_TRUE(it == expected.end());
+
+  IndexIterator *ui = uis[1];
+  ui->Rewind(ui->ctx);
+  for (t_docId id : {5, 100, 101, 2000}) {
+    auto next = expected.lower_bound(id);
+    ASSERT_EQ(*next == id ? INDEXREAD_OK : INDEXREAD_NOTFOUND, ui->SkipTo(ui->ctx, id, &h));
+    ASSERT_EQ(*next, h->docId);
+  }
+  ASSERT_EQ(INDEXREAD_OK, ui->Read(ui->ctx, &h));
+  ASSERT_EQ(*expected.upper_bound(2000), h->docId);
+  ASSERT_EQ(INDEXREAD_EOF, ui->SkipTo(ui->ctx, *expected.rbegin() + 1, &h));
+
+  uis[0]->Free(uis[0]);
+  uis[1]->Free(uis[1]);
+
+  // a union smaller than UNION_ITERATOR_ACCUMULATE is only accumulated on demand
+  IndexIterator **irs = (IndexIterator **)calloc(2, sizeof(IndexIterator *));
+  for (size_t j = 0; j < 2; ++j) {
+    irs[j] = NewReadIterator(NewTermIndexReader(idxs[j], NULL, RS_FIELDMASK_ALL, NULL, 1));
+  }
+  ui = NewUnionIterator(irs, 2, NULL, 1, 1, QN_PREFIX, NULL);
+  ASSERT_FALSE(IndexIterator_EnableAccumulation(ui, 0));
+  ASSERT_TRUE(IndexIterator_AccumulatedPostings(ui) == NULL);
+  ASSERT_TRUE(IndexIterator_EnableAccumulation(ui, 1));
+  std::set<t_docId> small;
+  for (size_t i = 0; i < 2; ++i) {
+    for (t_docId id = i + 1, n = 0; n < 40; id += 7 + i, ++n) {
+      small.insert(id);
+    }
+  }
+  ASSERT_EQ(small.size(), IndexIterator_AccumulatedPostings(ui)->len);
+  ui->Free(ui);
+
+  for (InvertedIndex *idx : idxs) {
+    InvertedIndex_Free(idx);
+  }
+}
+
+TEST_F(IndexTest, testExpansionCache) {
+  const size_t nterms = 120;
+  std::vector<InvertedIndex *> idxs;
+  std::set<t_docId> expected;
+  for (size_t i = 0; i < nterms; ++i) {
+    idxs.push_back(createIndex(30, 5 + i, i + 1));
+    for (t_docId id = i + 1, n = 0; n < 30; id += 5 + i, ++n) {
+      expected.insert(id);
+    }
+  }
+  IndexIterator **irs = (IndexIterator **)calloc(nterms, sizeof(IndexIterator *));
+  for (size_t j = 0; j < nterms; ++j) {
+    irs[j] = NewReadIterator(NewTermIndexReader(idxs[j], NULL, RS_FIELDMASK_ALL, NULL, 1));
+  }
+  IndexIterator *ui = NewUnionIterator(irs, nterms, NULL, 1, 1, QN_PREFIX, NULL);
+  ASSERT_TRUE(IndexIterator_EnableAccumulation(ui, 0));
+  ExpansionPostings *postings = IndexIterator_AccumulatedPostings(ui);
+  ASSERT_EQ(expected.size(), postings->len);
+
+  size_t oldMaxMemory = RSGlobalConfig.expansionCacheMaxMemory;
+  RSGlobalConfig.expansionCacheMaxMemory = 1 << 20;
+  ExpansionCache *cache = NewExpansionCache();
+  ExpansionTerm *terms = (ExpansionTerm *)rm_malloc(nterms * sizeof(*terms));
+  for (size_t i = 0; i < nterms; ++i) {
+    char buf[32];
+    size_t len = sprintf(buf, "hello%zu", i);
+    terms[i] = {rm_strdup(buf), len, 30};
+  }
+  ExpansionCache_Put(cache, ExpansionKind_Prefix, "hel", 3, RS_FIELDMASK_ALL, postings, terms,
+                     nterms);
+  // the cache keeps the postings of the freed union
+  ui->Free(ui);
+
+  ASSERT_TRUE(ExpansionCache_Get(cache, ExpansionKind_Suffix, "hel", 3, RS_FIELDMASK_ALL) == NULL);
+  ASSERT_TRUE(ExpansionCache_Get(cache, ExpansionKind_Prefix, "hel", 3, 0x2) == NULL);
+  const ExpansionCacheEntry *e =
+      ExpansionCache_Get(cache, ExpansionKind_Prefix, "hel", 3, RS_FIELDMASK_ALL);
+  ASSERT_TRUE(e != NULL);
+  ASSERT_EQ(1, cache->hits);
+  ASSERT_EQ(2, cache->misses);
+
+  RSQueryTerm **qterms = (RSQueryTerm **)rm_malloc(e->nterms * sizeof(*qterms));
+  for (size_t i = 0; i < e->nterms; ++i) {
+    RSToken tok = {.str = e->terms[i].str, .len = e->terms[i].len};
+    qterms[i] = NewQueryTerm(&tok, i);
+  }
+  IndexIterator *cached =
+      NewCachedUnionIterator(e->postings, qterms, e->nterms, NULL, 1, QN_PREFIX, NULL);
+  ASSERT_EQ(expected.size(), cached->NumEstimated(cached->ctx));
+
+  RSIndexResult *h = NULL;
+  for (t_docId id : expected) {
+    ASSERT_EQ(INDEXREAD_OK, cached->Read(cached->ctx, &h));
+    ASSERT_EQ(id, h->docId);
+    ASSERT_EQ(1, h->agg.numChildren);
+    ASSERT_EQ(0, strncmp(h->agg.children[0]->term.term->str, "hello", 5));
+  }
+  ASSERT_EQ(INDEXREAD_EOF, cached->Read(cached->ctx, &h));
+
+  // a matching term write evicts the expansion, while the iterator keeps reading its postings
+  ExpansionCache_OnTermWrite(cache, "shell", 5);
+  ASSERT_EQ(1, ExpansionCache_NumEntries(cache));
+  ExpansionCache_OnTermWrite(cache, "help", 4);
+  ASSERT_EQ(0, ExpansionCache_NumEntries(cache));
+  ASSERT_EQ(0, cache->memsize);
+  cached->Rewind(cached->ctx);
+  ASSERT_EQ(INDEXREAD_NOTFOUND, cached->SkipTo(cached->ctx, 1000, &h));
+  ASSERT_EQ(*expected.lower_bound(1000), h->docId);
+  cached->Free(cached);
+
+  // a term write evicts the prefixes, suffixes and substrings of the term in all fields
+  struct {
+    ExpansionKind kind;
+    const char *pattern;
+    t_fieldMask mask;
+  } entries[] = {{ExpansionKind_Prefix, "hel", RS_FIELDMASK_ALL},
+                 {ExpansionKind_Prefix, "hel", 0x2},
+                 {ExpansionKind_Suffix, "lo", RS_FIELDMASK_ALL},
+                 {ExpansionKind_Contains, "ll", RS_FIELDMASK_ALL},
+                 {ExpansionKind_Contains, "el", 0x2}};
+  for (auto &entry : entries) {
+    ExpansionPostings *p = NewExpansionPostings();
+    ExpansionCache_Put(cache, entry.kind, entry.pattern, strlen(entry.pattern), entry.mask, p,
+                       NULL, 0);
+    ExpansionPostings_Decref(p);
+  }
+  ASSERT_EQ(5, ExpansionCache_NumEntries(cache));
+  ExpansionCache_OnTermWrite(cache, "yellow", 6);
+  ASSERT_EQ(3, ExpansionCache_NumEntries(cache));
+  ASSERT_TRUE(ExpansionCache_Get(cache, ExpansionKind_Suffix, "lo", 2, RS_FIELDMASK_ALL));
+  ExpansionCache_OnTermWrite(cache, "helo", 4);
+  ASSERT_EQ(0, ExpansionCache_NumEntries(cache));
+  ASSERT_EQ(0, cache->memsize);
+
+  // the least recently used expansions are evicted to stay within the memory limit
+  const char *patterns[] = {"aa", "bb", "cc"};
+  for (int i = 0; i < 3; ++i) {
+    ExpansionPostings *p = NewExpansionPostings();
+    ExpansionCache_Put(cache, ExpansionKind_Contains, patterns[i], 2, RS_FIELDMASK_ALL, p, NULL, 0);
+    ExpansionPostings_Decref(p);
+    if (i == 0) {
+      RSGlobalConfig.expansionCacheMaxMemory = cache->memsize * 5 / 2;
+    } else if (i == 1) {
+      ASSERT_TRUE(ExpansionCache_Get(cache, ExpansionKind_Contains, "aa", 2, RS_FIELDMASK_ALL));
+    }
+  }
+  ASSERT_EQ(2, ExpansionCache_NumEntries(cache));
+  ASSERT_TRUE(ExpansionCache_Get(cache, ExpansionKind_Contains, "aa", 2, RS_FIELDMASK_ALL));
+  ASSERT_FALSE(ExpansionCache_Get(cache, ExpansionKind_Contains, "bb", 2, RS_FIELDMASK_ALL));
+  ASSERT_TRUE(ExpansionCache_Get(cache, ExpansionKind_Contains, "cc", 2, RS_FIELDMASK_ALL));
+
+  ExpansionCache_Free(cache);
+  RSGlobalConfig.expansionCacheMaxMemory = oldMaxMemory;
+  for (InvertedIndex *idx : idxs) {
+    InvertedIndex_Free(idx);
+  }
+}
+
 TEST_F(IndexTest, testWeight) {
   InvertedIndex *w = createIndex(10, 1);
   InvertedIndex *w2 = createIndex(10, 2);
@@ -349,6 +567,262 @@ TEST_F(IndexTest, testWeight) {
   InvertedIndex_Free(w2);
 }
 
+// Write docIds start, start+step, ... into a new index, with the frequency given per docId
+static InvertedIndex *createFreqIndex(int size, int step, int start,
+                                      uint32_t (*freqOf)(t_docId)) {
+  InvertedIndex *idx = NewInvertedIndex((IndexFlags)(INDEX_DEFAULT_FLAGS), 1);
+  IndexEncoder enc = InvertedIndex_GetEncoder(idx->flags);
+  t_docId id = start;
+  for (int i = 0; i < size; i++, id += step) {
+    ForwardIndexEntry h = {0};
+    h.docId = id;
+    h.fieldMask = 1;
+    h.freq = freqOf(id);
+    h.term = "hello";
+    h.len = 5;
+    h.vw = NewVarintVectorWriter(8);
+    VVW_Write(h.vw, 1);
+    InvertedIndex_WriteForwardIndexEntry(idx, enc, &h);
+    VVW_Free(h.vw);
+  }
+  return idx;
+}
+
+static double testBM25Bound(const RSIndexResult *r, uint32_t maxFreq, const RSIndexStats *stats) {
+  return r->term.term->idf * maxFreq / (maxFreq + 1.0);
+}
+
+TEST_F(IndexTest, testTopKPruning) {
+  RSToken tok = {0};
+  tok.str = (char *)"hello";
+  tok.len = 5;
+  // the readers take ownership of the terms
+  RSQueryTerm *t = NewQueryTerm(&tok, 1);
+
+  // a single block of docs with a high frequency
+  InvertedIndex *w = createFreqIndex(1000, 1, 1, [](t_docId id) -> uint32_t {
+    return (id > 500 && id <= 600) ? 9 : 1;
+  });
+  ASSERT_EQ(10, w->size);
+  ASSERT_EQ(9, w->blocks[5].maxFreq);
+  ASSERT_EQ(1, w->blocks[4].maxFreq);
+
+  double threshold = 0;
+  TopKPruneCtx ctx = {.TermBound = testBM25Bound, .threshold = &threshold};
+  IndexReader *r = NewTermIndexReader(w, NULL, RS_FIELDMASK_ALL, t, 1);
+  t->idf = 1;
+  IndexIterator *it = NewReadIterator(r);
+  ASSERT_TRUE(IndexIterator_EnableTopKPruning(it, &ctx));
+
+  RSIndexResult *h = NULL;
+  ASSERT_EQ(INDEXREAD_OK, it->Read(it->ctx, &h));
+  ASSERT_EQ(1, h->docId);
+
+  // only docs with frequency 9 can score above 0.5. Blocks are checked once we move to them, so
+  // the current one is still read to its end
+  threshold = 0.6;
+  t_docId expected = 2;
+  while (it->Read(it->ctx, &h) != INDEXREAD_EOF) {
+    ASSERT_EQ(expected, h->docId);
+    expected = expected == 100 ? 501 : expected + 1;
+  }
+  ASSERT_EQ(601, expected);
+  ASSERT_EQ(8, r->prune->blocksSkipped);
+
+  // skipping into a pruned block lands on the next unpruned one
+  it->Rewind(it->ctx);
+  ASSERT_EQ(INDEXREAD_NOTFOUND, it->SkipTo(it->ctx, 450, &h));
+  ASSERT_EQ(501, h->docId);
+  it->Free(it);
+
+  // in a union, the frequent term alone cannot beat the threshold, so it only completes the
+  // records of docs found by the rare term
+  RSQueryTerm *t1 = NewQueryTerm(&tok, 1);
+  RSQueryTerm *t2 = NewQueryTerm(&tok, 2);
+  t1->idf = 1;
+  IndexReader *r1 = NewTermIndexReader(w, NULL, RS_FIELDMASK_ALL, t1, 1);
+  InvertedIndex *w2 = createFreqIndex(10, 100, 100, [](t_docId id) -> uint32_t { return 1; });
+  IndexReader *r2 = NewTermIndexReader(w2, NULL, RS_FIELDMASK_ALL, t2, 1);
+  t2->idf = 4;
+  IndexIterator **irs = (IndexIterator **)calloc(2, sizeof(IndexIterator *));
+  irs[0] = NewReadIterator(r1);
+  irs[1] = NewReadIterator(r2);
+  IndexIterator *ui = NewUnionIterator(irs, 2, NULL, 0, 1, QN_UNION, NULL);
+  ASSERT_TRUE(IndexIterator_EnableTopKPruning(ui, &ctx));
+
+  threshold = 1;
+  expected = 100;
+  while (ui->Read(ui->ctx, &h) != INDEXREAD_EOF) {
+    ASSERT_EQ(expected, h->docId);
+    ASSERT_EQ(2, h->agg.numChildren);
+    expected += 100;
+  }
+  ASSERT_EQ(1100, expected);
+
+  // with no threshold, everything is returned
+  threshold = 0;
+  ui->Rewind(ui->ctx);
+  size_t n = 0;
+  while (ui->Read(ui->ctx, &h) != INDEXREAD_EOF) {
+    n++;
+  }
+  ASSERT_EQ(1000, n);
+
+  ui->Free(ui);
+  InvertedIndex_Free(w);
+  InvertedIndex_Free(w2);
+}
+
+TEST_F(IndexTest, testBitmapBlocks) {
+  InvertedIndex *idx = NewInvertedIndex(Index_DocIdsOnly, 1);
+  IndexEncoder enc = InvertedIndex_GetEncoder(Index_DocIdsOnly);
+  RSIndexResult rec = {0};
+  rec.type = RSResultType_Term;
+  rec.freq = 1;
+
+  // every third doc is dense enough for the full blocks to become bitmaps
+  for (t_docId i = 1; i <= 2500; i++) {
+    InvertedIndex_WriteEntryGeneric(idx, enc, i * 3, &rec);
+  }
+  ASSERT_EQ(3, idx->size);
+  ASSERT_EQ(IndexBlock_Bitmap, idx->blocks[0].type);
+  ASSERT_EQ(IndexBlock_Bitmap, idx->blocks[1].type);
+  ASSERT_EQ(IndexBlock_Encoded, idx->blocks[2].type);
+  ASSERT_EQ(3, idx->blocks[0].firstId);
+  ASSERT_EQ(3000, idx->blocks[0].lastId);
+  ASSERT_EQ(376, IndexBlock_DataLen(&idx->blocks[0]));
+
+  IndexReader *ir = NewTermIndexReader(idx, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  RSIndexResult *h = NULL;
+  t_docId expected = 3;
+  while (IR_Read(ir, &h) != INDEXREAD_EOF) {
+    ASSERT_EQ(expected, h->docId);
+    expected += 3;
+  }
+  ASSERT_EQ(7503, expected);
+  ASSERT_EQ(2500, ir->len);
+  IR_Free(ir);
+
+  ir = NewTermIndexReader(idx, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  ASSERT_EQ(INDEXREAD_OK, IR_SkipTo(ir, 3, &h));
+  ASSERT_EQ(INDEXREAD_NOTFOUND, IR_SkipTo(ir, 4, &h));
+  ASSERT_EQ(6, h->docId);
+  ASSERT_EQ(INDEXREAD_OK, IR_SkipTo(ir, 3000, &h));
+  ASSERT_EQ(INDEXREAD_NOTFOUND, IR_SkipTo(ir, 3001, &h));
+  ASSERT_EQ(3003, h->docId);
+  ASSERT_EQ(INDEXREAD_OK, IR_Read(ir, &h));
+  ASSERT_EQ(3006, h->docId);
+  ASSERT_EQ(INDEXREAD_NOTFOUND, IR_SkipTo(ir, 6001, &h));
+  ASSERT_EQ(6003, h->docId);
+  ASSERT_EQ(INDEXREAD_EOF, IR_SkipTo(ir, 7501, &h));
+  IR_Free(ir);
+
+  // bitmaps are saved as regular docId-only blocks
+  Buffer encoded = {0};
+  IndexBlock_EncodeDocIds(&idx->blocks[0], &encoded);
+  ASSERT_EQ(1000, encoded.offset);
+  Buffer_Free(&encoded);
+
+  // the next write after a full bitmap block starts a new block
+  InvertedIndex_Free(idx);
+  idx = NewInvertedIndex(Index_DocIdsOnly, 1);
+  DocTable dt = NewDocTable(10, 2000);
+  char buf[16];
+  for (t_docId i = 1; i <= 1000; i++) {
+    size_t nkey = sprintf(buf, "doc_%d", (int)i);
+    RSDocumentMetadata *dmd = DocTable_Put(&dt, buf, nkey, 1, Document_DefaultFlags, NULL, 0,
+                                           DocumentType_Hash);
+    InvertedIndex_WriteEntryGeneric(idx, enc, dmd->id, &rec);
+  }
+  ASSERT_EQ(1, idx->size);
+  ASSERT_EQ(IndexBlock_Bitmap, idx->blocks[0].type);
+  InvertedIndex_WriteEntryGeneric(idx, enc, 1001, &rec);
+  ASSERT_EQ(2, idx->size);
+
+  // repairing a bitmap keeps it a bitmap, starting at the first remaining doc
+  for (int i = 1; i <= 100; i++) {
+    size_t nkey = sprintf(buf, "doc_%d", i);
+    ASSERT_EQ(1, DocTable_Delete(&dt, buf, nkey));
+  }
+  IndexRepairParams params = {0};
+  params.limit = 1;
+  InvertedIndex_Repair(idx, &dt, 0, &params);
+  ASSERT_EQ(100, params.docsCollected);
+  ASSERT_EQ(IndexBlock_Bitmap, idx->blocks[0].type);
+  ASSERT_EQ(900, idx->blocks[0].numDocs);
+  ASSERT_EQ(101, idx->blocks[0].firstId);
+  ASSERT_EQ(1000, idx->blocks[0].lastId);
+
+  ir = NewTermIndexReader(idx, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  expected = 101;
+  while (IR_Read(ir, &h) != INDEXREAD_EOF) {
+    ASSERT_EQ(expected, h->docId);
+    expected++;
+  }
+  ASSERT_EQ(1002, expected);
+  IR_Free(ir);
+
+  DocTable_Free(&dt);
+  InvertedIndex_Free(idx);
+}
+
+TEST_F(IndexTest, testEliasFanoBlocks) {
+  InvertedIndex *idx = NewInvertedIndex(Index_EliasFano, 1);
+  IndexEncoder enc = InvertedIndex_GetEncoder(Index_EliasFano);
+  RSIndexResult rec = {0};
+  rec.type = RSResultType_Term;
+  rec.freq = 1;
+
+  // gaps too wide for a bitmap, and mostly taking two bytes as varints
+  std::vector<t_docId> ids;
+  t_docId docId = 0;
+  for (size_t i = 0; i < 2500; i++) {
+    docId += 1 + (i * 7919) % 600;
+    ids.push_back(docId);
+    InvertedIndex_WriteEntryGeneric(idx, enc, docId, &rec);
+  }
+  ASSERT_EQ(3, idx->size);
+  ASSERT_EQ(IndexBlock_EliasFano, idx->blocks[0].type);
+  ASSERT_EQ(IndexBlock_EliasFano, idx->blocks[1].type);
+  ASSERT_EQ(IndexBlock_Encoded, idx->blocks[2].type);
+  ASSERT_EQ(ids[0], idx->blocks[0].firstId);
+  ASSERT_EQ(ids[999], idx->blocks[0].lastId);
+
+  // packed blocks are saved as regular docId-only blocks
+  Buffer encoded = {0};
+  IndexBlock_EncodeDocIds(&idx->blocks[0], &encoded);
+  ASSERT_LT(IndexBlock_DataLen(&idx->blocks[0]), encoded.offset * 3 / 4);
+  Buffer_Free(&encoded);
+
+  IndexReader *ir = NewTermIndexReader(idx, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  RSIndexResult *h = NULL;
+  size_t n = 0;
+  while (IR_Read(ir, &h) != INDEXREAD_EOF) {
+    ASSERT_EQ(ids[n], h->docId);
+    n++;
+  }
+  ASSERT_EQ(ids.size(), n);
+  IR_Free(ir);
+
+  // skip to every other doc, and to the gaps between them
+  ir = NewTermIndexReader(idx, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  for (size_t i = 0; i < ids.size(); i += 2) {
+    ASSERT_EQ(INDEXREAD_OK, IR_SkipTo(ir, ids[i], &h));
+    ASSERT_EQ(ids[i], h->docId);
+  }
+  IR_Free(ir);
+  ir = NewTermIndexReader(idx, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  for (size_t i = 1; i < ids.size(); i += 3) {
+    if (ids[i] - ids[i - 1] == 1) continue;
+    ASSERT_EQ(INDEXREAD_NOTFOUND, IR_SkipTo(ir, ids[i] - 1, &h));
+    ASSERT_EQ(ids[i], h->docId);
+  }
+  ASSERT_EQ(INDEXREAD_EOF, IR_SkipTo(ir, ids.back() + 1, &h));
+  IR_Free(ir);
+
+  InvertedIndex_Free(idx);
+}
+
 TEST_F(IndexTest, testNot) {
   InvertedIndex *w = createIndex(16, 1);
   // not all numbers that divide by 3
@@ -359,7 +833,7 @@ TEST_F(IndexTest, testNot) {
   // printf("Reading!\n");
   IndexIterator **irs = (IndexIterator **)calloc(2, sizeof(IndexIterator *));
   irs[0] = NewReadIterator(r1);
-  irs[1] = NewNotIterator(NewReadIterator(r2), w2->lastId, 1);
+  irs[1] = NewNotIterator(NewReadIterator(r2), NULL, w2->lastId, 1);
 
   IndexIterator *ui = NewIntersecIterator(irs, 2, NULL, RS_FIELDMASK_ALL, -1, 0, 1);
   RSIndexResult *h = NULL;
@@ -383,7 +857,7 @@ TEST_F(IndexTest, testPureNot) {
   IndexReader *r1 = NewTermIndexReader(w, NULL, RS_FIELDMASK_ALL, NULL, 1);  //
   printf("last id: %llu\n", (unsigned long long)w->lastId);
 
-  IndexIterator *ir = NewNotIterator(NewReadIterator(r1), w->lastId + 5, 1);
+  IndexIterator *ir = NewNotIterator(NewReadIterator(r1), NULL, w->lastId + 5, 1);
 
   RSIndexResult *h = NULL;
   int expected[] = {1,  2,  4,  5,  7,  8,  10, 11, 13, 14, 16, 17, 19,
@@ -398,6 +872,179 @@ TEST_F(IndexTest, testPureNot) {
   InvertedIndex_Free(w);
 }
 
+TEST_F(IndexTest, testDeletedDocs) {
+  char buf[16];
+  DocTable dt = NewDocTable(10, 1000);
+  int N = 200;
+  for (int i = 1; i <= N; i++) {
+    size_t nkey = sprintf(buf, "doc_%d", i);
+    DocTable_Put(&dt, buf, nkey, 1, Document_DefaultFlags, NULL, 0, DocumentType_Hash);
+  }
+  // delete every document dividing by 4, and all documents from 100 to 180
+  for (int i = 1; i <= N; i++) {
+    if (i % 4 == 0 || (i >= 100 && i <= 180)) {
+      size_t nkey = sprintf(buf, "doc_%d", i);
+      ASSERT_EQ(1, DocTable_Delete(&dt, buf, nkey));
+    }
+  }
+  auto deleted = [](t_docId id) { return id % 4 == 0 || (id >= 100 && id <= 180); };
+  for (t_docId id = 0; id <= N + 100; id++) {
+    ASSERT_EQ(id && id <= N && deleted(id), DocTable_IsDeleted(&dt, id)) << id;
+    ASSERT_EQ(id && id <= N && !deleted(id), DocTable_Exists(&dt, id)) << id;
+  }
+
+  // the wildcard and NOT iterators skip deleted documents
+  InvertedIndex *w = createIndex(N, 3);
+  IndexIterator *ni = NewNotIterator(NewReadIterator(NewTermIndexReader(w, NULL, RS_FIELDMASK_ALL, NULL, 1)),
+                                     &dt, N, 1);
+  IndexIterator *wi = NewWildcardIterator(&dt, N);
+  RSIndexResult *h = NULL;
+  for (t_docId id = 1; id <= N; id++) {
+    if (deleted(id)) continue;
+    ASSERT_EQ(INDEXREAD_OK, wi->Read(wi->ctx, &h));
+    ASSERT_EQ(id, h->docId);
+    if (id % 3 == 0) continue;
+    ASSERT_EQ(INDEXREAD_OK, ni->Read(ni->ctx, &h));
+    ASSERT_EQ(id, h->docId);
+  }
+  ASSERT_EQ(INDEXREAD_EOF, wi->Read(wi->ctx, &h));
+  ASSERT_EQ(INDEXREAD_EOF, ni->Read(ni->ctx, &h));
+
+  wi->Rewind(wi->ctx);
+  ASSERT_EQ(INDEXREAD_OK, wi->SkipTo(wi->ctx, 97, &h));
+  ASSERT_EQ(97, h->docId);
+  ASSERT_EQ(INDEXREAD_NOTFOUND, wi->SkipTo(wi->ctx, 100, &h));
+  ASSERT_EQ(181, h->docId);
+  ASSERT_EQ(INDEXREAD_EOF, wi->SkipTo(wi->ctx, N, &h));
+
+  ni->Rewind(ni->ctx);
+  ASSERT_EQ(INDEXREAD_OK, ni->SkipTo(ni->ctx, 97, &h));
+  ASSERT_EQ(INDEXREAD_NOTFOUND, ni->SkipTo(ni->ctx, 99, &h));
+  ASSERT_EQ(INDEXREAD_NOTFOUND, ni->SkipTo(ni->ctx, 100, &h));
+  ASSERT_EQ(INDEXREAD_OK, ni->SkipTo(ni->ctx, 181, &h));
+
+  wi->Free(wi);
+  ni->Free(ni);
+  InvertedIndex_Free(w);
+
+  // a completed GC pass clears the bits of the documents deleted before it started, but not of
+  // those deleted while it ran
+  ASSERT_LT(0, DocTable_DeletedMemUsage(&dt));
+  DocTable_GcStarted(&dt);
+  ASSERT_EQ(1, DocTable_Delete(&dt, "doc_1", 5));
+  DocTable_GcCompleted(&dt);
+  for (t_docId id = 1; id <= N; id++) {
+    ASSERT_EQ(id == 1, DocTable_IsDeleted(&dt, id)) << id;
+    ASSERT_EQ(id != 1 && !deleted(id), DocTable_Exists(&dt, id)) << id;
+  }
+  ASSERT_EQ(sizeof(uint64_t), DocTable_DeletedMemUsage(&dt));
+  DocTable_GcStarted(&dt);
+  DocTable_GcCompleted(&dt);
+  ASSERT_EQ(0, DocTable_DeletedMemUsage(&dt));
+  ASSERT_FALSE(DocTable_Exists(&dt, 1));
+
+  DocTable_Free(&dt);
+}
+
+TEST_F(IndexTest, testDocTableEmptyPages) {
+  char buf[16];
+  DocTable dt = NewDocTable(10, 1000);
+  for (int i = 1; i < DOCTABLE_PAGE_SIZE; i++) {
+    size_t nkey = sprintf(buf, "doc_%d", i);
+    DocTable_Put(&dt, buf, nkey, 1, Document_DefaultFlags, NULL, 0, DocumentType_Hash);
+  }
+  // emptying the last page keeps it for the next documents
+  for (int i = 1; i < DOCTABLE_PAGE_SIZE; i++) {
+    size_t nkey = sprintf(buf, "doc_%d", i);
+    ASSERT_EQ(1, DocTable_Delete(&dt, buf, nkey));
+  }
+  ASSERT_TRUE(dt.pages[0].dmds != NULL);
+  ASSERT_EQ(0, dt.pages[0].numDocs);
+
+  // and it is freed once documents move on to the next page
+  RSDocumentMetadata *dmd =
+      DocTable_Put(&dt, "doc_a", 5, 1, Document_DefaultFlags, NULL, 0, DocumentType_Hash);
+  ASSERT_EQ(DOCTABLE_PAGE_SIZE, dmd->id);
+  ASSERT_TRUE(dt.pages[0].dmds == NULL);
+  ASSERT_EQ(dmd, DocTable_Get(&dt, DOCTABLE_PAGE_SIZE));
+  ASSERT_TRUE(DocTable_Get(&dt, 1) == NULL);
+
+  DocTable_Free(&dt);
+}
+
+TEST_F(IndexTest, testRenumberDocIds) {
+  char buf[16];
+  DocTable dt = NewDocTable(10, 1000);
+  int N = 3000;
+  for (int i = 1; i <= N; i++) {
+    size_t nkey = sprintf(buf, "doc_%d", i);
+    DocTable_Put(&dt, buf, nkey, 1, Document_DefaultFlags, NULL, 0, DocumentType_Hash);
+  }
+  for (int i = 3; i <= N; i += 3) {
+    size_t nkey = sprintf(buf, "doc_%d", i);
+    ASSERT_EQ(1, DocTable_Delete(&dt, buf, nkey));
+  }
+  InvertedIndex *w = createIndex(N, 1);
+  NumericRangeTree *rt = NewNumericRangeTree();
+  for (int i = 1; i <= N; i++) {
+    NumericRangeTree_Add(rt, i, i % 100);
+  }
+
+  DocIdRemap remap;
+  DocIdRemap_Init(&remap, &dt);
+  for (t_docId id = 0; id <= N + 100; id++) {
+    t_docId expected = id && id <= N && id % 3 ? id - id / 3 : 0;
+    ASSERT_EQ(expected, DocIdRemap_Get(&remap, id)) << id;
+  }
+
+  IndexRepairParams params = {0};
+  InvertedIndex_Renumber(w, &remap, &params);
+  ASSERT_EQ(N / 3, params.docsCollected);
+  ASSERT_LT(params.bytesAfterFix, params.bytesBeforFix);
+  ASSERT_EQ(N - N / 3, w->numDocs);
+  ASSERT_EQ(N - N / 3, w->lastId);
+  IndexReader *r = NewTermIndexReader(w, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  RSIndexResult *h = NULL;
+  for (t_docId id = 1; id <= N - N / 3; id++) {
+    ASSERT_EQ(INDEXREAD_OK, IR_Read(r, &h));
+    ASSERT_EQ(id, h->docId);
+  }
+  ASSERT_EQ(INDEXREAD_EOF, IR_Read(r, &h));
+  IR_Free(r);
+
+  // the last document was deleted, so the tree ends at the last live one
+  params = (IndexRepairParams){0};
+  NumericRangeTree_Renumber(rt, &remap, &params);
+  ASSERT_EQ(N / 3, params.docsCollected);
+  ASSERT_EQ(N - N / 3, rt->lastDocId);
+  ASSERT_EQ(0, NumericRangeTree_Add(rt, N - N / 3, 1).numRecords);
+  ASSERT_EQ(1, NumericRangeTree_Add(rt, N - N / 3 + 1, 1).numRecords);
+  NumericRangeTree_Free(rt);
+
+  DocTable_Renumber(&dt, &remap);
+  DocIdRemap_Free(&remap);
+  ASSERT_EQ(N - N / 3, dt.maxDocId);
+  for (int i = 1; i <= N; i++) {
+    size_t nkey = sprintf(buf, "doc_%d", i);
+    t_docId id = DocTable_GetId(&dt, buf, nkey);
+    ASSERT_EQ(i % 3 ? i - i / 3 : 0, id) << i;
+    if (id) {
+      RSDocumentMetadata *dmd = DocTable_Get(&dt, id);
+      ASSERT_TRUE(dmd != NULL);
+      ASSERT_EQ(id, dmd->id);
+      ASSERT_STREQ(buf, dmd->keyPtr);
+      ASSERT_FALSE(DocTable_IsDeleted(&dt, id));
+    }
+  }
+
+  // new documents follow the renumbered ones
+  t_docId id = DocTable_Put(&dt, "new", 3, 1, Document_DefaultFlags, NULL, 0, DocumentType_Hash)->id;
+  ASSERT_EQ(N - N / 3 + 1, id);
+
+  InvertedIndex_Free(w);
+  DocTable_Free(&dt);
+}
+
 // Note -- in test_index.c, this test was never actually run!
 TEST_F(IndexTest, DISABLED_testOptional) {
   InvertedIndex *w = createIndex(16, 1);
@@ -460,6 +1107,123 @@ TEST_F(IndexTest, testNumericInverted) {
   it->Free(it);
 }
 
+TEST_F(IndexTest, testPackedNumericBlocks) {
+  InvertedIndex *idx = NewInvertedIndex((IndexFlags)(Index_StoreNumeric | Index_PackNumeric), 1);
+  DocTable dt = NewDocTable(10, 2000);
+  char buf[16];
+
+  // millisecond timestamps of a few seconds apart, which take 9 bytes each when encoded
+  std::vector<t_docId> ids;
+  std::vector<double> values;
+  for (size_t i = 0; i < 250; i++) {
+    // leave gaps of documents without a value
+    if (i % 7 == 0) {
+      size_t nkey = sprintf(buf, "gap_%zu", i);
+      DocTable_Put(&dt, buf, nkey, 1, Document_DefaultFlags, NULL, 0, DocumentType_Hash);
+    }
+    size_t nkey = sprintf(buf, "doc_%zu", i);
+    RSDocumentMetadata *dmd = DocTable_Put(&dt, buf, nkey, 1, Document_DefaultFlags, NULL, 0,
+                                           DocumentType_Hash);
+    t_docId docId = dmd->id;
+    double value = 1700000000000.0 + i * 3217 + (i * 7919) % 1000;
+    ids.push_back(docId);
+    values.push_back(value);
+    InvertedIndex_WriteNumericEntry(idx, docId, value);
+  }
+  ASSERT_EQ(3, idx->size);
+  ASSERT_EQ(IndexBlock_NumericPacked, idx->blocks[0].type);
+  ASSERT_EQ(IndexBlock_NumericPacked, idx->blocks[1].type);
+  ASSERT_EQ(IndexBlock_Encoded, idx->blocks[2].type);
+  ASSERT_EQ(ids[0], idx->blocks[0].firstId);
+  ASSERT_EQ(ids[99], idx->blocks[0].lastId);
+  // smaller than the encoded last block, which has half as many records
+  ASSERT_LT(IndexBlock_DataLen(&idx->blocks[0]), IndexBlock_DataLen(&idx->blocks[2]));
+  // the last block may still be written to, so it has no bounds
+  NumericBlockBounds *bounds = NULL;
+  InvertedIndex_UpdateNumericBounds(idx, &bounds);
+  ASSERT_EQ(2, array_len(bounds));
+  ASSERT_EQ(ids[100], bounds[1].firstId);
+  ASSERT_LE(bounds[1].minVal, values[100]);
+  ASSERT_GE(bounds[1].maxVal, values[199]);
+
+  IndexReader *ir = NewNumericReader(NULL, idx, NULL, 0, 0);
+  RSIndexResult *h = NULL;
+  size_t n = 0;
+  while (IR_Read(ir, &h) != INDEXREAD_EOF) {
+    ASSERT_EQ(ids[n], h->docId);
+    ASSERT_EQ(values[n], h->num.value);
+    n++;
+  }
+  ASSERT_EQ(ids.size(), n);
+  IR_Free(ir);
+
+  // skip into the packed blocks, to existing ids and to the ones in between
+  ir = NewNumericReader(NULL, idx, NULL, 0, 0);
+  for (size_t i = 1; i < ids.size(); i += 5) {
+    if (ids[i] - ids[i - 1] > 1) {
+      ASSERT_EQ(INDEXREAD_NOTFOUND, IR_SkipTo(ir, ids[i] - 1, &h));
+    } else {
+      ASSERT_EQ(INDEXREAD_OK, IR_SkipTo(ir, ids[i], &h));
+    }
+    ASSERT_EQ(ids[i], h->docId);
+    ASSERT_EQ(values[i], h->num.value);
+  }
+  ASSERT_EQ(INDEXREAD_EOF, IR_SkipTo(ir, ids.back() + 1, &h));
+  IR_Free(ir);
+
+  // the values of packed blocks are filtered like encoded ones
+  NumericFilter *flt = NewNumericFilter(values[50], values[150], 1, 0);
+  ir = NewNumericReader(NULL, idx, flt, 0, 0);
+  n = 50;
+  while (IR_Read(ir, &h) != INDEXREAD_EOF) {
+    ASSERT_EQ(ids[n], h->docId);
+    n++;
+  }
+  ASSERT_EQ(150, n);
+  IR_Free(ir);
+  NumericFilter_Free(flt);
+
+  // repairing a packed block packs the remaining records again
+  for (size_t i = 0; i < 100; i += 2) {
+    size_t nkey = sprintf(buf, "doc_%zu", i);
+    ASSERT_EQ(1, DocTable_Delete(&dt, buf, nkey));
+  }
+  IndexRepairParams params = {0};
+  params.limit = 1;
+  InvertedIndex_Repair(idx, &dt, 0, &params);
+  ASSERT_EQ(50, params.docsCollected);
+  ASSERT_EQ(IndexBlock_NumericPacked, idx->blocks[0].type);
+  ASSERT_EQ(50, idx->blocks[0].numDocs);
+  ASSERT_EQ(ids[1], idx->blocks[0].firstId);
+  // the first id of the repaired block changed, so its bounds are computed again
+  ASSERT_NE(ids[1], bounds[0].firstId);
+  InvertedIndex_UpdateNumericBounds(idx, &bounds);
+  ASSERT_EQ(ids[1], bounds[0].firstId);
+  ASSERT_LE(bounds[0].minVal, values[1]);
+  ASSERT_GE(bounds[0].maxVal, values[99]);
+  array_free(bounds);
+
+  ir = NewNumericReader(NULL, idx, NULL, 0, 0);
+  n = 1;
+  while (IR_Read(ir, &h) != INDEXREAD_EOF) {
+    ASSERT_EQ(ids[n], h->docId);
+    ASSERT_EQ(values[n], h->num.value);
+    n += n < 99 ? 2 : 1;
+  }
+  ASSERT_EQ(ids.size(), n);
+  IR_Free(ir);
+  InvertedIndex_Free(idx);
+  DocTable_Free(&dt);
+
+  // blocks with fractions stay encoded
+  idx = NewInvertedIndex((IndexFlags)(Index_StoreNumeric | Index_PackNumeric), 1);
+  for (t_docId i = 1; i <= 100; i++) {
+    InvertedIndex_WriteNumericEntry(idx, i, i * 1000.5);
+  }
+  ASSERT_EQ(IndexBlock_Encoded, idx->blocks[0].type);
+  InvertedIndex_Free(idx);
+}
+
 TEST_F(IndexTest, testNumericVaried) {
   InvertedIndex *idx = NewInvertedIndex(Index_StoreNumeric, 1);
 
@@ -638,6 +1402,125 @@ TEST_F(IndexTest, testIntersection) {
   InvertedIndex_Free(w2);
 }
 
+TEST_F(IndexTest, testIntersectionWindows) {
+  // a full term index, a packed docId-only index and a NOT child, which is advanced with SkipTo
+  InvertedIndex *w = createIndex(20000, 3);
+  InvertedIndex *w2 = NewInvertedIndex(Index_DocIdsOnly, 1);
+  InvertedIndex *w3 = createIndex(2000, 7);
+  IndexEncoder enc = InvertedIndex_GetEncoder(Index_DocIdsOnly);
+  RSIndexResult rec = {0};
+  rec.type = RSResultType_Term;
+  rec.freq = 1;
+  for (t_docId i = 1; i <= 30000; i++) {
+    InvertedIndex_WriteEntryGeneric(w2, enc, i * 2, &rec);
+  }
+
+  IndexIterator **irs = (IndexIterator **)calloc(3, sizeof(IndexIterator *));
+  irs[0] = NewReadIterator(NewTermIndexReader(w, NULL, RS_FIELDMASK_ALL, NULL, 1));
+  irs[1] = NewReadIterator(NewTermIndexReader(w2, NULL, RS_FIELDMASK_ALL, NULL, 1));
+  irs[2] = NewNotIterator(NewReadIterator(NewTermIndexReader(w3, NULL, RS_FIELDMASK_ALL, NULL, 1)),
+                          NULL, w->lastId, 1);
+  IndexIterator *ii = NewIntersecIterator(irs, 3, NULL, RS_FIELDMASK_ALL, -1, 0, 1);
+
+  auto matches = [](t_docId id) { return id % 6 == 0 && (id % 7 || id > 14000); };
+  RSIndexResult *h = NULL;
+  t_docId expected = 0;
+  size_t count = 0;
+  while (ii->Read(ii->ctx, &h) != INDEXREAD_EOF) {
+    do {
+      expected++;
+    } while (!matches(expected));
+    ASSERT_EQ(expected, h->docId);
+    ASSERT_EQ(3, h->agg.numChildren);
+    ASSERT_EQ(expected, h->agg.children[0]->docId);
+    ASSERT_EQ(expected, h->agg.children[1]->docId);
+    ++count;
+  }
+  size_t total = 0;
+  for (t_docId id = 1; id <= 60000; id++) {
+    total += matches(id);
+  }
+  ASSERT_EQ(total, count);
+
+  ii->Rewind(ii->ctx);
+  ASSERT_EQ(INDEXREAD_OK, ii->SkipTo(ii->ctx, 18, &h));
+  ASSERT_EQ(18, h->docId);
+  ASSERT_EQ(INDEXREAD_NOTFOUND, ii->SkipTo(ii->ctx, 37, &h));
+  ASSERT_EQ(48, h->docId);
+  ASSERT_EQ(INDEXREAD_OK, ii->Read(ii->ctx, &h));
+  ASSERT_EQ(54, h->docId);
+  ASSERT_EQ(INDEXREAD_OK, ii->SkipTo(ii->ctx, 54000, &h));
+  ASSERT_EQ(54000, h->docId);
+  ASSERT_EQ(INDEXREAD_NOTFOUND, ii->SkipTo(ii->ctx, 59999, &h));
+  ASSERT_EQ(60000, h->docId);
+  ASSERT_EQ(INDEXREAD_EOF, ii->Read(ii->ctx, &h));
+
+  ii->Free(ii);
+  InvertedIndex_Free(w);
+  InvertedIndex_Free(w2);
+  InvertedIndex_Free(w3);
+}
+
+TEST_F(IndexTest, testIntersectionAdaptiveOrder) {
+  // the union is estimated as larger than the reader, but matches far fewer documents
+  InvertedIndex *dense = createIndex(50000, 2);
+  std::vector<InvertedIndex *> sparse;
+  const size_t nsparse = 60;
+  for (size_t i = 0; i < nsparse; ++i) {
+    sparse.push_back(createIndex(1000, 100));
+  }
+  IndexIterator **uits = (IndexIterator **)calloc(nsparse, sizeof(IndexIterator *));
+  for (size_t i = 0; i < nsparse; ++i) {
+    uits[i] = NewReadIterator(NewTermIndexReader(sparse[i], NULL, RS_FIELDMASK_ALL, NULL, 1));
+  }
+  IndexIterator **irs = (IndexIterator **)calloc(2, sizeof(IndexIterator *));
+  irs[0] = NewUnionIterator(uits, nsparse, NULL, 0, 1, QN_UNION, NULL);
+  irs[1] = NewReadIterator(NewTermIndexReader(dense, NULL, RS_FIELDMASK_ALL, NULL, 1));
+  ASSERT_GT(irs[0]->NumEstimated(irs[0]->ctx), irs[1]->NumEstimated(irs[1]->ctx));
+
+  IndexIterator *ii = NewIntersecIterator(irs, 2, NULL, RS_FIELDMASK_ALL, -1, 0, 1);
+  RSIndexResult *h = NULL;
+  t_docId expected = 0;
+  while (ii->Read(ii->ctx, &h) != INDEXREAD_EOF) {
+    expected += 100;
+    ASSERT_EQ(expected, h->docId);
+    ASSERT_EQ(2, h->agg.numChildren);
+  }
+  ASSERT_EQ(100000, expected);
+
+  ii->Free(ii);
+  InvertedIndex_Free(dense);
+  for (InvertedIndex *idx : sparse) {
+    InvertedIndex_Free(idx);
+  }
+}
+
+TEST_F(IndexTest, testNumericEstimate) {
+  InvertedIndex *idx = NewInvertedIndex(Index_StoreNumeric, 1);
+  for (int i = 1; i <= 1000; i++) {
+    InvertedIndex_WriteNumericEntry(idx, i, i);
+  }
+
+  // a range which the filter covers entirely is read without a filter
+  IndexIterator *it = NewReadIterator(NewNumericReader(NULL, idx, NULL, 1, 1000));
+  ASSERT_EQ(1000, it->NumEstimated(it->ctx));
+  it->Free(it);
+
+  NumericFilter *flt = NewNumericFilter(751, 2000, 1, 1);
+  it = NewReadIterator(NewNumericReader(NULL, idx, flt, 1, 1000));
+  ASSERT_NEAR(250, it->NumEstimated(it->ctx), 1);
+  it->Free(it);
+  NumericFilter_Free(flt);
+
+  flt = NewNumericFilter(5000, 6000, 1, 1);
+  it = NewReadIterator(NewNumericReader(NULL, idx, flt, 1, 1000));
+  ASSERT_EQ(1, it->NumEstimated(it->ctx));
+  it->Free(it);
+  NumericFilter_Free(flt);
+
+  InvertedIndex_Free(idx);
+}
+
 TEST_F(IndexTest, testHybridVector) {
 
   size_t n = 100;
@@ -1181,7 +2064,7 @@ TEST_F(IndexTest, testDocTable) {
   ASSERT_EQ(N + 1, dt.size);
   ASSERT_EQ(N, dt.maxDocId);
 #ifdef __x86_64__
-  ASSERT_EQ(10180, (int)dt.memsize);
+  ASSERT_EQ(8580, (int)dt.memsize);
 #endif
   for (int i = 0; i < N; i++) {
     sprintf(buf, "doc_%d", i);
@@ -1220,7 +2103,7 @@ TEST_F(IndexTest, testDocTable) {
   RSDocumentMetadata *dmd = DocTable_Put(&dt, "Hello", 5, 1.0, Document_DefaultFlags, NULL, 0, DocumentType_Hash);
   t_docId strDocId = dmd->id;
   ASSERT_TRUE(0 != strDocId);
-  ASSERT_EQ(71, (int)dt.memsize);
+  ASSERT_EQ(55, (int)dt.memsize);
 
   // Test that binary keys also work here
   static const char binBuf[] = {"Hello\x00World"};
@@ -1228,13 +2111,61 @@ TEST_F(IndexTest, testDocTable) {
   ASSERT_FALSE(DocIdMap_Get(&dt.dim, binBuf, binBufLen));
   dmd = DocTable_Put(&dt, binBuf, binBufLen, 1.0, Document_DefaultFlags, NULL, 0, DocumentType_Hash);
   ASSERT_TRUE(dmd);
-  ASSERT_EQ(148, (int)dt.memsize);
+  ASSERT_EQ(116, (int)dt.memsize);
   ASSERT_NE(dmd->id, strDocId);
   ASSERT_EQ(dmd->id, DocIdMap_Get(&dt.dim, binBuf, binBufLen));
   ASSERT_EQ(strDocId, DocIdMap_Get(&dt.dim, "Hello", 5));
   DocTable_Free(&dt);
 }
 
+TEST_F(IndexTest, testDocIdMap) {
+  char buf[16];
+  DocTable dt = NewDocTable(10, 1000);
+  ASSERT_EQ(0, DocIdMap_MemUsage(&dt.dim));
+  int N = 5000;
+  for (int i = 0; i < N; i++) {
+    size_t nkey = sprintf(buf, "doc_%d", i);
+    DocTable_Put(&dt, buf, nkey, 1, Document_DefaultFlags, NULL, 0, DocumentType_Hash);
+  }
+  ASSERT_EQ(N, dt.dim.size);
+  // the map keeps at most 7/8 of its slots occupied
+  ASSERT_LE(N * 8, dt.dim.cap * 7);
+
+  // delete and re-add documents so that probe sequences go through deleted slots
+  for (int round = 0; round < 3; round++) {
+    for (int i = round; i < N; i += 3) {
+      size_t nkey = sprintf(buf, "doc_%d", i);
+      ASSERT_EQ(1, DocTable_Delete(&dt, buf, nkey));
+      ASSERT_EQ(0, DocIdMap_Get(&dt.dim, buf, nkey));
+    }
+    for (int i = 0; i < N; i++) {
+      size_t nkey = sprintf(buf, "doc_%d", i);
+      t_docId id = DocIdMap_Get(&dt.dim, buf, nkey);
+      ASSERT_EQ(i % 3 != round, id != 0) << buf;
+      if (id) {
+        ASSERT_STREQ(buf, DocTable_Get(&dt, id)->keyPtr);
+      } else {
+        DocTable_Put(&dt, buf, nkey, 1, Document_DefaultFlags, NULL, 0, DocumentType_Hash);
+      }
+    }
+    ASSERT_EQ(N, dt.dim.size);
+  }
+
+  // renaming a document moves its entry to the new key
+  t_docId id = DocIdMap_Get(&dt.dim, "doc_7", 5);
+  ASSERT_EQ(REDISMODULE_OK, DocTable_Replace(&dt, "doc_7", 5, "renamed", 7));
+  ASSERT_EQ(0, DocIdMap_Get(&dt.dim, "doc_7", 5));
+  ASSERT_EQ(id, DocIdMap_Get(&dt.dim, "renamed", 7));
+
+  // an emptied map releases its table
+  for (int i = 0; i < N; i++) {
+    size_t nkey = i == 7 ? sprintf(buf, "renamed") : sprintf(buf, "doc_%d", i);
+    ASSERT_EQ(1, DocTable_Delete(&dt, buf, nkey));
+  }
+  ASSERT_EQ(0, DocIdMap_MemUsage(&dt.dim));
+  DocTable_Free(&dt);
+}
+
 TEST_F(IndexTest, testSortable) {
   RSSortingTable *tbl = NewSortingTable();
   RSSortingTable_Add(&tbl, "foo", RSValue_String);
@@ -5,6 +5,10 @@
 
 #include <set>
 #include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <math.h>
 
 #define DOCID1 "doc1"
 #define DOCID2 "doc2"
@@ -204,6 +208,136 @@ TEST_F(LLApiTest, testAddDocumentGeoField) {
   RediSearch_DropIndex(index);
 }
 
+static double haversine(double lon1, double lat1, double lon2, double lat2) {
+  double rlat1 = lat1 * M_PI / 180, rlat2 = lat2 * M_PI / 180;
+  double u = sin((rlat2 - rlat1) / 2), v = sin((lon2 - lon1) * M_PI / 180 / 2);
+  return 2 * 6372797.560856 * asin(sqrt(u * u + cos(rlat1) * cos(rlat2) * v * v));
+}
+
+static std::set<std::string> iterateIds(RSIndex* index, const char* q) {
+  std::set<std::string> ids;
+  // knn queries are only parsed by dialect 2
+  RSResultsIterator* it = RediSearch_IterateQueryWithDialect(index, q, strlen(q), 2, NULL);
+  if (!it) {
+    return ids;
+  }
+  size_t len;
+  const char* id;
+  while ((id = (const char*)RediSearch_ResultsIteratorNext(it, index, &len))) {
+    ids.insert(std::string(id, len));
+  }
+  RediSearch_ResultsIteratorFree(it);
+  return ids;
+}
+
+TEST_F(LLApiTest, testGeoKnn) {
+  RSIndex* index = RediSearch_CreateIndex("index", NULL);
+  RediSearch_CreateGeoField(index, GEO_FIELD_NAME);
+  RediSearch_CreateField(index, FIELD_NAME_1, RSFLDTYPE_FULLTEXT, RSFLDOPT_NONE);
+
+  // a grid over the whole globe, so the nearest points are found after expanding the radius
+  std::vector<std::pair<double, std::string>> all, odd;
+  double lon0 = 10.3, lat0 = 20.7;
+  int n = 0;
+  for (int lon = -180; lon < 180; lon += 4) {
+    for (int lat = -80; lat <= 80; lat += 4, ++n) {
+      std::string id = "g" + std::to_string(n);
+      RSDoc* d = RediSearch_CreateDocument(id.c_str(), id.size(), 1.0, NULL);
+      RediSearch_DocumentAddFieldGeo(d, GEO_FIELD_NAME, lat, lon, RSFLDTYPE_DEFAULT);
+      RediSearch_DocumentAddFieldCString(d, FIELD_NAME_1, n % 2 ? "odd" : "even", RSFLDTYPE_DEFAULT);
+      ASSERT_EQ(RediSearch_SpecAddDocument(index, d), REDISMODULE_OK);
+      all.push_back({haversine(lon0, lat0, lon, lat), id});
+      if (n % 2) {
+        odd.push_back(all.back());
+      }
+    }
+  }
+  std::sort(all.begin(), all.end());
+  std::sort(odd.begin(), odd.end());
+
+  std::set<std::string> expected;
+  for (size_t i = 0; i < 5; ++i) {
+    expected.insert(all[i].second);
+  }
+  ASSERT_EQ(expected, iterateIds(index, "@geo:[KNN 5 10.3 20.7]"));
+
+  expected.clear();
+  for (size_t i = 0; i < 5; ++i) {
+    expected.insert(odd[i].second);
+  }
+  // the nearest of the documents matching the rest of the query
+  ASSERT_EQ(expected, iterateIds(index, "odd @geo:[KNN 5 10.3 20.7]"));
+
+  // every document is returned when k is larger than the index
+  ASSERT_EQ(n, iterateIds(index, "@geo:[KNN 100000 10.3 20.7]").size());
+  ASSERT_EQ(odd.size(), iterateIds(index, "odd @geo:[KNN 100000 10.3 20.7]").size());
+
+  // the nearest point is on the other side of the antimeridian
+  std::set<std::string> nearest = iterateIds(index, "@geo:[KNN 1 179.9 0.1]");
+  ASSERT_EQ(1, nearest.size());
+  ASSERT_EQ(std::string("g") + std::to_string(20), *nearest.begin());
+
+  RediSearch_DropIndex(index);
+}
+
+TEST_F(LLApiTest, testGeoShapes) {
+  RSIndex* index = RediSearch_CreateIndex("index", NULL);
+  RediSearch_CreateGeoField(index, GEO_FIELD_NAME);
+
+  // a grid of whole degrees around the meridian and on both sides of the antimeridian, so the
+  // points are never on the edges of the shapes
+  std::vector<std::pair<int, int>> points;
+  for (int lon = -180; lon < 180; ++lon) {
+    if (lon >= -170 && lon < -10 || lon >= 20 && lon < 170) {
+      continue;
+    }
+    for (int lat = -10; lat < 20; ++lat) {
+      std::string id = std::to_string(lon) + "," + std::to_string(lat);
+      RSDoc* d = RediSearch_CreateDocument(id.c_str(), id.size(), 1.0, NULL);
+      RediSearch_DocumentAddFieldGeo(d, GEO_FIELD_NAME, lat, lon, RSFLDTYPE_DEFAULT);
+      ASSERT_EQ(RediSearch_SpecAddDocument(index, d), REDISMODULE_OK);
+      points.push_back({lon, lat});
+    }
+  }
+  auto expect = [&](std::function<bool(int, int)> within) {
+    std::set<std::string> ids;
+    for (auto& p : points) {
+      if (within(p.first, p.second)) {
+        ids.insert(std::to_string(p.first) + "," + std::to_string(p.second));
+      }
+    }
+    return ids;
+  };
+
+  auto box = expect([](int lon, int lat) { return lon >= -3 && lon <= 7 && lat >= 3 && lat <= 4; });
+  ASSERT_EQ(11 * 2, box.size());
+  ASSERT_EQ(box, iterateIds(index, "@geo:[BBOX -3.5 2.5 7.5 4.5]"));
+
+  // a box whose min longitude is east of its max longitude crosses the antimeridian
+  box = expect([](int lon, int lat) { return (lon > 175 || lon < -176) && lat > -3 && lat < 1; });
+  ASSERT_EQ(8 * 3, box.size());
+  ASSERT_EQ(box, iterateIds(index, "@geo:[BBOX 175.5 -2.5 -176.5 0.5]"));
+
+  // a concave polygon, shaped as an L
+  auto l = expect([](int lon, int lat) {
+    return lon >= 1 && lat >= 1 && (lon <= 10 && lat <= 3 || lon <= 3 && lat <= 10);
+  });
+  ASSERT_EQ(10 * 3 + 3 * 7, l.size());
+  ASSERT_EQ(l, iterateIds(index, "@geo:[POLYGON 0.5 0.5 10.5 0.5 10.5 3.5 3.5 3.5 3.5 10.5 0.5 10.5]"));
+
+  // a triangle, whose cells cover points outside of it
+  auto triangle = expect([](int lon, int lat) { return lat > 0 && lon > 0 && lon + lat <= 8; });
+  ASSERT_EQ(7 * 8 / 2, triangle.size());
+  ASSERT_EQ(triangle, iterateIds(index, "@geo:[POLYGON 0.5 0.5 0.5 7.6 7.6 0.5]"));
+
+  // shapes with invalid coordinates or too few points are not parsed
+  ASSERT_EQ(0, iterateIds(index, "@geo:[BBOX -3.5 200 7.5 4.5]").size());
+  ASSERT_EQ(0, iterateIds(index, "@geo:[BBOX -3.5 4.5 7.5 2.5]").size());
+  ASSERT_EQ(0, iterateIds(index, "@geo:[POLYGON 0.5 0.5 10.5 0.5]").size());
+
+  RediSearch_DropIndex(index);
+}
+
 TEST_F(LLApiTest, testAddDocumentNumericFieldWithMoreThenOneNode) {
   // creating the index
   RSIndex* index = RediSearch_CreateIndex("index", NULL);
@@ -474,6 +608,64 @@ TEST_F(LLApiTest, testSuffixTag) {
   RediSearch_DropIndex(index);
 }
 
+TEST_F(LLApiTest, testContainsNgrams) {
+  // creating the index
+  RSIndex* index = RediSearch_CreateIndex("index", NULL);
+  RediSearch_CreateTextField(index, FIELD_NAME_1);
+  RediSearch_CreateField(index, FIELD_NAME_2, RSFLDTYPE_FULLTEXT, RSFLDOPT_WITHNGRAMS);
+  RediSearch_CreateTagField(index, TAG_FIELD_NAME1);
+  RediSearch_CreateField(index, TAG_FIELD_NAME2, RSFLDTYPE_TAG, RSFLDOPT_WITHNGRAMS);
+  char buff[16];
+  for (int i = 0; i < 10; ++i) {
+    sprintf(buff, "%d", i);
+    RSDoc* d = RediSearch_CreateDocument(buff, strlen(buff), 1.0, NULL);
+    RediSearch_DocumentAddFieldCString(d, FIELD_NAME_1, words[i], RSFLDTYPE_DEFAULT);
+    RediSearch_DocumentAddFieldCString(d, FIELD_NAME_2, words[i], RSFLDTYPE_DEFAULT);
+    RediSearch_DocumentAddFieldCString(d, TAG_FIELD_NAME1, words[i], RSFLDTYPE_DEFAULT);
+    RediSearch_DocumentAddFieldCString(d, TAG_FIELD_NAME2, words[i], RSFLDTYPE_DEFAULT);
+    RediSearch_SpecAddDocument(index, d);
+  }
+
+  // the n-gram index finds the same terms as a walk over all terms
+  struct {
+    const char *pattern;
+    bool contains;
+    int count;
+  } cases[] = {{"el", true, 7}, {"ell", true, 4}, {"lpe", true, 1}, {"er", false, 3},
+               {"ell", false, 2}, {"xyz", true, 0}};
+  for (auto &c : cases) {
+    for (int i = 0; i < 4; ++i) {
+      RSQNode* qn;
+      if (i < 2) {
+        const char *field = i ? FIELD_NAME_2 : FIELD_NAME_1;
+        qn = c.contains ? RediSearch_CreateContainsNode(index, field, c.pattern)
+                        : RediSearch_CreateSuffixNode(index, field, c.pattern);
+      } else {
+        qn = RediSearch_CreateTagNode(index, i == 3 ? TAG_FIELD_NAME2 : TAG_FIELD_NAME1);
+        RediSearch_QueryNodeAddChild(qn, c.contains ? RediSearch_CreateTagContainsNode(index, c.pattern)
+                                                    : RediSearch_CreateTagSuffixNode(index, c.pattern));
+      }
+      RSResultsIterator* iter = RediSearch_GetResultsIterator(qn, index);
+      if (!iter) {
+        ASSERT_EQ(c.count, 0);
+        continue;
+      }
+
+      const char* id;
+      size_t len;
+      int ii = 0;
+      while ((id = (const char*)RediSearch_ResultsIteratorNext(iter, index, &len))) {
+        ASSERT_TRUE(strstr(words[*id - '0'], c.pattern) != NULL);
+        ++ii;
+      }
+      ASSERT_EQ(ii, c.count) << c.pattern << " " << i;
+
+      RediSearch_ResultsIteratorFree(iter);
+    }
+  }
+  RediSearch_DropIndex(index);
+}
+
 static void PopulateIndex(RSIndex* index) {
   char buf[] = {"Mark_"};
   size_t nbuf = strlen(buf);
@@ -1107,9 +1299,9 @@ TEST_F(LLApiTest, testInfo) {
   // common stats
   ASSERT_EQ(info.numDocuments, 2);
   ASSERT_EQ(info.maxDocId, 2);
-  ASSERT_EQ(info.docTableSize, 140);
+  ASSERT_EQ(info.docTableSize, 108);
   ASSERT_EQ(info.sortablesSize, 48);
-  ASSERT_EQ(info.docTrieSize, 87);
+  ASSERT_EQ(info.docTrieSize, 72);
   ASSERT_EQ(info.numTerms, 5);
   ASSERT_EQ(info.numRecords, 7);
   ASSERT_EQ(info.invertedSize, 32);
@@ -52,6 +52,13 @@ class QASTCXX : public QueryAST {
     QAST_Print(this, sctx->spec);
   }
 
+  std::string key() const {
+    sds s = QAST_SerializeKey(this, &m_opts);
+    std::string ret(s ? s : "");
+    sdsfree(s);
+    return ret;
+  }
+
   const char *getError() const {
     return QueryError_GetError(&m_status);
   }
@@ -831,3 +838,30 @@ TEST_F(QueryTest, testTags) {
   ASSERT_STREQ("lorem\\ ipsum", n->children[3]->tn.str);
   IndexSpec_Free(ctx.spec);
 }
+
+TEST_F(QueryTest, testSerializeKey) {
+  static const char *args[] = {"SCHEMA", "title", "text", "n", "numeric"};
+  QueryError err = {QUERY_OK};
+  IndexSpec *spec = IndexSpec_Parse("idx", args, sizeof(args) / sizeof(const char *), &err);
+  RedisSearchCtx ctx = SEARCH_CTX_STATIC(NULL, spec);
+
+  auto key = [&](const char *qt, int ver = 2) {
+    QASTCXX ast(ctx);
+    EXPECT_TRUE(ast.parse(qt, ver)) << ast.getError();
+    return ast.key();
+  };
+
+  // the key does not depend on how the query is spelled
+  ASSERT_EQ(key("hello world"), key("  hello   world "));
+  ASSERT_EQ(key("@title:hello"), key("@title:(hello)"));
+
+  // but tells apart queries that explain the same way
+  ASSERT_NE(key("hel*"), key("*hel"));
+  ASSERT_NE(key("hel*"), key("*hel*"));
+  ASSERT_NE(key("%hello%"), key("%%hello%%"));
+  ASSERT_NE(key("@n:[1 2]"), key("@n:[(1 2]"));
+  ASSERT_NE(key("@n:[1 2]"), key("@n:[1.0000001 2]"));
+  ASSERT_NE(key("hello => {$weight: 0.5}"), key("hello => {$weight: 0.25}"));
+  ASSERT_NE(key("foo bar"), key("foobar"));
+  IndexSpec_Free(ctx.spec);
+}
@@ -2,10 +2,14 @@
 #include "gtest/gtest.h"
 
 #include "numeric_index.h"
+#include "numeric_order.h"
 #include "index.h"
 #include "rmutil/alloc.h"
+#include "util/arr.h"
 
 #include <stdio.h>
+#include <math.h>
+#include <algorithm>
 
 extern "C" {
 // declaration for an internal function implemented in numeric_index.c
@@ -141,6 +145,197 @@ TEST_F(RangeTest, testRangeIterator) {
   NumericRangeTree_Free(t);
 }
 
+TEST_F(RangeTest, testBlockBounds) {
+  NumericRangeTree *t = NewNumericRangeTree();
+  for (size_t i = 0; i < 10000; i++) {
+    NumericRangeTree_Add(t, i + 1, 50 - (double)(i % 1000) / 10);
+  }
+
+  // a range crossing the filter's minimum, with runs of values in and out of the filter
+  NumericFilter *flt = NewNumericFilter(0, 100, 1, 1);
+  Vector *v = NumericRangeTree_Find(t, flt->min, flt->max);
+  NumericRange *rng = NULL;
+  for (int i = 0; i < Vector_Size(v); i++) {
+    NumericRange *cur;
+    Vector_Get(v, i, &cur);
+    if (cur->minVal < flt->min) {
+      rng = cur;
+    }
+  }
+  Vector_Free(v);
+  ASSERT_TRUE(rng != NULL);
+  ASSERT_EQ(rng->entries->numDocs, 1740);
+
+  // the bounds are kept by the range, so the blocks of other indexes don't grow
+  ASSERT_EQ(48, sizeof(IndexBlock));
+  IndexReader *ir = NewNumericBoundedReader(NULL, rng->entries, flt, rng->minVal, rng->maxVal,
+                                            &rng->blockBounds);
+  ASSERT_EQ(rng->entries->size - 1, array_len(rng->blockBounds));
+  for (uint32_t i = 0; i < array_len(rng->blockBounds); i++) {
+    ASSERT_EQ(rng->entries->blocks[i].firstId, rng->blockBounds[i].firstId);
+    ASSERT_LE(rng->blockBounds[i].minVal, rng->blockBounds[i].maxVal);
+  }
+  RSIndexResult *res;
+  size_t count = 0;
+  while (IR_Read(ir, &res) == INDEXREAD_OK) {
+    ASSERT_TRUE(NumericFilter_Match(flt, res->num.value));
+    count++;
+  }
+  ASSERT_EQ(count, 1450);
+  // blocks entirely inside the filter are read without testing their values
+  ASSERT_EQ(ir->blocksMatched, 6);
+  ASSERT_EQ(ir->blocksSkipped, 0);
+  IR_Free(ir);
+
+  // a filter on values which are all in one run skips the blocks of the other runs
+  NumericFilter *narrow = NewNumericFilter(-2, -1, 1, 1);
+  ir = NewNumericBoundedReader(NULL, rng->entries, narrow, rng->minVal, rng->maxVal,
+                               &rng->blockBounds);
+  count = 0;
+  while (IR_Read(ir, &res) == INDEXREAD_OK) {
+    ASSERT_TRUE(NumericFilter_Match(narrow, res->num.value));
+    count++;
+  }
+  ASSERT_EQ(count, 110);
+  ASSERT_EQ(ir->blocksSkipped, 7);
+  ASSERT_EQ(ir->blocksMatched, 0);
+  IR_Free(ir);
+
+  NumericFilter_Free(narrow);
+  NumericFilter_Free(flt);
+  NumericRangeTree_Free(t);
+}
+
+TEST_F(RangeTest, testEstimateAndCount) {
+  NumericRangeTree *t = NewNumericRangeTree();
+  // values bunched towards the low end, so a range is not evenly spread
+  for (size_t i = 0; i < 10000; i++) {
+    double x = (double)(i % 1000);
+    NumericRangeTree_Add(t, i + 1, floor(x * x / 1000));
+  }
+
+  IndexSpec sp;
+  memset(&sp, 0, sizeof(sp));
+  sp.docs = DocTable_New(100);
+  char key[32];
+  for (size_t i = 0; i < 10000; i++) {
+    size_t n = sprintf(key, "doc%zu", i + 1);
+    DocTable_Put(&sp.docs, key, n, 1, Document_DefaultFlags, NULL, 0, DocumentType_Hash);
+  }
+  NumericFilter *flt = NewNumericFilter(0, 100, 1, 1);
+  ASSERT_EQ(NumericRangeTree_CountMatches(t, &sp, flt), 3180);
+
+  // deleted documents are left out of the count, whether a range was counted before or not
+  DocTable_Delete(&sp.docs, "doc1", 4);
+  ASSERT_EQ(NumericRangeTree_CountMatches(t, &sp, flt), 3179);
+  ASSERT_EQ(NumericRangeTree_CountMatches(t, &sp, flt), 3179);
+  DocTable_Delete(&sp.docs, "doc2", 4);
+  ASSERT_EQ(NumericRangeTree_CountMatches(t, &sp, flt), 3178);
+
+  // the range crossing the filter's maximum is estimated from the sample of its values
+  Vector *v = NumericRangeTree_Find(t, flt->min, flt->max);
+  NumericRange *rng = NULL;
+  for (int i = 0; i < Vector_Size(v); i++) {
+    NumericRange *cur;
+    Vector_Get(v, i, &cur);
+    if (cur->maxVal > flt->max) {
+      rng = cur;
+    }
+  }
+  Vector_Free(v);
+  ASSERT_TRUE(rng != NULL);
+  ASSERT_EQ(rng->entries->numDocs, 3660);
+
+  IndexIterator *it = NewNumericRangeIterator(NULL, rng, flt);
+  size_t count = 0;
+  RSIndexResult *res;
+  while (it->Read(it->ctx, &res) == INDEXREAD_OK) {
+    count++;
+  }
+  ASSERT_EQ(count, 940);
+  // assuming evenly spread values would give 619
+  size_t estimated = it->NumEstimated(it->ctx);
+  ASSERT_GE(estimated, 850);
+  ASSERT_LE(estimated, 1030);
+  it->Free(it);
+
+  IndexIterator *union_it = createNumericIterator(NULL, t, flt);
+  estimated = union_it->NumEstimated(union_it->ctx);
+  ASSERT_GE(estimated, 3090);
+  ASSERT_LE(estimated, 3270);
+  union_it->Free(union_it);
+
+  NumericFilter *exclusive = NewNumericFilter(0, 100, 0, 0);
+  ASSERT_EQ(NumericRangeTree_CountMatches(t, &sp, exclusive), 2850);
+
+  NumericFilter_Free(exclusive);
+  NumericFilter_Free(flt);
+  NumericRangeTree_Free(t);
+  DocTable_Free(&sp.docs);
+
+  // a range too small to have a sample is estimated by all its entries
+  t = NewNumericRangeTree();
+  for (size_t i = 0; i < 5; i++) {
+    NumericRangeTree_Add(t, i + 1, i);
+  }
+  flt = NewNumericFilter(0, 1, 1, 1);
+  it = createNumericIterator(NULL, t, flt);
+  ASSERT_EQ(it->NumEstimated(it->ctx), 5);
+  it->Free(it);
+  NumericFilter_Free(flt);
+  NumericRangeTree_Free(t);
+}
+
+TEST_F(RangeTest, testNumericOrderIterator) {
+  NumericRangeTree *t = NewNumericRangeTree();
+  const size_t N = 20000;
+  std::vector<double> lookup(N + 1);
+  std::vector<t_docId> ids;
+  for (size_t i = 0; i < N; i++) {
+    t_docId docId = i + 1;
+    lookup[docId] = (double)(1 + prng() % (N / 10));
+    NumericRangeTree_Add(t, docId, lookup[docId]);
+    if (docId % 3 == 0) {
+      ids.push_back(docId);
+    }
+  }
+  ASSERT_GT(t->numRanges, 1);
+
+  for (int ascending = 0; ascending < 2; ascending++) {
+    IndexIterator *filter = NewIdListIterator(&ids[0], ids.size(), 1);
+    IndexIterator *it = NewNumericOrderIterator(NULL, t, filter, -1, ascending);
+
+    size_t count = 0;
+    t_docId lastId = 0;
+    RSIndexResult *res = NULL;
+    while (it->Read(it->ctx, &res) == INDEXREAD_OK) {
+      ASSERT_EQ(res->docId % 3, 0);
+      if (lastId) {
+        double prev = lookup[lastId], cur = lookup[res->docId];
+        // equal values are ordered by docId, in the direction of the sort
+        if (ascending) {
+          ASSERT_TRUE(prev < cur || (prev == cur && lastId < res->docId));
+        } else {
+          ASSERT_TRUE(prev > cur || (prev == cur && lastId > res->docId));
+        }
+      }
+      lastId = res->docId;
+      count++;
+    }
+    ASSERT_EQ(count, ids.size());
+
+    // reading again after a rewind starts from the first value
+    it->Rewind(it->ctx);
+    ASSERT_EQ(it->Read(it->ctx, &res), INDEXREAD_OK);
+    t_docId first = res->docId;
+    for (auto id : ids) {
+      ASSERT_TRUE(ascending ? lookup[first] <= lookup[id] : lookup[first] >= lookup[id]);
+    }
+    it->Free(it);
+  }
+  NumericRangeTree_Free(t);
+}
+
 // int benchmarkNumericRangeTree() {
 //   NumericRangeTree *t = NewNumericRangeTree();
 //   int count = 1;
@@ -173,3 +368,99 @@ TEST_F(RangeTest, testRangeIterator) {
 //   NumericFilter_Free(flt);
 //   return 0;
 // }
+
+static int treeDepth(NumericRangeNode *n) {
+  if (NumericRangeNode_IsLeaf(n)) {
+    return 0;
+  }
+  return 1 + std::max(treeDepth(n->left), treeDepth(n->right));
+}
+
+TEST_F(RangeTest, testBalancedTree) {
+  NumericRangeTree *t = NewNumericRangeTree();
+  // increasing timestamps always split the rightmost leaf
+  const size_t N = 300000;
+  for (size_t i = 0; i < N; i++) {
+    NumericRangeTree_Add(t, i + 1, 1700000000000.0 + i * 1000);
+  }
+
+  NumericRange **leaves = NumericRangeTree_GetLeafRanges(t);
+  size_t nleaves = array_len(leaves);
+  ASSERT_GT(nleaves, 100);
+  size_t total = 0;
+  for (size_t i = 0; i < nleaves; i++) {
+    total += leaves[i]->entries->numDocs;
+    if (i) {
+      ASSERT_LT(leaves[i - 1]->maxVal, leaves[i]->minVal);
+    }
+  }
+  ASSERT_EQ(N, total);
+
+  int minDepth = (int)ceil(log2(nleaves));
+  ASSERT_EQ(treeDepth(t->root), t->root->maxDepth);
+  ASSERT_LE(t->root->maxDepth, minDepth + 2);
+
+  // a balanced tree is left as is
+  NumericRangeNode *root = t->root;
+  NRN_AddRv rv = NumericRangeTree_Rebalance(t);
+  ASSERT_FALSE(rv.changed);
+  ASSERT_EQ(root, t->root);
+
+  array_free(leaves);
+  NumericRangeTree_Free(t);
+
+  // a tree leaning to the right, as trimming the empty leaves of a tree could leave it
+  t = NewNumericRangeTree();
+  NumericRangeNode **np = &t->root;
+  NumericRangeNode_Free(t->root);
+  const size_t nvine = 64;
+  for (size_t i = 0; i < nvine; i++) {
+    NumericRangeNode *leaf = NewLeafNode(2, 16, Index_StoreNumeric);
+    NumericRange_Add(leaf->range, i + 1, i * 10, 1);
+    if (i + 1 == nvine) {
+      *np = leaf;
+      break;
+    }
+    NumericRangeNode *n = (NumericRangeNode *)rm_calloc(1, sizeof(*n));
+    n->value = i * 10 + 5;
+    n->left = leaf;
+    *np = n;
+    np = &n->right;
+  }
+  t->numRanges = 2 * nvine - 1;
+  t->lastDocId = nvine;
+  ASSERT_EQ(nvine - 1, treeDepth(t->root));
+
+  leaves = NumericRangeTree_GetLeafRanges(t);
+  nleaves = array_len(leaves);
+  ASSERT_EQ(nvine, nleaves);
+  rv = NumericRangeTree_Rebalance(t);
+  ASSERT_TRUE(rv.changed);
+  ASSERT_EQ(treeDepth(t->root), t->root->maxDepth);
+  ASSERT_EQ(6, t->root->maxDepth);
+
+  // the leaves and the ranges found are the same after rebuilding the tree
+  NumericRange **rebuilt = NumericRangeTree_GetLeafRanges(t);
+  ASSERT_EQ(nleaves, array_len(rebuilt));
+  for (size_t i = 0; i < nleaves; i++) {
+    ASSERT_EQ(leaves[i], rebuilt[i]);
+    Vector *v = NumericRangeTree_Find(t, leaves[i]->minVal, leaves[i]->maxVal);
+    ASSERT_EQ(1, Vector_Size(v));
+    NumericRange *l;
+    Vector_Get(v, 0, &l);
+    ASSERT_EQ(leaves[i], l);
+    Vector_Free(v);
+  }
+  array_free(rebuilt);
+  array_free(leaves);
+
+  // new values are still added to the right leaves
+  NumericRangeTree_Add(t, nvine + 1, 101);
+  Vector *v = NumericRangeTree_Find(t, 101, 101);
+  ASSERT_EQ(1, Vector_Size(v));
+  NumericRange *found;
+  Vector_Get(v, 0, &found);
+  ASSERT_EQ(2, found->entries->numDocs);
+  Vector_Free(v);
+  NumericRangeTree_Free(t);
+}
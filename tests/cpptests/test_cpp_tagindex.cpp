@@ -1,6 +1,8 @@
 #include "tag_index.h"
+#include "bitset_iterator.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <vector>
 #include <string>
 
@@ -25,7 +27,7 @@ TEST_F(TagIndexTest, testCreate) {
     ASSERT_EQ(0, sz);
   }
 
-  ASSERT_EQ(v.size(), idx->values->cardinality);
+  ASSERT_EQ(v.size(), TagIndex_NumValues(idx));
   ASSERT_EQ(300000, totalSZ);
 
   IndexIterator *it = TagIndex_OpenReader(idx, NULL, "hello", 5, 1);
@@ -49,6 +51,109 @@ TEST_F(TagIndexTest, testCreate) {
   TagIndex_Free(idx);
 }
 
+TEST_F(TagIndexTest, testSortedValues) {
+  TagIndex *idx = NewTagIndex();
+  std::vector<const char *> v{"foo", "bar", "foobar", "fo", "baz", "qux"};
+  for (t_docId d = 1; d <= v.size(); d++) {
+    TagIndex_Index(idx, &v[d - 1], 1, d);
+  }
+  ASSERT_EQ(v.size(), TagIndex_NumValues(idx));
+  ASSERT_TRUE(TagIndex_OpenIndex(idx, "foo", 3, 0) != NULL);
+  ASSERT_TRUE(TagIndex_OpenIndex(idx, "fooba", 5, 0) == NULL);
+
+  TagValue **sorted = TagIndex_SortedValues(idx);
+  std::vector<std::string> expected{"bar", "baz", "fo", "foo", "foobar", "qux"};
+  for (size_t i = 0; i < expected.size(); i++) {
+    ASSERT_EQ(expected[i], std::string(sorted[i]->str, sorted[i]->len));
+  }
+  ASSERT_EQ(2, TagIndex_SeekValue(idx, "fo", 2, 0));
+  ASSERT_EQ(3, TagIndex_SeekValue(idx, "fo", 2, 1));
+  ASSERT_EQ(3, TagIndex_SeekValue(idx, "fob", 3, 0));
+  ASSERT_EQ(0, TagIndex_SeekValue(idx, "", 0, 0));
+  ASSERT_EQ(6, TagIndex_SeekValue(idx, "zzz", 3, 0));
+
+  // the sorted values are kept up to date as values are removed and added
+  TagIndex_DeleteValue(idx, "foo", 3);
+  ASSERT_EQ(v.size() - 1, TagIndex_NumValues(idx));
+  sorted = TagIndex_SortedValues(idx);
+  ASSERT_EQ("foobar", std::string(sorted[3]->str, sorted[3]->len));
+  ASSERT_TRUE(TagIndex_OpenReader(idx, NULL, "foo", 3, 1) == NULL);
+
+  // values are merged in whether or not the view is read in between, and a value can be removed
+  // before it was merged
+  std::vector<std::string> all{"bar", "baz", "fo", "foobar", "qux"};
+  char buf[32];
+  for (t_docId d = 1; d <= 3000; d++) {
+    size_t n = sprintf(buf, d % 2 ? "V%u" : "v%u", (unsigned)(d * 7919 % 3001));
+    const char *s = buf;
+    TagIndex_Index(idx, &s, 1, d);
+    all.push_back(std::string(buf, n));
+    if (d % 100 == 0) {
+      TagIndex_DeleteValue(idx, buf, n);
+      all.pop_back();
+    }
+    if (d % 1500 == 0) {
+      sorted = TagIndex_SortedValues(idx);
+    }
+  }
+  TagIndex_DeleteValue(idx, "baz", 3);
+  all.erase(all.begin() + 1);
+  ASSERT_EQ(all.size(), TagIndex_NumValues(idx));
+  std::sort(all.begin(), all.end(), [](const std::string &a, const std::string &b) {
+    int rc = strcasecmp(a.c_str(), b.c_str());
+    return rc ? rc < 0 : a < b;
+  });
+  sorted = TagIndex_SortedValues(idx);
+  for (size_t i = 0; i < all.size(); i++) {
+    ASSERT_EQ(all[i], std::string(sorted[i]->str, sorted[i]->len)) << i;
+  }
+  TagIndex_Free(idx);
+}
+
+TEST_F(TagIndexTest, testBitsets) {
+  TagIndex *idx = NewTagIndex();
+  const char *even = "even", *odd = "odd";
+  for (t_docId d = 1; d <= 100; d++) {
+    TagIndex_Index(idx, d % 2 ? &odd : &even, 1, d);
+  }
+  ASSERT_TRUE(TagIndex_GetBitset(idx, "even", 4) == NULL);
+
+  // the bitsets of the existing values are built, and the new documents are added to them
+  TagIndex_EnableBitsets(idx);
+  for (t_docId d = 101; d <= 200; d++) {
+    TagIndex_Index(idx, d % 2 ? &odd : &even, 1, d);
+  }
+  const TagBitset *b = TagIndex_GetBitset(idx, "even", 4);
+  ASSERT_TRUE(b != NULL);
+  ASSERT_TRUE(TagIndex_GetBitset(idx, "none", 4) == NULL);
+  size_t count = 0;
+  for (size_t i = 0; i < b->nwords; i++) {
+    count += __builtin_popcountll(b->words[i]);
+  }
+  ASSERT_EQ(100, count);
+
+  uint64_t *words = (uint64_t *)rm_calloc(b->nwords, sizeof(*words));
+  memcpy(words, b->words, b->nwords * sizeof(*words));
+  IndexIterator *it = NewBitsetIterator(words, b->nwords, 1);
+  ASSERT_EQ(100, it->NumEstimated(it->ctx));
+  RSIndexResult *r;
+  t_docId expected = 0;
+  while (INDEXREAD_EOF != it->Read(it->ctx, &r)) {
+    expected += 2;
+    ASSERT_EQ(expected, r->docId);
+  }
+  ASSERT_EQ(200, expected);
+
+  it->Rewind(it->ctx);
+  ASSERT_EQ(INDEXREAD_OK, it->SkipTo(it->ctx, 64, &r));
+  ASSERT_EQ(64, r->docId);
+  ASSERT_EQ(INDEXREAD_NOTFOUND, it->SkipTo(it->ctx, 129, &r));
+  ASSERT_EQ(130, r->docId);
+  ASSERT_EQ(INDEXREAD_EOF, it->SkipTo(it->ctx, 201, &r));
+  it->Free(it);
+  TagIndex_Free(idx);
+}
+
 #define TEST_MY_SEP(sep, str)                     \
   orig = s = strdup(str);                         \
   token = TagIndex_SepString(sep, &s, &tokenLen); \
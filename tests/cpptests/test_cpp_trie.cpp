@@ -2,6 +2,7 @@
 #include "gtest/gtest.h"
 #include "trie/trie.h"
 #include "trie/trie_type.h"
+#include "ngram.h"
 
 #include <set>
 #include <string>
@@ -200,3 +201,81 @@ TEST_F(TrieTest, testFreeCallback) {
 
   TrieType_Free(t);
 }
+
+static int ngramFunc(const char *s, size_t n, void *ctx) {
+  ElemSet *e = (ElemSet *)ctx;
+  std::string xs(s, n);
+  assert(e->end() == e->find(xs));
+  e->insert(xs);
+  return REDISEARCH_OK;
+}
+
+static ElemSet ngramMatches(NgramIndex *idx, const std::string &pattern, bool contains) {
+  ElemSet found;
+  struct timespec timeout = {INT32_MAX, 0};
+  NgramIndex_IterateContains(idx, pattern.c_str(), pattern.size(), contains, ngramFunc, &found,
+                             &timeout);
+  return found;
+}
+
+static ElemSet expectedMatches(const ElemSet &terms, const std::string &pattern, bool contains) {
+  ElemSet expected;
+  for (const auto &term : terms) {
+    if (contains ? term.find(pattern) != std::string::npos
+                 : term.size() >= pattern.size() &&
+                       !term.compare(term.size() - pattern.size(), pattern.size(), pattern)) {
+      expected.insert(term);
+    }
+  }
+  return expected;
+}
+
+TEST_F(TrieTest, testNgramIndex) {
+  NgramIndex *idx = NewNgramIndex(NGRAM_LEN);
+  ElemSet terms;
+  char buf[64];
+  for (int i = 0; i < 3000; ++i) {
+    sprintf(buf, "sku-%04d-%c%c", i * 7 % 10000, 'a' + i % 26, 'a' + i % 5);
+    terms.insert(buf);
+    NgramIndex_Add(idx, buf, strlen(buf));
+    // adding a term twice does nothing
+    NgramIndex_Add(idx, buf, strlen(buf));
+  }
+  ASSERT_EQ(terms.size(), NgramIndex_NumTerms(idx));
+
+  // the n-grams of "abab" are all in "ababx", but not in this order in "babxa"
+  const char *patterns[] = {"a", "-a", "sku", "-00", "0-a", "00-", "14-", "777", "-fa", "abab", "sku-0007-hc"};
+  terms.insert("ababx");
+  NgramIndex_Add(idx, "ababx", 5);
+  terms.insert("babxa");
+  NgramIndex_Add(idx, "babxa", 5);
+  for (const char *p : patterns) {
+    ASSERT_EQ(expectedMatches(terms, p, true), ngramMatches(idx, p, true)) << p;
+    ASSERT_EQ(expectedMatches(terms, p, false), ngramMatches(idx, p, false)) << p;
+  }
+
+  // deleting most terms compacts the ids of the others
+  size_t i = 0;
+  for (auto it = terms.begin(); it != terms.end(); ++i) {
+    if (i % 4) {
+      NgramIndex_Delete(idx, it->c_str(), it->size());
+      it = terms.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  NgramIndex_Delete(idx, "nonexistent", 11);
+  ASSERT_EQ(terms.size(), NgramIndex_NumTerms(idx));
+  for (int i = 0; i < 100; ++i) {
+    sprintf(buf, "sku-%04d-new", i);
+    terms.insert(buf);
+    NgramIndex_Add(idx, buf, strlen(buf));
+  }
+  for (const char *p : patterns) {
+    ASSERT_EQ(expectedMatches(terms, p, true), ngramMatches(idx, p, true)) << p;
+    ASSERT_EQ(expectedMatches(terms, p, false), ngramMatches(idx, p, false)) << p;
+  }
+  ASSERT_EQ(expectedMatches(terms, "-new", true), ngramMatches(idx, "-new", true));
+
+  NgramIndex_Free(idx);
+}
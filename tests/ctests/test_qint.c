@@ -35,5 +35,40 @@ int main(int argc, char **argv) {
   assert(arr[1] == 456);
   assert(arr[2] == 789);
   Buffer_Free(&b);
+
+  // batch decoding of records with all the value widths, with and without trailing blobs
+  for (int len = 1; len <= 4; len++) {
+    for (int skip = 0; skip < 2; skip++) {
+      Buffer_Init(&b, 1024);
+      w = NewBufferWriter(&b);
+      const int N = 300;
+      for (uint32_t i = 0; i < N; i++) {
+        uint32_t vals[4] = {i, i << 8, i << 16, i << 24};
+        if (skip) vals[len - 1] = i % 5;
+        uint32_t expected = vals[len - 1];
+        qint_encode(&w, vals, len);
+        for (uint32_t j = 0; skip && j < expected; j++) {
+          Buffer_Write(&w, "x", 1);
+        }
+      }
+
+      uint32_t out[4 * 64];
+      r = NewBufferReader(&b);
+      uint32_t i = 0;
+      size_t n;
+      while ((n = qint_decode_batch(&r, out, len, skip, 64)) > 0) {
+        for (size_t k = 0; k < n; k++, i++) {
+          uint32_t vals[4] = {i, i << 8, i << 16, i << 24};
+          if (skip) vals[len - 1] = i % 5;
+          for (int j = 0; j < len; j++) {
+            assert(out[k * 4 + j] == vals[j]);
+          }
+        }
+      }
+      assert(i == N);
+      assert(BufferReader_AtEnd(&r));
+      Buffer_Free(&b);
+    }
+  }
   return 0;
 }
\ No newline at end of file
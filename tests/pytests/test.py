@@ -822,6 +822,58 @@ def testSortByWithTie(env):
     env.assertEqual(res1, res2)
 
 
+def testSortByWithoutCount(env):
+    conn = getConnectionByEnv(env)
+    env.expect('ft.create', 'idx', 'ON', 'HASH',
+               'schema', 't', 'text', 'n', 'numeric', 'SORTABLE').ok()
+    N = 3000
+    for i in range(N):
+        conn.execute_command('hset', 'doc%d' % i, 't', 'hello' if i % 3 else 'world', 'n', (i * 37) % 500)
+
+    # the results are read in the order of the field, and are the same as when all are sorted
+    for query in ['hello', '*', '@n:[100 200]']:
+        for order in ['asc', 'desc']:
+            for offset, limit in [(0, 10), (25, 10), (0, 1)]:
+                args = ['ft.search', 'idx', query, 'nocontent', 'sortby', 'n', order, 'limit', offset, limit]
+                expected = env.cmd(*args)
+                res = env.cmd(*(args + ['withoutcount']))
+                env.assertEqual(res[1:], expected[1:])
+                env.assertLessEqual(res[0], offset + limit)
+
+    # documents without a value come last
+    conn.execute_command('hset', 'nonum', 't', 'world')
+    res = env.cmd('ft.search', 'idx', 'world', 'nocontent', 'sortby', 'n', 'desc', 'limit', 0, N, 'withoutcount')
+    env.assertEqual(res[-1], 'nonum')
+    env.assertEqual(len(res) - 1, N // 3 + 1)
+
+def testNumericRangeCount(env):
+    conn = getConnectionByEnv(env)
+    env.expect('ft.create', 'idx', 'ON', 'HASH', 'schema', 'n', 'numeric').ok()
+    N = 3000
+    for i in range(N):
+        conn.execute_command('hset', 'doc%d' % i, 'n', (i * 37) % 500)
+
+    live = set(range(N))
+
+    def expected(lo, hi):
+        return len([i for i in live if lo <= (i * 37) % 500 <= hi])
+
+    # counting the matches of a numeric range gives the same total as reading them
+    for lo, hi in [(0, 499), (100, 200), (250, 250), (600, 700)]:
+        query = '@n:[%d %d]' % (lo, hi)
+        env.assertEqual(env.cmd('ft.search', 'idx', query, 'limit', 0, 0), [expected(lo, hi)])
+        env.assertEqual(env.cmd('ft.aggregate', 'idx', query, 'limit', 0, 0)[0], expected(lo, hi))
+
+    # deleted documents are not counted
+    for i in range(0, N, 3):
+        conn.execute_command('del', 'doc%d' % i)
+        live.remove(i)
+    for lo, hi in [(0, 499), (100, 200)]:
+        query = '@n:[%d %d]' % (lo, hi)
+        env.assertEqual(env.cmd('ft.search', 'idx', query, 'limit', 0, 0), [expected(lo, hi)])
+        res = env.cmd('ft.search', 'idx', query, 'nocontent', 'limit', 0, N)
+        env.assertEqual(res[0], expected(lo, hi))
+
 def testNot(env):
     conn = getConnectionByEnv(env)
     env.expect('ft.create', 'idx', 'ON', 'HASH', 'schema', 'foo', 'text').ok()
@@ -3548,4 +3600,58 @@ def test_emoji(env):
     env.expect('ft.search', 'idx', '😀😁*').equal([1, 'doc4', ['test', '😀😁🙂']])
     env.expect('ft.search', 'idx', '%😀😁%').equal([1, 'doc4', ['test', '😀😁🙂']])
     conn.execute_command('HSET', 'doc4', 'test', '')
-    '''
\ No newline at end of file
+    '''
+
+
+def testResultCache(env):
+    env = Env(moduleArgs='RESULT_CACHE_SIZE 8')
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH', 'SCHEMA', 't', 'TEXT', 'n', 'NUMERIC', 'SORTABLE').ok()
+    for i in range(10):
+        conn.execute_command('HSET', 'doc%d' % i, 't', 'hello world' if i % 2 else 'hello', 'n', i)
+
+    def cache_stats():
+        return to_dict(index_info(env, 'idx')['result_cache_stats'])
+
+    res = env.cmd('FT.SEARCH', 'idx', 'hello', 'SORTBY', 'n', 'DESC', 'LIMIT', 2, 3, 'NOCONTENT')
+    env.assertEqual(res, [10, 'doc7', 'doc6', 'doc5'])
+    # the same query, spelled differently, is answered from the cache
+    env.expect('FT.SEARCH', 'idx', '  hello ', 'SORTBY', 'n', 'DESC', 'LIMIT', 2, 3, 'NOCONTENT').equal(res)
+    env.expect('FT.SEARCH', 'idx', '$w', 'PARAMS', 2, 'w', 'hello', 'SORTBY', 'n', 'DESC',
+               'LIMIT', 2, 3, 'NOCONTENT', 'DIALECT', 2).equal(res)
+    env.expect('FT.SEARCH', 'idx', 'hello world', 'LIMIT', 0, 0).equal([5])
+    env.expect('FT.SEARCH', 'idx', 'hello world', 'LIMIT', 0, 0).equal([5])
+    stats = cache_stats()
+    env.assertEqual(stats['hits'], 3)
+    env.assertEqual(stats['misses'], 2)
+    env.assertEqual(stats['entries'], 2)
+
+    # scores are cached along with the documents
+    res = env.cmd('FT.SEARCH', 'idx', 'world', 'WITHSCORES', 'NOCONTENT')
+    env.expect('FT.SEARCH', 'idx', 'world', 'WITHSCORES', 'NOCONTENT').equal(res)
+
+    # different options are different entries
+    env.expect('FT.SEARCH', 'idx', 'hello', 'SORTBY', 'n', 'ASC', 'LIMIT', 2, 3, 'NOCONTENT').equal([10, 'doc2', 'doc3', 'doc4'])
+    env.assertEqual(cache_stats()['hits'], 4)
+
+    # any write invalidates the cached results
+    conn.execute_command('HSET', 'doc10', 't', 'hello world', 'n', 10)
+    env.expect('FT.SEARCH', 'idx', 'hello world', 'LIMIT', 0, 0).equal([6])
+    conn.execute_command('DEL', 'doc10')
+    env.expect('FT.SEARCH', 'idx', 'hello world', 'LIMIT', 0, 0).equal([5])
+    env.assertEqual(cache_stats()['hits'], 4)
+
+    # pages larger than the memory limit are not cached
+    env.assertTrue(float(cache_stats()['size_mb']) > 0)
+    env.expect('FT.CONFIG', 'SET', 'RESULT_CACHE_MAX_MEMORY', 200).ok()
+    res = env.cmd('FT.SEARCH', 'idx', 'hello', 'LIMIT', 0, 10, 'NOCONTENT')
+    env.expect('FT.SEARCH', 'idx', 'hello', 'LIMIT', 0, 10, 'NOCONTENT').equal(res)
+    env.assertEqual(cache_stats()['hits'], 4)
+    env.expect('FT.CONFIG', 'SET', 'RESULT_CACHE_MAX_MEMORY', 16 * 1024 * 1024).ok()
+
+    # the cache is disabled when its size is 0
+    env.expect('FT.CONFIG', 'SET', 'RESULT_CACHE_SIZE', 0).ok()
+    env.expect('FT.SEARCH', 'idx', 'hello world', 'LIMIT', 0, 0).equal([5])
+    env.expect('FT.SEARCH', 'idx', 'hello world', 'LIMIT', 0, 0).equal([5])
+    env.assertEqual(cache_stats()['hits'], 4)
@@ -37,16 +37,23 @@ def testGetConfigOptions(env):
     assert env.expect('ft.config', 'get', 'GC_POLICY').res[0][0] =='GC_POLICY'
     assert env.expect('ft.config', 'get', 'FORK_GC_RUN_INTERVAL').res[0][0] =='FORK_GC_RUN_INTERVAL'
     assert env.expect('ft.config', 'get', 'FORK_GC_CLEAN_THRESHOLD').res[0][0] =='FORK_GC_CLEAN_THRESHOLD'
+    assert env.expect('ft.config', 'get', 'FORK_GC_COMPACT_DOCIDS_RATIO').res[0][0] =='FORK_GC_COMPACT_DOCIDS_RATIO'
     assert env.expect('ft.config', 'get', 'FORK_GC_RETRY_INTERVAL').res[0][0] =='FORK_GC_RETRY_INTERVAL'
     assert env.expect('ft.config', 'get', '_MAX_RESULTS_TO_UNSORTED_MODE').res[0][0] =='_MAX_RESULTS_TO_UNSORTED_MODE'
     assert env.expect('ft.config', 'get', 'PARTIAL_INDEXED_DOCS').res[0][0] =='PARTIAL_INDEXED_DOCS'
     assert env.expect('ft.config', 'get', 'UNION_ITERATOR_HEAP').res[0][0] =='UNION_ITERATOR_HEAP'
+    assert env.expect('ft.config', 'get', 'UNION_ITERATOR_ACCUMULATE').res[0][0] =='UNION_ITERATOR_ACCUMULATE'
+    assert env.expect('ft.config', 'get', 'EXPANSION_CACHE_MAX_MEMORY').res[0][0] =='EXPANSION_CACHE_MAX_MEMORY'
+    assert env.expect('ft.config', 'get', 'RESULT_CACHE_SIZE').res[0][0] =='RESULT_CACHE_SIZE'
+    assert env.expect('ft.config', 'get', 'RESULT_CACHE_TTL').res[0][0] =='RESULT_CACHE_TTL'
+    assert env.expect('ft.config', 'get', 'RESULT_CACHE_MAX_MEMORY').res[0][0] =='RESULT_CACHE_MAX_MEMORY'
     assert env.expect('ft.config', 'get', '_NUMERIC_COMPRESS').res[0][0] =='_NUMERIC_COMPRESS'
     assert env.expect('ft.config', 'get', '_NUMERIC_RANGES_PARENTS').res[0][0] =='_NUMERIC_RANGES_PARENTS'
     assert env.expect('ft.config', 'get', 'RAW_DOCID_ENCODING').res[0][0] =='RAW_DOCID_ENCODING'
     assert env.expect('ft.config', 'get', 'FORK_GC_CLEAN_NUMERIC_EMPTY_NODES').res[0][0] =='FORK_GC_CLEAN_NUMERIC_EMPTY_NODES'
     assert env.expect('ft.config', 'get', '_FORK_GC_CLEAN_NUMERIC_EMPTY_NODES').res[0][0] =='_FORK_GC_CLEAN_NUMERIC_EMPTY_NODES'
     assert env.expect('ft.config', 'get', '_FREE_RESOURCE_ON_THREAD').res[0][0] =='_FREE_RESOURCE_ON_THREAD'
+    assert env.expect('ft.config', 'get', '_TOPK_PRUNING').res[0][0] =='_TOPK_PRUNING'
 
 '''
 
@@ -109,6 +116,7 @@ def testAllConfig(env):
     env.assertEqual(res_dict['MIN_PHONETIC_TERM_LEN'][0], '3')
     env.assertEqual(res_dict['FORK_GC_RUN_INTERVAL'][0], '30')
     env.assertEqual(res_dict['FORK_GC_CLEAN_THRESHOLD'][0], '100')
+    env.assertEqual(res_dict['FORK_GC_COMPACT_DOCIDS_RATIO'][0], '0')
     env.assertEqual(res_dict['FORK_GC_RETRY_INTERVAL'][0], '5')
     env.assertEqual(res_dict['CURSOR_MAX_IDLE'][0], '300000')
     env.assertEqual(res_dict['NO_MEM_POOLS'][0], 'false')
@@ -118,6 +126,7 @@ def testAllConfig(env):
     env.assertEqual(res_dict['FORK_GC_CLEAN_NUMERIC_EMPTY_NODES'][0], 'true')
     env.assertEqual(res_dict['_FORK_GC_CLEAN_NUMERIC_EMPTY_NODES'][0], 'true')
     env.assertEqual(res_dict['_FREE_RESOURCE_ON_THREAD'][0], 'true')
+    env.assertEqual(res_dict['_TOPK_PRUNING'][0], 'false')
 
     # skip ctest configured tests
     #env.assertEqual(res_dict['GC_POLICY'][0], 'fork')
@@ -148,9 +157,15 @@ def testInitConfig(env):
     test_arg_num('MIN_PHONETIC_TERM_LEN', 3)
     test_arg_num('FORK_GC_RUN_INTERVAL', 3)
     test_arg_num('FORK_GC_CLEAN_THRESHOLD', 3)
+    test_arg_num('FORK_GC_COMPACT_DOCIDS_RATIO', 4)
     test_arg_num('FORK_GC_RETRY_INTERVAL', 3)
     test_arg_num('_MAX_RESULTS_TO_UNSORTED_MODE', 3)
     test_arg_num('UNION_ITERATOR_HEAP', 20)
+    test_arg_num('UNION_ITERATOR_ACCUMULATE', 0)
+    test_arg_num('EXPANSION_CACHE_MAX_MEMORY', 1024)
+    test_arg_num('RESULT_CACHE_SIZE', 128)
+    test_arg_num('RESULT_CACHE_TTL', 1000)
+    test_arg_num('RESULT_CACHE_MAX_MEMORY', 4096)
     test_arg_num('_NUMERIC_RANGES_PARENTS', 1)
 
     # True/False arguments
@@ -194,6 +209,8 @@ def testInitConfig(env):
     test_arg_str('_FORK_GC_CLEAN_NUMERIC_EMPTY_NODES', 'true', 'true')
     test_arg_str('_FREE_RESOURCE_ON_THREAD', 'false', 'false')
     test_arg_str('_FREE_RESOURCE_ON_THREAD', 'true', 'true')
+    test_arg_str('_TOPK_PRUNING', 'false', 'false')
+    test_arg_str('_TOPK_PRUNING', 'true', 'true')
 
 def testImmutable(env):
     env.skipOnCluster()
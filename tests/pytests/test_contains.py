@@ -364,3 +364,115 @@ def test_params(env):
   env.expect('ft.search', 'idx', '$prefix*', 'PARAMS', 2, 'prefix', 'wor').equal([1, 'doc1', ['t', 'world']])
   env.expect('ft.search', 'idx', '*$contains*', 'PARAMS', 2, 'contains', 'orl').equal([1, 'doc1', ['t', 'world']])
   env.expect('ft.search', 'idx', '*$suffix', 'PARAMS', 2, 'suffix', 'rld').equal([1, 'doc1', ['t', 'world']])
+
+def testExpansionCache(env):
+  env = Env(moduleArgs='UNION_ITERATOR_ACCUMULATE 1')
+  env.skipOnCluster()
+  conn = getConnectionByEnv(env)
+  env.cmd('ft.create', 'idx', 'SCHEMA', 't', 'TEXT')
+  for i in range(10):
+    conn.execute_command('HSET', 'doc%d' % i, 't', 'hello%d world' % i)
+
+  def cache_stats():
+    return to_dict(index_info(env, 'idx')['expansion_cache_stats'])
+
+  for _ in range(3):
+    env.expect('ft.search', 'idx', 'hell*', 'NOCONTENT', 'LIMIT', 0, 0).equal([10])
+    env.expect('ft.search', 'idx', '*llo5*', 'NOCONTENT').equal([1, 'doc5'])
+  stats = cache_stats()
+  env.assertEqual(stats['hits'], 4)
+  env.assertEqual(stats['misses'], 2)
+  env.assertEqual(stats['entries'], 2)
+
+  # indexing a matching term evicts the cached expansion
+  conn.execute_command('HSET', 'doc10', 't', 'helloo')
+  env.assertEqual(cache_stats()['entries'], 1)
+  env.expect('ft.search', 'idx', 'hell*', 'NOCONTENT', 'LIMIT', 0, 0).equal([11])
+
+  # deleted documents are not returned from the cache
+  conn.execute_command('DEL', 'doc5')
+  env.expect('ft.search', 'idx', '*llo5*', 'NOCONTENT').equal([0])
+
+  # positions are not cached
+  env.expect('ft.search', 'idx', 'hell* world', 'SLOP', 0, 'NOCONTENT', 'LIMIT', 0, 0).equal([9])
+  env.assertEqual(cache_stats()['hits'], 5)
+
+def testExpansionCacheSmallExpansions(env):
+  # expansions below UNION_ITERATOR_ACCUMULATE are cached as well
+  env.skipOnCluster()
+  conn = getConnectionByEnv(env)
+  env.cmd('ft.create', 'idx', 'SCHEMA', 't', 'TEXT')
+  conn.execute_command('HSET', 'doc1', 't', 'hello')
+  conn.execute_command('HSET', 'doc2', 't', 'help')
+  conn.execute_command('HSET', 'doc3', 't', 'world')
+
+  for _ in range(3):
+    res = env.cmd('ft.search', 'idx', 'hel*', 'NOCONTENT')
+    env.assertEqual(sorted(res[1:]), ['doc1', 'doc2'])
+  stats = to_dict(index_info(env, 'idx')['expansion_cache_stats'])
+  env.assertEqual(stats['hits'], 2)
+  env.assertEqual(stats['misses'], 1)
+  env.assertEqual(stats['entries'], 1)
+
+def testWITHNGRAMSParam(env):
+  env.expect('ft.create', 'idx', 'schema', 't', 'TEXT', 'WITHNGRAMS', 'tag', 'TAG', 'WITHNGRAMS', 'SORTABLE').ok()
+  res_info = [['identifier', 't', 'attribute', 't', 'type', 'TEXT', 'WEIGHT', '1', 'WITHNGRAMS'],
+              ['identifier', 'tag', 'attribute', 'tag', 'type', 'TAG', 'SEPARATOR', ',', 'SORTABLE', 'WITHNGRAMS']]
+  assertInfoField(env, 'idx', 'attributes', res_info)
+
+def testNgrams(env):
+  env.skipOnCluster()
+  env.expect('ft.config', 'set', 'MINPREFIX', 1).ok()
+  env.expect('ft.config', 'set', 'MAXEXPANSIONS', 10000000).equal('OK')
+  env.expect('ft.config set FORK_GC_CLEAN_THRESHOLD 0').ok()
+  conn = getConnectionByEnv(env)
+
+  # the same queries are answered by a walk over all terms, the suffix trie and the n-gram index
+  index_list = ['idx_bf', 'idx_suffix', 'idx_ngrams']
+  env.cmd('ft.create', 'idx_bf', 'PREFIX', 1, 'bf:', 'SCHEMA', 't', 'TEXT', 'tag', 'TAG')
+  env.cmd('ft.create', 'idx_suffix', 'PREFIX', 1, 'suffix:', 'SCHEMA', 't', 'TEXT', 'WITHSUFFIXTRIE', 'tag', 'TAG', 'WITHSUFFIXTRIE')
+  env.cmd('ft.create', 'idx_ngrams', 'PREFIX', 1, 'ngrams:', 'SCHEMA', 't', 'TEXT', 'WITHNGRAMS', 'tag', 'TAG', 'WITHNGRAMS')
+
+  pl = conn.pipeline()
+  for prefix in ['bf:', 'suffix:', 'ngrams:']:
+    for i in range(1000):
+      sku = 'sku%04dx%d' % (i * 7 % 10000, i % 3)
+      pl.execute_command('HSET', '%s%d' % (prefix, i), 't', sku, 'tag', sku)
+  pl.execute()
+
+  queries = ['*ku*', '*0x1*', '*77*', '*777*', '*x2', '*7x1', '*kux*', '*x*', '*sku0007x1*']
+  def check():
+    for query in queries:
+      res = [env.cmd('ft.search', idx, query, 'LIMIT', 0, 0) for idx in index_list]
+      env.assertEqual(res[0], res[1], message=query)
+      env.assertEqual(res[0], res[2], message=query)
+      tag_query = '@tag:{%s}' % query
+      res = [env.cmd('ft.search', idx, tag_query, 'LIMIT', 0, 0) for idx in index_list]
+      env.assertEqual(res[0], res[1], message=tag_query)
+      env.assertEqual(res[0], res[2], message=tag_query)
+  check()
+  env.expect('ft.search', 'idx_ngrams', '*777*', 'LIMIT', 0, 0).equal([1])
+  env.expect('ft.search', 'idx_ngrams', '@tag:{*7x1}', 'LIMIT', 0, 0).equal([34])
+  env.assertTrue(float(index_info(env, 'idx_ngrams')['ngram_index_sz_mb']) > 0)
+  env.assertFalse('ngram_index_sz_mb' in index_info(env, 'idx_suffix'))
+
+  # terms of deleted documents are removed from the n-gram index by the gc
+  for prefix in ['bf:', 'suffix:', 'ngrams:']:
+    for i in range(0, 1000, 2):
+      conn.execute_command('DEL', '%s%d' % (prefix, i))
+  for idx in index_list:
+    forceInvokeGC(env, idx)
+  check()
+
+def testNgramsMixedFields(env):
+  env.skipOnCluster()
+  conn = getConnectionByEnv(env)
+  conn.execute_command('FT.CREATE', 'idx', 'SCHEMA', 't1', 'TEXT', 'WITHNGRAMS', 't2', 'TEXT')
+  conn.execute_command('HSET', 'doc1', 't1', 'hello', 't2', 'yellow')
+  conn.execute_command('HSET', 'doc2', 't1', 'world', 't2', 'bellow')
+
+  # a field without an n-gram index is queried by a walk over all terms
+  env.expect('ft.search', 'idx', '@t1:*ell*', 'NOCONTENT').equal([1, 'doc1'])
+  env.expect('ft.search', 'idx', '@t2:*ell*', 'LIMIT', 0, 0).equal([2])
+  env.expect('ft.search', 'idx', '*llow', 'LIMIT', 0, 0).equal([2])
+  env.expect('ft.search', 'idx', '*orl*', 'NOCONTENT').equal([1, 'doc2'])
@@ -269,3 +269,45 @@ def testGFreeEmpryTerms(env):
     forceInvokeGC(env, 'idx')
     env.expect('FT.DEBUG', 'DUMP_TERMS', 'idx').equal([])
 
+
+def testCompactDocIds(env):
+    if env.isCluster():
+        raise unittest.SkipTest()
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH',
+               'SCHEMA', 'title', 'TEXT', 'n', 'NUMERIC', 't', 'TAG').ok()
+    # every document is rewritten twice, so its id is far behind the next one
+    for _ in range(3):
+        for i in range(1, 11):
+            conn.execute_command('HSET', 'doc%d' % i, 'title', 'hello', 'n', i, 't', 'tag%d' % (i % 2))
+    conn.execute_command('DEL', 'doc10')
+
+    res = to_dict(env.cmd('FT.DEBUG', 'COMPACT_DOCIDS', 'idx'))
+    env.assertEqual(res['max_doc_id_before'], 30)
+    env.assertEqual(res['max_doc_id_after'], 9)
+    env.assertLess(res['inverted_size_after'], res['inverted_size_before'])
+
+    env.assertEqual(env.cmd('FT.DEBUG', 'DUMP_INVIDX', 'idx', 'hello'), list(range(1, 10)))
+    env.assertEqual(env.cmd('FT.DEBUG', 'DUMP_TAGIDX', 'idx', 't'),
+                    [['tag0', [2, 4, 6, 8]], ['tag1', [1, 3, 5, 7, 9]]])
+    env.assertEqual(env.cmd('FT.DEBUG', 'DOCIDTOID', 'idx', 'doc3'), 3)
+    env.expect('FT.SEARCH', 'idx', '@n:[3 4]', 'NOCONTENT', 'SORTBY', 'n').equal([2, 'doc3', 'doc4'])
+
+    # new documents keep counting from the compacted ids
+    conn.execute_command('HSET', 'doc11', 'title', 'hello', 'n', 11, 't', 'tag1')
+    env.assertEqual(env.cmd('FT.DEBUG', 'DOCIDTOID', 'idx', 'doc11'), 10)
+
+    # finished and failed queries don't hold the ids of the index
+    env.cmd('FT.AGGREGATE', 'idx', 'hello', 'GROUPBY', 1, '@t', 'REDUCE', 'COUNT', 0)
+    env.expect('FT.SEARCH', 'idx', 'hello', 'SORTBY', 'nosuchfield').error()
+    conn.execute_command('DEL', 'doc1')
+    res = to_dict(env.cmd('FT.DEBUG', 'COMPACT_DOCIDS', 'idx'))
+    env.assertEqual(res['max_doc_id_after'], 9)
+
+def testCompactDocIdsVector(env):
+    if env.isCluster():
+        raise unittest.SkipTest()
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH', 'SCHEMA',
+               'v', 'VECTOR', 'FLAT', '6', 'TYPE', 'FLOAT32', 'DIM', '2', 'DISTANCE_METRIC', 'L2').ok()
+    env.expect('FT.DEBUG', 'COMPACT_DOCIDS', 'idx').error() \
+       .contains('Can not renumber the documents of an index with vector fields')
@@ -1,5 +1,5 @@
 from RLTest import Env
-from common import getConnectionByEnv
+from common import getConnectionByEnv, toSortedFlatList
 
 def testGeoHset(env):
   conn = getConnectionByEnv(env)
@@ -117,3 +117,66 @@ def testGeoDistanceFile(env):
               'APPLY', 'geodistance(@location,-0.15036,51.50566)', 'AS', 'distance',
               'GROUPBY', '1', '@distance',
               'SORTBY', 2, '@distance', 'ASC').equal(res)
+
+def testGeoKnn(env):
+  env.skipOnCluster()
+  conn = getConnectionByEnv(env)
+  env.expect('FT.CREATE', 'idx', 'SCHEMA', 'location', 'GEO', 'type', 'TAG').ok()
+  conn.execute_command('HSET', 'geo1', 'location', '1.22,4.56', 'type', 'cafe')
+  conn.execute_command('HSET', 'geo2', 'location', '1.24,4.56', 'type', 'bar')
+  conn.execute_command('HSET', 'geo3', 'location', '1.23,4.55', 'type', 'cafe')
+  conn.execute_command('HSET', 'geo4', 'location', '1.23,4.57', 'type', 'bar')
+
+  # the nearest points, with their distance in meters
+  res = env.cmd('FT.SEARCH', 'idx', '@location:[KNN 2 1.25 4.5]', 'SORTBY', '__location_distance',
+                'RETURN', 1, '__location_distance', 'DIALECT', 2)
+  env.assertEqual([res[0], res[1], res[3]], [2, 'geo1', 'geo2'])
+  env.assertAlmostEqual(float(res[2][1]), 5987.15, 0.01)
+  env.assertAlmostEqual(float(res[4][1]), 6765.06, 0.01)
+
+  # the nearest of the documents matching the rest of the query
+  env.expect('FT.SEARCH', 'idx', '@type:{bar} @location:[KNN 1 1.25 4.5]', 'NOCONTENT',
+             'DIALECT', 2).equal([1, 'geo2'])
+  env.expect('FT.SEARCH', 'idx', '@type:{cafe} @location:[KNN 2 1.25 4.5]', 'NOCONTENT',
+             'SORTBY', '__location_distance', 'DESC', 'DIALECT', 2).equal([2, 'geo3', 'geo1'])
+  env.expect('FT.SEARCH', 'idx', '@location:[KNN $k $lon $lat]', 'NOCONTENT',
+             'PARAMS', 6, 'k', 10, 'lon', 1.25, 'lat', 4.5, 'DIALECT', 2).equal([4, 'geo1', 'geo2', 'geo3', 'geo4'])
+
+  env.expect('FT.SEARCH', 'idx', '@location:[KNN 0 1.25 4.5]', 'DIALECT', 2).error().contains('Syntax error')
+  env.expect('FT.SEARCH', 'idx', '@location:[KNN $k 1.25 4.5]', 'PARAMS', 2, 'k', 0,
+             'DIALECT', 2).error().contains('Invalid GeoFilter KNN k')
+  env.expect('FT.SEARCH', 'idx', '@location:[KNN 1 1.25 4.5] @location:[KNN 1 1.2 4.5]',
+             'DIALECT', 2).error().contains('Only one KNN clause')
+  env.expect('FT.AGGREGATE', 'idx', '@location:[KNN 1 1.25 4.5]',
+             'DIALECT', 2).error().contains('not yet supported on FT.AGGREGATE')
+
+def testGeoShapes(env):
+  conn = getConnectionByEnv(env)
+  env.expect('FT.CREATE', 'idx', 'SCHEMA', 'location', 'GEO', 'type', 'TAG').ok()
+  conn.execute_command('HSET', 'geo1', 'location', '1.22,4.56', 'type', 'cafe')
+  conn.execute_command('HSET', 'geo2', 'location', '1.24,4.56', 'type', 'bar')
+  conn.execute_command('HSET', 'geo3', 'location', '1.23,4.55', 'type', 'cafe')
+  conn.execute_command('HSET', 'geo4', 'location', '1.23,4.57', 'type', 'bar')
+  conn.execute_command('HSET', 'geo5', 'location', '-179.9,4.56', 'type', 'bar')
+
+  res = env.cmd('FT.SEARCH', 'idx', '@location:[BBOX 1.225 4.5 1.25 4.565]', 'NOCONTENT', 'DIALECT', 2)
+  env.assertEqual(toSortedFlatList(res), toSortedFlatList([2, 'geo2', 'geo3']))
+  env.expect('FT.SEARCH', 'idx', '@type:{cafe} @location:[BBOX 1.225 4.5 1.25 4.565]', 'NOCONTENT',
+             'DIALECT', 2).equal([1, 'geo3'])
+  # a box across the antimeridian
+  env.expect('FT.SEARCH', 'idx', '@location:[BBOX 179 4 -179 5]', 'NOCONTENT',
+             'DIALECT', 2).equal([1, 'geo5'])
+  res = env.cmd('FT.SEARCH', 'idx', '@location:[BBOX $minlon $minlat $maxlon $maxlat]', 'NOCONTENT',
+                'PARAMS', 8, 'minlon', 1.2, 'minlat', 4.5, 'maxlon', 1.3, 'maxlat', 4.6, 'DIALECT', 2)
+  env.assertEqual(toSortedFlatList(res), toSortedFlatList([4, 'geo1', 'geo2', 'geo3', 'geo4']))
+
+  # a triangle which contains geo1 and geo4 but not the rest of its bounding box
+  res = env.cmd('FT.SEARCH', 'idx', '@location:[POLYGON 1.21 4.54 1.24 4.58 1.21 4.58]', 'NOCONTENT',
+                'DIALECT', 2)
+  env.assertEqual(toSortedFlatList(res), toSortedFlatList([2, 'geo1', 'geo4']))
+
+  env.expect('FT.SEARCH', 'idx', '@location:[POLYGON 1.21 4.55 1.21 4.58]', 'DIALECT', 2).error().contains('Syntax error')
+  env.expect('FT.SEARCH', 'idx', '@location:[BOX 1.2 4.5 1.3 4.6]', 'DIALECT', 2).error().contains('Syntax error')
+  env.expect('FT.SEARCH', 'idx', '@location:[BBOX 1.2 4.6 1.3 4.5]', 'DIALECT', 2).error().contains('Invalid GeoFilter box')
+  env.expect('FT.SEARCH', 'idx', '@location:[BBOX $minlon 4.5 1.3 4.6]', 'PARAMS', 2, 'minlon', 200,
+             'DIALECT', 2).error().contains('Invalid GeoFilter lat/lon')
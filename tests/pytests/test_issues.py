@@ -255,16 +255,16 @@ def testMemAllocated(env):
   env.execute_command('FT.CREATE', 'idx1', 'SCHEMA', 't', 'TEXT')
   assertInfoField(env, 'idx1', 'key_table_size_mb', '0')
   conn.execute_command('HSET', 'doc1', 't', 'foo bar baz')
-  assertInfoField(env, 'idx1', 'key_table_size_mb', '2.765655517578125e-05')
+  assertInfoField(env, 'idx1', 'key_table_size_mb', '6.866455078125e-05')
   conn.execute_command('HSET', 'doc2', 't', 'hello world')
-  assertInfoField(env, 'idx1', 'key_table_size_mb', '8.296966552734375e-05')
+  assertInfoField(env, 'idx1', 'key_table_size_mb', '6.866455078125e-05')
   conn.execute_command('HSET', 'd3', 't', 'help')
-  assertInfoField(env, 'idx1', 'key_table_size_mb', '0.00013828277587890625')
+  assertInfoField(env, 'idx1', 'key_table_size_mb', '6.866455078125e-05')
 
   conn.execute_command('DEL', 'd3')
-  assertInfoField(env, 'idx1', 'key_table_size_mb', '8.296966552734375e-05')
+  assertInfoField(env, 'idx1', 'key_table_size_mb', '6.866455078125e-05')
   conn.execute_command('DEL', 'doc1')
-  assertInfoField(env, 'idx1', 'key_table_size_mb', '2.765655517578125e-05')
+  assertInfoField(env, 'idx1', 'key_table_size_mb', '6.866455078125e-05')
   conn.execute_command('DEL', 'doc2')
   assertInfoField(env, 'idx1', 'key_table_size_mb', '0')
 
@@ -272,7 +272,7 @@ def testMemAllocated(env):
   env.execute_command('FT.CREATE', 'idx2', 'SCHEMA', 't', 'TEXT')
   for i in range(1000):
     conn.execute_command('HSET', 'doc%d' % i, 't', 'text%d' % i)
-  assertInfoField(env, 'idx2', 'key_table_size_mb', '0.027684211730957031')
+  assertInfoField(env, 'idx2', 'key_table_size_mb', '0.017578125')
 
   for i in range(1000):
     conn.execute_command('DEL', 'doc%d' % i)
@@ -143,3 +143,43 @@ def testEmptyNumericLeakCenter(env):
 
     res = env.cmd('FT.SEARCH', 'idx', '@n:[-inf + inf]', 'NOCONTENT')
     env.assertEqual(res[0], docs / 100 + 100)
+
+def testPackedNumeric(env):
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CREATE', 'idx', 'SCHEMA', 'ts', 'NUMERIC', 'COMPRESSED', 'SORTABLE').ok()
+    env.expect('FT.CREATE', 'idx_plain', 'SCHEMA', 'ts', 'NUMERIC', 'SORTABLE').ok()
+
+    res = env.cmd('FT.INFO', 'idx')
+    env.assertContains('COMPRESSED', res[res.index('attributes') + 1][0])
+
+    # millisecond timestamps, with a few fractional values which keep their blocks encoded
+    N = 3000
+    start = 1700000000000
+    values = {}
+    pl = conn.pipeline()
+    for i in range(N):
+        values[i] = start + i * 1500 + (i * 7919) % 1000
+        if i % 401 == 0:
+            values[i] += 0.5
+        pl.execute_command('HSET', 'doc%d' % i, 'ts', values[i])
+    pl.execute()
+
+    def check():
+        for lo, hi in [(start, start + N * 1500), (start + 100000, start + 900000), (start + 5, start + 5)]:
+            count = len([i for i in values if lo <= values[i] <= hi])
+            q = '@ts:[%d %d]' % (lo, hi)
+            for idx in ['idx', 'idx_plain']:
+                env.assertEqual(env.cmd('FT.SEARCH', idx, q, 'LIMIT', 0, 0)[0], count)
+            res = env.cmd('FT.SEARCH', 'idx', q, 'SORTBY', 'ts', 'RETURN', 1, 'ts', 'LIMIT', 0, 10)
+            env.assertEqual(res, env.cmd('FT.SEARCH', 'idx_plain', q, 'SORTBY', 'ts', 'RETURN', 1, 'ts', 'LIMIT', 0, 10))
+
+    for _ in env.retry_with_rdb_reload():
+        waitForIndex(env, 'idx')
+        check()
+
+    # garbage collection of the packed blocks
+    for i in range(0, N, 3):
+        conn.execute_command('DEL', 'doc%d' % i)
+        del values[i]
+    forceInvokeGC(env, 'idx')
+    check()
@@ -179,7 +179,8 @@ def testProfileNumeric(env):
 
   actual_res = conn.execute_command('ft.profile', 'idx', 'search', 'query', '@n:[0,100]', 'nocontent')
   expected_res = ['Iterators profile', ['Type', 'UNION', 'Query type', 'NUMERIC', 'Counter', 5010, 'Child iterators',
-                    ['Type', 'NUMERIC', 'Term', '-2.9 - 14.4', 'Counter', 1450, 'Size', 1740],
+                    ['Type', 'NUMERIC', 'Term', '-2.9 - 14.4', 'Counter', 1450, 'Size', 1740,
+                     'Blocks skipped', 0, 'Blocks matched', 6],
                     ['Type', 'NUMERIC', 'Term', '14.5 - 30.7', 'Counter', 1630, 'Size', 1630],
                     ['Type', 'NUMERIC', 'Term', '30.8 - 38', 'Counter', 730, 'Size', 730],
                     ['Type', 'NUMERIC', 'Term', '38.1 - 44.6', 'Counter', 660, 'Size', 660],
@@ -189,6 +190,11 @@ def testProfileNumeric(env):
 
   env.assertEqual(actual_res[1][3], expected_res)
 
+  # blocks without a value in the filter are skipped
+  actual_res = conn.execute_command('ft.profile', 'idx', 'search', 'query', '@n:[-2,-1]', 'nocontent')
+  env.assertEqual(actual_res[0][0], 110)
+  env.assertEqual(actual_res[1][3][8:], ['Blocks skipped', 7, 'Blocks matched', 0])
+
 def testProfileTag(env):
   env.skipOnCluster()
   conn = getConnectionByEnv(env)
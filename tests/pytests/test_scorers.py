@@ -206,3 +206,25 @@ def testScoreError(env):
     waitForIndex(env, 'idx')
     env.expect('ft.add idx doc1 0.01 fields title hello').ok()
     env.expect('ft.search idx hello EXPLAINSCORE').error().contains('EXPLAINSCORE must be accompanied with WITHSCORES')
+
+def testTopKPruning(env):
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    env.expect('ft.create idx ON HASH schema title text body text').ok()
+    waitForIndex(env, 'idx')
+    for i in range(1000):
+        body = 'common ' * (1 + i % 7)
+        if i % 97 == 0:
+            body += 'rare ' * (1 + i % 3)
+        conn.execute_command('HSET', 'doc%d' % i, 'title', 'hello world %d' % i, 'body', body)
+
+    queries = ['common | rare', 'rare | world', 'common rare', '(common | rare) world']
+    for scorer in ['TFIDF', 'TFIDF.DOCNORM', 'BM25']:
+        for q in queries:
+            expected = env.cmd('ft.search', 'idx', q, 'scorer', scorer, 'withscores', 'nocontent', 'limit', 0, 10)
+            env.expect('ft.config', 'set', '_TOPK_PRUNING', 'true').ok()
+            res = env.cmd('ft.search', 'idx', q, 'scorer', scorer, 'withscores', 'nocontent', 'limit', 0, 10)
+            env.expect('ft.config', 'set', '_TOPK_PRUNING', 'false').ok()
+            # the total is an estimate when pruning, but the top results are the same
+            env.assertEqual(expected[1:], res[1:], message='%s %s' % (scorer, q))
+            env.assertLessEqual(res[0], expected[0])
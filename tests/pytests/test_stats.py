@@ -240,3 +240,11 @@ def testDocTableInfo(env):
     env.assertEqual(int(d['num_docs']), 0)
     env.assertEqual(int(d['doc_table_size_mb']), 0)
     env.assertEqual(int(d['sortable_values_size_mb']), 0)
+
+    # the record of the deleted documents is dropped once the gc collected them
+    if not env.isCluster():
+        env.assertGreater(float(d['deleted_bitmap_size_mb']), 0)
+        env.expect('ft.config set FORK_GC_CLEAN_THRESHOLD 0').ok()
+        forceInvokeGC(env, 'idx')
+        d = ft_info_to_dict(env, 'idx')
+        env.assertEqual(float(d['deleted_bitmap_size_mb']), 0)
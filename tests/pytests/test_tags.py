@@ -249,6 +249,124 @@ def testTagCaseSensitive(env):
     env.expect('FT.SEARCH', 'idx4', '@t:{f\\ o}')         \
         .equal([1, 'doc3', ['t', 'f o']])
 
+def testTagCompressed(env):
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CREATE', 'idx', 'SCHEMA', 't', 'TAG', 'COMPRESSED', 'SEPARATOR', ',').ok()
+    env.expect('FT.CREATE', 'idx_plain', 'SCHEMA', 't', 'TAG').ok()
+
+    res = env.cmd('FT.INFO', 'idx')
+    env.assertContains('COMPRESSED', res[res.index('attributes') + 1][0])
+
+    # enough documents for several full blocks, with dense and sparse tags
+    N = 5000
+    pl = conn.pipeline()
+    for i in range(N):
+        tags = ['all']
+        if i % 3 == 0:
+            tags.append('third')
+        if i % 251 == 0:
+            tags.append('rare')
+        pl.execute_command('HSET', 'doc%d' % i, 't', ','.join(tags))
+    pl.execute()
+
+    for _ in env.retry_with_rdb_reload():
+        waitForIndex(env, 'idx')
+        for q, count in [('@t:{all}', N), ('@t:{third}', (N + 2) // 3), ('@t:{rare}', (N + 250) // 251),
+                         ('@t:{third} @t:{rare}', len(range(0, N, 753))),
+                         ('@t:{third} | @t:{rare}', len(set(range(0, N, 3)) | set(range(0, N, 251))))]:
+            env.assertEqual(env.cmd('FT.SEARCH', 'idx', q, 'LIMIT', 0, 0)[0], count)
+            env.assertEqual(env.cmd('FT.SEARCH', 'idx_plain', q, 'LIMIT', 0, 0)[0], count)
+
+def testTagBitset(env):
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CREATE', 'idx', 'SCHEMA', 'c', 'TAG', 'BITSET', 'SORTABLE', 't', 'TAG', 'BITSET').ok()
+    env.expect('FT.CREATE', 'idx_plain', 'SCHEMA', 'c', 'TAG', 'SORTABLE', 't', 'TAG').ok()
+
+    res = env.cmd('FT.INFO', 'idx')
+    env.assertContains('BITSET', res[res.index('attributes') + 1])
+
+    N = 1000
+    colors = ['red', 'green', 'blue', 'black']
+    pl = conn.pipeline()
+    for i in range(N):
+        tags = ['all'] + (['even'] if i % 2 == 0 else []) + (['tenth'] if i % 10 == 0 else [])
+        pl.execute_command('HSET', 'doc%d' % i, 'c', colors[i % 4], 't', ','.join(tags))
+    # a document without a color
+    pl.execute_command('HSET', 'doc%d' % N, 't', 'all')
+    pl.execute()
+
+    def facets(idx, query, field, *byTagValues):
+        res = env.cmd('FT.AGGREGATE', idx, query, 'GROUPBY', 1, '@' + field, *byTagValues,
+                      'REDUCE', 'COUNT', 0, 'AS', 'n', 'REDUCE', 'COUNT', 0, 'AS', 'm')
+        return sorted([(row[1], row[3], row[5]) for row in res[1:]], key=str)
+
+    for _ in env.retry_with_rdb_reload():
+        waitForIndex(env, 'idx')
+        for q in ['@c:{red | blue}', '@c:{red | blue | black} @t:{tenth}', '@t:{even} @c:{green | black}',
+                  '@c:{red | green} @t:{all} @t:{tenth | even}', '-@c:{red | blue}']:
+            env.assertEqual(env.cmd('FT.SEARCH', 'idx', q, 'LIMIT', 0, 0)[0],
+                            env.cmd('FT.SEARCH', 'idx_plain', q, 'LIMIT', 0, 0)[0], message=q)
+            env.assertEqual(toSortedFlatList(env.cmd('FT.SEARCH', 'idx', q, 'NOCONTENT', 'LIMIT', 0, N)),
+                            toSortedFlatList(env.cmd('FT.SEARCH', 'idx_plain', q, 'NOCONTENT', 'LIMIT', 0, N)),
+                            message=q)
+
+        # the facets of single values are the same as the groups of the documents
+        for q in ['*', '@t:{tenth}', '@c:{red | blue}']:
+            env.assertEqual(facets('idx', q, 'c', 'TAGVALUES'), facets('idx_plain', q, 'c'), message=q)
+
+        # a plain GROUPBY on a multi-valued field groups by the value of the field, as without BITSET
+        for q in ['*', '@c:{red}', '@t:{tenth}']:
+            env.assertEqual(facets('idx', q, 't'), facets('idx_plain', q, 't'), message=q)
+        env.assertEqual(facets('idx', '@c:{red}', 't'),
+                        [('all,even', '200', '200'), ('all,even,tenth', '50', '50')])
+
+        # while TAGVALUES counts the documents of each value
+        env.assertEqual(facets('idx', '@c:{red}', 't', 'TAGVALUES'),
+                        [('all', '250', '250'), ('even', '250', '250'), ('tenth', '50', '50')])
+        env.expect('FT.AGGREGATE', 'idx_plain', '*', 'GROUPBY', 1, '@t', 'TAGVALUES',
+                   'REDUCE', 'COUNT', 0).error().contains('TAGVALUES requires a BITSET TAG field')
+        env.expect('FT.AGGREGATE', 'idx', '*', 'GROUPBY', 1, '@t', 'TAGVALUES',
+                   'REDUCE', 'SUM', 1, '@c').error().contains('TAGVALUES only supports COUNT reducers')
+
+    # deleted documents are not counted
+    for i in range(0, N, 4):
+        conn.execute_command('DEL', 'doc%d' % i)
+    forceInvokeGC(env, 'idx')
+    env.assertEqual(facets('idx', '*', 'c', 'TAGVALUES'),
+                    [(None, '1', '1'), ('black', '250', '250'), ('blue', '250', '250'), ('green', '250', '250')])
+    env.assertEqual(env.cmd('FT.SEARCH', 'idx', '@c:{red | blue}', 'LIMIT', 0, 0)[0], 250)
+
+def testTagUuids(env):
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CREATE', 'idx', 'SCHEMA', 't', 'TAG', 'CASESENSITIVE').ok()
+
+    # uuid-like values, a few of them differing only by case
+    N = 1000
+    uuids = ['a%07x-%04x-4000-8000-%012x' % (i * 2654435761 % (1 << 28), i, i * 40503) for i in range(N)]
+    uuids[1] = uuids[2].upper()
+    pl = conn.pipeline()
+    for i, uuid in enumerate(uuids):
+        pl.execute_command('HSET', 'doc%d' % i, 't', uuid)
+    pl.execute()
+
+    for _ in env.retry_with_rdb_reload():
+        waitForIndex(env, 'idx')
+        env.assertEqual(sorted(env.cmd('FT.TAGVALS', 'idx', 't')), sorted(uuids))
+        for i in [0, 1, 2, 500, N - 1]:
+            env.assertEqual(env.cmd('FT.SEARCH', 'idx', '@t:{%s}' % uuids[i].replace('-', '\\-'), 'NOCONTENT'),
+                            [1, 'doc%d' % i])
+
+        # the completions of a prefix are the values starting with it, with the same case
+        prefix = uuids[2][:2]
+        expected = [i for i, uuid in enumerate(uuids) if uuid.startswith(prefix)]
+        res = env.cmd('FT.SEARCH', 'idx', '@t:{%s*}' % prefix, 'NOCONTENT', 'LIMIT', 0, N)
+        env.assertEqual(sorted(res[1:]), sorted(['doc%d' % i for i in expected]))
+        env.assertEqual(res[0], len(expected))
+
+        prefix = uuids[1][:2]
+        res = env.cmd('FT.SEARCH', 'idx', '@t:{%s*}' % prefix, 'NOCONTENT', 'LIMIT', 0, N)
+        env.assertEqual(res[0], len([uuid for uuid in uuids if uuid.startswith(prefix)]))
+
 def testTagGCClearEmpty(env):
     env.skipOnCluster()
 
@@ -258,7 +376,7 @@ def testTagGCClearEmpty(env):
     conn.execute_command('HSET', 'doc1', 't', 'foo')
     conn.execute_command('HSET', 'doc2', 't', 'bar')
     conn.execute_command('HSET', 'doc3', 't', 'baz')
-    env.expect('FT.DEBUG', 'DUMP_TAGIDX', 'idx', 't').equal([['foo', [1]], ['bar', [2]], ['baz', [3]]])
+    env.expect('FT.DEBUG', 'DUMP_TAGIDX', 'idx', 't').equal([['bar', [2]], ['baz', [3]], ['foo', [1]]])
     env.expect('FT.SEARCH', 'idx', '@t:{foo}').equal([1, 'doc1', ['t', 'foo']])
 
     # delete two tags